@@ -90,6 +90,8 @@
     "test/cxx/ConfigKit/SubSchemaTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/ConfigKit/NestedSchemaTest.o" =>
     "test/cxx/ConfigKit/NestedSchemaTest.cpp",
+  "#{TEST_OUTPUT_DIR}cxx/LoggingKit/AsyncWriterTest.o" =>
+    "test/cxx/LoggingKit/AsyncWriterTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/MemoryKit/MbufTest.o" =>
     "test/cxx/MemoryKit/MbufTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/MemoryKit/PallocTest.o" =>
@@ -100,6 +102,8 @@
     "test/cxx/DataStructures/StringKeyTableTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/DataStructures/StringMapTest.o" =>
     "test/cxx/DataStructures/StringMapTest.cpp",
+  "#{TEST_OUTPUT_DIR}cxx/DataStructures/IndexedMinHeapTest.o" =>
+    "test/cxx/DataStructures/IndexedMinHeapTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/FileTools/PathSecurityCheckTest.o" =>
     "test/cxx/FileTools/PathSecurityCheckTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/IOTools/MessageSerializationTest.o" =>
@@ -130,6 +134,8 @@
     "test/cxx/DateParsingTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/UtilsTest.o" =>
     "test/cxx/UtilsTest.cpp",
+  "#{TEST_OUTPUT_DIR}cxx/Algorithms/HasherTest.o" =>
+    "test/cxx/Algorithms/HasherTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/StrIntTools/StrIntUtilsTest.o" =>
     "test/cxx/StrIntTools/StrIntUtilsTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/StrIntTools/TemplateTest.o" =>
@@ -22,6 +22,7 @@
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -55,9 +56,12 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/DataStructures/StringMap.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
    "src/cxx_supportlib/FileTools/FileManip.h",
@@ -107,6 +111,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -170,6 +175,7 @@
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -204,9 +210,12 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/DataStructures/StringMap.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
    "src/cxx_supportlib/FileTools/FileManip.h",
@@ -254,6 +263,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -543,6 +553,7 @@
    "src/cxx_supportlib/Utils/AsyncSignalSafeUtils.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/IniFile.h",
+   "src/cxx_supportlib/Utils/Lock.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
    "src/cxx_supportlib/Utils/Timer.h",
@@ -679,6 +690,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -688,7 +700,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
@@ -778,6 +792,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -787,7 +802,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
@@ -878,6 +895,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -887,7 +905,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
@@ -978,6 +998,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -987,7 +1008,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
@@ -1078,6 +1101,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -1087,7 +1111,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
@@ -1178,6 +1204,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -1187,7 +1214,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
@@ -1279,6 +1308,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -1288,7 +1318,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
@@ -1379,6 +1411,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -1388,7 +1421,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
@@ -1479,6 +1514,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -1488,7 +1524,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
@@ -1579,6 +1617,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -1588,7 +1627,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
@@ -1679,6 +1720,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -1688,7 +1730,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
@@ -1799,6 +1843,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -1810,6 +1855,7 @@
    "src/cxx_supportlib/Constants.h",
    "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/DataStructures/StringMap.h",
@@ -1924,6 +1970,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -1933,7 +1980,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
@@ -2024,6 +2073,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -2033,7 +2083,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
@@ -2124,6 +2176,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -2133,7 +2186,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
@@ -2224,6 +2279,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -2233,7 +2289,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
@@ -2324,6 +2382,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -2333,7 +2392,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
@@ -2424,6 +2485,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -2433,7 +2495,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
@@ -2524,6 +2588,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -2533,7 +2598,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
@@ -2624,6 +2691,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -2633,7 +2701,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
@@ -2724,6 +2794,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -2733,7 +2804,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
@@ -2823,6 +2896,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -2832,7 +2906,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
@@ -2919,6 +2995,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -3142,6 +3219,7 @@
    "src/cxx_supportlib/Utils/AsyncSignalSafeUtils.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/IniFile.h",
+   "src/cxx_supportlib/Utils/Lock.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
    "src/cxx_supportlib/Utils/Timer.h",
@@ -3210,6 +3288,7 @@
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
    "src/agent/Core/SecurityUpdateChecker.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -3248,9 +3327,12 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/DataStructures/StringMap.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
    "src/cxx_supportlib/FileTools/FileManip.h",
@@ -3301,6 +3383,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -3370,6 +3453,7 @@
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
    "src/agent/Core/SecurityUpdateChecker.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -3408,9 +3492,12 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/DataStructures/StringMap.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
    "src/cxx_supportlib/FileTools/FileManip.h",
@@ -3461,6 +3548,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -3550,6 +3638,7 @@
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -3582,9 +3671,12 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/DataStructures/StringMap.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
    "src/cxx_supportlib/FileTools/FileManip.h",
@@ -3630,6 +3722,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -3711,6 +3804,7 @@
    "src/cxx_supportlib/ServerKit/Hooks.h",
    "src/cxx_supportlib/ServerKit/HttpChunkedBodyParserState.h",
    "src/cxx_supportlib/ServerKit/HttpHeaderParserState.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
    "src/cxx_supportlib/StaticString.h",
@@ -3754,6 +3848,7 @@
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -3786,9 +3881,12 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/DataStructures/StringMap.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
    "src/cxx_supportlib/FileTools/FileManip.h",
@@ -3834,6 +3932,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -3895,6 +3994,7 @@
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -3930,6 +4030,7 @@
    "src/cxx_supportlib/Constants.h",
    "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/DataStructures/StringMap.h",
@@ -3978,6 +4079,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -4036,6 +4138,152 @@
    "src/agent/Core/Controller/AppResponse.h",
    "src/agent/Core/Controller/Config.h",
    "src/agent/Core/Controller/Request.h",
+   "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
+   "src/agent/Core/SpawningKit/Config.h",
+   "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
+   "src/agent/Core/SpawningKit/Context.h",
+   "src/agent/Core/SpawningKit/DirectSpawner.h",
+   "src/agent/Core/SpawningKit/DummySpawner.h",
+   "src/agent/Core/SpawningKit/Exceptions.h",
+   "src/agent/Core/SpawningKit/Factory.h",
+   "src/agent/Core/SpawningKit/Handshake/BackgroundIOCapturer.h",
+   "src/agent/Core/SpawningKit/Handshake/Perform.h",
+   "src/agent/Core/SpawningKit/Handshake/Prepare.h",
+   "src/agent/Core/SpawningKit/Handshake/Session.h",
+   "src/agent/Core/SpawningKit/Handshake/WorkDir.h",
+   "src/agent/Core/SpawningKit/Journey.h",
+   "src/agent/Core/SpawningKit/PipeWatcher.h",
+   "src/agent/Core/SpawningKit/Result.h",
+   "src/agent/Core/SpawningKit/Result/AutoGeneratedCode.h",
+   "src/agent/Core/SpawningKit/SmartSpawner.h",
+   "src/agent/Core/SpawningKit/Spawner.h",
+   "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Shared/ApplicationPoolApiKey.h",
+   "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
+   "src/cxx_supportlib/AppLocalConfigFileUtils.h",
+   "src/cxx_supportlib/ConfigKit/Common.h",
+   "src/cxx_supportlib/ConfigKit/ConfigKit.h",
+   "src/cxx_supportlib/ConfigKit/DummyTranslator.h",
+   "src/cxx_supportlib/ConfigKit/Schema.h",
+   "src/cxx_supportlib/ConfigKit/SchemaUtils.h",
+   "src/cxx_supportlib/ConfigKit/Store.h",
+   "src/cxx_supportlib/ConfigKit/Translator.h",
+   "src/cxx_supportlib/ConfigKit/Utils.h",
+   "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
+   "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
+   "src/cxx_supportlib/DataStructures/LString.h",
+   "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/Exceptions.h",
+   "src/cxx_supportlib/FileDescriptor.h",
+   "src/cxx_supportlib/FileTools/FileManip.h",
+   "src/cxx_supportlib/FileTools/PathManip.h",
+   "src/cxx_supportlib/Hooks.h",
+   "src/cxx_supportlib/IOTools/BufferedIO.h",
+   "src/cxx_supportlib/IOTools/IOUtils.h",
+   "src/cxx_supportlib/IOTools/MessageIO.h",
+   "src/cxx_supportlib/Integrations/LibevJsonUtils.h",
+   "src/cxx_supportlib/JsonTools/JsonUtils.h",
+   "src/cxx_supportlib/LoggingKit/Assert.h",
+   "src/cxx_supportlib/LoggingKit/Forward.h",
+   "src/cxx_supportlib/LoggingKit/Logging.h",
+   "src/cxx_supportlib/LoggingKit/LoggingKit.h",
+   "src/cxx_supportlib/LveLoggingDecorator.h",
+   "src/cxx_supportlib/MemoryKit/mbuf.h",
+   "src/cxx_supportlib/MemoryKit/palloc.h",
+   "src/cxx_supportlib/ProcessManagement/Spawn.h",
+   "src/cxx_supportlib/ProcessManagement/Utils.h",
+   "src/cxx_supportlib/RandomGenerator.h",
+   "src/cxx_supportlib/ResourceLocator.h",
+   "src/cxx_supportlib/SafeLibev.h",
+   "src/cxx_supportlib/SecurityKit/MemZeroGuard.h",
+   "src/cxx_supportlib/ServerKit/Channel.h",
+   "src/cxx_supportlib/ServerKit/Client.h",
+   "src/cxx_supportlib/ServerKit/ClientRef.h",
+   "src/cxx_supportlib/ServerKit/Config.h",
+   "src/cxx_supportlib/ServerKit/Context.h",
+   "src/cxx_supportlib/ServerKit/CookieUtils.h",
+   "src/cxx_supportlib/ServerKit/Errors.h",
+   "src/cxx_supportlib/ServerKit/FdSinkChannel.h",
+   "src/cxx_supportlib/ServerKit/FdSourceChannel.h",
+   "src/cxx_supportlib/ServerKit/FileBufferedChannel.h",
+   "src/cxx_supportlib/ServerKit/FileBufferedFdSinkChannel.h",
+   "src/cxx_supportlib/ServerKit/HeaderTable.h",
+   "src/cxx_supportlib/ServerKit/Hooks.h",
+   "src/cxx_supportlib/ServerKit/HttpChunkedBodyParser.h",
+   "src/cxx_supportlib/ServerKit/HttpChunkedBodyParserState.h",
+   "src/cxx_supportlib/ServerKit/HttpClient.h",
+   "src/cxx_supportlib/ServerKit/HttpHeaderParser.h",
+   "src/cxx_supportlib/ServerKit/HttpHeaderParserState.h",
+   "src/cxx_supportlib/ServerKit/HttpRequest.h",
+   "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
+   "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
+   "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/llerrors.h",
+   "src/cxx_supportlib/ServerKit/llhttp.h",
+   "src/cxx_supportlib/ServerKit/url_parser.h",
+   "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/StrIntTools/DateParsing.h",
+   "src/cxx_supportlib/StrIntTools/StrIntUtils.h",
+   "src/cxx_supportlib/StrIntTools/StringScanning.h",
+   "src/cxx_supportlib/SystemTools/ProcessMetricsCollector.h",
+   "src/cxx_supportlib/SystemTools/SystemMetricsCollector.h",
+   "src/cxx_supportlib/SystemTools/SystemTime.h",
+   "src/cxx_supportlib/SystemTools/UserDatabase.h",
+   "src/cxx_supportlib/Utils.h",
+   "src/cxx_supportlib/Utils/AnsiColorConstants.h",
+   "src/cxx_supportlib/Utils/AsyncSignalSafeUtils.h",
+   "src/cxx_supportlib/Utils/FastStringStream.h",
+   "src/cxx_supportlib/Utils/HttpConstants.h",
+   "src/cxx_supportlib/Utils/IniFile.h",
+   "src/cxx_supportlib/Utils/Lock.h",
+   "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/ScopeGuard.h",
+   "src/cxx_supportlib/Utils/SpeedMeter.h",
+   "src/cxx_supportlib/Utils/Timer.h",
+   "src/cxx_supportlib/Utils/VariantMap.h",
+   "src/cxx_supportlib/WrapperRegistry/Entry.h",
+   "src/cxx_supportlib/WrapperRegistry/Registry.h",
+   "src/cxx_supportlib/oxt/backtrace.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_enabled.hpp",
+   "src/cxx_supportlib/oxt/detail/context.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_darwin.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_gcc_x86.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_portable.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_pthreads.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_enabled.hpp",
+   "src/cxx_supportlib/oxt/dynamic_thread_group.hpp",
+   "src/cxx_supportlib/oxt/macros.hpp",
+   "src/cxx_supportlib/oxt/spin_lock.hpp",
+   "src/cxx_supportlib/oxt/system_calls.hpp",
+   "src/cxx_supportlib/oxt/thread.hpp",
+   "src/cxx_supportlib/oxt/tracable_exception.hpp"],
+ "src/agent/Core/Controller/CoalesceRequests.cpp"=>
+  ["src/agent/Core/ApplicationPool/AbstractSession.h",
+   "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
+   "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
+   "src/agent/Core/ApplicationPool/Common.h",
+   "src/agent/Core/ApplicationPool/Context.h",
+   "src/agent/Core/ApplicationPool/Group.h",
+   "src/agent/Core/ApplicationPool/Options.h",
+   "src/agent/Core/ApplicationPool/Pool.h",
+   "src/agent/Core/ApplicationPool/Process.h",
+   "src/agent/Core/ApplicationPool/Session.h",
+   "src/agent/Core/ApplicationPool/Socket.h",
+   "src/agent/Core/Controller.h",
+   "src/agent/Core/Controller/AppResponse.h",
+   "src/agent/Core/Controller/Client.h",
+   "src/agent/Core/Controller/Config.h",
+   "src/agent/Core/Controller/Request.h",
+   "src/agent/Core/Controller/TurboCaching.h",
+   "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -4068,9 +4316,12 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/DataStructures/StringMap.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
    "src/cxx_supportlib/FileTools/FileManip.h",
@@ -4079,6 +4330,7 @@
    "src/cxx_supportlib/IOTools/BufferedIO.h",
    "src/cxx_supportlib/IOTools/IOUtils.h",
    "src/cxx_supportlib/IOTools/MessageIO.h",
+   "src/cxx_supportlib/IOTools/MessageSerialization.h",
    "src/cxx_supportlib/Integrations/LibevJsonUtils.h",
    "src/cxx_supportlib/JsonTools/JsonUtils.h",
    "src/cxx_supportlib/LoggingKit/Assert.h",
@@ -4099,6 +4351,7 @@
    "src/cxx_supportlib/ServerKit/ClientRef.h",
    "src/cxx_supportlib/ServerKit/Config.h",
    "src/cxx_supportlib/ServerKit/Context.h",
+   "src/cxx_supportlib/ServerKit/CookieUtils.h",
    "src/cxx_supportlib/ServerKit/Errors.h",
    "src/cxx_supportlib/ServerKit/FdSinkChannel.h",
    "src/cxx_supportlib/ServerKit/FdSourceChannel.h",
@@ -4114,10 +4367,13 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
+   "src/cxx_supportlib/ServerKit/url_parser.h",
    "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/StrIntTools/DateParsing.h",
    "src/cxx_supportlib/StrIntTools/StrIntUtils.h",
    "src/cxx_supportlib/StrIntTools/StringScanning.h",
    "src/cxx_supportlib/SystemTools/ProcessMetricsCollector.h",
@@ -4173,6 +4429,7 @@
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -4205,9 +4462,12 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/DataStructures/StringMap.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
    "src/cxx_supportlib/FileTools/FileManip.h",
@@ -4253,6 +4513,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -4296,7 +4557,8 @@
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
  "src/agent/Core/Controller/Config.h"=>
-  ["src/cxx_supportlib/Algorithms/Hasher.h",
+  ["src/agent/Core/ApplicationPool/Options.h",
+   "src/cxx_supportlib/Algorithms/Hasher.h",
    "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -4312,6 +4574,7 @@
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
+   "src/cxx_supportlib/FileTools/FileManip.h",
    "src/cxx_supportlib/FileTools/PathManip.h",
    "src/cxx_supportlib/IOTools/IOUtils.h",
    "src/cxx_supportlib/IOTools/MessageIO.h",
@@ -4323,6 +4586,7 @@
    "src/cxx_supportlib/LoggingKit/LoggingKit.h",
    "src/cxx_supportlib/MemoryKit/mbuf.h",
    "src/cxx_supportlib/MemoryKit/palloc.h",
+   "src/cxx_supportlib/ResourceLocator.h",
    "src/cxx_supportlib/SafeLibev.h",
    "src/cxx_supportlib/SecurityKit/MemZeroGuard.h",
    "src/cxx_supportlib/ServerKit/Channel.h",
@@ -4344,6 +4608,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -4354,6 +4619,7 @@
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HttpConstants.h",
+   "src/cxx_supportlib/Utils/IniFile.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/VariantMap.h",
    "src/cxx_supportlib/WrapperRegistry/Entry.h",
@@ -4392,6 +4658,7 @@
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -4424,9 +4691,12 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/DataStructures/StringMap.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
    "src/cxx_supportlib/FileTools/FileManip.h",
@@ -4472,6 +4742,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -4514,7 +4785,317 @@
    "src/cxx_supportlib/oxt/system_calls.hpp",
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
- "src/agent/Core/Controller/Hooks.cpp"=>
+ "src/agent/Core/Controller/Hooks.cpp"=>
+  ["src/agent/Core/ApplicationPool/AbstractSession.h",
+   "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
+   "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
+   "src/agent/Core/ApplicationPool/Common.h",
+   "src/agent/Core/ApplicationPool/Context.h",
+   "src/agent/Core/ApplicationPool/Group.h",
+   "src/agent/Core/ApplicationPool/Options.h",
+   "src/agent/Core/ApplicationPool/Pool.h",
+   "src/agent/Core/ApplicationPool/Process.h",
+   "src/agent/Core/ApplicationPool/Session.h",
+   "src/agent/Core/ApplicationPool/Socket.h",
+   "src/agent/Core/Controller.h",
+   "src/agent/Core/Controller/AppResponse.h",
+   "src/agent/Core/Controller/Client.h",
+   "src/agent/Core/Controller/Config.h",
+   "src/agent/Core/Controller/Request.h",
+   "src/agent/Core/Controller/TurboCaching.h",
+   "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
+   "src/agent/Core/SpawningKit/Config.h",
+   "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
+   "src/agent/Core/SpawningKit/Context.h",
+   "src/agent/Core/SpawningKit/DirectSpawner.h",
+   "src/agent/Core/SpawningKit/DummySpawner.h",
+   "src/agent/Core/SpawningKit/Exceptions.h",
+   "src/agent/Core/SpawningKit/Factory.h",
+   "src/agent/Core/SpawningKit/Handshake/BackgroundIOCapturer.h",
+   "src/agent/Core/SpawningKit/Handshake/Perform.h",
+   "src/agent/Core/SpawningKit/Handshake/Prepare.h",
+   "src/agent/Core/SpawningKit/Handshake/Session.h",
+   "src/agent/Core/SpawningKit/Handshake/WorkDir.h",
+   "src/agent/Core/SpawningKit/Journey.h",
+   "src/agent/Core/SpawningKit/PipeWatcher.h",
+   "src/agent/Core/SpawningKit/Result.h",
+   "src/agent/Core/SpawningKit/Result/AutoGeneratedCode.h",
+   "src/agent/Core/SpawningKit/SmartSpawner.h",
+   "src/agent/Core/SpawningKit/Spawner.h",
+   "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Shared/ApplicationPoolApiKey.h",
+   "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
+   "src/cxx_supportlib/AppLocalConfigFileUtils.h",
+   "src/cxx_supportlib/ConfigKit/Common.h",
+   "src/cxx_supportlib/ConfigKit/ConfigKit.h",
+   "src/cxx_supportlib/ConfigKit/DummyTranslator.h",
+   "src/cxx_supportlib/ConfigKit/Schema.h",
+   "src/cxx_supportlib/ConfigKit/SchemaUtils.h",
+   "src/cxx_supportlib/ConfigKit/Store.h",
+   "src/cxx_supportlib/ConfigKit/Translator.h",
+   "src/cxx_supportlib/ConfigKit/Utils.h",
+   "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
+   "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
+   "src/cxx_supportlib/DataStructures/LString.h",
+   "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/DataStructures/StringMap.h",
+   "src/cxx_supportlib/Exceptions.h",
+   "src/cxx_supportlib/FileDescriptor.h",
+   "src/cxx_supportlib/FileTools/FileManip.h",
+   "src/cxx_supportlib/FileTools/PathManip.h",
+   "src/cxx_supportlib/Hooks.h",
+   "src/cxx_supportlib/IOTools/BufferedIO.h",
+   "src/cxx_supportlib/IOTools/IOUtils.h",
+   "src/cxx_supportlib/IOTools/MessageIO.h",
+   "src/cxx_supportlib/IOTools/MessageSerialization.h",
+   "src/cxx_supportlib/Integrations/LibevJsonUtils.h",
+   "src/cxx_supportlib/JsonTools/JsonUtils.h",
+   "src/cxx_supportlib/LoggingKit/Assert.h",
+   "src/cxx_supportlib/LoggingKit/Forward.h",
+   "src/cxx_supportlib/LoggingKit/Logging.h",
+   "src/cxx_supportlib/LoggingKit/LoggingKit.h",
+   "src/cxx_supportlib/LveLoggingDecorator.h",
+   "src/cxx_supportlib/MemoryKit/mbuf.h",
+   "src/cxx_supportlib/MemoryKit/palloc.h",
+   "src/cxx_supportlib/ProcessManagement/Spawn.h",
+   "src/cxx_supportlib/ProcessManagement/Utils.h",
+   "src/cxx_supportlib/RandomGenerator.h",
+   "src/cxx_supportlib/ResourceLocator.h",
+   "src/cxx_supportlib/SafeLibev.h",
+   "src/cxx_supportlib/SecurityKit/MemZeroGuard.h",
+   "src/cxx_supportlib/ServerKit/Channel.h",
+   "src/cxx_supportlib/ServerKit/Client.h",
+   "src/cxx_supportlib/ServerKit/ClientRef.h",
+   "src/cxx_supportlib/ServerKit/Config.h",
+   "src/cxx_supportlib/ServerKit/Context.h",
+   "src/cxx_supportlib/ServerKit/CookieUtils.h",
+   "src/cxx_supportlib/ServerKit/Errors.h",
+   "src/cxx_supportlib/ServerKit/FdSinkChannel.h",
+   "src/cxx_supportlib/ServerKit/FdSourceChannel.h",
+   "src/cxx_supportlib/ServerKit/FileBufferedChannel.h",
+   "src/cxx_supportlib/ServerKit/FileBufferedFdSinkChannel.h",
+   "src/cxx_supportlib/ServerKit/HeaderTable.h",
+   "src/cxx_supportlib/ServerKit/Hooks.h",
+   "src/cxx_supportlib/ServerKit/HttpChunkedBodyParser.h",
+   "src/cxx_supportlib/ServerKit/HttpChunkedBodyParserState.h",
+   "src/cxx_supportlib/ServerKit/HttpClient.h",
+   "src/cxx_supportlib/ServerKit/HttpHeaderParser.h",
+   "src/cxx_supportlib/ServerKit/HttpHeaderParserState.h",
+   "src/cxx_supportlib/ServerKit/HttpRequest.h",
+   "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
+   "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
+   "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/llerrors.h",
+   "src/cxx_supportlib/ServerKit/llhttp.h",
+   "src/cxx_supportlib/ServerKit/url_parser.h",
+   "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/StrIntTools/DateParsing.h",
+   "src/cxx_supportlib/StrIntTools/StrIntUtils.h",
+   "src/cxx_supportlib/StrIntTools/StringScanning.h",
+   "src/cxx_supportlib/SystemTools/ProcessMetricsCollector.h",
+   "src/cxx_supportlib/SystemTools/SystemMetricsCollector.h",
+   "src/cxx_supportlib/SystemTools/SystemTime.h",
+   "src/cxx_supportlib/SystemTools/UserDatabase.h",
+   "src/cxx_supportlib/Utils.h",
+   "src/cxx_supportlib/Utils/AnsiColorConstants.h",
+   "src/cxx_supportlib/Utils/AsyncSignalSafeUtils.h",
+   "src/cxx_supportlib/Utils/FastStringStream.h",
+   "src/cxx_supportlib/Utils/HttpConstants.h",
+   "src/cxx_supportlib/Utils/IniFile.h",
+   "src/cxx_supportlib/Utils/Lock.h",
+   "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/ScopeGuard.h",
+   "src/cxx_supportlib/Utils/SpeedMeter.h",
+   "src/cxx_supportlib/Utils/Timer.h",
+   "src/cxx_supportlib/Utils/VariantMap.h",
+   "src/cxx_supportlib/WrapperRegistry/Entry.h",
+   "src/cxx_supportlib/WrapperRegistry/Registry.h",
+   "src/cxx_supportlib/oxt/backtrace.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_enabled.hpp",
+   "src/cxx_supportlib/oxt/detail/context.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_darwin.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_gcc_x86.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_portable.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_pthreads.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_enabled.hpp",
+   "src/cxx_supportlib/oxt/dynamic_thread_group.hpp",
+   "src/cxx_supportlib/oxt/macros.hpp",
+   "src/cxx_supportlib/oxt/spin_lock.hpp",
+   "src/cxx_supportlib/oxt/system_calls.hpp",
+   "src/cxx_supportlib/oxt/thread.hpp",
+   "src/cxx_supportlib/oxt/tracable_exception.hpp"],
+ "src/agent/Core/Controller/Implementation.cpp"=>
+  ["src/agent/Core/ApplicationPool/AbstractSession.h",
+   "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
+   "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
+   "src/agent/Core/ApplicationPool/Common.h",
+   "src/agent/Core/ApplicationPool/Context.h",
+   "src/agent/Core/ApplicationPool/Group.h",
+   "src/agent/Core/ApplicationPool/Options.h",
+   "src/agent/Core/ApplicationPool/Pool.h",
+   "src/agent/Core/ApplicationPool/Process.h",
+   "src/agent/Core/ApplicationPool/Session.h",
+   "src/agent/Core/ApplicationPool/Socket.h",
+   "src/agent/Core/Controller.h",
+   "src/agent/Core/Controller/AppResponse.h",
+   "src/agent/Core/Controller/BufferBody.cpp",
+   "src/agent/Core/Controller/CheckoutSession.cpp",
+   "src/agent/Core/Controller/Client.h",
+   "src/agent/Core/Controller/CoalesceRequests.cpp",
+   "src/agent/Core/Controller/Config.cpp",
+   "src/agent/Core/Controller/Config.h",
+   "src/agent/Core/Controller/ForwardResponse.cpp",
+   "src/agent/Core/Controller/Hooks.cpp",
+   "src/agent/Core/Controller/InitRequest.cpp",
+   "src/agent/Core/Controller/InitializationAndShutdown.cpp",
+   "src/agent/Core/Controller/InternalUtils.cpp",
+   "src/agent/Core/Controller/Miscellaneous.cpp",
+   "src/agent/Core/Controller/RefreshTurboCache.cpp",
+   "src/agent/Core/Controller/Request.h",
+   "src/agent/Core/Controller/SendRequest.cpp",
+   "src/agent/Core/Controller/SpliceBody.cpp",
+   "src/agent/Core/Controller/StateInspection.cpp",
+   "src/agent/Core/Controller/TurboCaching.h",
+   "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
+   "src/agent/Core/SpawningKit/Config.h",
+   "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
+   "src/agent/Core/SpawningKit/Context.h",
+   "src/agent/Core/SpawningKit/DirectSpawner.h",
+   "src/agent/Core/SpawningKit/DummySpawner.h",
+   "src/agent/Core/SpawningKit/ErrorRenderer.h",
+   "src/agent/Core/SpawningKit/Exceptions.h",
+   "src/agent/Core/SpawningKit/Factory.h",
+   "src/agent/Core/SpawningKit/Handshake/BackgroundIOCapturer.h",
+   "src/agent/Core/SpawningKit/Handshake/Perform.h",
+   "src/agent/Core/SpawningKit/Handshake/Prepare.h",
+   "src/agent/Core/SpawningKit/Handshake/Session.h",
+   "src/agent/Core/SpawningKit/Handshake/WorkDir.h",
+   "src/agent/Core/SpawningKit/Journey.h",
+   "src/agent/Core/SpawningKit/PipeWatcher.h",
+   "src/agent/Core/SpawningKit/Result.h",
+   "src/agent/Core/SpawningKit/Result/AutoGeneratedCode.h",
+   "src/agent/Core/SpawningKit/SmartSpawner.h",
+   "src/agent/Core/SpawningKit/Spawner.h",
+   "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Shared/ApplicationPoolApiKey.h",
+   "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
+   "src/cxx_supportlib/AppLocalConfigFileUtils.h",
+   "src/cxx_supportlib/AppTypeDetector/Detector.h",
+   "src/cxx_supportlib/ConfigKit/Common.h",
+   "src/cxx_supportlib/ConfigKit/ConfigKit.h",
+   "src/cxx_supportlib/ConfigKit/DummyTranslator.h",
+   "src/cxx_supportlib/ConfigKit/Schema.h",
+   "src/cxx_supportlib/ConfigKit/SchemaUtils.h",
+   "src/cxx_supportlib/ConfigKit/Store.h",
+   "src/cxx_supportlib/ConfigKit/Translator.h",
+   "src/cxx_supportlib/ConfigKit/Utils.h",
+   "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
+   "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
+   "src/cxx_supportlib/DataStructures/LString.h",
+   "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/DataStructures/StringMap.h",
+   "src/cxx_supportlib/Exceptions.h",
+   "src/cxx_supportlib/FileDescriptor.h",
+   "src/cxx_supportlib/FileTools/FileManip.h",
+   "src/cxx_supportlib/FileTools/PathManip.h",
+   "src/cxx_supportlib/Hooks.h",
+   "src/cxx_supportlib/IOTools/BufferedIO.h",
+   "src/cxx_supportlib/IOTools/IOUtils.h",
+   "src/cxx_supportlib/IOTools/MessageIO.h",
+   "src/cxx_supportlib/IOTools/MessageSerialization.h",
+   "src/cxx_supportlib/Integrations/LibevJsonUtils.h",
+   "src/cxx_supportlib/JsonTools/JsonUtils.h",
+   "src/cxx_supportlib/LoggingKit/Assert.h",
+   "src/cxx_supportlib/LoggingKit/Forward.h",
+   "src/cxx_supportlib/LoggingKit/Logging.h",
+   "src/cxx_supportlib/LoggingKit/LoggingKit.h",
+   "src/cxx_supportlib/LveLoggingDecorator.h",
+   "src/cxx_supportlib/MemoryKit/mbuf.h",
+   "src/cxx_supportlib/MemoryKit/palloc.h",
+   "src/cxx_supportlib/ProcessManagement/Spawn.h",
+   "src/cxx_supportlib/ProcessManagement/Utils.h",
+   "src/cxx_supportlib/RandomGenerator.h",
+   "src/cxx_supportlib/ResourceLocator.h",
+   "src/cxx_supportlib/SafeLibev.h",
+   "src/cxx_supportlib/SecurityKit/MemZeroGuard.h",
+   "src/cxx_supportlib/ServerKit/Channel.h",
+   "src/cxx_supportlib/ServerKit/Client.h",
+   "src/cxx_supportlib/ServerKit/ClientRef.h",
+   "src/cxx_supportlib/ServerKit/Config.h",
+   "src/cxx_supportlib/ServerKit/Context.h",
+   "src/cxx_supportlib/ServerKit/CookieUtils.h",
+   "src/cxx_supportlib/ServerKit/Errors.h",
+   "src/cxx_supportlib/ServerKit/FdSinkChannel.h",
+   "src/cxx_supportlib/ServerKit/FdSourceChannel.h",
+   "src/cxx_supportlib/ServerKit/FileBufferedChannel.h",
+   "src/cxx_supportlib/ServerKit/FileBufferedFdSinkChannel.h",
+   "src/cxx_supportlib/ServerKit/HeaderTable.h",
+   "src/cxx_supportlib/ServerKit/Hooks.h",
+   "src/cxx_supportlib/ServerKit/HttpChunkedBodyParser.h",
+   "src/cxx_supportlib/ServerKit/HttpChunkedBodyParserState.h",
+   "src/cxx_supportlib/ServerKit/HttpClient.h",
+   "src/cxx_supportlib/ServerKit/HttpHeaderParser.h",
+   "src/cxx_supportlib/ServerKit/HttpHeaderParserState.h",
+   "src/cxx_supportlib/ServerKit/HttpRequest.h",
+   "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
+   "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
+   "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/llerrors.h",
+   "src/cxx_supportlib/ServerKit/llhttp.h",
+   "src/cxx_supportlib/ServerKit/url_parser.h",
+   "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/StrIntTools/DateParsing.h",
+   "src/cxx_supportlib/StrIntTools/StrIntUtils.h",
+   "src/cxx_supportlib/StrIntTools/StringScanning.h",
+   "src/cxx_supportlib/StrIntTools/Template.h",
+   "src/cxx_supportlib/SystemTools/ProcessMetricsCollector.h",
+   "src/cxx_supportlib/SystemTools/SystemMetricsCollector.h",
+   "src/cxx_supportlib/SystemTools/SystemTime.h",
+   "src/cxx_supportlib/SystemTools/UserDatabase.h",
+   "src/cxx_supportlib/Utils.h",
+   "src/cxx_supportlib/Utils/AnsiColorConstants.h",
+   "src/cxx_supportlib/Utils/AsyncSignalSafeUtils.h",
+   "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/FastStringStream.h",
+   "src/cxx_supportlib/Utils/HttpConstants.h",
+   "src/cxx_supportlib/Utils/IniFile.h",
+   "src/cxx_supportlib/Utils/Lock.h",
+   "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/ScopeGuard.h",
+   "src/cxx_supportlib/Utils/SpeedMeter.h",
+   "src/cxx_supportlib/Utils/Timer.h",
+   "src/cxx_supportlib/Utils/VariantMap.h",
+   "src/cxx_supportlib/WrapperRegistry/Entry.h",
+   "src/cxx_supportlib/WrapperRegistry/Registry.h",
+   "src/cxx_supportlib/oxt/backtrace.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_enabled.hpp",
+   "src/cxx_supportlib/oxt/detail/context.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_darwin.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_gcc_x86.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_portable.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_pthreads.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_enabled.hpp",
+   "src/cxx_supportlib/oxt/dynamic_thread_group.hpp",
+   "src/cxx_supportlib/oxt/macros.hpp",
+   "src/cxx_supportlib/oxt/spin_lock.hpp",
+   "src/cxx_supportlib/oxt/system_calls.hpp",
+   "src/cxx_supportlib/oxt/thread.hpp",
+   "src/cxx_supportlib/oxt/tracable_exception.hpp"],
+ "src/agent/Core/Controller/InitRequest.cpp"=>
   ["src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
@@ -4533,6 +5114,7 @@
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -4556,6 +5138,7 @@
    "src/cxx_supportlib/Algorithms/Hasher.h",
    "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
+   "src/cxx_supportlib/AppTypeDetector/Detector.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
    "src/cxx_supportlib/ConfigKit/DummyTranslator.h",
@@ -4565,9 +5148,12 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/DataStructures/StringMap.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
    "src/cxx_supportlib/FileTools/FileManip.h",
@@ -4613,6 +5199,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -4628,6 +5215,7 @@
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/AnsiColorConstants.h",
    "src/cxx_supportlib/Utils/AsyncSignalSafeUtils.h",
+   "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HttpConstants.h",
    "src/cxx_supportlib/Utils/IniFile.h",
@@ -4655,7 +5243,7 @@
    "src/cxx_supportlib/oxt/system_calls.hpp",
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
- "src/agent/Core/Controller/Implementation.cpp"=>
+ "src/agent/Core/Controller/InitializationAndShutdown.cpp"=>
   ["src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
@@ -4669,28 +5257,17 @@
    "src/agent/Core/ApplicationPool/Socket.h",
    "src/agent/Core/Controller.h",
    "src/agent/Core/Controller/AppResponse.h",
-   "src/agent/Core/Controller/BufferBody.cpp",
-   "src/agent/Core/Controller/CheckoutSession.cpp",
    "src/agent/Core/Controller/Client.h",
-   "src/agent/Core/Controller/Config.cpp",
    "src/agent/Core/Controller/Config.h",
-   "src/agent/Core/Controller/ForwardResponse.cpp",
-   "src/agent/Core/Controller/Hooks.cpp",
-   "src/agent/Core/Controller/InitRequest.cpp",
-   "src/agent/Core/Controller/InitializationAndShutdown.cpp",
-   "src/agent/Core/Controller/InternalUtils.cpp",
-   "src/agent/Core/Controller/Miscellaneous.cpp",
    "src/agent/Core/Controller/Request.h",
-   "src/agent/Core/Controller/SendRequest.cpp",
-   "src/agent/Core/Controller/StateInspection.cpp",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
    "src/agent/Core/SpawningKit/DirectSpawner.h",
    "src/agent/Core/SpawningKit/DummySpawner.h",
-   "src/agent/Core/SpawningKit/ErrorRenderer.h",
    "src/agent/Core/SpawningKit/Exceptions.h",
    "src/agent/Core/SpawningKit/Factory.h",
    "src/agent/Core/SpawningKit/Handshake/BackgroundIOCapturer.h",
@@ -4709,7 +5286,6 @@
    "src/cxx_supportlib/Algorithms/Hasher.h",
    "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
-   "src/cxx_supportlib/AppTypeDetector/Detector.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
    "src/cxx_supportlib/ConfigKit/DummyTranslator.h",
@@ -4721,6 +5297,7 @@
    "src/cxx_supportlib/Constants.h",
    "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/DataStructures/StringMap.h",
@@ -4769,6 +5346,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -4777,7 +5355,6 @@
    "src/cxx_supportlib/StrIntTools/DateParsing.h",
    "src/cxx_supportlib/StrIntTools/StrIntUtils.h",
    "src/cxx_supportlib/StrIntTools/StringScanning.h",
-   "src/cxx_supportlib/StrIntTools/Template.h",
    "src/cxx_supportlib/SystemTools/ProcessMetricsCollector.h",
    "src/cxx_supportlib/SystemTools/SystemMetricsCollector.h",
    "src/cxx_supportlib/SystemTools/SystemTime.h",
@@ -4785,7 +5362,6 @@
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/AnsiColorConstants.h",
    "src/cxx_supportlib/Utils/AsyncSignalSafeUtils.h",
-   "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HttpConstants.h",
    "src/cxx_supportlib/Utils/IniFile.h",
@@ -4813,7 +5389,7 @@
    "src/cxx_supportlib/oxt/system_calls.hpp",
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
- "src/agent/Core/Controller/InitRequest.cpp"=>
+ "src/agent/Core/Controller/InternalUtils.cpp"=>
   ["src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
@@ -4832,6 +5408,7 @@
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -4855,7 +5432,6 @@
    "src/cxx_supportlib/Algorithms/Hasher.h",
    "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
-   "src/cxx_supportlib/AppTypeDetector/Detector.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
    "src/cxx_supportlib/ConfigKit/DummyTranslator.h",
@@ -4867,6 +5443,7 @@
    "src/cxx_supportlib/Constants.h",
    "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/DataStructures/StringMap.h",
@@ -4915,6 +5492,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -4930,7 +5508,6 @@
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/AnsiColorConstants.h",
    "src/cxx_supportlib/Utils/AsyncSignalSafeUtils.h",
-   "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HttpConstants.h",
    "src/cxx_supportlib/Utils/IniFile.h",
@@ -4958,7 +5535,7 @@
    "src/cxx_supportlib/oxt/system_calls.hpp",
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
- "src/agent/Core/Controller/InitializationAndShutdown.cpp"=>
+ "src/agent/Core/Controller/Miscellaneous.cpp"=>
   ["src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
@@ -4977,6 +5554,7 @@
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -5009,9 +5587,12 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/DataStructures/StringMap.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
    "src/cxx_supportlib/FileTools/FileManip.h",
@@ -5057,6 +5638,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -5099,7 +5681,7 @@
    "src/cxx_supportlib/oxt/system_calls.hpp",
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
- "src/agent/Core/Controller/InternalUtils.cpp"=>
+ "src/agent/Core/Controller/RefreshTurboCache.cpp"=>
   ["src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
@@ -5118,6 +5700,7 @@
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -5150,9 +5733,12 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/DataStructures/StringMap.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
    "src/cxx_supportlib/FileTools/FileManip.h",
@@ -5198,6 +5784,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -5240,7 +5827,7 @@
    "src/cxx_supportlib/oxt/system_calls.hpp",
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
- "src/agent/Core/Controller/Miscellaneous.cpp"=>
+ "src/agent/Core/Controller/Request.h"=>
   ["src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
@@ -5252,13 +5839,10 @@
    "src/agent/Core/ApplicationPool/Process.h",
    "src/agent/Core/ApplicationPool/Session.h",
    "src/agent/Core/ApplicationPool/Socket.h",
-   "src/agent/Core/Controller.h",
    "src/agent/Core/Controller/AppResponse.h",
-   "src/agent/Core/Controller/Client.h",
    "src/agent/Core/Controller/Config.h",
-   "src/agent/Core/Controller/Request.h",
-   "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -5291,7 +5875,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
@@ -5302,7 +5888,6 @@
    "src/cxx_supportlib/IOTools/BufferedIO.h",
    "src/cxx_supportlib/IOTools/IOUtils.h",
    "src/cxx_supportlib/IOTools/MessageIO.h",
-   "src/cxx_supportlib/IOTools/MessageSerialization.h",
    "src/cxx_supportlib/Integrations/LibevJsonUtils.h",
    "src/cxx_supportlib/JsonTools/JsonUtils.h",
    "src/cxx_supportlib/LoggingKit/Assert.h",
@@ -5339,6 +5924,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -5381,7 +5967,7 @@
    "src/cxx_supportlib/oxt/system_calls.hpp",
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
- "src/agent/Core/Controller/Request.h"=>
+ "src/agent/Core/Controller/SendRequest.cpp"=>
   ["src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
@@ -5393,8 +5979,14 @@
    "src/agent/Core/ApplicationPool/Process.h",
    "src/agent/Core/ApplicationPool/Session.h",
    "src/agent/Core/ApplicationPool/Socket.h",
+   "src/agent/Core/Controller.h",
    "src/agent/Core/Controller/AppResponse.h",
+   "src/agent/Core/Controller/Client.h",
    "src/agent/Core/Controller/Config.h",
+   "src/agent/Core/Controller/Request.h",
+   "src/agent/Core/Controller/TurboCaching.h",
+   "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -5427,9 +6019,12 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/DataStructures/StringMap.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
    "src/cxx_supportlib/FileTools/FileManip.h",
@@ -5438,6 +6033,7 @@
    "src/cxx_supportlib/IOTools/BufferedIO.h",
    "src/cxx_supportlib/IOTools/IOUtils.h",
    "src/cxx_supportlib/IOTools/MessageIO.h",
+   "src/cxx_supportlib/IOTools/MessageSerialization.h",
    "src/cxx_supportlib/Integrations/LibevJsonUtils.h",
    "src/cxx_supportlib/JsonTools/JsonUtils.h",
    "src/cxx_supportlib/LoggingKit/Assert.h",
@@ -5458,6 +6054,7 @@
    "src/cxx_supportlib/ServerKit/ClientRef.h",
    "src/cxx_supportlib/ServerKit/Config.h",
    "src/cxx_supportlib/ServerKit/Context.h",
+   "src/cxx_supportlib/ServerKit/CookieUtils.h",
    "src/cxx_supportlib/ServerKit/Errors.h",
    "src/cxx_supportlib/ServerKit/FdSinkChannel.h",
    "src/cxx_supportlib/ServerKit/FdSourceChannel.h",
@@ -5473,10 +6070,13 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
+   "src/cxx_supportlib/ServerKit/url_parser.h",
    "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/StrIntTools/DateParsing.h",
    "src/cxx_supportlib/StrIntTools/StrIntUtils.h",
    "src/cxx_supportlib/StrIntTools/StringScanning.h",
    "src/cxx_supportlib/SystemTools/ProcessMetricsCollector.h",
@@ -5513,7 +6113,7 @@
    "src/cxx_supportlib/oxt/system_calls.hpp",
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
- "src/agent/Core/Controller/SendRequest.cpp"=>
+ "src/agent/Core/Controller/SpliceBody.cpp"=>
   ["src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
@@ -5532,6 +6132,7 @@
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -5564,9 +6165,12 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/DataStructures/StringMap.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
    "src/cxx_supportlib/FileTools/FileManip.h",
@@ -5612,6 +6216,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -5673,6 +6278,7 @@
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -5705,9 +6311,12 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/DataStructures/StringMap.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
    "src/cxx_supportlib/FileTools/FileManip.h",
@@ -5753,6 +6362,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -5797,6 +6407,7 @@
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
  "src/agent/Core/Controller/TurboCaching.h"=>
   ["src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
    "src/cxx_supportlib/ConfigKit/ConfigKit.h",
@@ -5826,6 +6437,7 @@
    "src/cxx_supportlib/ServerKit/Config.h",
    "src/cxx_supportlib/ServerKit/Context.h",
    "src/cxx_supportlib/ServerKit/CookieUtils.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/url_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/StrIntTools/DateParsing.h",
@@ -5876,6 +6488,7 @@
    "src/agent/Core/OptionParser.h",
    "src/agent/Core/ResponseCache.h",
    "src/agent/Core/SecurityUpdateChecker.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -5923,6 +6536,7 @@
    "src/cxx_supportlib/Constants.h",
    "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/DataStructures/StringMap.h",
@@ -5979,6 +6593,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -6039,7 +6654,9 @@
    "src/cxx_supportlib/oxt/macros.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
  "src/agent/Core/ResponseCache.h"=>
-  ["src/cxx_supportlib/Algorithms/Hasher.h",
+  ["src/agent/Core/SharedResponseCache.h",
+   "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Constants.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/MemoryKit/mbuf.h",
@@ -6095,6 +6712,18 @@
    "src/cxx_supportlib/oxt/system_calls.hpp",
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
+ "src/agent/Core/SharedResponseCache.h"=>
+  ["src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/LString.h",
+   "src/cxx_supportlib/MemoryKit/mbuf.h",
+   "src/cxx_supportlib/MemoryKit/palloc.h",
+   "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/StrIntTools/StrIntUtils.h",
+   "src/cxx_supportlib/oxt/backtrace.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_enabled.hpp",
+   "src/cxx_supportlib/oxt/macros.hpp"],
  "src/agent/Core/SpawningKit/Config.h"=>
   ["src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
@@ -6980,6 +7609,7 @@
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -7012,9 +7642,12 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/DataStructures/StringMap.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
    "src/cxx_supportlib/FileTools/FileManip.h",
@@ -7060,6 +7693,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -7208,6 +7842,7 @@
    "src/cxx_supportlib/ServerKit/FileBufferedFdSinkChannel.h",
    "src/cxx_supportlib/ServerKit/HeaderTable.h",
    "src/cxx_supportlib/ServerKit/Hooks.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -7575,6 +8210,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -7625,6 +8261,7 @@
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
    "src/agent/Core/SecurityUpdateChecker.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -7664,9 +8301,12 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/DataStructures/StringMap.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
    "src/cxx_supportlib/FileTools/FileManip.h",
@@ -7717,6 +8357,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -7817,6 +8458,7 @@
    "src/agent/Core/OptionParser.h",
    "src/agent/Core/ResponseCache.h",
    "src/agent/Core/SecurityUpdateChecker.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -7865,9 +8507,12 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/DataStructures/StringMap.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
    "src/cxx_supportlib/FileTools/FileManip.h",
@@ -7920,6 +8565,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -8708,6 +9354,8 @@
   ["src/cxx_supportlib/Algorithms/Hasher.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/oxt/macros.hpp"],
+ "src/cxx_supportlib/DataStructures/IndexedMinHeap.h"=>
+  [],
  "src/cxx_supportlib/DataStructures/LString.cpp"=>
   ["src/cxx_supportlib/Algorithms/Hasher.h",
    "src/cxx_supportlib/DataStructures/LString.h",
@@ -9039,6 +9687,23 @@
    "src/cxx_supportlib/oxt/detail/backtrace_disabled.hpp",
    "src/cxx_supportlib/oxt/detail/backtrace_enabled.hpp",
    "src/cxx_supportlib/oxt/macros.hpp"],
+ "src/cxx_supportlib/LoggingKit/AsyncWriter.h"=>
+  ["src/cxx_supportlib/Exceptions.h",
+   "src/cxx_supportlib/LoggingKit/Forward.h",
+   "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/SystemTools/SystemTime.h",
+   "src/cxx_supportlib/oxt/detail/context.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_darwin.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_gcc_x86.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_portable.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_pthreads.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_enabled.hpp",
+   "src/cxx_supportlib/oxt/macros.hpp",
+   "src/cxx_supportlib/oxt/spin_lock.hpp",
+   "src/cxx_supportlib/oxt/system_calls.hpp",
+   "src/cxx_supportlib/oxt/thread.hpp",
+   "src/cxx_supportlib/oxt/tracable_exception.hpp"],
  "src/cxx_supportlib/LoggingKit/Config.h"=>
   ["src/cxx_supportlib/Algorithms/Hasher.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
@@ -9117,6 +9782,7 @@
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileTools/PathManip.h",
    "src/cxx_supportlib/LoggingKit/Assert.h",
+   "src/cxx_supportlib/LoggingKit/AsyncWriter.h",
    "src/cxx_supportlib/LoggingKit/Config.h",
    "src/cxx_supportlib/LoggingKit/Context.h",
    "src/cxx_supportlib/LoggingKit/Forward.h",
@@ -9390,6 +10056,7 @@
    "src/cxx_supportlib/ServerKit/Config.h",
    "src/cxx_supportlib/ServerKit/Context.h",
    "src/cxx_supportlib/ServerKit/Hooks.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/StrIntTools/StrIntUtils.h",
    "src/cxx_supportlib/SystemTools/SystemTime.h",
@@ -9445,6 +10112,7 @@
    "src/cxx_supportlib/ServerKit/FileBufferedChannel.h",
    "src/cxx_supportlib/ServerKit/FileBufferedFdSinkChannel.h",
    "src/cxx_supportlib/ServerKit/Hooks.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
    "src/cxx_supportlib/StaticString.h",
@@ -9526,6 +10194,7 @@
    "src/cxx_supportlib/SafeLibev.h",
    "src/cxx_supportlib/SecurityKit/MemZeroGuard.h",
    "src/cxx_supportlib/ServerKit/Config.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/StrIntTools/StrIntUtils.h",
    "src/cxx_supportlib/SystemTools/SystemTime.h",
@@ -9591,6 +10260,7 @@
    "src/cxx_supportlib/ServerKit/Config.h",
    "src/cxx_supportlib/ServerKit/Context.h",
    "src/cxx_supportlib/ServerKit/Hooks.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/StrIntTools/StrIntUtils.h",
    "src/cxx_supportlib/SystemTools/SystemTime.h",
@@ -9642,6 +10312,7 @@
    "src/cxx_supportlib/ServerKit/Config.h",
    "src/cxx_supportlib/ServerKit/Context.h",
    "src/cxx_supportlib/ServerKit/Hooks.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/StrIntTools/StrIntUtils.h",
    "src/cxx_supportlib/SystemTools/SystemTime.h",
@@ -9694,6 +10365,7 @@
    "src/cxx_supportlib/ServerKit/Context.h",
    "src/cxx_supportlib/ServerKit/Errors.h",
    "src/cxx_supportlib/ServerKit/Hooks.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
    "src/cxx_supportlib/StaticString.h",
@@ -9749,6 +10421,7 @@
    "src/cxx_supportlib/ServerKit/Errors.h",
    "src/cxx_supportlib/ServerKit/FileBufferedChannel.h",
    "src/cxx_supportlib/ServerKit/Hooks.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
    "src/cxx_supportlib/StaticString.h",
@@ -9834,6 +10507,7 @@
    "src/cxx_supportlib/ServerKit/HttpChunkedBodyParserState.h",
    "src/cxx_supportlib/ServerKit/HttpHeaderParserState.h",
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
    "src/cxx_supportlib/StaticString.h",
@@ -9898,6 +10572,7 @@
    "src/cxx_supportlib/ServerKit/HttpChunkedBodyParserState.h",
    "src/cxx_supportlib/ServerKit/HttpHeaderParserState.h",
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
    "src/cxx_supportlib/StaticString.h",
@@ -9975,6 +10650,7 @@
    "src/cxx_supportlib/ServerKit/Hooks.h",
    "src/cxx_supportlib/ServerKit/HttpChunkedBodyParserState.h",
    "src/cxx_supportlib/ServerKit/HttpHeaderParserState.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
    "src/cxx_supportlib/StaticString.h",
@@ -10048,6 +10724,7 @@
    "src/cxx_supportlib/ServerKit/HttpHeaderParserState.h",
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -10077,8 +10754,23 @@
  "src/cxx_supportlib/ServerKit/Implementation.cpp"=>
   ["src/cxx_supportlib/Algorithms/Hasher.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/LString.h",
+   "src/cxx_supportlib/MemoryKit/mbuf.h",
+   "src/cxx_supportlib/MemoryKit/palloc.h",
+   "src/cxx_supportlib/ServerKit/HeaderTable.h",
    "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/StrIntTools/StrIntUtils.h",
+   "src/cxx_supportlib/oxt/backtrace.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_enabled.hpp",
    "src/cxx_supportlib/oxt/macros.hpp"],
+ "src/cxx_supportlib/ServerKit/IoUring.h"=>
+  ["src/cxx_supportlib/Exceptions.h",
+   "src/cxx_supportlib/MemoryKit/mbuf.h",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_enabled.hpp",
+   "src/cxx_supportlib/oxt/macros.hpp",
+   "src/cxx_supportlib/oxt/tracable_exception.hpp"],
  "src/cxx_supportlib/ServerKit/Server.h"=>
   ["src/cxx_supportlib/Algorithms/Hasher.h",
    "src/cxx_supportlib/Algorithms/MovingAverage.h",
@@ -10115,6 +10807,7 @@
    "src/cxx_supportlib/ServerKit/FileBufferedChannel.h",
    "src/cxx_supportlib/ServerKit/FileBufferedFdSinkChannel.h",
    "src/cxx_supportlib/ServerKit/Hooks.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
    "src/cxx_supportlib/StaticString.h",
@@ -10876,6 +11569,7 @@
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
    "src/agent/Core/SecurityUpdateChecker.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -10916,9 +11610,12 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/DataStructures/StringMap.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
    "src/cxx_supportlib/FileTools/FileManip.h",
@@ -10969,6 +11666,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -11014,6 +11712,48 @@
    "src/cxx_supportlib/oxt/system_calls.hpp",
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
+ "test/cxx/Algorithms/HasherTest.cpp"=>
+  ["src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/BackgroundEventLoop.h",
+   "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/Exceptions.h",
+   "src/cxx_supportlib/FileDescriptor.h",
+   "src/cxx_supportlib/FileTools/FileManip.h",
+   "src/cxx_supportlib/IOTools/IOUtils.h",
+   "src/cxx_supportlib/InstanceDirectory.h",
+   "src/cxx_supportlib/LoggingKit/Assert.h",
+   "src/cxx_supportlib/LoggingKit/Forward.h",
+   "src/cxx_supportlib/LoggingKit/Logging.h",
+   "src/cxx_supportlib/LoggingKit/LoggingKit.h",
+   "src/cxx_supportlib/ProcessManagement/Spawn.h",
+   "src/cxx_supportlib/ProcessManagement/Utils.h",
+   "src/cxx_supportlib/RandomGenerator.h",
+   "src/cxx_supportlib/ResourceLocator.h",
+   "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/StrIntTools/StrIntUtils.h",
+   "src/cxx_supportlib/SystemTools/SystemTime.h",
+   "src/cxx_supportlib/SystemTools/UserDatabase.h",
+   "src/cxx_supportlib/Utils.h",
+   "src/cxx_supportlib/Utils/FastStringStream.h",
+   "src/cxx_supportlib/Utils/IniFile.h",
+   "src/cxx_supportlib/oxt/backtrace.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_enabled.hpp",
+   "src/cxx_supportlib/oxt/detail/context.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_darwin.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_gcc_x86.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_portable.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_pthreads.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_enabled.hpp",
+   "src/cxx_supportlib/oxt/macros.hpp",
+   "src/cxx_supportlib/oxt/spin_lock.hpp",
+   "src/cxx_supportlib/oxt/system_calls.hpp",
+   "src/cxx_supportlib/oxt/thread.hpp",
+   "src/cxx_supportlib/oxt/tracable_exception.hpp",
+   "test/cxx/TestSupport.h",
+   "test/tut/tut.h"],
  "test/cxx/Base64DecodingTest.cpp"=>
   ["src/cxx_supportlib/Algorithms/Hasher.h",
    "src/cxx_supportlib/BackgroundEventLoop.h",
@@ -11420,6 +12160,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/BackgroundEventLoop.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
@@ -11521,6 +12262,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/BackgroundEventLoop.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
@@ -11531,7 +12273,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
@@ -11626,6 +12370,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppLocalConfigFileUtils.h",
    "src/cxx_supportlib/BackgroundEventLoop.h",
    "src/cxx_supportlib/ConfigKit/Common.h",
@@ -11716,6 +12461,7 @@
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -11749,9 +12495,12 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/DataStructures/StringMap.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
    "src/cxx_supportlib/FileTools/FileManip.h",
@@ -11798,6 +12547,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -11858,6 +12608,7 @@
    "src/agent/Core/Controller/Config.h",
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -11891,7 +12642,9 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
@@ -11939,6 +12692,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -12533,6 +13287,7 @@
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/SharedResponseCache.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/Config/AutoGeneratedCode.h",
    "src/agent/Core/SpawningKit/Context.h",
@@ -12567,9 +13322,12 @@
    "src/cxx_supportlib/ConfigKit/Translator.h",
    "src/cxx_supportlib/ConfigKit/Utils.h",
    "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashMap.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/DataStructures/StringMap.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
    "src/cxx_supportlib/FileTools/FileManip.h",
@@ -12616,6 +13374,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -12717,6 +13476,49 @@
    "test/cxx/TestSupport.h",
    "test/tut/tut.h",
    "test/tut/tut_reporter.h"],
+ "test/cxx/DataStructures/IndexedMinHeapTest.cpp"=>
+  ["src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/BackgroundEventLoop.h",
+   "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/IndexedMinHeap.h",
+   "src/cxx_supportlib/Exceptions.h",
+   "src/cxx_supportlib/FileDescriptor.h",
+   "src/cxx_supportlib/FileTools/FileManip.h",
+   "src/cxx_supportlib/IOTools/IOUtils.h",
+   "src/cxx_supportlib/InstanceDirectory.h",
+   "src/cxx_supportlib/LoggingKit/Assert.h",
+   "src/cxx_supportlib/LoggingKit/Forward.h",
+   "src/cxx_supportlib/LoggingKit/Logging.h",
+   "src/cxx_supportlib/LoggingKit/LoggingKit.h",
+   "src/cxx_supportlib/ProcessManagement/Spawn.h",
+   "src/cxx_supportlib/ProcessManagement/Utils.h",
+   "src/cxx_supportlib/RandomGenerator.h",
+   "src/cxx_supportlib/ResourceLocator.h",
+   "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/StrIntTools/StrIntUtils.h",
+   "src/cxx_supportlib/SystemTools/SystemTime.h",
+   "src/cxx_supportlib/SystemTools/UserDatabase.h",
+   "src/cxx_supportlib/Utils.h",
+   "src/cxx_supportlib/Utils/FastStringStream.h",
+   "src/cxx_supportlib/Utils/IniFile.h",
+   "src/cxx_supportlib/oxt/backtrace.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_enabled.hpp",
+   "src/cxx_supportlib/oxt/detail/context.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_darwin.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_gcc_x86.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_portable.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_pthreads.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_enabled.hpp",
+   "src/cxx_supportlib/oxt/macros.hpp",
+   "src/cxx_supportlib/oxt/spin_lock.hpp",
+   "src/cxx_supportlib/oxt/system_calls.hpp",
+   "src/cxx_supportlib/oxt/thread.hpp",
+   "src/cxx_supportlib/oxt/tracable_exception.hpp",
+   "test/cxx/TestSupport.h",
+   "test/tut/tut.h"],
  "test/cxx/DataStructures/LStringTest.cpp"=>
   ["src/cxx_supportlib/Algorithms/Hasher.h",
    "src/cxx_supportlib/BackgroundEventLoop.h",
@@ -13198,6 +14000,59 @@
    "src/cxx_supportlib/oxt/tracable_exception.hpp",
    "test/cxx/TestSupport.h",
    "test/tut/tut.h"],
+ "test/cxx/LoggingKit/AsyncWriterTest.cpp"=>
+  ["src/cxx_supportlib/Algorithms/Hasher.h",
+   "src/cxx_supportlib/BackgroundEventLoop.h",
+   "src/cxx_supportlib/ConfigKit/Common.h",
+   "src/cxx_supportlib/ConfigKit/ConfigKit.h",
+   "src/cxx_supportlib/ConfigKit/DummyTranslator.h",
+   "src/cxx_supportlib/ConfigKit/Schema.h",
+   "src/cxx_supportlib/ConfigKit/Store.h",
+   "src/cxx_supportlib/ConfigKit/Translator.h",
+   "src/cxx_supportlib/ConfigKit/Utils.h",
+   "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/Exceptions.h",
+   "src/cxx_supportlib/FileDescriptor.h",
+   "src/cxx_supportlib/FileTools/FileManip.h",
+   "src/cxx_supportlib/IOTools/IOUtils.h",
+   "src/cxx_supportlib/InstanceDirectory.h",
+   "src/cxx_supportlib/LoggingKit/Assert.h",
+   "src/cxx_supportlib/LoggingKit/AsyncWriter.h",
+   "src/cxx_supportlib/LoggingKit/Config.h",
+   "src/cxx_supportlib/LoggingKit/Context.h",
+   "src/cxx_supportlib/LoggingKit/Forward.h",
+   "src/cxx_supportlib/LoggingKit/Logging.h",
+   "src/cxx_supportlib/LoggingKit/LoggingKit.h",
+   "src/cxx_supportlib/ProcessManagement/Spawn.h",
+   "src/cxx_supportlib/ProcessManagement/Utils.h",
+   "src/cxx_supportlib/RandomGenerator.h",
+   "src/cxx_supportlib/ResourceLocator.h",
+   "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/StrIntTools/StrIntUtils.h",
+   "src/cxx_supportlib/SystemTools/SystemTime.h",
+   "src/cxx_supportlib/SystemTools/UserDatabase.h",
+   "src/cxx_supportlib/Utils.h",
+   "src/cxx_supportlib/Utils/FastStringStream.h",
+   "src/cxx_supportlib/Utils/IniFile.h",
+   "src/cxx_supportlib/oxt/backtrace.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_enabled.hpp",
+   "src/cxx_supportlib/oxt/detail/context.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_darwin.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_gcc_x86.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_portable.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_pthreads.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_enabled.hpp",
+   "src/cxx_supportlib/oxt/macros.hpp",
+   "src/cxx_supportlib/oxt/spin_lock.hpp",
+   "src/cxx_supportlib/oxt/system_calls.hpp",
+   "src/cxx_supportlib/oxt/thread.hpp",
+   "src/cxx_supportlib/oxt/tracable_exception.hpp",
+   "test/cxx/TestSupport.h",
+   "test/tut/tut.h"],
  "test/cxx/MemoryKit/MbufTest.cpp"=>
   ["src/cxx_supportlib/Algorithms/Hasher.h",
    "src/cxx_supportlib/BackgroundEventLoop.h",
@@ -13364,6 +14219,7 @@
    "src/cxx_supportlib/ServerKit/Config.h",
    "src/cxx_supportlib/ServerKit/Context.h",
    "src/cxx_supportlib/ServerKit/Hooks.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/StrIntTools/StrIntUtils.h",
    "src/cxx_supportlib/SystemTools/SystemTime.h",
@@ -13474,6 +14330,7 @@
    "src/cxx_supportlib/ServerKit/Errors.h",
    "src/cxx_supportlib/ServerKit/FileBufferedChannel.h",
    "src/cxx_supportlib/ServerKit/Hooks.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
    "src/cxx_supportlib/StaticString.h",
@@ -13585,6 +14442,7 @@
    "src/cxx_supportlib/ResourceLocator.h",
    "src/cxx_supportlib/SafeLibev.h",
    "src/cxx_supportlib/SecurityKit/MemZeroGuard.h",
+   "src/cxx_supportlib/ServerKit/AcceptLoadBalancer.h",
    "src/cxx_supportlib/ServerKit/Channel.h",
    "src/cxx_supportlib/ServerKit/Client.h",
    "src/cxx_supportlib/ServerKit/ClientRef.h",
@@ -13604,6 +14462,7 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
@@ -13677,6 +14536,7 @@
    "src/cxx_supportlib/ServerKit/FileBufferedChannel.h",
    "src/cxx_supportlib/ServerKit/FileBufferedFdSinkChannel.h",
    "src/cxx_supportlib/ServerKit/Hooks.h",
+   "src/cxx_supportlib/ServerKit/IoUring.h",
    "src/cxx_supportlib/ServerKit/Server.h",
    "src/cxx_supportlib/ServerKit/llerrors.h",
    "src/cxx_supportlib/ServerKit/llhttp.h",
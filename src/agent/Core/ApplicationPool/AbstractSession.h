@@ -59,6 +59,12 @@ public:
 
 	virtual void requestOOBW() { /* Do nothing */ }
 
+	/**
+	 * Tells the pool how long (in microseconds) the process took to start
+	 * responding. Used by the least latency routing policy.
+	 */
+	virtual void reportResponseTime(unsigned long long usec) { /* Do nothing */ }
+
 	/**
 	 * This Session object becomes fully unsable after closing.
 	 */
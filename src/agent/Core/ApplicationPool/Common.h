@@ -31,6 +31,7 @@
 #include <boost/intrusive_ptr.hpp>
 #include <boost/function.hpp>
 #include <oxt/tracable_exception.hpp>
+#include <Utils/Lock.h>
 #include <ResourceLocator.h>
 #include <RandomGenerator.h>
 #include <StaticString.h>
@@ -170,6 +171,19 @@ typedef StringKeyTable<GroupPtr> GroupMap;
 typedef boost::function<void (const ProcessPtr &process, DisableResult result)> DisableCallback;
 typedef boost::function<void ()> Callback;
 
+/**
+ * The pool lock (`Pool::syncher`) is a readers-writer lock. Holding it
+ * exclusively gives access to everything in the pool. Holding it shared
+ * only makes the pool structure (the set of groups, processes and their
+ * enabled states, the pool getWaitlist) read-only; group-local session
+ * accounting may then only be modified while also holding that group's
+ * `Group::sessionSyncher`. See Pool::asyncGet() and Group::onSessionClose().
+ */
+typedef boost::unique_lock<boost::shared_mutex> PoolScopedLock;
+typedef boost::lock_guard<boost::shared_mutex> PoolLockGuard;
+typedef boost::shared_lock<boost::shared_mutex> PoolSharedLock;
+typedef BasicDynamicScopedLock<boost::shared_mutex> PoolDynamicScopedLock;
+
 struct GetCallback {
 	void (*func)(const AbstractSessionPtr &session, const ExceptionPtr &e, void *userData);
 	mutable void *userData;
@@ -38,6 +38,7 @@
 #include <boost/container/vector.hpp>
 #include <boost/container/small_vector.hpp>
 #include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
 #include <oxt/macros.hpp>
 #include <oxt/thread.hpp>
 #include <oxt/dynamic_thread_group.hpp>
@@ -46,6 +47,9 @@
 #include <cstdlib>
 #include <cassert>
 #include <MemoryKit/palloc.h>
+#include <Algorithms/MovingAverage.h>
+#include <DataStructures/HashMap.h>
+#include <DataStructures/IndexedMinHeap.h>
 #include <WrapperRegistry/Registry.h>
 #include <Hooks.h>
 #include <Utils.h>
@@ -136,7 +140,9 @@ public:
 	 */
 	unsigned int restartsInitiated;
 	/**
-	 * The number of processes that are being spawned right now.
+	 * The number of processes that are being spawned right now. Each one is
+	 * being spawned by its own spawn loop thread, and there are at most
+	 * `options.spawnConcurrency` of them.
 	 *
 	 * Invariant:
 	 *     if processesBeingSpawned > 0: m_spawning
@@ -156,9 +162,9 @@ public:
 	 */
 	boost::atomic<boost::uint8_t> lifeStatus;
 	/**
-	 * Whether the spawner thread is currently working. Note that even
-	 * if it's working, it doesn't necessarily mean that processes are
-	 * being spawned (i.e. that processesBeingSpawned > 0). After the
+	 * Whether any spawn loop thread is currently working. Note that even
+	 * if one is working, it doesn't necessarily mean that processes are
+	 * being spawned (i.e. that processesBeingSpawned > 0). After a
 	 * thread is done spawning a process, it will attempt to attach
 	 * the newly-spawned process to the group. During that time it's not
 	 * technically spawning anything.
@@ -176,6 +182,14 @@ public:
 	 */
 	bool m_restarting: 1;
 	bool alwaysRestartFileExists: 1;
+	/**
+	 * Protects the session accounting of this group (the session counters
+	 * of its processes, `enabledProcessBusynessLevels` and
+	 * `nEnabledProcessesTotallyBusy`) and `options` while the pool lock is
+	 * only held in shared mode. Not needed while the pool lock is held
+	 * exclusively.
+	 */
+	boost::mutex sessionSyncher;
 
 	/** Contains the spawn loop thread and the restarter thread. */
 	dynamic_thread_group interruptableThreads;
@@ -188,7 +202,7 @@ public:
 	 * whether any of the Processes can be shut down.
 	 */
 	bool detachedProcessesCheckerActive;
-	boost::condition_variable detachedProcessesCheckerCond;
+	boost::condition_variable_any detachedProcessesCheckerCond;
 	Callback shutdownCallback;
 	GroupPtr selfPointer;
 
@@ -205,10 +219,13 @@ public:
 
 	RouteResult route(const Options &options) const;
 	SessionPtr newSession(Process *process, unsigned long long now = 0);
+	SessionPtr getWithSharedPoolLock(const Options &newOptions);
 	static void _onSessionInitiateFailure(Session *session);
 	static void _onSessionClose(Session *session);
 	OXT_FORCE_INLINE void onSessionInitiateFailure(Process *process, Session *session);
 	OXT_FORCE_INLINE void onSessionClose(Process *process, Session *session);
+	bool closeSessionWithSharedPoolLock(Process *process, Session *session);
+	void updateStatisticsForClosedSession(Process *process, Session *session);
 
 	/****** Spawning and restarting ******/
 
@@ -219,6 +236,10 @@ public:
 	void finalizeRestart(GroupPtr self, Options oldOptions, Options newOptions,
 		RestartMethod method, SpawningKit::FactoryPtr spawningKitFactory,
 		unsigned int restartsInitiated, boost::container::vector<Callback> postLockActions);
+	void startSpawnLoop();
+	void startAdditionalSpawnLoops();
+	unsigned int spawnDemand() const;
+	void updateDemandStatistics(unsigned long long now = 0);
 
 	/****** Process list management ******/
 
@@ -226,6 +247,8 @@ public:
 	Process *findProcessWithStickySessionIdOrLowestBusyness(unsigned int id) const;
 	Process *findProcessWithLowestBusyness(const ProcessList &processes) const;
 	Process *findEnabledProcessWithLowestBusyness() const;
+	Process *findEnabledProcessWithTwoRandomChoices(RoutingPolicy policy) const;
+	unsigned int nextRoutingRandomNumber() const;
 
 	void addProcessToList(const ProcessPtr &process, ProcessList &destination);
 	void removeProcessFromList(const ProcessPtr &process, ProcessList &source);
@@ -363,11 +386,43 @@ public:
 	ProcessList detachedProcesses;
 
 	/**
-	 * A cache of the processes' busyness. It's in a compact structure
-	 * so that `findProcessWithLowestBusyness()` can work very quickly
-	 * when there are a large number of processes.
+	 * A cache of the enabled processes' busyness, indexed by their position
+	 * in `enabledProcesses`. It's a min-heap so that
+	 * `findEnabledProcessWithLowestBusyness()` takes constant time and updating
+	 * a process's busyness takes O(log n), even when there are a large number
+	 * of processes.
+	 */
+	IndexedMinHeap enabledProcessBusynessLevels;
+	/**
+	 * Maps the sticky session IDs of enabled processes to those processes,
+	 * so that sticky sessions can be routed without scanning `enabledProcesses`.
+	 */
+	HashMap<unsigned int, Process *> enabledProcessesByStickySessionId;
+	/**
+	 * State of the xorshift generator that picks the random candidates for
+	 * the power of two choices and least latency routing policies. Protected
+	 * in the same way as the session accounting.
+	 */
+	mutable boost::uint32_t routingRandomState;
+	/**
+	 * Moving averages of this group's demand, only maintained when
+	 * `options.predictiveSpawning` is set. Demand is sampled whenever a
+	 * session is opened or closed and whenever a client is put on the
+	 * get wait list, and is defined as the number of totally busy enabled
+	 * processes plus the number of waiting clients. The short term average
+	 * follows the last few seconds and the long term average roughly the
+	 * last minute; `predictedProcessesNeeded()` extrapolates the trend
+	 * between the two. Protected in the same way as the session accounting.
+	 */
+	DiscExpMovingAverage<200> shortTermDemand;
+	DiscExpMovingAverage<20> longTermDemand;
+	/**
+	 * The time at which this group became over-provisioned according to
+	 * the predictive spawning statistics, or 0 if it isn't. The garbage
+	 * collector shuts down an idle process once this is more than
+	 * `options.scaleDownDelay` seconds ago.
 	 */
-	boost::container::vector<int> enabledProcessBusynessLevels;
+	unsigned long long overProvisionedSince;
 
 	/**
 	 * get() requests for this group that cannot be immediately satisfied are
@@ -451,12 +506,15 @@ public:
 	void restart(const Options &options, RestartMethod method = RM_DEFAULT);
 	bool restarting() const;
 	bool needsRestart(const Options &options);
+	bool restartCheckIsDue(const Options &options) const;
 
 	SpawnResult spawn();
 	bool spawning() const;
 	bool shouldSpawn() const;
 	bool shouldSpawnForGetAction() const;
 	bool allowSpawn() const;
+	void recordDemand(double demand, unsigned long long now);
+	unsigned int predictedProcessesNeeded(unsigned long long now = 0) const;
 
 	/****** Process list management ******/
 
@@ -115,6 +115,9 @@ Group::Group(Pool *_pool, const Options &_options)
 	disablingCount = 0;
 	disabledCount  = 0;
 	nEnabledProcessesTotallyBusy = 0;
+	// xorshift must not be seeded with 0.
+	routingRandomState = _pool->getRandomGenerator()->generateUint() | 1;
+	overProvisionedSince = 0;
 	spawner        = getContext()->spawningKitFactory->create(options);
 	restartsInitiated = 0;
 	processesBeingSpawned = 0;
@@ -91,9 +91,13 @@ Group::resetOptions(const Options &newOptions, Options *destination) {
 void
 Group::mergeOptions(const Options &other) {
 	options.maxRequests      = other.maxRequests;
+	options.memoryLimit      = other.memoryLimit;
 	options.minProcesses     = other.minProcesses;
 	options.statThrottleRate = other.statThrottleRate;
 	options.maxPreloaderIdleTime = other.maxPreloaderIdleTime;
+	options.spawnConcurrency = other.spawnConcurrency;
+	options.predictiveSpawning = other.predictiveSpawning;
+	options.scaleDownDelay   = other.scaleDownDelay;
 }
 
 /* Given a hook name like "queue_full_error", we return HookScriptOptions filled in with this name and a spec
@@ -277,6 +281,7 @@ Group::pushGetWaiter(const Options &newOptions, const GetCallback &callback,
 		getWaitlist.push_back(GetWaiter(
 			newOptions.copyAndPersist(),
 			callback));
+		updateDemandStatistics(newOptions.currentTime);
 		return true;
 	} else {
 		postLockActions.push_back(boost::bind(GetCallback::call,
@@ -95,7 +95,7 @@ Group::lockAndMaybeInitiateOobw(const ProcessPtr &process, DisableResult result,
 
 	// Standard resource management boilerplate stuff...
 	Pool *pool = getPool();
-	boost::unique_lock<boost::mutex> lock(pool->syncher);
+	PoolScopedLock lock(pool->syncher);
 	if (OXT_UNLIKELY(!process->isAlive() || !isAlive())) {
 		return;
 	}
@@ -196,7 +196,7 @@ Group::spawnThreadOOBWRequest(GroupPtr self, ProcessPtr process) {
 	UPDATE_TRACE_POINT();
 	{
 		// Standard resource management boilerplate stuff...
-		boost::unique_lock<boost::mutex> lock(pool->syncher);
+		PoolScopedLock lock(pool->syncher);
 		if (OXT_UNLIKELY(!process->isAlive()
 			|| process->enabled == Process::DETACHED
 			|| !isAlive()))
@@ -267,7 +267,7 @@ Group::spawnThreadOOBWRequest(GroupPtr self, ProcessPtr process) {
 	{
 		// Standard resource management boilerplate stuff...
 		Pool *pool = getPool();
-		boost::unique_lock<boost::mutex> lock(pool->syncher);
+		PoolScopedLock lock(pool->syncher);
 		if (OXT_UNLIKELY(!process->isAlive() || !isAlive())) {
 			return;
 		}
@@ -320,7 +320,7 @@ void
 Group::requestOOBW(const ProcessPtr &process) {
 	// Standard resource management boilerplate stuff...
 	Pool *pool = getPool();
-	boost::unique_lock<boost::mutex> lock(pool->syncher);
+	PoolScopedLock lock(pool->syncher);
 	if (isAlive() && process->isAlive() && process->oobwStatus == Process::OOBW_NOT_ACTIVE) {
 		process->oobwStatus = Process::OOBW_REQUESTED;
 	}
@@ -53,37 +53,22 @@ using namespace boost;
 
 Process *
 Group::findProcessWithStickySessionId(unsigned int id) const {
-	ProcessList::const_iterator it, end = enabledProcesses.end();
-	for (it = enabledProcesses.begin(); it != end; it++) {
-		Process *process = it->get();
-		if (process->getStickySessionId() == id) {
-			return process;
-		}
+	HashMap<unsigned int, Process *>::const_iterator it =
+		enabledProcessesByStickySessionId.find(id);
+	if (it != enabledProcessesByStickySessionId.end()) {
+		return it->second;
+	} else {
+		return NULL;
 	}
-	return NULL;
 }
 
 Process *
 Group::findProcessWithStickySessionIdOrLowestBusyness(unsigned int id) const {
-	int leastBusyProcessIndex = -1;
-	int lowestBusyness = 0;
-	unsigned int i, size = enabledProcessBusynessLevels.size();
-	const int *enabledProcessBusynessLevels = &this->enabledProcessBusynessLevels[0];
-
-	for (i = 0; i < size; i++) {
-		Process *process = enabledProcesses[i].get();
-		if (process->getStickySessionId() == id) {
-			return process;
-		} else if (leastBusyProcessIndex == -1 || enabledProcessBusynessLevels[i] < lowestBusyness) {
-			leastBusyProcessIndex = i;
-			lowestBusyness = enabledProcessBusynessLevels[i];
-		}
-	}
-
-	if (leastBusyProcessIndex == -1) {
-		return NULL;
+	Process *process = findProcessWithStickySessionId(id);
+	if (process != NULL) {
+		return process;
 	} else {
-		return enabledProcesses[leastBusyProcessIndex].get();
+		return findEnabledProcessWithLowestBusyness();
 	}
 }
 
@@ -115,20 +100,69 @@ Process *
 Group::findEnabledProcessWithLowestBusyness() const {
 	if (enabledProcesses.empty()) {
 		return NULL;
+	} else {
+		return enabledProcesses[enabledProcessBusynessLevels.top()].get();
+	}
+}
+
+/**
+ * Picks two distinct random enabled processes and returns the better one of
+ * the two: the least busy one, or with RP_LEAST_LATENCY, the one with the
+ * lowest `latencyCost()`. Ties go to the process that comes first in
+ * `enabledProcesses`. If both candidates are totally busy, then this falls
+ * back to `findEnabledProcessWithLowestBusyness()` so that a request is never
+ * queued while another process can still handle it.
+ */
+Process *
+Group::findEnabledProcessWithTwoRandomChoices(RoutingPolicy policy) const {
+	unsigned int count = enabledProcesses.size();
+	if (count <= 1) {
+		return findEnabledProcessWithLowestBusyness();
 	}
 
-	int leastBusyProcessIndex = -1;
-	int lowestBusyness = 0;
-	unsigned int i, size = enabledProcessBusynessLevels.size();
-	const int *enabledProcessBusynessLevels = &this->enabledProcessBusynessLevels[0];
+	unsigned int i = nextRoutingRandomNumber() % count;
+	unsigned int j = nextRoutingRandomNumber() % (count - 1);
+	if (j >= i) {
+		j++;
+	} else {
+		std::swap(i, j);
+	}
+	Process *first = enabledProcesses[i].get();
+	Process *second = enabledProcesses[j].get();
 
-	for (i = 0; i < size; i++) {
-		if (leastBusyProcessIndex == -1 || enabledProcessBusynessLevels[i] < lowestBusyness) {
-			leastBusyProcessIndex = i;
-			lowestBusyness = enabledProcessBusynessLevels[i];
+	if (!first->canBeRoutedTo()) {
+		if (second->canBeRoutedTo()) {
+			return second;
+		} else {
+			return findEnabledProcessWithLowestBusyness();
+		}
+	} else if (!second->canBeRoutedTo()) {
+		return first;
+	} else if (policy == RP_LEAST_LATENCY) {
+		if (second->latencyCost() < first->latencyCost()) {
+			return second;
+		} else {
+			return first;
+		}
+	} else {
+		if (second->busyness() < first->busyness()) {
+			return second;
+		} else {
+			return first;
 		}
 	}
-	return enabledProcesses[leastBusyProcessIndex].get();
+}
+
+unsigned int
+Group::nextRoutingRandomNumber() const {
+	// xorshift32. Good enough for load balancing and it doesn't need a lock
+	// of its own or a system call.
+	boost::uint32_t x = routingRandomState;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	routingRandomState = x;
+	return x;
 }
 
 /**
@@ -144,7 +178,11 @@ Group::addProcessToList(const ProcessPtr &process, ProcessList &destination) {
 	if (&destination == &enabledProcesses) {
 		process->enabled = Process::ENABLED;
 		enabledCount++;
-		enabledProcessBusynessLevels.push_back(process->busyness());
+		enabledProcessBusynessLevels.push(process->busyness());
+		// On a sticky session ID collision the earliest process wins, just
+		// like a scan over `enabledProcesses` would.
+		enabledProcessesByStickySessionId.insert(make_pair(
+			process->getStickySessionId(), process.get()));
 		if (process->isTotallyBusy()) {
 			nEnabledProcessesTotallyBusy++;
 		}
@@ -213,12 +251,15 @@ Group::removeProcessFromList(const ProcessPtr &process, ProcessList &source) {
 		process->setIndex(i);
 	}
 
-	// Rebuild enabledProcessBusynessLevels
+	// Rebuild enabledProcessBusynessLevels and enabledProcessesByStickySessionId
 	if (&source == &enabledProcesses) {
 		enabledProcessBusynessLevels.clear();
+		enabledProcessesByStickySessionId.clear();
 		for (it = source.begin(); it != end; it++, i++) {
 			const ProcessPtr &process = *it;
-			enabledProcessBusynessLevels.push_back(process->busyness());
+			enabledProcessBusynessLevels.push(process->busyness());
+			enabledProcessesByStickySessionId.insert(make_pair(
+				process->getStickySessionId(), process.get()));
 		}
 		enabledProcessBusynessLevels.shrink_to_fit();
 	}
@@ -308,7 +349,7 @@ Group::detachedProcessesCheckerMain(GroupPtr self) {
 		debug->messages->recv("Proceed with starting detached processes checker");
 	}
 
-	boost::unique_lock<boost::mutex> lock(pool->syncher);
+	PoolScopedLock lock(pool->syncher);
 	while (true) {
 		assert(detachedProcessesCheckerActive);
 
@@ -464,6 +505,7 @@ Group::attach(const ProcessPtr &process,
 	// Update GC sleep timer.
 	wakeUpGarbageCollector();
 
+	postLockActions.push_back(boost::bind(&Process::prewarmConnections, process));
 	postLockActions.push_back(boost::bind(&Group::runAttachHooks, this, process));
 
 	return AR_OK;
@@ -533,6 +575,7 @@ Group::detachAll(boost::container::vector<Callback> &postLockActions) {
 	disablingProcesses.clear();
 	disabledProcesses.clear();
 	enabledProcessBusynessLevels.clear();
+	enabledProcessesByStickySessionId.clear();
 	enabledCount = 0;
 	disablingCount = 0;
 	disabledCount = 0;
@@ -560,6 +603,7 @@ Group::enable(const ProcessPtr &process, boost::container::vector<Callback> &pos
 		P_DEBUG("Enabling DISABLED process " << process->inspect());
 		removeProcessFromList(process, disabledProcesses);
 		addProcessToList(process, enabledProcesses);
+		postLockActions.push_back(boost::bind(&Process::prewarmConnections, process));
 	} else {
 		P_DEBUG("Enabling ENABLED process " << process->inspect());
 	}
@@ -64,7 +64,13 @@ Group::RouteResult
 Group::route(const Options &options) const {
 	if (OXT_LIKELY(enabledCount > 0)) {
 		if (options.stickySessionId == 0) {
-			Process *process = findEnabledProcessWithLowestBusyness();
+			Process *process;
+			if (options.routingPolicy == RP_LEAST_BUSY) {
+				process = findEnabledProcessWithLowestBusyness();
+			} else {
+				process = findEnabledProcessWithTwoRandomChoices(
+					options.routingPolicy);
+			}
 			if (process->canBeRoutedTo()) {
 				return RouteResult(process);
 			} else {
@@ -93,6 +99,39 @@ Group::route(const Options &options) const {
 	}
 }
 
+/* Checks out a session while holding the pool lock in shared mode only.
+ * This only succeeds if the get() action boils down to routing to an
+ * enabled process: no restart check is due, no process needs to be
+ * spawned and there's a process that isn't totally busy. Otherwise NULL
+ * is returned without any side effects other than merging the options,
+ * and the caller must call get() under the exclusive pool lock.
+ */
+SessionPtr
+Group::getWithSharedPoolLock(const Options &newOptions) {
+	boost::lock_guard<boost::mutex> l(sessionSyncher);
+
+	if (OXT_UNLIKELY(!isAlive()
+		|| newOptions.noop
+		|| restarting()
+		|| enabledCount == 0
+		|| restartCheckIsDue(newOptions)))
+	{
+		return SessionPtr();
+	}
+
+	mergeOptions(newOptions);
+	if (OXT_UNLIKELY(shouldSpawnForGetAction())) {
+		return SessionPtr();
+	}
+
+	RouteResult result = route(newOptions);
+	if (result.process == NULL) {
+		return SessionPtr();
+	}
+	P_DEBUG("Session checked out from process " << result.process->inspect());
+	return newSession(result.process, newOptions.currentTime);
+}
+
 SessionPtr
 Group::newSession(Process *process, unsigned long long now) {
 	bool wasTotallyBusy = process->isTotallyBusy();
@@ -100,11 +139,12 @@ Group::newSession(Process *process, unsigned long long now) {
 	session->onInitiateFailure = _onSessionInitiateFailure;
 	session->onClose   = _onSessionClose;
 	if (process->enabled == Process::ENABLED) {
-		enabledProcessBusynessLevels[process->getIndex()] = process->busyness();
+		enabledProcessBusynessLevels.set(process->getIndex(), process->busyness());
 		if (!wasTotallyBusy && process->isTotallyBusy()) {
 			nEnabledProcessesTotallyBusy++;
 		}
 	}
+	updateDemandStatistics(now);
 	return session;
 }
 
@@ -129,7 +169,7 @@ Group::onSessionInitiateFailure(Process *process, Session *session) {
 	TRACE_POINT();
 	// Standard resource management boilerplate stuff...
 	Pool *pool = getPool();
-	boost::unique_lock<boost::mutex> lock(pool->syncher);
+	PoolScopedLock lock(pool->syncher);
 	assert(process->isAlive());
 	assert(isAlive() || getLifeStatus() == SHUTTING_DOWN);
 
@@ -144,20 +184,8 @@ Group::onSessionInitiateFailure(Process *process, Session *session) {
 	runAllActions(actions);
 }
 
-OXT_FORCE_INLINE void
-Group::onSessionClose(Process *process, Session *session) {
-	TRACE_POINT();
-	// Standard resource management boilerplate stuff...
-	Pool *pool = getPool();
-	boost::unique_lock<boost::mutex> lock(pool->syncher);
-	assert(process->isAlive());
-	assert(isAlive() || getLifeStatus() == SHUTTING_DOWN);
-
-	P_TRACE(2, "Session closed for process " << process->inspect());
-	verifyInvariants();
-	UPDATE_TRACE_POINT();
-
-	/* Update statistics. */
+void
+Group::updateStatisticsForClosedSession(Process *process, Session *session) {
 	bool wasTotallyBusy = process->isTotallyBusy();
 	process->sessionClosed(session);
 	assert(process->getLifeStatus() == Process::ALIVE);
@@ -165,12 +193,70 @@ Group::onSessionClose(Process *process, Session *session) {
 		|| process->enabled == Process::DISABLING
 		|| process->enabled == Process::DETACHED);
 	if (process->enabled == Process::ENABLED) {
-		enabledProcessBusynessLevels[process->getIndex()] = process->busyness();
+		enabledProcessBusynessLevels.set(process->getIndex(), process->busyness());
 		if (wasTotallyBusy) {
 			assert(nEnabledProcessesTotallyBusy >= 1);
 			nEnabledProcessesTotallyBusy--;
 		}
 	}
+	updateDemandStatistics();
+}
+
+/* Closes the session while holding the pool lock in shared mode only,
+ * provided that doing so doesn't involve anything other than updating
+ * statistics: i.e. the process won't have to be detached or disabled, no
+ * out-of-band work is to be initiated and nobody is waiting on this group.
+ * Returns false (and leaves everything untouched) otherwise, in which case
+ * the caller must close the session under the exclusive pool lock.
+ */
+bool
+Group::closeSessionWithSharedPoolLock(Process *process, Session *session) {
+	Pool *pool = getPool();
+	PoolSharedLock lock(pool->syncher);
+	boost::lock_guard<boost::mutex> l(sessionSyncher);
+
+	if (process->enabled != Process::ENABLED
+	 || process->oobwStatus == Process::OOBW_REQUESTED
+	 || !getWaitlist.empty()
+	 || (options.maxRequests > 0 && process->processed + 1 >= options.maxRequests))
+	{
+		return false;
+	}
+	if (process->sessions == 1
+	 && (!pool->getWaitlist.empty() || anotherGroupIsWaitingForCapacity()))
+	{
+		// The process will become idle and its capacity may be needed elsewhere.
+		return false;
+	}
+
+	P_TRACE(2, "Session closed for process " << process->inspect());
+	updateStatisticsForClosedSession(process, session);
+	return true;
+}
+
+OXT_FORCE_INLINE void
+Group::onSessionClose(Process *process, Session *session) {
+	TRACE_POINT();
+	Pool *pool = getPool();
+
+	/* In the common case, closing a session only involves updating
+	 * this group's statistics, which doesn't need the pool lock
+	 * exclusively.
+	 */
+	if (closeSessionWithSharedPoolLock(process, session)) {
+		return;
+	}
+
+	// Standard resource management boilerplate stuff...
+	PoolScopedLock lock(pool->syncher);
+	assert(process->isAlive());
+	assert(isAlive() || getLifeStatus() == SHUTTING_DOWN);
+
+	P_TRACE(2, "Session closed for process " << process->inspect());
+	verifyInvariants();
+	UPDATE_TRACE_POINT();
+
+	updateStatisticsForClosedSession(process, session);
 
 	/* This group now has a process that's guaranteed to be not
 	 * totally busy.
@@ -125,7 +125,7 @@ Group::spawnThreadRealMain(const SpawningKit::SpawnerPtr &spawner,
 
 		UPDATE_TRACE_POINT();
 		ScopeGuard guard(boost::bind(Process::forceTriggerShutdownAndCleanup, process));
-		boost::unique_lock<boost::mutex> lock(pool->syncher);
+		PoolScopedLock lock(pool->syncher);
 
 		if (!isAlive()) {
 			if (process != NULL) {
@@ -158,7 +158,7 @@ Group::spawnThreadRealMain(const SpawningKit::SpawnerPtr &spawner,
 		assert(processesBeingSpawned > 0);
 
 		processesBeingSpawned--;
-		assert(processesBeingSpawned == 0);
+		assert(processesBeingSpawned >= 0);
 
 		UPDATE_TRACE_POINT();
 		boost::container::vector<Callback> actions;
@@ -191,17 +191,20 @@ Group::spawnThreadRealMain(const SpawningKit::SpawnerPtr &spawner,
 			done = true;
 		}
 
+		// Other spawn loops may still be running, and the processes that
+		// they're spawning are already accounted for by spawnDemand().
 		done = done
-			|| (processLowerLimitsSatisfied() && getWaitlist.empty())
+			|| spawnDemand() == 0
 			|| processUpperLimitsReached()
 			|| pool->atFullCapacityUnlocked();
-		m_spawning = !done;
 		if (done) {
 			P_DEBUG("Spawn loop done");
 		} else {
 			processesBeingSpawned++;
+			startAdditionalSpawnLoops();
 			P_DEBUG("Continue spawning");
 		}
+		m_spawning = processesBeingSpawned > 0;
 
 		UPDATE_TRACE_POINT();
 		pool->fullVerifyInvariants();
@@ -251,7 +254,7 @@ Group::finalizeRestart(GroupPtr self,
 		debug->messages->recv("Finish restarting");
 	}
 
-	ScopedLock l(pool->syncher);
+	PoolScopedLock l(pool->syncher);
 	if (!isAlive()) {
 		P_DEBUG("Group " << getName() << " is shutting down, so aborting restart");
 		return;
@@ -421,16 +424,128 @@ Group::needsRestart(const Options &options) {
 	}
 }
 
+/**
+ * Returns whether calling `needsRestart()` with the given options could do
+ * anything right now. If not, then `needsRestart()` is guaranteed to return
+ * false without stat()ing any files or modifying any state.
+ */
+bool
+Group::restartCheckIsDue(const Options &options) const {
+	if (m_restarting) {
+		return false;
+	}
+
+	time_t now;
+	if (options.currentTime != 0) {
+		now = options.currentTime / 1000000;
+	} else {
+		now = SystemTime::get();
+	}
+	return lastRestartFileCheckTime == 0
+		|| lastRestartFileCheckTime <= now - (time_t) options.statThrottleRate
+		|| alwaysRestartFileExists;
+}
+
+/**
+ * Starts a spawn loop thread, which spawns one process at a time until
+ * `spawnDemand()` is satisfied or until the limits are reached. The caller
+ * must have checked the limits.
+ */
+void
+Group::startSpawnLoop() {
+	interruptableThreads.create_thread(
+		boost::bind(&Group::spawnThreadMain,
+			this, shared_from_this(), spawner,
+			options.copyAndPersist().clearPerRequestFields(),
+			restartsInitiated),
+		"Group process spawner: " + info.name,
+		POOL_HELPER_THREAD_STACK_SIZE);
+	m_spawning = true;
+	processesBeingSpawned++;
+}
+
+/**
+ * Starts more spawn loops while there is demand for more processes than are
+ * already being spawned, up to `options.spawnConcurrency` loops, while
+ * respecting the resource limits. Processes that are being spawned count
+ * towards the limits, so parallel spawning never overshoots them.
+ */
+void
+Group::startAdditionalSpawnLoops() {
+	unsigned int concurrency = std::max(options.spawnConcurrency, 1u);
+	while ((unsigned int) processesBeingSpawned < concurrency
+		&& spawnDemand() > 0
+		&& !processUpperLimitsReached()
+		&& !poolAtFullCapacity())
+	{
+		P_DEBUG("Spawning another process in parallel for group " << info.name);
+		startSpawnLoop();
+	}
+}
+
+/**
+ * Returns how many more processes are needed, on top of the ones that are
+ * already being spawned: enough to satisfy `minProcesses`, one for every
+ * request in the wait list and, if predictive spawning is enabled, enough
+ * to satisfy `predictedProcessesNeeded()`.
+ */
+unsigned int
+Group::spawnDemand() const {
+	unsigned int result = 0;
+	if (capacityUsed() < options.minProcesses) {
+		result = options.minProcesses - capacityUsed();
+	}
+	if (getWaitlist.size() > (unsigned int) processesBeingSpawned) {
+		result = std::max<unsigned int>(result,
+			getWaitlist.size() - processesBeingSpawned);
+	}
+	if (options.predictiveSpawning) {
+		unsigned int predicted = predictedProcessesNeeded();
+		if (capacityUsed() < predicted) {
+			result = std::max(result, predicted - capacityUsed());
+		}
+	}
+	return result;
+}
+
+/**
+ * Samples the current demand for the predictive spawning statistics. Called
+ * whenever the demand may have changed; does nothing unless predictive
+ * spawning is enabled.
+ */
+void
+Group::updateDemandStatistics(unsigned long long now) {
+	if (OXT_LIKELY(!options.predictiveSpawning)) {
+		return;
+	}
+	if (now == 0) {
+		now = SystemTime::getUsec();
+	}
+	recordDemand(nEnabledProcessesTotallyBusy + getWaitlist.size(), now);
+	if (overProvisionedSince != 0 && predictedProcessesNeeded(now) >= capacityUsed()) {
+		overProvisionedSince = 0;
+	}
+}
+
 /**
  * Attempts to increase the number of processes by one, while respecting the
  * resource limits. That is, this method will ensure that there are at least
  * `minProcesses` processes, but no more than `maxProcesses` processes, and no
  * more than `pool->max` processes in the entire pool.
+ *
+ * If `options.spawnConcurrency` is larger than 1 and there is demand for
+ * more processes, then multiple processes are spawned in parallel.
  */
 SpawnResult
 Group::spawn() {
 	assert(isAlive());
 	if (m_spawning) {
+		// If no process is being spawned right now, then a spawn loop is
+		// busy attaching its process and will decide by itself whether
+		// to continue.
+		if (processesBeingSpawned > 0) {
+			startAdditionalSpawnLoops();
+		}
 		return SR_IN_PROGRESS;
 	} else if (restarting()) {
 		return SR_ERR_RESTARTING;
@@ -440,15 +555,8 @@ Group::spawn() {
 		return SR_ERR_POOL_AT_FULL_CAPACITY;
 	} else {
 		P_DEBUG("Requested spawning of new process for group " << info.name);
-		interruptableThreads.create_thread(
-			boost::bind(&Group::spawnThreadMain,
-				this, shared_from_this(), spawner,
-				options.copyAndPersist().clearPerRequestFields(),
-				restartsInitiated),
-			"Group process spawner: " + info.name,
-			POOL_HELPER_THREAD_STACK_SIZE);
-		m_spawning = true;
-		processesBeingSpawned++;
+		startSpawnLoop();
+		startAdditionalSpawnLoops();
 		return SR_OK;
 	}
 }
@@ -466,6 +574,8 @@ Group::shouldSpawn() const {
 			!processLowerLimitsSatisfied()
 			|| allEnabledProcessesAreTotallyBusy()
 			|| !getWaitlist.empty()
+			|| (options.predictiveSpawning
+				&& capacityUsed() < predictedProcessesNeeded())
 		);
 }
 
@@ -488,6 +598,35 @@ Group::allowSpawn() const {
 		&& !poolAtFullCapacity();
 }
 
+/** Adds a demand sample to the predictive spawning statistics. */
+void
+Group::recordDemand(double demand, unsigned long long now) {
+	shortTermDemand.update(demand, now);
+	longTermDemand.update(demand, now);
+}
+
+/**
+ * The number of processes that predictive spawning thinks this group will
+ * need shortly. The short term average demand is extrapolated by how much it
+ * exceeds the long term average, so that a rising load is provisioned for
+ * before requests start queueing, and 25% headroom is added on top. A
+ * falling load is not extrapolated: scaling down is left to the garbage
+ * collector, which waits `options.scaleDownDelay` seconds first.
+ */
+unsigned int
+Group::predictedProcessesNeeded(unsigned long long now) const {
+	if (!shortTermDemand.available()) {
+		return 0;
+	}
+	if (now == 0) {
+		now = SystemTime::getUsec();
+	}
+	double shortTerm = shortTermDemand.average(now);
+	double longTerm = longTermDemand.average(now);
+	double predicted = shortTerm + std::max(shortTerm - longTerm, 0.0);
+	return (unsigned int) ceil(predicted * 1.25);
+}
+
 
 } // namespace ApplicationPool2
 } // namespace Passenger
@@ -255,6 +255,11 @@ Group::inspectConfigInAdminPanelFormat(Json::Value &result) const {
 		(Json::UInt) DEFAULT_MAX_PRELOADER_IDLE_TIME);
 	result["max_out_of_band_work_instances"] = VAL(options.maxOutOfBandWorkInstances,
 		(Json::UInt) 1);
+	result["spawn_concurrency"] = VAL(options.spawnConcurrency,
+		(Json::UInt) DEFAULT_SPAWN_CONCURRENCY);
+	result["predictive_spawning"] = VAL(options.predictiveSpawning, false);
+	result["scale_down_delay"] = VAL(options.scaleDownDelay,
+		(Json::UInt) DEFAULT_SCALE_DOWN_DELAY);
 	result["base_uri"] = SVAL(options.baseURI, P_STATIC_STRING("/"));
 	result["user"] = SVAL(options.user, options.defaultUser);
 	result["group"] = SVAL(options.group, options.defaultGroup);
@@ -265,6 +270,7 @@ Group::inspectConfigInAdminPanelFormat(Json::Value &result) const {
 	result["max_request_queue_size"] = VAL(options.maxRequestQueueSize,
 		(Json::UInt) DEFAULT_MAX_REQUEST_QUEUE_SIZE);
 	result["max_requests"] = VAL((Json::UInt) options.maxRequests, 0u);
+	result["memory_limit"] = VAL(options.memoryLimit, 0u);
 	result["abort_websockets_on_process_shutdown"] = VAL(options.abortWebsocketsOnProcessShutdown);
 	result["force_max_concurrent_requests_per_process"] = VAL(options.forceMaxConcurrentRequestsPerProcess, -1);
 	result["restart_dir"] = NON_EMPTY_SVAL(options.restartDir);
@@ -121,7 +121,10 @@ Group::verifyExpensiveInvariants() const {
 		assert(process->isAlive());
 		assert(process->oobwStatus == Process::OOBW_NOT_ACTIVE
 			|| process->oobwStatus == Process::OOBW_REQUESTED);
+		assert(enabledProcessBusynessLevels.get(process->getIndex()) == process->busyness());
+		assert(findProcessWithStickySessionId(process->getStickySessionId()) != NULL);
 	}
+	assert(enabledProcessBusynessLevels.size() == enabledProcesses.size());
 
 	end = disablingProcesses.end();
 	for (it = disablingProcesses.begin(); it != end; it++) {
@@ -44,6 +44,37 @@ namespace ApplicationPool2 {
 using namespace std;
 using namespace boost;
 
+
+/**
+ * How Group::route() picks an enabled process for a request that isn't
+ * bound to a process through a sticky session.
+ */
+enum RoutingPolicy {
+	/** Route to the process with the lowest busyness. */
+	RP_LEAST_BUSY,
+	/** Pick two random processes and route to the least busy of the two. */
+	RP_POWER_OF_TWO_CHOICES,
+	/** Pick two random processes and route to the one with the lowest
+	 * average response time, weighted by the number of open sessions. */
+	RP_LEAST_LATENCY,
+
+	RP_UNKNOWN
+};
+
+inline RoutingPolicy
+parseRoutingPolicy(const StaticString &policy) {
+	if (policy == "least_busy") {
+		return RP_LEAST_BUSY;
+	} else if (policy == "power_of_two_choices") {
+		return RP_POWER_OF_TWO_CHOICES;
+	} else if (policy == "least_latency") {
+		return RP_LEAST_LATENCY;
+	} else {
+		return RP_UNKNOWN;
+	}
+}
+
+
 /**
  * This struct encapsulates information for ApplicationPool::get() and for
  * Spawner::spawn(), such as which application is to be spawned.
@@ -354,6 +385,37 @@ public:
 	 */
 	unsigned int maxOutOfBandWorkInstances;
 
+	/**
+	 * The maximum number of processes that this group may be spawning at
+	 * the same time. Values lower than 1 are treated as 1.
+	 */
+	unsigned int spawnConcurrency;
+
+	/**
+	 * Whether the group should spawn processes ahead of demand, based on
+	 * moving averages of how busy it has recently been. See
+	 * `Group::predictedProcessesNeeded()`.
+	 */
+	bool predictiveSpawning;
+
+	/**
+	 * When predictive spawning is enabled: the number of seconds that the
+	 * group must have been continuously over-provisioned before an idle
+	 * process is shut down. After shutting down a process, the group waits
+	 * this long again before shutting down the next one. This is
+	 * independent of the pool's max idle time.
+	 */
+	unsigned int scaleDownDelay;
+
+	/**
+	 * The maximum amount of private memory (in MB) that a process may use
+	 * before it is gracefully shut down and replaced. Private memory is the
+	 * unique set size plus swap, so pages that are still shared with a
+	 * preloader or with other processes don't count. A value of 0 means
+	 * unlimited.
+	 */
+	unsigned int memoryLimit;
+
 	/**
 	 * The maximum number of requests that may live in the Group.getWaitlist queue.
 	 * A value of 0 means unlimited.
@@ -405,6 +467,11 @@ public:
 	 */
 	unsigned long maxRequests;
 
+	/**
+	 * How to pick a process for requests that don't have a sticky session ID.
+	 */
+	RoutingPolicy routingPolicy;
+
 	/** If the current time (in microseconds) has already been queried, set it
 	 * here. Pool will use this timestamp instead of querying it again.
 	 */
@@ -472,6 +539,10 @@ public:
 		  maxProcesses(0),
 		  maxPreloaderIdleTime(-1),
 		  maxOutOfBandWorkInstances(1),
+		  spawnConcurrency(DEFAULT_SPAWN_CONCURRENCY),
+		  predictiveSpawning(false),
+		  scaleDownDelay(DEFAULT_SCALE_DOWN_DELAY),
+		  memoryLimit(0),
 		  maxRequestQueueSize(DEFAULT_MAX_REQUEST_QUEUE_SIZE),
 		  abortWebsocketsOnProcessShutdown(true),
 		  stickySessionsCookieAttributes(DEFAULT_STICKY_SESSIONS_COOKIE_ATTRIBUTES, sizeof(DEFAULT_STICKY_SESSIONS_COOKIE_ATTRIBUTES) - 1),
@@ -479,6 +550,7 @@ public:
 		  stickySessionId(0),
 		  statThrottleRate(DEFAULT_STAT_THROTTLE_RATE),
 		  maxRequests(0),
+		  routingPolicy(RP_LEAST_BUSY),
 		  currentTime(0),
 		  noop(false)
 		  /*********************************/
@@ -605,6 +677,10 @@ public:
 			appendKeyValue3(vec, "max_processes",       maxProcesses);
 			appendKeyValue2(vec, "max_preloader_idle_time", maxPreloaderIdleTime);
 			appendKeyValue3(vec, "max_out_of_band_work_instances", maxOutOfBandWorkInstances);
+			appendKeyValue3(vec, "spawn_concurrency",   spawnConcurrency);
+			appendKeyValue4(vec, "predictive_spawning", predictiveSpawning);
+			appendKeyValue3(vec, "scale_down_delay",    scaleDownDelay);
+			appendKeyValue3(vec, "memory_limit",        memoryLimit);
 			appendKeyValue (vec, "sticky_sessions_cookie_attributes", stickySessionsCookieAttributes);
 		}
 
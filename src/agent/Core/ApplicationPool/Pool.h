@@ -213,7 +213,7 @@ public:
 	friend class Process;
 	friend struct tut::ApplicationPool2_PoolTest;
 
-	mutable boost::mutex syncher;
+	mutable boost::shared_mutex syncher;
 	unsigned int max;
 	unsigned long long maxIdleTime;
 	bool selfchecking;
@@ -329,6 +329,9 @@ public:
 	static void updateProcessMetrics(const ProcessList &processes,
 		const ProcessMetricMap &allMetrics,
 		vector<ProcessPtr> &processesToDetach);
+	static ProcessPtr findProcessExceedingMemoryLimit(const Group *group);
+	void recycleProcessesExceedingMemoryLimits(
+		boost::container::vector<Callback> &postLockActions);
 	void realCollectAnalytics();
 
 
@@ -340,7 +343,7 @@ public:
 		boost::container::vector<Callback> actions;
 	};
 
-	boost::condition_variable garbageCollectionCond;
+	boost::condition_variable_any garbageCollectionCond;
 
 	void initializeGarbageCollection();
 	static void garbageCollect(PoolPtr self);
@@ -349,6 +352,9 @@ public:
 		const GroupPtr &group, const ProcessPtr &process, ProcessList &output);
 	void garbageCollectProcessesInGroup(GarbageCollectorState &state,
 		const GroupPtr &group);
+	void garbageCollectIdleConnectionsInGroup(GarbageCollectorState &state,
+		const GroupPtr &group);
+	void maybeScaleDownGroup(GarbageCollectorState &state, const GroupPtr &group);
 	void maybeCleanPreloader(GarbageCollectorState &state, const GroupPtr &group);
 	unsigned long long realGarbageCollect();
 	void wakeupGarbageCollector();
@@ -389,6 +395,7 @@ public:
 	const pair<uid_t, gid_t> getGroupRunUidAndGids(const StaticString &appGroupName);
 	Group *findMatchingGroup(const Options &options);
 	GroupPtr createGroup(const Options &options);
+	SessionPtr getWithSharedLock(const Options &options);
 	GroupPtr createGroupAndAsyncGetFromIt(const Options &options,
 		const GetCallback &callback, boost::container::vector<Callback> &postLockActions);
 	void forceDetachGroup(const GroupPtr &group,
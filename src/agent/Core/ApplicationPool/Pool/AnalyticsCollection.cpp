@@ -108,6 +108,67 @@ Pool::updateProcessMetrics(const ProcessList &processes,
 	}
 }
 
+/* Returns the enabled process in the given group that uses the most private
+ * memory, provided that it's more than the group's memory limit. Private
+ * memory doesn't include pages that are still shared with the preloader or
+ * with other processes, so that preforked apps aren't penalized for memory
+ * that they don't use on their own.
+ */
+ProcessPtr
+Pool::findProcessExceedingMemoryLimit(const Group *group) {
+	if (group->options.memoryLimit == 0) {
+		return ProcessPtr();
+	}
+
+	ProcessPtr result;
+	size_t maxMemory = (size_t) group->options.memoryLimit * 1024;
+	foreach (const ProcessPtr &process, group->enabledProcesses) {
+		if (process->metrics.isValid()
+		 && process->metrics.privateMemory() > maxMemory)
+		{
+			result = process;
+			maxMemory = process->metrics.privateMemory();
+		}
+	}
+	return result;
+}
+
+/* Gracefully restarts processes that exceed their group's memory limit:
+ * the process is detached, so that it's shut down as soon as it has
+ * finished its current requests, and a replacement is spawned if the group
+ * needs one. At most one process per group is restarted per analytics
+ * collection cycle, so that when all processes grow at the same rate, the
+ * group isn't left without capacity.
+ */
+void
+Pool::recycleProcessesExceedingMemoryLimits(
+	boost::container::vector<Callback> &postLockActions)
+{
+	vector<ProcessPtr> processesToRecycle;
+	GroupMap::ConstIterator g_it(groups);
+
+	while (*g_it != NULL) {
+		const GroupPtr &group = g_it.getValue();
+		ProcessPtr process = findProcessExceedingMemoryLimit(group.get());
+		if (process) {
+			processesToRecycle.push_back(process);
+		}
+		g_it.next();
+	}
+
+	foreach (const ProcessPtr &process, processesToRecycle) {
+		Group *group = process->getGroup();
+		P_NOTICE("Process " << process->inspect() << " is using "
+			<< process->metrics.privateMemory() / 1024 << " MB of private memory,"
+			" which exceeds the memory limit of " << group->options.memoryLimit
+			<< " MB; shutting it down gracefully");
+		detachProcessUnlocked(process, postLockActions);
+		if (group->shouldSpawn()) {
+			group->spawn();
+		}
+	}
+}
+
 void
 Pool::realCollectAnalytics() {
 	TRACE_POINT();
@@ -120,13 +181,13 @@ Pool::realCollectAnalytics() {
 	// Collect all the PIDs.
 	{
 		UPDATE_TRACE_POINT();
-		LockGuard l(syncher);
+		PoolLockGuard l(syncher);
 		max = this->max;
 	}
 	pids.reserve(max);
 	{
 		UPDATE_TRACE_POINT();
-		LockGuard l(syncher);
+		PoolLockGuard l(syncher);
 		GroupMap::ConstIterator g_it(groups);
 
 		while (*g_it != NULL) {
@@ -162,7 +223,7 @@ Pool::realCollectAnalytics() {
 		UPDATE_TRACE_POINT();
 		vector<ProcessPtr> processesToDetach;
 		boost::container::vector<Callback> actions;
-		ScopedLock l(syncher);
+		PoolScopedLock l(syncher);
 		GroupMap::ConstIterator g_it(groups);
 
 		UPDATE_TRACE_POINT();
@@ -181,6 +242,9 @@ Pool::realCollectAnalytics() {
 		UPDATE_TRACE_POINT();
 		processesToDetach.clear();
 
+		UPDATE_TRACE_POINT();
+		recycleProcessesExceedingMemoryLimits(actions);
+
 		l.unlock();
 
 		UPDATE_TRACE_POINT();
@@ -54,7 +54,7 @@ void
 Pool::garbageCollect(PoolPtr self) {
 	TRACE_POINT();
 	{
-		ScopedLock lock(self->syncher);
+		PoolScopedLock lock(self->syncher);
 		self->garbageCollectionCond.timed_wait(lock,
 			posix_time::seconds(5));
 	}
@@ -63,7 +63,7 @@ Pool::garbageCollect(PoolPtr self) {
 			UPDATE_TRACE_POINT();
 			unsigned long long sleepTime = self->realGarbageCollect();
 			UPDATE_TRACE_POINT();
-			ScopedLock lock(self->syncher);
+			PoolScopedLock lock(self->syncher);
 			self->garbageCollectionCond.timed_wait(lock,
 				posix_time::microseconds(sleepTime));
 		} catch (const thread_interrupted &) {
@@ -113,10 +113,18 @@ Pool::garbageCollectProcessesInGroup(GarbageCollectorState &state,
 			processesToGc);
 	}
 
+	// Groups with predictive spawning keep the processes they're
+	// expected to need shortly.
+	unsigned long minProcesses = group->options.minProcesses;
+	if (group->options.predictiveSpawning) {
+		minProcesses = std::max<unsigned long>(minProcesses,
+			group->predictedProcessesNeeded(state.now));
+	}
+
 	p_it  = processesToGc.begin();
 	p_end = processesToGc.end();
 	while (p_it != p_end
-	 && (unsigned long) group->getProcessCount() > group->options.minProcesses)
+	 && (unsigned long) group->getProcessCount() > minProcesses)
 	{
 		ProcessPtr process = *p_it;
 		P_DEBUG("Garbage collect idle process: " << process->inspect() <<
@@ -126,6 +134,73 @@ Pool::garbageCollectProcessesInGroup(GarbageCollectorState &state,
 	}
 }
 
+void
+Pool::garbageCollectIdleConnectionsInGroup(GarbageCollectorState &state,
+	const GroupPtr &group)
+{
+	ProcessList *lists[] = { &group->enabledProcesses, &group->disablingProcesses,
+		&group->disabledProcesses };
+
+	for (unsigned int i = 0; i < sizeof(lists) / sizeof(ProcessList *); i++) {
+		ProcessList::iterator p_it, p_end = lists[i]->end();
+		for (p_it = lists[i]->begin(); p_it != p_end; p_it++) {
+			unsigned long long nextExpiry = (*p_it)->reapIdleConnections(state.now);
+			if (nextExpiry != 0) {
+				maybeUpdateNextGcRuntime(state, nextExpiry);
+			}
+		}
+	}
+}
+
+/**
+ * Scale-down hysteresis for groups with predictive spawning. If the group
+ * has more processes than it's predicted to need, and that has been the
+ * case for at least `scaleDownDelay` seconds, then one idle process is
+ * detached. The delay then starts over, so that the group shrinks one
+ * process at a time.
+ */
+void
+Pool::maybeScaleDownGroup(GarbageCollectorState &state, const GroupPtr &group) {
+	unsigned long long scaleDownDelay =
+		(unsigned long long) group->options.scaleDownDelay * 1000000;
+	unsigned int needed = std::max<unsigned int>(group->options.minProcesses,
+		group->predictedProcessesNeeded(state.now));
+
+	if (group->capacityUsed() <= needed) {
+		group->overProvisionedSince = 0;
+		if (group->getProcessCount() > group->options.minProcesses) {
+			// Check again later, because the prediction decays over time.
+			maybeUpdateNextGcRuntime(state, state.now + scaleDownDelay);
+		}
+		return;
+	}
+
+	if (group->overProvisionedSince == 0) {
+		group->overProvisionedSince = state.now;
+	}
+	unsigned long long scaleDownTime = group->overProvisionedSince + scaleDownDelay;
+	if (state.now < scaleDownTime) {
+		maybeUpdateNextGcRuntime(state, scaleDownTime);
+		return;
+	}
+
+	ProcessPtr idleProcess;
+	foreach (const ProcessPtr &process, group->enabledProcesses) {
+		if (process->sessions == 0
+		 && (!idleProcess || process->lastUsed < idleProcess->lastUsed))
+		{
+			idleProcess = process;
+		}
+	}
+	if (idleProcess) {
+		P_DEBUG("Scale down over-provisioned group " << group->getName() <<
+			": detaching idle process " << idleProcess->inspect());
+		group->detach(idleProcess, state.actions);
+	}
+	group->overProvisionedSince = state.now;
+	maybeUpdateNextGcRuntime(state, state.now + scaleDownDelay);
+}
+
 void
 Pool::maybeCleanPreloader(GarbageCollectorState &state, const GroupPtr &group) {
 	if (group->spawner->cleanable() && group->options.getMaxPreloaderIdleTime() != 0) {
@@ -144,7 +219,7 @@ Pool::maybeCleanPreloader(GarbageCollectorState &state, const GroupPtr &group) {
 unsigned long long
 Pool::realGarbageCollect() {
 	TRACE_POINT();
-	ScopedLock lock(syncher);
+	PoolScopedLock lock(syncher);
 	GroupMap::ConstIterator g_it(groups);
 	GarbageCollectorState state;
 	state.now = SystemTime::getUsec();
@@ -162,8 +237,16 @@ Pool::realGarbageCollect() {
 			garbageCollectProcessesInGroup(state, group);
 		}
 
+		if (group->options.predictiveSpawning) {
+			// ...shrink groups that have been over-provisioned for a while.
+			maybeScaleDownGroup(state, group);
+		}
+
 		group->verifyInvariants();
 
+		// ...close pooled app connections that have been idle for too long.
+		garbageCollectIdleConnectionsInGroup(state, group);
+
 		// ...cleanup the spawner if it's been idle for more than preloaderIdleTime.
 		maybeCleanPreloader(state, group);
 
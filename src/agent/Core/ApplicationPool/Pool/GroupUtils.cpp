@@ -50,7 +50,7 @@ using namespace boost;
 
 const pair<uid_t, gid_t>
 Pool::getGroupRunUidAndGids(const StaticString &appGroupName) {
-	LockGuard l(syncher);
+	PoolLockGuard l(syncher);
 	GroupPtr *group;
 	if (!groups.lookup(appGroupName.c_str(), &group)) {
 		throw RuntimeException("Could not find group: " + appGroupName);
@@ -90,6 +90,23 @@ Pool::createGroup(const Options &options) {
 	return group;
 }
 
+/**
+ * Checks out a session from an existing group while only holding the pool
+ * lock in shared mode. Returns NULL if that isn't possible, in which case
+ * the get() action must be performed under the exclusive lock.
+ */
+SessionPtr
+Pool::getWithSharedLock(const Options &options) {
+	PoolSharedLock lock(syncher);
+	assert(lifeStatus == ALIVE || lifeStatus == PREPARED_FOR_SHUTDOWN);
+	Group *group = findMatchingGroup(options);
+	if (OXT_LIKELY(group != NULL)) {
+		return group->getWithSharedPoolLock(options);
+	} else {
+		return SessionPtr();
+	}
+}
+
 GroupPtr
 Pool::createGroupAndAsyncGetFromIt(const Options &options,
 	const GetCallback &callback, boost::container::vector<Callback> &postLockActions)
@@ -160,7 +177,7 @@ Pool::findOrCreateGroup(const Options &options) {
 
 	Ticket ticket;
 	{
-		LockGuard l(syncher);
+		PoolLockGuard l(syncher);
 		GroupPtr *group;
 		if (!groups.lookup(options.getAppGroupName(), &group)) {
 			// Forcefully create Group, don't care whether resource limits
@@ -173,7 +190,7 @@ Pool::findOrCreateGroup(const Options &options) {
 
 GroupPtr
 Pool::findGroupByApiKey(const StaticString &value, bool lock) const {
-	DynamicScopedLock l(syncher, lock);
+	PoolDynamicScopedLock l(syncher, lock);
 	GroupMap::ConstIterator g_it(groups);
 	while (*g_it != NULL) {
 		const GroupPtr &group = g_it.getValue();
@@ -188,7 +205,7 @@ Pool::findGroupByApiKey(const StaticString &value, bool lock) const {
 bool
 Pool::detachGroupByName(const HashedStaticString &name) {
 	TRACE_POINT();
-	ScopedLock l(syncher);
+	PoolScopedLock l(syncher);
 	GroupPtr group = groups.lookupCopy(name);
 
 	if (OXT_LIKELY(group != NULL)) {
@@ -231,7 +248,7 @@ Pool::detachGroupByName(const HashedStaticString &name) {
 
 bool
 Pool::detachGroupByApiKey(const StaticString &value) {
-	ScopedLock l(syncher);
+	PoolScopedLock l(syncher);
 	GroupPtr group = findGroupByApiKey(value, false);
 	if (group != NULL) {
 		string name = group->getName();
@@ -245,7 +262,7 @@ Pool::detachGroupByApiKey(const StaticString &value) {
 
 bool
 Pool::restartGroupByName(const StaticString &name, const RestartOptions &options) {
-	ScopedLock l(syncher);
+	PoolScopedLock l(syncher);
 	GroupMap::ConstIterator g_it(groups);
 	while (*g_it != NULL) {
 		const GroupPtr &group = g_it.getValue();
@@ -268,7 +285,7 @@ Pool::restartGroupByName(const StaticString &name, const RestartOptions &options
 
 unsigned int
 Pool::restartGroupsByAppRoot(const StaticString &appRoot, const RestartOptions &options) {
-	ScopedLock l(syncher);
+	PoolScopedLock l(syncher);
 	GroupMap::ConstIterator g_it(groups);
 	unsigned int result = 0;
 
@@ -74,14 +74,14 @@ Pool::~Pool() {
 /** Must be called right after construction. */
 void
 Pool::initialize() {
-	LockGuard l(syncher);
+	PoolLockGuard l(syncher);
 	initializeAnalyticsCollection();
 	initializeGarbageCollection();
 }
 
 void
 Pool::initDebugging() {
-	LockGuard l(syncher);
+	PoolLockGuard l(syncher);
 	debugSupport = boost::make_shared<DebugSupport>();
 }
 
@@ -95,7 +95,7 @@ Pool::initDebugging() {
 void
 Pool::prepareForShutdown() {
 	TRACE_POINT();
-	ScopedLock lock(syncher);
+	PoolScopedLock lock(syncher);
 	assert(lifeStatus == ALIVE);
 	lifeStatus = PREPARED_FOR_SHUTDOWN;
 	if (abortLongRunningConnectionsCallback) {
@@ -112,7 +112,7 @@ Pool::prepareForShutdown() {
 void
 Pool::destroy() {
 	TRACE_POINT();
-	ScopedLock lock(syncher);
+	PoolScopedLock lock(syncher);
 	assert(lifeStatus == ALIVE || lifeStatus == PREPARED_FOR_SHUTDOWN);
 
 	lifeStatus = SHUTTING_DOWN;
@@ -45,7 +45,21 @@ using namespace boost;
 // should never call the callback while holding the lock.
 void
 Pool::asyncGet(const Options &options, const GetCallback &callback, bool lockNow) {
-	DynamicScopedLock lock(syncher, lockNow);
+	if (OXT_LIKELY(lockNow)) {
+		/* Best case: the group exists and has a process available. Routing
+		 * only touches that group, so we don't need to serialize with gets
+		 * for other groups.
+		 */
+		SessionPtr session = getWithSharedLock(options);
+		if (session != NULL) {
+			P_TRACE(2, "asyncGet(appGroupName=" << options.getAppGroupName()
+				<< ") finished with shared lock");
+			callback(session, ExceptionPtr());
+			return;
+		}
+	}
+
+	PoolDynamicScopedLock lock(syncher, lockNow);
 
 	assert(lifeStatus == ALIVE || lifeStatus == PREPARED_FOR_SHUTDOWN);
 	verifyInvariants();
@@ -170,7 +184,7 @@ Pool::get(const Options &options, Ticket *ticket) {
 
 void
 Pool::setMax(unsigned int max) {
-	ScopedLock l(syncher);
+	PoolScopedLock l(syncher);
 	assert(max > 0);
 	fullVerifyInvariants();
 	bool bigger = max > this->max;
@@ -199,14 +213,14 @@ Pool::setMax(unsigned int max) {
 
 void
 Pool::setMaxIdleTime(unsigned long long value) {
-	LockGuard l(syncher);
+	PoolLockGuard l(syncher);
 	maxIdleTime = value;
 	wakeupGarbageCollector();
 }
 
 void
 Pool::enableSelfChecking(bool enabled) {
-	LockGuard l(syncher);
+	PoolLockGuard l(syncher);
 	selfchecking = enabled;
 }
 
@@ -215,7 +229,7 @@ Pool::enableSelfChecking(bool enabled) {
  */
 bool
 Pool::isSpawning(bool lock) const {
-	DynamicScopedLock l(syncher, lock);
+	PoolDynamicScopedLock l(syncher, lock);
 	GroupMap::ConstIterator g_it(groups);
 	while (*g_it != NULL) {
 		const GroupPtr &group = g_it.getValue();
@@ -238,7 +252,7 @@ Pool::authorizeByUid(uid_t uid, bool lock) const {
 		return true;
 	}
 
-	DynamicScopedLock l(syncher, lock);
+	PoolDynamicScopedLock l(syncher, lock);
 	GroupMap::ConstIterator g_it(groups);
 	while (*g_it != NULL) {
 		const GroupPtr &group = g_it.getValue();
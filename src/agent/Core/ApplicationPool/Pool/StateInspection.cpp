@@ -71,6 +71,15 @@ Pool::atFullCapacityUnlocked() const {
 	return capacityUsedUnlocked() >= max;
 }
 
+static string
+formatProcessMemoryInMb(ssize_t kb) {
+	if (kb == -1) {
+		return "?";
+	} else {
+		return toString(kb / 1024) + "M";
+	}
+}
+
 void
 Pool::inspectProcessList(const InspectOptions &options, stringstream &result,
 	const Group *group, const ProcessList &processes) const
@@ -111,6 +120,15 @@ Pool::inspectProcessList(const InspectOptions &options, stringstream &result,
 			distanceOfTimeInWords(process->lastUsed / 1000000).c_str());
 		result << buf << endl;
 
+		if (options.verbose && process->metrics.isValid()) {
+			snprintf(buf, sizeof(buf),
+				"    PSS     : %-5s   USS     : %-5s   Swap     : %s",
+				formatProcessMemoryInMb(process->metrics.pss).c_str(),
+				formatProcessMemoryInMb(process->metrics.uss).c_str(),
+				formatProcessMemoryInMb(process->metrics.swap).c_str());
+			result << buf << endl;
+		}
+
 		if (process->enabled == Process::DISABLING) {
 			result << "    Disabling..." << endl;
 		} else if (process->enabled == Process::DISABLED) {
@@ -137,7 +155,7 @@ Pool::inspectProcessList(const InspectOptions &options, stringstream &result,
 
 string
 Pool::inspect(const InspectOptions &options, bool lock) const {
-	DynamicScopedLock l(syncher, lock);
+	PoolDynamicScopedLock l(syncher, lock);
 	stringstream result;
 	const char *headerColor = maybeColorize(options, ANSI_COLOR_YELLOW ANSI_COLOR_BLUE_BG ANSI_COLOR_BOLD);
 	const char *resetColor  = maybeColorize(options, ANSI_COLOR_RESET);
@@ -203,7 +221,7 @@ Pool::inspect(const InspectOptions &options, bool lock) const {
 
 string
 Pool::toXml(const ToXmlOptions &options, bool lock) const {
-	DynamicScopedLock l(syncher, lock);
+	PoolDynamicScopedLock l(syncher, lock);
 	stringstream result;
 	GroupMap::ConstIterator g_it(groups);
 	ProcessList::const_iterator p_it;
@@ -272,7 +290,7 @@ Pool::toXml(const ToXmlOptions &options, bool lock) const {
 
 Json::Value
 Pool::inspectPropertiesInAdminPanelFormat(const ToJsonOptions &options) const {
-	ScopedLock l(syncher);
+	PoolScopedLock l(syncher);
 	Json::Value result(Json::objectValue);
 	GroupMap::ConstIterator g_it(groups);
 	ProcessList::const_iterator p_it;
@@ -313,7 +331,7 @@ Pool::inspectPropertiesInAdminPanelFormat(const ToJsonOptions &options) const {
 
 Json::Value
 Pool::inspectConfigInAdminPanelFormat(const ToJsonOptions &options) const {
-	ScopedLock l(syncher);
+	PoolScopedLock l(syncher);
 	Json::Value result(Json::objectValue);
 	GroupMap::ConstIterator g_it(groups);
 	ProcessList::const_iterator p_it;
@@ -402,13 +420,13 @@ Pool::makeSingleNonEmptyStrValueJsonConfigFormat(const StaticString &val) {
 
 unsigned int
 Pool::capacityUsed() const {
-	LockGuard l(syncher);
+	PoolLockGuard l(syncher);
 	return capacityUsedUnlocked();
 }
 
 bool
 Pool::atFullCapacity() const {
-	LockGuard l(syncher);
+	PoolLockGuard l(syncher);
 	return atFullCapacityUnlocked();
 }
 
@@ -419,7 +437,7 @@ Pool::atFullCapacity() const {
  */
 unsigned int
 Pool::getProcessCount(bool lock) const {
-	DynamicScopedLock l(syncher, lock);
+	PoolDynamicScopedLock l(syncher, lock);
 	unsigned int result = 0;
 	GroupMap::ConstIterator g_it(groups);
 	while (*g_it != NULL) {
@@ -432,7 +450,7 @@ Pool::getProcessCount(bool lock) const {
 
 unsigned int
 Pool::getGroupCount() const {
-	LockGuard l(syncher);
+	PoolLockGuard l(syncher);
 	return groups.size();
 }
 
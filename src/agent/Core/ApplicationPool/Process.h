@@ -39,6 +39,7 @@
 #include <climits>
 #include <cassert>
 #include <cstring>
+#include <Algorithms/MovingAverage.h>
 #include <Constants.h>
 #include <FileDescriptor.h>
 #include <LoggingKit/LoggingKit.h>
@@ -389,6 +390,11 @@ public:
 	int sessions;
 	/** Number of sessions opened so far. */
 	unsigned int processed;
+	/** Exponential moving average of the time (in microseconds) that this
+	 * process took to start responding, as reported through
+	 * Session::reportResponseTime(). -1 if nothing has been reported yet.
+	 */
+	double responseTimeAverage;
 	/** Do not access directly, always use `isAlive()`/`isDead()`/`getLifeStatus()` or
 	 * through `lifetimeSyncher`. */
 	enum LifeStatus {
@@ -459,6 +465,7 @@ public:
 		  lastUsed(spawnEndTime),
 		  sessions(0),
 		  processed(0),
+		  responseTimeAverage(-1),
 		  lifeStatus(ALIVE),
 		  enabled(ENABLED),
 		  oobwStatus(OOBW_NOT_ACTIVE),
@@ -484,6 +491,7 @@ public:
 		  lastUsed(spawnEndTime),
 		  sessions(0),
 		  processed(0),
+		  responseTimeAverage(-1),
 		  lifeStatus(ALIVE),
 		  enabled(ENABLED),
 		  oobwStatus(OOBW_NOT_ACTIVE),
@@ -603,6 +611,14 @@ public:
 		if (type == SpawningKit::Result::GENERIC) {
 			syscalls::kill(getPid(), SIGTERM);
 		}
+		if (type != SpawningKit::Result::DUMMY) {
+			// Don't keep the process waiting for requests on
+			// pooled connections while it shuts down.
+			SocketList::iterator it, end = sockets.end();
+			for (it = sockets.begin(); it != end; it++) {
+				it->closeAllConnections();
+			}
+		}
 	}
 
 	bool shutdownTimeoutExpired() const {
@@ -691,6 +707,66 @@ public:
 		return sockets;
 	}
 
+	/**
+	 * Opens connections to the sockets that accept HTTP requests ahead of
+	 * time, so that the first requests routed to this process don't have
+	 * to connect. Called outside the pool lock when the process is attached
+	 * or enabled again.
+	 *
+	 * The connections are opened without holding `lifetimeSyncher`. They
+	 * are then added to the connection pools while holding it, so that a
+	 * concurrent triggerShutdown() either comes first, in which case we
+	 * close them, or closes them itself.
+	 */
+	void prewarmConnections() {
+		if (isDummy() || !isAlive()) {
+			return;
+		}
+
+		vector< vector<Connection> > connections(socketsAcceptingHttpRequestsCount);
+		unsigned int i;
+		bool alive;
+
+		for (i = 0; i < socketsAcceptingHttpRequestsCount; i++) {
+			socketsAcceptingHttpRequests[i]->openPrewarmedConnections(
+				APP_CONNECTION_PREWARM_LIMIT, connections[i]);
+		}
+
+		{
+			oxt::spin_lock::scoped_lock lock(lifetimeSyncher);
+			alive = lifeStatus == ALIVE;
+			if (alive) {
+				for (i = 0; i < socketsAcceptingHttpRequestsCount; i++) {
+					socketsAcceptingHttpRequests[i]->addPrewarmedConnections(
+						APP_CONNECTION_PREWARM_LIMIT, connections[i]);
+				}
+			}
+		}
+
+		for (i = 0; i < socketsAcceptingHttpRequestsCount; i++) {
+			socketsAcceptingHttpRequests[i]->closePrewarmedConnections(connections[i]);
+		}
+	}
+
+	/**
+	 * Closes pooled connections that have been idle for longer than
+	 * APP_CONNECTION_IDLE_TIMEOUT. Returns the time at which the next
+	 * pooled connection expires, or 0 if there are none.
+	 */
+	unsigned long long reapIdleConnections(unsigned long long now) {
+		unsigned long long nextExpiry = 0;
+		SocketList::iterator it, end = sockets.end();
+
+		for (it = sockets.begin(); it != end; it++) {
+			unsigned long long expiry = it->reapIdleConnections(now,
+				APP_CONNECTION_IDLE_TIMEOUT * 1000000ull);
+			if (expiry != 0 && (nextExpiry == 0 || expiry < nextExpiry)) {
+				nextExpiry = expiry;
+			}
+		}
+		return nextExpiry;
+	}
+
 	Socket *findSocketsAcceptingHttpRequestsAndWithLowestBusyness() const {
 		if (OXT_UNLIKELY(socketsAcceptingHttpRequestsCount == 0)) {
 			return NULL;
@@ -846,9 +922,31 @@ public:
 		socket->sessions--;
 		this->sessions--;
 		processed++;
+		if (session->getResponseTime() != 0) {
+			// Weigh the last sample heavily enough that a process which
+			// starts pausing (e.g. because of garbage collection) loses
+			// traffic within a few requests.
+			responseTimeAverage = expMovingAverage(responseTimeAverage,
+				session->getResponseTime(), 0.3);
+		}
 		assert(!isTotallyBusy());
 	}
 
+	/**
+	 * The cost of routing one more request to this process according to
+	 * the least latency routing policy: the average response time,
+	 * multiplied by the number of requests that would be in flight.
+	 * Processes that haven't reported a response time yet are considered
+	 * to be fast, so that they get probed.
+	 */
+	double latencyCost() const {
+		if (responseTimeAverage < 0) {
+			return 0;
+		} else {
+			return (responseTimeAverage + 1) * (sessions + 1);
+		}
+	}
+
 	/**
 	 * Returns the uptime of this process so far, as a string.
 	 */
@@ -872,6 +970,10 @@ public:
 		stream << "<sessions>" << sessions << "</sessions>";
 		stream << "<busyness>" << busyness() << "</busyness>";
 		stream << "<processed>" << processed << "</processed>";
+		if (responseTimeAverage >= 0) {
+			stream << "<response_time_average>" << (unsigned long long) responseTimeAverage
+				<< "</response_time_average>";
+		}
 		stream << "<spawner_creation_time>" << spawnerCreationTime << "</spawner_creation_time>";
 		stream << "<spawn_start_time>" << spawnStartTime << "</spawn_start_time>";
 		stream << "<spawn_end_time>" << spawnEndTime << "</spawn_end_time>";
@@ -916,6 +1018,8 @@ public:
 			stream << "<rss>" << metrics.rss << "</rss>";
 			stream << "<pss>" << metrics.pss << "</pss>";
 			stream << "<private_dirty>" << metrics.privateDirty << "</private_dirty>";
+			stream << "<uss>" << metrics.uss << "</uss>";
+			stream << "<shared>" << metrics.shared() << "</shared>";
 			stream << "<swap>" << metrics.swap << "</swap>";
 			stream << "<real_memory>" << metrics.realMemory() << "</real_memory>";
 			stream << "<vmsize>" << metrics.vmsize << "</vmsize>";
@@ -87,6 +87,8 @@ private:
 	Connection connection;
 	mutable boost::atomic<int> refcount;
 	bool closed;
+	/** As reported by reportResponseTime(); 0 if not reported. */
+	unsigned long long responseTime;
 
 	void deinitiate(bool success, bool wantKeepAlive) {
 		connection.fail = !success;
@@ -124,6 +126,7 @@ public:
 		  socket(_socket),
 		  refcount(1),
 		  closed(false),
+		  responseTime(0),
 		  onInitiateFailure(NULL),
 		  onClose(NULL)
 		{ }
@@ -184,7 +187,7 @@ public:
 	virtual void initiate(bool blocking = true) {
 		assert(!closed);
 		ScopeGuard g(boost::bind(&Session::callOnInitiateFailure, this));
-		Connection connection = socket->checkoutConnection();
+		Connection connection = socket->checkoutConnection(blocking);
 		connection.fail = true;
 		if (connection.blocking && !blocking) {
 			FdGuard g2(connection.fd, NULL, 0);
@@ -225,6 +228,14 @@ public:
 
 	virtual void requestOOBW();
 
+	virtual void reportResponseTime(unsigned long long usec) {
+		responseTime = usec;
+	}
+
+	unsigned long long getResponseTime() const {
+		return responseTime;
+	}
+
 
 	virtual void ref() const {
 		refcount.fetch_add(1, boost::memory_order_relaxed);
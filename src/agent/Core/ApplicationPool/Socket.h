@@ -28,16 +28,25 @@
 
 #include <vector>
 #include <oxt/macros.hpp>
+#include <oxt/system_calls.hpp>
 #include <boost/thread.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/weak_ptr.hpp>
 #include <boost/container/small_vector.hpp>
+#include <boost/atomic.hpp>
+#include <oxt/spin_lock.hpp>
+#include <algorithm>
 #include <climits>
 #include <cassert>
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+#include <Constants.h>
 #include <LoggingKit/LoggingKit.h>
 #include <StaticString.h>
 #include <MemoryKit/palloc.h>
 #include <IOTools/IOUtils.h>
+#include <SystemTools/SystemTime.h>
 #include <Core/ApplicationPool/Common.h>
 
 namespace Passenger {
@@ -52,12 +61,15 @@ struct Connection {
 	bool wantKeepAlive: 1;
 	bool fail: 1;
 	bool blocking: 1;
+	/** When this connection was last checked into the connection pool, in microseconds. */
+	unsigned long long lastUsed;
 
 	Connection()
 		: fd(-1),
 		  wantKeepAlive(false),
 		  fail(false),
-		  blocking(true)
+		  blocking(true),
+		  lastUsed(0)
 		{ }
 
 	void close() {
@@ -74,28 +86,160 @@ struct Connection {
 /**
  * Not thread-safe except for the connection pooling methods, so only use
  * within the ApplicationPool lock.
+ *
+ * Idle connections are pooled in APP_CONNECTION_POOL_SHARDS shards, each
+ * with its own spin lock. Every thread checks connections in and out of
+ * its own shard, so Controller threads normally never contend with each
+ * other for the connection pool. A thread only looks at other shards when
+ * its own shard is empty.
+ *
+ * Prewarmed connections are kept apart from connections that have been used
+ * before, and are only handed out when a shard has no used connections left.
+ * Their connect may still be in progress, so a blocking checkout waits for
+ * it to complete, and connects by itself if it failed or if the app has hung
+ * up since. That way a dead app is still reported as a connect failure.
+ * Blocking checkouts must not skip them: an app that handles one connection
+ * at a time may already be waiting on a prewarmed connection.
  */
 class Socket {
 private:
-	boost::mutex connectionPoolLock;
-	vector<Connection> idleConnections;
+	struct ConnectionPoolShard {
+		oxt::spin_lock syncher;
+		vector<Connection> idleConnections;
+		vector<Connection> prewarmedConnections;
+	};
+
+	ConnectionPoolShard connectionPool[APP_CONNECTION_POOL_SHARDS];
 
 	OXT_FORCE_INLINE
 	int connectionPoolLimit() const {
 		return concurrency;
 	}
 
-	Connection connect() const {
+	/**
+	 * Atomically increments `counter` if it is below `limit`. Returns whether
+	 * it did; if so, `newValue` is set to the incremented value.
+	 */
+	static bool incrementIfBelow(boost::atomic<int> &counter, int limit, int &newValue) {
+		int value = counter.load(boost::memory_order_relaxed);
+		do {
+			if (value >= limit) {
+				return false;
+			}
+		} while (!counter.compare_exchange_weak(value, value + 1,
+			boost::memory_order_relaxed));
+		newValue = value + 1;
+		return true;
+	}
+
+	static unsigned int getCurrentThreadShard() {
+		static boost::atomic<unsigned int> nextShard(0);
+		static __thread int shard = -1;
+		if (OXT_UNLIKELY(shard == -1)) {
+			shard = nextShard.fetch_add(1, boost::memory_order_relaxed)
+				% APP_CONNECTION_POOL_SHARDS;
+		}
+		return shard;
+	}
+
+	/**
+	 * Connects to this socket. A non-blocking connect never blocks the calling
+	 * thread: a TCP connection may still be in progress when this method
+	 * returns, which the caller notices as the socket not being writable yet.
+	 */
+	Connection connect(bool blocking) const {
 		Connection connection;
 		P_TRACE(3, "Connecting to " << address);
-		connection.fd = connectToServer(address, __FILE__, __LINE__);
+		if (blocking) {
+			connection.fd = connectToServer(address, __FILE__, __LINE__);
+		} else {
+			NConnect_State state;
+			setupNonBlockingSocket(state, address, __FILE__, __LINE__);
+			if (!connectToServer(state) && state.type == SAT_UNIX) {
+				// A Unix domain socket only refuses to connect immediately
+				// if the listen backlog is full. Let the caller retry.
+				string message = "Cannot connect to Unix socket '";
+				message.append(address.data(), address.size());
+				message.append("': the listen backlog is full");
+				throw SystemException(message, EAGAIN);
+			}
+			if (state.type == SAT_UNIX) {
+				connection.fd = state.s_unix.fd.detach();
+			} else {
+				connection.fd = state.s_tcp.fd.detach();
+			}
+		}
 		connection.fail = true;
 		connection.wantKeepAlive = false;
-		connection.blocking = true;
+		connection.blocking = blocking;
 		P_LOG_FILE_DESCRIPTOR_PURPOSE(connection.fd, "App " << pid << " connection");
 		return connection;
 	}
 
+	bool popIdleConnection(ConnectionPoolShard &shard, Connection &connection) {
+		oxt::spin_lock::scoped_lock l(shard.syncher);
+		if (!shard.idleConnections.empty()) {
+			connection = shard.idleConnections.back();
+			shard.idleConnections.pop_back();
+			return true;
+		} else if (!shard.prewarmedConnections.empty()) {
+			connection = shard.prewarmedConnections.back();
+			shard.prewarmedConnections.pop_back();
+			return true;
+		} else {
+			return false;
+		}
+	}
+
+	void pushIdleConnection(ConnectionPoolShard &shard, const Connection &connection) {
+		oxt::spin_lock::scoped_lock l(shard.syncher);
+		shard.idleConnections.push_back(connection);
+	}
+
+	void pushPrewarmedConnection(ConnectionPoolShard &shard, const Connection &connection) {
+		oxt::spin_lock::scoped_lock l(shard.syncher);
+		shard.prewarmedConnections.push_back(connection);
+	}
+
+	static void reapConnections(vector<Connection> &connections, unsigned long long now,
+		unsigned long long maxIdleTime, vector<Connection> &expired,
+		unsigned long long &nextExpiry)
+	{
+		vector<Connection>::iterator it = connections.begin();
+
+		while (it != connections.end()) {
+			unsigned long long expiry = it->lastUsed + maxIdleTime;
+			if (expiry <= now) {
+				expired.push_back(*it);
+				it = connections.erase(it);
+			} else {
+				if (nextExpiry == 0 || expiry < nextExpiry) {
+					nextExpiry = expiry;
+				}
+				it++;
+			}
+		}
+	}
+
+	void copyConnectionPool(const Socket &other) {
+		for (unsigned int i = 0; i < APP_CONNECTION_POOL_SHARDS; i++) {
+			connectionPool[i].idleConnections = other.connectionPool[i].idleConnections;
+			connectionPool[i].prewarmedConnections = other.connectionPool[i].prewarmedConnections;
+		}
+	}
+
+	static void closeConnections(const StaticString &address, vector<Connection> &connections) {
+		vector<Connection>::iterator it, end = connections.end();
+
+		for (it = connections.begin(); it != end; it++) {
+			try {
+				it->close();
+			} catch (const SystemException &e) {
+				P_ERROR("Cannot close a connection with socket " << address << ": " << e.what());
+			}
+		}
+	}
+
 public:
 	// Socket properties. Read-only.
 	StaticString address;
@@ -111,8 +255,8 @@ public:
 	bool acceptHttpRequests;
 
 	// Private. In public section as alignment optimization.
-	int totalConnections;
-	int totalIdleConnections;
+	boost::atomic<int> totalConnections;
+	boost::atomic<int> totalIdleConnections;
 
 	/** Invariant: sessions >= 0 */
 	int sessions;
@@ -120,7 +264,10 @@ public:
 	Socket()
 		: pid(-1),
 		  concurrency(-1),
-		  acceptHttpRequests(0)
+		  acceptHttpRequests(0),
+		  totalConnections(0),
+		  totalIdleConnections(0),
+		  sessions(0)
 		{ }
 
 	Socket(pid_t _pid, const StaticString &_address, const StaticString &_protocol,
@@ -137,22 +284,25 @@ public:
 		{ }
 
 	Socket(const Socket &other)
-		: idleConnections(other.idleConnections),
-		  address(other.address),
+		: address(other.address),
 		  protocol(other.protocol),
 		  description(other.description),
 		  pid(other.pid),
 		  concurrency(other.concurrency),
 		  acceptHttpRequests(other.acceptHttpRequests),
-		  totalConnections(other.totalConnections),
-		  totalIdleConnections(other.totalIdleConnections),
+		  totalConnections(other.totalConnections.load(boost::memory_order_relaxed)),
+		  totalIdleConnections(other.totalIdleConnections.load(boost::memory_order_relaxed)),
 		  sessions(other.sessions)
-		{ }
+	{
+		copyConnectionPool(other);
+	}
 
 	Socket &operator=(const Socket &other) {
-		totalConnections = other.totalConnections;
-		totalIdleConnections = other.totalIdleConnections;
-		idleConnections = other.idleConnections;
+		totalConnections.store(other.totalConnections.load(boost::memory_order_relaxed),
+			boost::memory_order_relaxed);
+		totalIdleConnections.store(other.totalIdleConnections.load(boost::memory_order_relaxed),
+			boost::memory_order_relaxed);
+		copyConnectionPool(other);
 		address = other.address;
 		protocol = other.protocol;
 		description = other.description;
@@ -166,66 +316,233 @@ public:
 	/**
 	 * Connect to this socket or reuse an existing connection.
 	 *
+	 * If `blocking` is false, then a new connection is set up with a
+	 * non-blocking connect, and the returned connection is non-blocking.
+	 * A pooled connection is returned as is; check `connection.blocking`.
+	 * The exception is a non-blocking one handed to a blocking checkout,
+	 * which is made blocking first, or replaced by a new connection if
+	 * that fails. It may have been prewarmed.
+	 *
 	 * One MUST call checkinConnection() when one's done using the Connection.
 	 * Failure to do so will result in a resource leak.
+	 *
+	 * @throws SystemException Connecting failed.
 	 */
-	Connection checkoutConnection() {
-		boost::unique_lock<boost::mutex> l(connectionPoolLock);
-
-		if (!idleConnections.empty()) {
-			P_TRACE(3, "Socket " << address << ": checking out connection from connection pool (" <<
-				idleConnections.size() << " -> " << (idleConnections.size() - 1) <<
-				" items). Current total number of connections: " << totalConnections);
-			Connection connection = idleConnections.back();
-			idleConnections.pop_back();
-			totalIdleConnections--;
-			return connection;
-		} else {
-			Connection connection = connect();
-			totalConnections++;
-			P_TRACE(3, "Socket " << address << ": there are now " <<
-				totalConnections << " total connections");
-			l.unlock();
-			return connection;
+	Connection checkoutConnection(bool blocking = true) {
+		unsigned int shard = getCurrentThreadShard();
+		Connection connection;
+
+		for (unsigned int i = 0; i < APP_CONNECTION_POOL_SHARDS; i++) {
+			if (popIdleConnection(connectionPool[(shard + i) % APP_CONNECTION_POOL_SHARDS],
+				connection))
+			{
+				int idle = totalIdleConnections.fetch_sub(1, boost::memory_order_relaxed) - 1;
+				P_TRACE(3, "Socket " << address << ": checking out connection from connection pool "
+					"shard " << ((shard + i) % APP_CONNECTION_POOL_SHARDS) << " (" <<
+					idle << " idle connections left). Current total number of connections: " <<
+					totalConnections.load(boost::memory_order_relaxed));
+				if (!blocking || connection.blocking) {
+					return connection;
+				}
+				try {
+					makeConnectionBlocking(connection);
+					return connection;
+				} catch (const SystemException &e) {
+					P_DEBUG("Socket " << address << ": discarding pooled connection: "
+						<< e.what());
+					connection.fail = true;
+					checkinConnection(connection);
+					break;
+				}
+			}
 		}
+
+		connection = connect(blocking);
+		int total = totalConnections.fetch_add(1, boost::memory_order_relaxed) + 1;
+		P_TRACE(3, "Socket " << address << ": there are now " <<
+			total << " total connections");
+		return connection;
+	}
+
+	/**
+	 * Makes a connection that was set up with a non-blocking connect, such
+	 * as a prewarmed one, blocking. Like a blocking connect, this waits until
+	 * the connect has completed.
+	 *
+	 * @throws SystemException The connect failed, or the app has already
+	 *   closed the connection or sent data on it, neither of which it does
+	 *   on a connection that it has not received a request on.
+	 */
+	void makeConnectionBlocking(Connection &connection) const {
+		struct pollfd pfd;
+		int ret, error;
+		socklen_t len = sizeof(error);
+
+		pfd.fd = connection.fd;
+		pfd.events = POLLOUT | POLLIN;
+		pfd.revents = 0;
+		ret = oxt::syscalls::poll(&pfd, 1, -1);
+		if (ret == -1) {
+			int e = errno;
+			throw SystemException("poll() failed", e);
+		}
+		if (getsockopt(connection.fd, SOL_SOCKET, SO_ERROR, &error, &len) == -1) {
+			int e = errno;
+			throw SystemException("getsockopt() failed", e);
+		}
+		if (error != 0) {
+			string message = "Cannot connect to '";
+			message.append(address.data(), address.size());
+			message.append("'");
+			throw SystemException(message, error);
+		}
+		if (pfd.revents & (POLLIN | POLLHUP)) {
+			string message = "The connection to '";
+			message.append(address.data(), address.size());
+			message.append("' was closed by the other side");
+			throw SystemException(message, ECONNRESET);
+		}
+		setBlocking(connection.fd);
+		connection.blocking = true;
 	}
 
 	void checkinConnection(Connection &connection) {
-		boost::unique_lock<boost::mutex> l(connectionPoolLock);
+		int idle;
 
-		if (connection.fail || !connection.wantKeepAlive || totalIdleConnections >= connectionPoolLimit()) {
-			totalConnections--;
-			assert(totalConnections >= 0);
+		if (connection.fail || !connection.wantKeepAlive
+		 || !incrementIfBelow(totalIdleConnections, connectionPoolLimit(), idle))
+		{
+			int total = totalConnections.fetch_sub(1, boost::memory_order_relaxed) - 1;
+			assert(total >= 0);
 			P_TRACE(3, "Socket " << address << ": connection not checked back into "
-				"connection pool. There are now " << totalConnections <<
+				"connection pool. There are now " << total <<
 				" connections in total");
-			l.unlock();
 			connection.close();
 		} else {
-			P_TRACE(3, "Socket " << address << ": checking in connection into connection pool (" <<
-				totalIdleConnections << " -> " << (totalIdleConnections + 1) <<
-				" items). Current total number of connections: " << totalConnections);
-			totalIdleConnections++;
-			idleConnections.push_back(connection);
+			unsigned int shard = getCurrentThreadShard();
+			P_TRACE(3, "Socket " << address << ": checking in connection into connection pool "
+				"shard " << shard << " (" << idle << " idle connections). "
+				"Current total number of connections: " <<
+				totalConnections.load(boost::memory_order_relaxed));
+			connection.lastUsed = SystemTime::getUsec();
+			pushIdleConnection(connectionPool[shard], connection);
+		}
+	}
+
+	/**
+	 * Opens connections ahead of time and adds them to the connection pool,
+	 * until it holds `count` connections or is at its limit. Connections are
+	 * set up with a non-blocking connect, so this never waits for the app.
+	 * They are only handed out to non-blocking checkouts.
+	 * Errors are logged and otherwise ignored.
+	 */
+	void prewarmConnections(int count) {
+		vector<Connection> connections;
+		openPrewarmedConnections(count, connections);
+		unsigned int added = addPrewarmedConnections(count, connections);
+		closePrewarmedConnections(connections);
+		if (added > 0) {
+			P_TRACE(3, "Socket " << address << ": prewarmed " << added << " connections");
 		}
 	}
 
+	/**
+	 * The first step of prewarmConnections(): opens the connections that are
+	 * needed to fill the connection pool up to `count` connections, and
+	 * appends them to `connections`. They are not accounted for in the
+	 * connection pool until they are passed to addPrewarmedConnections().
+	 */
+	void openPrewarmedConnections(int count, vector<Connection> &connections) {
+		int needed = std::min(count, connectionPoolLimit())
+			- totalConnections.load(boost::memory_order_relaxed);
+
+		try {
+			for (int i = 0; i < needed; i++) {
+				Connection connection = connect(false);
+				connection.fail = false;
+				connection.wantKeepAlive = true;
+				connection.lastUsed = SystemTime::getUsec();
+				connections.push_back(connection);
+			}
+		} catch (const SystemException &e) {
+			P_DEBUG("Cannot prewarm connections to socket " << address << ": " << e.what());
+		}
+	}
+
+	/**
+	 * The second step of prewarmConnections(): adds connections opened by
+	 * openPrewarmedConnections() to the connection pool, for as long as it
+	 * holds fewer than `count` connections and is below its limit. Removes
+	 * the added connections from `connections` and returns their number;
+	 * the caller must close the remaining ones with closePrewarmedConnections().
+	 * Doesn't make system calls, so this may be called while holding a spin lock.
+	 */
+	unsigned int addPrewarmedConnections(int count, vector<Connection> &connections) {
+		int limit = std::min(count, connectionPoolLimit());
+		unsigned int i = 0;
+		int dummy;
+
+		while (!connections.empty()
+			&& incrementIfBelow(totalConnections, limit, dummy))
+		{
+			if (!incrementIfBelow(totalIdleConnections, connectionPoolLimit(), dummy)) {
+				totalConnections.fetch_sub(1, boost::memory_order_relaxed);
+				break;
+			}
+			pushPrewarmedConnection(connectionPool[i % APP_CONNECTION_POOL_SHARDS],
+				connections.back());
+			connections.pop_back();
+			i++;
+		}
+		return i;
+	}
+
+	void closePrewarmedConnections(vector<Connection> &connections) {
+		closeConnections(address, connections);
+		connections.clear();
+	}
+
+	/**
+	 * Closes pooled connections that have been idle since before `now - maxIdleTime`
+	 * (both in microseconds). Returns the time at which the next pooled connection
+	 * expires, or 0 if there are no more pooled connections.
+	 */
+	unsigned long long reapIdleConnections(unsigned long long now, unsigned long long maxIdleTime) {
+		vector<Connection> expired;
+		unsigned long long nextExpiry = 0;
+
+		for (unsigned int i = 0; i < APP_CONNECTION_POOL_SHARDS; i++) {
+			ConnectionPoolShard &shard = connectionPool[i];
+			oxt::spin_lock::scoped_lock l(shard.syncher);
+			reapConnections(shard.idleConnections, now, maxIdleTime, expired, nextExpiry);
+			reapConnections(shard.prewarmedConnections, now, maxIdleTime, expired, nextExpiry);
+		}
+
+		if (!expired.empty()) {
+			totalIdleConnections.fetch_sub(expired.size(), boost::memory_order_relaxed);
+			totalConnections.fetch_sub(expired.size(), boost::memory_order_relaxed);
+			P_DEBUG("Socket " << address << ": closing " << expired.size() <<
+				" idle connections");
+			closeConnections(address, expired);
+		}
+		return nextExpiry;
+	}
+
 	void closeAllConnections() {
-		boost::unique_lock<boost::mutex> l(connectionPoolLock);
 		assert(sessions == 0);
-		assert(totalConnections == totalIdleConnections);
-		vector<Connection>::iterator it, end = idleConnections.end();
-
-		for (it = idleConnections.begin(); it != end; it++) {
-			try {
-				it->close();
-			} catch (const SystemException &e) {
-				P_ERROR("Cannot close a connection with socket " << address << ": " << e.what());
+		assert(totalConnections.load() == totalIdleConnections.load());
+		for (unsigned int i = 0; i < APP_CONNECTION_POOL_SHARDS; i++) {
+			vector<Connection> connections, prewarmedConnections;
+			{
+				oxt::spin_lock::scoped_lock l(connectionPool[i].syncher);
+				connectionPool[i].idleConnections.swap(connections);
+				connectionPool[i].prewarmedConnections.swap(prewarmedConnections);
 			}
+			closeConnections(address, connections);
+			closeConnections(address, prewarmedConnections);
 		}
-		idleConnections.clear();
-		totalConnections = 0;
-		totalIdleConnections = 0;
+		totalConnections.store(0);
+		totalIdleConnections.store(0);
 	}
 
 
@@ -91,12 +91,18 @@ using namespace std;
  *   api_server_file_buffered_channel_delay_in_file_mode_switching   unsigned integer   -          default(0)
  *   api_server_file_buffered_channel_max_disk_chunk_read_size       unsigned integer   -          default(0)
  *   api_server_file_buffered_channel_threshold                      unsigned integer   -          default(131072)
+ *   api_server_io_uring                                             boolean            -          default(false),read_only
+ *   api_server_io_uring_recv_buffers                                unsigned integer   -          default(256),read_only
  *   api_server_mbuf_block_chunk_size                                unsigned integer   -          default(4096),read_only
  *   api_server_min_spare_clients                                    unsigned integer   -          default(0)
  *   api_server_request_freelist_limit                               unsigned integer   -          default(1024)
  *   api_server_start_reading_after_accept                           boolean            -          default(true)
  *   app_output_log_level                                            string             -          default("notice")
+ *   async_logging                                                   boolean            -          default(false)
+ *   async_logging_buffer_size                                       unsigned integer   -          default(131072),read_only
+ *   async_logging_overflow_policy                                   string             -          default("block")
  *   benchmark_mode                                                  string             -          -
+ *   client_migration_threshold                                      unsigned integer   -          default(0)
  *   config_manifest                                                 object             -          read_only
  *   controller_accept_burst_count                                   unsigned integer   -          default(32)
  *   controller_addresses                                            array of strings   -          default(["tcp://127.0.0.1:3000"]),read_only
@@ -108,9 +114,12 @@ using namespace std;
  *   controller_file_buffered_channel_delay_in_file_mode_switching   unsigned integer   -          default(0)
  *   controller_file_buffered_channel_max_disk_chunk_read_size       unsigned integer   -          default(0)
  *   controller_file_buffered_channel_threshold                      unsigned integer   -          default(131072)
+ *   controller_io_uring                                             boolean            -          default(false),read_only
+ *   controller_io_uring_recv_buffers                                unsigned integer   -          default(256),read_only
  *   controller_mbuf_block_chunk_size                                unsigned integer   -          default(4096),read_only
  *   controller_min_spare_clients                                    unsigned integer   -          default(0)
  *   controller_request_freelist_limit                               unsigned integer   -          default(1024)
+ *   controller_reuse_port                                           boolean            -          default(false),read_only
  *   controller_secure_headers_password                              any                -          secret
  *   controller_socket_backlog                                       unsigned integer   -          default(2048),read_only
  *   controller_start_reading_after_accept                           boolean            -          default(true)
@@ -127,14 +136,18 @@ using namespace std;
  *   default_max_preloader_idle_time                                 unsigned integer   -          default(300)
  *   default_max_request_queue_size                                  unsigned integer   -          default(100)
  *   default_max_requests                                            unsigned integer   -          default(0)
+ *   default_memory_limit                                            unsigned integer   -          default(0)
  *   default_meteor_app_settings                                     string             -          -
  *   default_min_instances                                           unsigned integer   -          default(1)
  *   default_nodejs                                                  string             -          default("node")
+ *   default_predictive_spawning                                     boolean            -          default(false)
  *   default_preload_bundler                                         boolean            -          default(false)
  *   default_python                                                  string             -          default("python")
  *   default_ruby                                                    string             -          default("ruby")
+ *   default_scale_down_delay                                        unsigned integer   -          default(60)
  *   default_server_name                                             string             -          default
  *   default_server_port                                             unsigned integer   -          default
+ *   default_spawn_concurrency                                       unsigned integer   -          default(1)
  *   default_spawn_method                                            string             -          default("smart")
  *   default_sticky_sessions                                         boolean            -          default(false)
  *   default_sticky_sessions_cookie_attributes                       string             -          default("SameSite=Lax; Secure;")
@@ -161,7 +174,9 @@ using namespace std;
  *   pool_idle_time                                                  unsigned integer   -          default(300)
  *   pool_selfchecks                                                 boolean            -          default(false)
  *   prestart_urls                                                   array of strings   -          default([]),read_only
+ *   request_body_splice_threshold                                   unsigned integer   -          default(131072)
  *   response_buffer_high_watermark                                  unsigned integer   -          default(134217728)
+ *   routing_policy                                                  string             -          default("least_busy")
  *   security_update_checker_certificate_path                        string             -          -
  *   security_update_checker_disabled                                boolean            -          default(false)
  *   security_update_checker_interval                                unsigned integer   -          default(86400)
@@ -187,6 +202,11 @@ using namespace std;
  *   telemetry_collector_timeout                                     unsigned integer   -          default(180)
  *   telemetry_collector_url                                         string             -          default("https://anontelemetry.phusionpassenger.com/v1/collect.json")
  *   telemetry_collector_verify_server                               boolean            -          default(true)
+ *   turbocache_coalescing_timeout                                   unsigned integer   -          default(5000),read_only
+ *   turbocache_max_body_size                                        unsigned integer   -          default(524288),read_only
+ *   turbocache_max_entries                                          unsigned integer   -          default(1024),read_only
+ *   turbocache_max_memory                                           unsigned integer   -          default(16777216),read_only
+ *   turbocache_shared                                               boolean            -          default(false),read_only
  *   turbocaching                                                    boolean            -          default(true),read_only
  *   user_switching                                                  boolean            -          default(true)
  *   vary_turbocache_by_cookie                                       string             -          -
@@ -507,6 +527,7 @@ public:
 		add("controller_addresses", STRING_ARRAY_TYPE, OPTIONAL | READ_ONLY, getDefaultControllerAddresses());
 		add("api_server_addresses", STRING_ARRAY_TYPE, OPTIONAL | READ_ONLY, Json::arrayValue);
 		add("controller_cpu_affine", BOOL_TYPE, OPTIONAL | READ_ONLY, false);
+		add("controller_reuse_port", BOOL_TYPE, OPTIONAL | READ_ONLY, false);
 		add("file_descriptor_ulimit", UINT_TYPE, OPTIONAL | READ_ONLY, 0);
 
 		add("hook_attached_process", STRING_TYPE, OPTIONAL | READ_ONLY);
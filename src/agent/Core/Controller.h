@@ -71,6 +71,7 @@
 #include <MemoryKit/palloc.h>
 #include <DataStructures/LString.h>
 #include <DataStructures/StringKeyTable.h>
+#include <DataStructures/StringMap.h>
 #include <WrapperRegistry/Registry.h>
 #include <StaticString.h>
 #include <Utils.h>
@@ -143,6 +144,15 @@ private:
 	friend class ResponseCache<Request>;
 	struct ev_check checkWatcher;
 	TurboCaching<Request> turboCaching;
+	StringMap<CoalescedRequests *> coalescedRequests;
+	boost::uint64_t coalescedRequestCount;
+	// Number of request bodies that were forwarded with splice() until
+	// the end, and number of times that splicing had to be abandoned
+	// because a socket doesn't support it. See SpliceBody.cpp.
+	boost::uint64_t splicedRequestBodyCount;
+	boost::uint64_t requestBodySpliceFallbackCount;
+	struct TurboCacheRefresh;
+	StringMap<TurboCacheRefresh *> turboCacheRefreshes;
 	ConfigKit::Store *singleAppModeConfig;
 
 	#ifdef DEBUG_CC_EVENT_LOOP_BLOCKING
@@ -163,6 +173,7 @@ private:
 	void initializeFlags(Client *client, Request *req, RequestAnalysis &analysis);
 	bool respondFromTurboCache(Client *client, Request *req);
 	void initializePoolOptions(Client *client, Request *req, RequestAnalysis &analysis);
+	void fillPerRequestPoolOptions(Request *req);
 	void fillPoolOptionsFromConfigCaches(Options &options, psg_pool_t *pool,
 		const ControllerRequestConfigPtr &requestConfigCache);
 	static void fillPoolOption(Request *req, StaticString &field,
@@ -185,6 +196,41 @@ private:
 	const LString *getStickySessionCookieName(Request *req);
 
 
+	/****** Stage: coalesce turbocache misses ******/
+
+	bool coalesceRequest(Client *client, Request *req);
+	void releaseCoalescedRequests(Request *req);
+	void resumeCoalescedRequests(CoalescedRequests *coalesced);
+	static void resumeCoalescedRequestLater(Request *req);
+	static void onCoalescingTimeout(EV_P_ struct ev_timer *timer, int revents);
+
+
+	/****** Refresh turbocache entries in the background ******/
+
+	void refreshTurboCacheEntry(Client *client, Request *req);
+	Request *createTurboCacheRefreshRequest(Request *req);
+	bool initializeTurboCacheRefreshPoolOptions(Request *req);
+	static void turboCacheRefreshSessionCheckedOut(const AbstractSessionPtr &session,
+		const ExceptionPtr &e, void *userData);
+	void turboCacheRefreshSessionCheckedOutFromEventLoopThread(TurboCacheRefresh *refresh,
+		AbstractSessionPtr session, ExceptionPtr e);
+	void sendTurboCacheRefreshRequest(TurboCacheRefresh *refresh);
+	static Channel::Result onTurboCacheRefreshAppSourceData(Channel *_channel,
+		const MemoryKit::mbuf &buffer, int errcode);
+	Channel::Result processTurboCacheRefreshResponse(TurboCacheRefresh *refresh,
+		const MemoryKit::mbuf &buffer, int errcode);
+	bool beginTurboCacheRefreshResponse(TurboCacheRefresh *refresh);
+	bool bufferTurboCacheRefreshResponseBody(TurboCacheRefresh *refresh,
+		const MemoryKit::mbuf &buffer);
+	ServerKit::HttpChunkedBodyParser createTurboCacheRefreshChunkedBodyParser(
+		TurboCacheRefresh *refresh);
+	static unsigned int formatTurboCacheRefreshChunkedBodyParserLoggingPrefix(char *buf,
+		unsigned int bufsize, void *userData);
+	void finishTurboCacheRefresh(TurboCacheRefresh *refresh, bool success);
+	void unrefTurboCacheRefresh(TurboCacheRefresh *refresh);
+	void destroyTurboCacheRefresh(TurboCacheRefresh *refresh);
+
+
 	/****** Stage: buffering body ******/
 
 	void beginBufferingBody(Client *client, Request *req);
@@ -229,9 +275,9 @@ private:
 	void sendHeaderToAppWithSessionProtocol(Client *client, Request *req);
 	static void sendBodyToAppWhenAppSinkIdle(Channel *_channel, unsigned int size);
 	unsigned int determineMaxHeaderSizeForSessionProtocol(Request *req,
-		SessionProtocolWorkingState &state, string delta_monotonic);
+		SessionProtocolWorkingState &state);
 	bool constructHeaderForSessionProtocol(Request *req, char * restrict buffer,
-		unsigned int &size, const SessionProtocolWorkingState &state, string delta_monotonic);
+		unsigned int &size, const SessionProtocolWorkingState &state);
 	void sendHeaderToAppWithHttpProtocol(Client *client, Request *req);
 	bool constructHeaderBuffersForHttpProtocol(Request *req, struct iovec *buffers,
 		unsigned int maxbuffers, unsigned int & restrict_ref nbuffers,
@@ -251,6 +297,22 @@ private:
 	void logAppSocketWriteError(Client *client, int errcode);
 
 
+	/****** Stage: send request body to application with splice() ******/
+
+	#ifdef __linux__
+		bool shouldSpliceBody(Request *req) const;
+		void beginSplicingBody(Client *client, Request *req);
+		static void onSpliceClientReadable(EV_P_ struct ev_io *io, int revents);
+		static void onSpliceAppWritable(EV_P_ struct ev_io *io, int revents);
+		void spliceBody(Client *client, Request *req);
+		void finishSplicingBody(Client *client, Request *req);
+		void stopSplicingBodyWithClientError(Client *client, Request *req, int errcode);
+		void stopSplicingBodyWithAppError(Client *client, Request *req, int errcode);
+		void fallBackFromSplicingBody(Client *client, Request *req);
+		void stopSplicingBody(Request *req);
+	#endif
+
+
 	/****** Stage: forward application response to client ******/
 
 	static Channel::Result _onAppSourceData(Channel *_channel,
@@ -258,6 +320,7 @@ private:
 	Channel::Result onAppSourceData(Client *client, Request *req,
 		const MemoryKit::mbuf &buffer, int errcode);
 	void onAppResponseBegin(Client *client, Request *req);
+	void prepareAppResponseHeaders(Request *req);
 	void prepareAppResponseCaching(Client *client, Request *req);
 	void onAppResponse100Continue(Client *client, Request *req);
 	bool constructHeaderBuffersForResponse(Request *req, struct iovec *buffers,
@@ -293,6 +356,9 @@ private:
 	void handleAppResponseBodyEnd(Client *client, Request *req);
 	OXT_FORCE_INLINE void keepAliveAppConnection(Client *client, Request *req);
 	void storeAppResponseInTurboCache(Client *client, Request *req);
+	void respondFromRevalidatedTurboCacheEntry(Client *client, Request *req);
+	bool respondFromStaleTurboCacheEntry(Client *client, Request *req,
+		const StaticString &reason);
 
 
 	/***** Hooks ******/
@@ -358,12 +424,16 @@ protected:
 	virtual bool shouldDisconnectClientOnShutdown(Client *client);
 	virtual bool shouldAutoDechunkBody(Client *client, Request *req);
 	virtual bool supportsUpgrade(Client *client, Request *req);
+	virtual Controller *getClientMigrationTarget(Client *client);
 
 
 	/****** Marked virtual so that unit tests can mock these ******/
 
 	virtual void asyncGetFromApplicationPool(Request *req,
 		ApplicationPool2::GetCallback callback);
+	#ifdef __linux__
+		virtual ssize_t spliceData(int fdIn, int fdOut, size_t size);
+	#endif
 
 
 public:
@@ -373,6 +443,12 @@ public:
 	ResourceLocator *resourceLocator;
 	WrapperRegistry::Registry *wrapperRegistry;
 	PoolPtr appPool;
+	SharedResponseCache *sharedResponseCache;
+	/**
+	 * The controllers of the other threads, to which idle keep-alive
+	 * clients may be moved. See `client_migration_threshold`.
+	 */
+	vector<Controller *> clientMigrationPeers;
 
 
 	/****** Initialization and shutdown ******/
@@ -392,8 +468,12 @@ public:
 		  poolOptionsCache(4),
 
 		  turboCaching(),
+		  coalescedRequestCount(0),
+		  splicedRequestBodyCount(0),
+		  requestBodySpliceFallbackCount(0),
 		  singleAppModeConfig(NULL),
-		  resourceLocator(NULL)
+		  resourceLocator(NULL),
+		  sharedResponseCache(NULL)
 		  /**************************/
 	{
 		if (mainConfig.singleAppMode) {
@@ -224,6 +224,11 @@ Controller::reportSessionCheckoutError(Client *client, Request *req,
 	const ExceptionPtr &e)
 {
 	TRACE_POINT();
+	if (respondFromStaleTurboCacheEntry(client, req,
+		string("application pool could not provide a session (") + e->what() + ")"))
+	{
+		return;
+	}
 	{
 		boost::shared_ptr<RequestQueueFullException> e2 =
 			dynamic_pointer_cast<RequestQueueFullException>(e);
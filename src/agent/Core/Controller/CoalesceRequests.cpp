@@ -0,0 +1,159 @@
+/*
+ *  Phusion Passenger - https://www.phusionpassenger.com/
+ *  Copyright (c) 2014-2018 Phusion Holding B.V.
+ *
+ *  "Passenger", "Phusion Passenger" and "Union Station" are registered
+ *  trademarks of Phusion Holding B.V.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#include <Core/Controller.h>
+
+/*************************************************************************
+ *
+ * Implements Core::Controller methods pertaining coalescing concurrent
+ * turbocache misses for the same key, so that only one of them is
+ * forwarded to the application.
+ *
+ *************************************************************************/
+
+namespace Passenger {
+namespace Core {
+
+using namespace std;
+using namespace boost;
+
+
+/****************************
+ *
+ * Private methods
+ *
+ ****************************/
+
+
+/**
+ * Called for requests that missed the turbocache and are about to be
+ * forwarded to the application. If another request for the same key is
+ * already waiting for the application's response, then this request
+ * waits for that response too (up to `turbocache_coalescing_timeout`
+ * msec), after which it is served from the turbocache if possible.
+ *
+ * Returns whether the request was put on hold.
+ */
+bool
+Controller::coalesceRequest(Client *client, Request *req) {
+	if (mainConfig.turbocacheCoalescingTimeout == 0
+	 || req->cacheKey.empty()
+	 || req->hasBody()
+	 || !turboCaching.isEnabled()
+	 || !turboCaching.responseCache.requestAllowsFetching(req))
+	{
+		return false;
+	}
+
+	CoalescedRequests *coalesced = coalescedRequests.get(req->cacheKey);
+	if (coalesced == NULL) {
+		// Only requests whose response may be stored can be waited for.
+		if (turboCaching.responseCache.requestAllowsStoring(req)) {
+			coalesced = new CoalescedRequests();
+			coalesced->controller = this;
+			coalesced->key = req->cacheKey;
+			coalesced->leader = req;
+			ev_timer_init(&coalesced->timer, onCoalescingTimeout,
+				mainConfig.turbocacheCoalescingTimeout / 1000.0, 0);
+			coalesced->timer.data = coalesced;
+			coalescedRequests.set(coalesced->key, coalesced);
+			req->coalescedRequests = coalesced;
+		}
+		return false;
+	}
+
+	SKC_TRACE(client, 2, "Turbocaching: waiting for the response to another request"
+		" for the same key (key \"" << cEscapeString(req->cacheKey) << "\")");
+	if (coalesced->waiters.empty()) {
+		ev_timer_start(getLoop(), &coalesced->timer);
+	}
+	coalesced->waiters.push_back(req);
+	coalescedRequestCount++;
+	req->state = Request::WAITING_FOR_COALESCED_RESPONSE;
+	refRequest(req, __FILE__, __LINE__);
+	return true;
+}
+
+/**
+ * Must be called when the response to `req` has been stored in the
+ * turbocache, or when it is known that it won't be. Resumes the requests
+ * that wait for it, if any.
+ */
+void
+Controller::releaseCoalescedRequests(Request *req) {
+	CoalescedRequests *coalesced = req->coalescedRequests;
+	if (coalesced != NULL) {
+		resumeCoalescedRequests(coalesced);
+	}
+}
+
+void
+Controller::resumeCoalescedRequests(CoalescedRequests *coalesced) {
+	vector<Request *>::const_iterator it, end = coalesced->waiters.end();
+
+	ev_timer_stop(getLoop(), &coalesced->timer);
+	coalescedRequests.remove(coalesced->key);
+	coalesced->leader->coalescedRequests = NULL;
+
+	// The waiting requests are resumed from the event loop, so that
+	// they are not processed in the middle of handling the leader.
+	// The references that they hold are passed on.
+	for (it = coalesced->waiters.begin(); it != end; it++) {
+		getContext()->libev->runLater(boost::bind(resumeCoalescedRequestLater, *it));
+	}
+	delete coalesced;
+}
+
+void
+Controller::resumeCoalescedRequestLater(Request *req) {
+	Client *client = static_cast<Client *>(req->client);
+	Controller *self = static_cast<Controller *>(
+		Controller::getServerFromClient(client));
+	SKC_LOG_EVENT_FROM_STATIC(self, Controller, client, "resumeCoalescedRequestLater");
+
+	if (!req->ended()) {
+		SKC_TRACE_FROM_STATIC(self, client, 2, "Turbocaching: resuming coalesced request");
+		if (!self->respondFromTurboCache(client, req)) {
+			self->checkoutSession(client, req);
+		}
+	}
+	self->unrefRequest(req, __FILE__, __LINE__);
+}
+
+void
+Controller::onCoalescingTimeout(EV_P_ struct ev_timer *timer, int revents) {
+	CoalescedRequests *coalesced = static_cast<CoalescedRequests *>(timer->data);
+	Controller *self = coalesced->controller;
+	Client *client = static_cast<Client *>(coalesced->leader->client);
+
+	SKC_DEBUG_FROM_STATIC(self, client, "Turbocaching: timed out waiting for the response;"
+		" forwarding " << coalesced->waiters.size() << " coalesced request(s)"
+		" to the application");
+	self->resumeCoalescedRequests(coalesced);
+}
+
+
+} // namespace Core
+} // namespace Passenger
@@ -40,6 +40,7 @@
 #include <ServerKit/HttpServer.h>
 #include <SystemTools/UserDatabase.h>
 #include <WrapperRegistry/Registry.h>
+#include <Core/ApplicationPool/Options.h>
 #include <Constants.h>
 #include <Exceptions.h>
 #include <StaticString.h>
@@ -85,6 +86,7 @@ parseControllerBenchmarkMode(const StaticString &mode) {
  *   accept_burst_count                                  unsigned integer   -          default(32)
  *   benchmark_mode                                      string             -          -
  *   client_freelist_limit                               unsigned integer   -          default(0)
+ *   client_migration_threshold                          unsigned integer   -          default(0)
  *   default_abort_websockets_on_process_shutdown        boolean            -          default(true)
  *   default_app_file_descriptor_ulimit                  unsigned integer   -          -
  *   default_bind_address                                string             -          default("127.0.0.1")
@@ -97,14 +99,18 @@ parseControllerBenchmarkMode(const StaticString &mode) {
  *   default_max_preloader_idle_time                     unsigned integer   -          default(300)
  *   default_max_request_queue_size                      unsigned integer   -          default(100)
  *   default_max_requests                                unsigned integer   -          default(0)
+ *   default_memory_limit                                unsigned integer   -          default(0)
  *   default_meteor_app_settings                         string             -          -
  *   default_min_instances                               unsigned integer   -          default(1)
  *   default_nodejs                                      string             -          default("node")
+ *   default_predictive_spawning                         boolean            -          default(false)
  *   default_preload_bundler                             boolean            -          default(false)
  *   default_python                                      string             -          default("python")
  *   default_ruby                                        string             -          default("ruby")
+ *   default_scale_down_delay                            unsigned integer   -          default(60)
  *   default_server_name                                 string             required   -
  *   default_server_port                                 unsigned integer   required   -
+ *   default_spawn_concurrency                           unsigned integer   -          default(1)
  *   default_spawn_method                                string             -          default("smart")
  *   default_sticky_sessions                             boolean            -          default(false)
  *   default_sticky_sessions_cookie_attributes           string             -          default("SameSite=Lax; Secure;")
@@ -115,13 +121,20 @@ parseControllerBenchmarkMode(const StaticString &mode) {
  *   max_instances_per_app                               unsigned integer   -          read_only
  *   min_spare_clients                                   unsigned integer   -          default(0)
  *   multi_app                                           boolean            -          default(true),read_only
+ *   request_body_splice_threshold                       unsigned integer   -          default(131072)
  *   request_freelist_limit                              unsigned integer   -          default(1024)
  *   response_buffer_high_watermark                      unsigned integer   -          default(134217728)
+ *   routing_policy                                      string             -          default("least_busy")
  *   server_software                                     string             -          default("Phusion_Passenger/6.0.24")
  *   show_version_in_header                              boolean            -          default(true)
  *   start_reading_after_accept                          boolean            -          default(true)
  *   stat_throttle_rate                                  unsigned integer   -          default(10)
  *   thread_number                                       unsigned integer   required   read_only
+ *   turbocache_coalescing_timeout                       unsigned integer   -          default(5000),read_only
+ *   turbocache_max_body_size                            unsigned integer   -          default(524288),read_only
+ *   turbocache_max_entries                              unsigned integer   -          default(1024),read_only
+ *   turbocache_max_memory                               unsigned integer   -          default(16777216),read_only
+ *   turbocache_shared                                   boolean            -          default(false),read_only
  *   turbocaching                                        boolean            -          default(true),read_only
  *   user_switching                                      boolean            -          default(true)
  *   vary_turbocache_by_cookie                           string             -          -
@@ -138,12 +151,20 @@ private:
 		add("thread_number", UINT_TYPE, REQUIRED | READ_ONLY);
 		add("multi_app", BOOL_TYPE, OPTIONAL | READ_ONLY, true);
 		add("turbocaching", BOOL_TYPE, OPTIONAL | READ_ONLY, true);
+		add("turbocache_max_entries", UINT_TYPE, OPTIONAL | READ_ONLY, DEFAULT_TURBOCACHE_MAX_ENTRIES);
+		add("turbocache_max_memory", UINT_TYPE, OPTIONAL | READ_ONLY, DEFAULT_TURBOCACHE_MAX_MEMORY);
+		add("turbocache_max_body_size", UINT_TYPE, OPTIONAL | READ_ONLY, DEFAULT_TURBOCACHE_MAX_BODY_SIZE);
+		add("turbocache_shared", BOOL_TYPE, OPTIONAL | READ_ONLY, false);
+		add("turbocache_coalescing_timeout", UINT_TYPE, OPTIONAL | READ_ONLY, DEFAULT_TURBOCACHE_COALESCING_TIMEOUT);
 		add("integration_mode", STRING_TYPE, OPTIONAL | READ_ONLY, DEFAULT_INTEGRATION_MODE);
 
 		add("user_switching", BOOL_TYPE, OPTIONAL, true);
 		add("stat_throttle_rate", UINT_TYPE, OPTIONAL, DEFAULT_STAT_THROTTLE_RATE);
+		add("routing_policy", STRING_TYPE, OPTIONAL, "least_busy");
 		add("show_version_in_header", BOOL_TYPE, OPTIONAL, true);
 		add("response_buffer_high_watermark", UINT_TYPE, OPTIONAL, DEFAULT_RESPONSE_BUFFER_HIGH_WATERMARK);
+		add("request_body_splice_threshold", UINT_TYPE, OPTIONAL, DEFAULT_REQUEST_BODY_SPLICE_THRESHOLD);
+		add("client_migration_threshold", UINT_TYPE, OPTIONAL, 0);
 		add("graceful_exit", BOOL_TYPE, OPTIONAL, true);
 		add("benchmark_mode", STRING_TYPE, OPTIONAL);
 
@@ -173,10 +194,14 @@ private:
 		add("default_app_file_descriptor_ulimit", UINT_TYPE, OPTIONAL);
 		add("default_min_instances", UINT_TYPE, OPTIONAL, 1);
 		add("default_max_preloader_idle_time", UINT_TYPE, OPTIONAL, DEFAULT_MAX_PRELOADER_IDLE_TIME);
+		add("default_spawn_concurrency", UINT_TYPE, OPTIONAL, DEFAULT_SPAWN_CONCURRENCY);
+		add("default_predictive_spawning", BOOL_TYPE, OPTIONAL, false);
+		add("default_scale_down_delay", UINT_TYPE, OPTIONAL, DEFAULT_SCALE_DOWN_DELAY);
 		add("default_max_request_queue_size", UINT_TYPE, OPTIONAL, DEFAULT_MAX_REQUEST_QUEUE_SIZE);
 		add("default_force_max_concurrent_requests_per_process", INT_TYPE, OPTIONAL, -1);
 		add("default_abort_websockets_on_process_shutdown", BOOL_TYPE, OPTIONAL, true);
 		add("default_max_requests", UINT_TYPE, OPTIONAL, 0);
+		add("default_memory_limit", UINT_TYPE, OPTIONAL, 0);
 
 
 		/*******************/
@@ -208,6 +233,17 @@ private:
 			errors.push_back(Error("'{{benchmark_mode}}' is not set to a valid value"));
 		}
 
+		if (ApplicationPool2::parseRoutingPolicy(config["routing_policy"].asString())
+			== ApplicationPool2::RP_UNKNOWN)
+		{
+			errors.push_back(Error("'{{routing_policy}}' must be one of"
+				" 'least_busy', 'power_of_two_choices' or 'least_latency'"));
+		}
+
+		if (config["turbocache_max_entries"].asUInt() < 1) {
+			errors.push_back(Error("'{{turbocache_max_entries}}' must be at least 1"));
+		}
+
 		/*******************/
 	}
 
@@ -341,9 +377,13 @@ public:
 	unsigned int threadNumber;
 	unsigned int statThrottleRate;
 	unsigned int responseBufferHighWatermark;
+	unsigned int requestBodySpliceThreshold;
+	unsigned int clientMigrationThreshold;
 	StaticString integrationMode;
 	StaticString serverLogName;
 	unsigned int maxInstancesPerApp;
+	unsigned int turbocacheCoalescingTimeout;
+	ApplicationPool2::RoutingPolicy routingPolicy;
 	ControllerBenchmarkMode benchmarkMode: 3;
 	bool singleAppMode: 1;
 	bool userSwitching: 1;
@@ -359,9 +399,13 @@ public:
 		  threadNumber(config["thread_number"].asUInt()),
 		  statThrottleRate(config["stat_throttle_rate"].asUInt()),
 		  responseBufferHighWatermark(config["response_buffer_high_watermark"].asUInt()),
+		  requestBodySpliceThreshold(config["request_body_splice_threshold"].asUInt()),
+		  clientMigrationThreshold(config["client_migration_threshold"].asUInt()),
 		  integrationMode(psg_pstrdup(pool, config["integration_mode"].asString())),
 		  serverLogName(createServerLogName()),
 		  maxInstancesPerApp(config["max_instances_per_app"].asUInt()),
+		  turbocacheCoalescingTimeout(config["turbocache_coalescing_timeout"].asUInt()),
+		  routingPolicy(ApplicationPool2::parseRoutingPolicy(config["routing_policy"].asString())),
 		  benchmarkMode(parseControllerBenchmarkMode(config["benchmark_mode"].asString())),
 		  singleAppMode(!config["multi_app"].asBool()),
 		  userSwitching(config["user_switching"].asBool()),
@@ -389,8 +433,12 @@ public:
 		std::swap(threadNumber, other.threadNumber);
 		std::swap(statThrottleRate, other.statThrottleRate);
 		std::swap(responseBufferHighWatermark, other.responseBufferHighWatermark);
+		std::swap(requestBodySpliceThreshold, other.requestBodySpliceThreshold);
+		std::swap(clientMigrationThreshold, other.clientMigrationThreshold);
 		std::swap(integrationMode, other.integrationMode);
 		std::swap(serverLogName, other.serverLogName);
+		std::swap(turbocacheCoalescingTimeout, other.turbocacheCoalescingTimeout);
+		std::swap(routingPolicy, other.routingPolicy);
 		SWAP_BITFIELD(ControllerBenchmarkMode, benchmarkMode);
 		SWAP_BITFIELD(bool, singleAppMode);
 		SWAP_BITFIELD(bool, userSwitching);
@@ -430,6 +478,13 @@ public:
 	StaticString defaultStickySessionsCookieAttributes;
 	StaticString defaultVaryTurbocacheByCookie;
 
+	/**
+	 * The SERVER_SOFTWARE and SERVER_PROTOCOL session protocol headers,
+	 * which are the same for every request, so that they can be copied
+	 * into the header with a single append.
+	 */
+	StaticString sessionProtocolServerHeaders;
+
 	StaticString defaultCustomErrorPage;
 	StaticString defaultFriendlyErrorPages;
 	StaticString defaultEnvironment;
@@ -439,13 +494,17 @@ public:
 	unsigned int defaultAppFileDescriptorUlimit;
 	unsigned int defaultMinInstances;
 	unsigned int defaultMaxPreloaderIdleTime;
+	unsigned int defaultSpawnConcurrency;
+	unsigned int defaultScaleDownDelay;
 	unsigned int defaultMaxRequestQueueSize;
 	unsigned int defaultMaxRequests;
+	unsigned int defaultMemoryLimit;
 	int defaultForceMaxConcurrentRequestsPerProcess;
 	bool showVersionInHeader: 1;
 	bool defaultAbortWebsocketsOnProcessShutdown;
 	bool defaultLoadShellEnvvars;
 	bool defaultPreloadBundler;
+	bool defaultPredictiveSpawning;
 
 	/*******************/
 	/*******************/
@@ -475,16 +534,28 @@ public:
 		  defaultAppFileDescriptorUlimit(config["default_app_file_descriptor_ulimit"].asUInt()),
 		  defaultMinInstances(config["default_min_instances"].asUInt()),
 		  defaultMaxPreloaderIdleTime(config["default_max_preloader_idle_time"].asUInt()),
+		  defaultSpawnConcurrency(config["default_spawn_concurrency"].asUInt()),
+		  defaultScaleDownDelay(config["default_scale_down_delay"].asUInt()),
 		  defaultMaxRequestQueueSize(config["default_max_request_queue_size"].asUInt()),
 		  defaultMaxRequests(config["default_max_requests"].asUInt()),
+		  defaultMemoryLimit(config["default_memory_limit"].asUInt()),
 		  defaultForceMaxConcurrentRequestsPerProcess(config["default_force_max_concurrent_requests_per_process"].asInt()),
 		  showVersionInHeader(config["show_version_in_header"].asBool()),
 		  defaultAbortWebsocketsOnProcessShutdown(config["default_abort_websockets_on_process_shutdown"].asBool()),
 		  defaultLoadShellEnvvars(config["default_load_shell_envvars"].asBool()),
-		  defaultPreloadBundler(config["default_preload_bundler"].asBool())
+		  defaultPreloadBundler(config["default_preload_bundler"].asBool()),
+		  defaultPredictiveSpawning(config["default_predictive_spawning"].asBool())
 
 		  /*******************/
-		{ }
+	{
+		string serverHeaders;
+		serverHeaders.append("SERVER_SOFTWARE", sizeof("SERVER_SOFTWARE"));
+		serverHeaders.append(serverSoftware.data(), serverSoftware.size());
+		serverHeaders.append(1, '\0');
+		serverHeaders.append("SERVER_PROTOCOL", sizeof("SERVER_PROTOCOL"));
+		serverHeaders.append("HTTP/1.1", sizeof("HTTP/1.1"));
+		sessionProtocolServerHeaders = psg_pstrdup(pool, serverHeaders);
+	}
 
 	~ControllerRequestConfig() {
 		psg_destroy_pool(pool);
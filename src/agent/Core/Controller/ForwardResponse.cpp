@@ -333,6 +333,60 @@ Controller::onAppResponseBegin(Client *client, Request *req) {
 
 	// Localize hash table operations for better CPU caching.
 	oobw = resp->secureHeaders.lookup(PASSENGER_REQUEST_OOB_WORK) != NULL;
+	prepareAppResponseHeaders(req);
+
+	if (req->session != NULL) {
+		// Feeds the least latency routing policy. 0 means "not measured",
+		// so report at least 1 microsecond.
+		ev_tstamp responseTime = ev_now(getLoop()) - req->appRequestSentAt;
+		req->session->reportResponseTime(std::max<unsigned long long>(1,
+			(unsigned long long) (responseTime * 1000000)));
+	}
+	if (OXT_UNLIKELY(oobw)) {
+		SKC_TRACE(client, 2, "Response with OOBW detected");
+		if (req->session != NULL) {
+			req->session->requestOOBW();
+		}
+	}
+
+	if (req->staleCacheEntry.valid() && resp->statusCode == 304) {
+		respondFromRevalidatedTurboCacheEntry(client, req);
+		return;
+	} else if (resp->statusCode >= 500 && respondFromStaleTurboCacheEntry(client, req,
+		"application responded with status " + toString(resp->statusCode)))
+	{
+		return;
+	}
+
+	prepareAppResponseCaching(client, req);
+
+	UPDATE_TRACE_POINT();
+	if (!sendResponseHeaderWithWritev(client, req, bytesWritten)) {
+		UPDATE_TRACE_POINT();
+		if (bytesWritten >= 0 || errno == EAGAIN || errno == EWOULDBLOCK) {
+			sendResponseHeaderWithBuffering(client, req, bytesWritten);
+		} else {
+			int e = errno;
+			P_ASSERT_EQ(bytesWritten, -1);
+			disconnectWithClientSocketWriteError(&client, e);
+		}
+	}
+
+	if (!req->ended() && !resp->hasBody() && !resp->upgraded()) {
+		UPDATE_TRACE_POINT();
+		handleAppResponseBodyEnd(client, req);
+		endRequest(&client, &req);
+	}
+}
+
+/**
+ * Removes the application response headers that we generate ourselves,
+ * and extracts the ones that need special treatment.
+ */
+void
+Controller::prepareAppResponseHeaders(Request *req) {
+	AppResponse *resp = &req->appResponse;
+
 	resp->date = resp->headers.lookup(HTTP_DATE);
 	resp->setCookie = resp->headers.lookup(ServerKit::HTTP_SET_COOKIE);
 	if (resp->setCookie != NULL) {
@@ -371,33 +425,6 @@ Controller::onAppResponseBegin(Client *client, Request *req) {
 		// or Transfer-Encoding. So we should disable keep-alive.
 		req->wantKeepAlive = false;
 	}
-
-	prepareAppResponseCaching(client, req);
-
-	if (OXT_UNLIKELY(oobw)) {
-		SKC_TRACE(client, 2, "Response with OOBW detected");
-		if (req->session != NULL) {
-			req->session->requestOOBW();
-		}
-	}
-
-	UPDATE_TRACE_POINT();
-	if (!sendResponseHeaderWithWritev(client, req, bytesWritten)) {
-		UPDATE_TRACE_POINT();
-		if (bytesWritten >= 0 || errno == EAGAIN || errno == EWOULDBLOCK) {
-			sendResponseHeaderWithBuffering(client, req, bytesWritten);
-		} else {
-			int e = errno;
-			P_ASSERT_EQ(bytesWritten, -1);
-			disconnectWithClientSocketWriteError(&client, e);
-		}
-	}
-
-	if (!req->ended() && !resp->hasBody() && !resp->upgraded()) {
-		UPDATE_TRACE_POINT();
-		handleAppResponseBodyEnd(client, req);
-		endRequest(&client, &req);
-	}
 }
 
 void
@@ -410,10 +437,10 @@ Controller::prepareAppResponseCaching(Client *client, Request *req) {
 		 && turboCaching.responseCache.prepareRequestForStoring(req))
 		{
 			if (resp->bodyType == AppResponse::RBT_CONTENT_LENGTH
-			 && resp->aux.bodyInfo.contentLength > ResponseCache<Request>::MAX_BODY_SIZE)
+			 && resp->aux.bodyInfo.contentLength > turboCaching.responseCache.getMaxBodySize())
 			{
 				SKC_DEBUG(client, "Response body larger than " <<
-					ResponseCache<Request>::MAX_BODY_SIZE <<
+					turboCaching.responseCache.getMaxBodySize() <<
 					" bytes, so response is not eligible for turbocaching");
 				// Decrease store success ratio.
 				turboCaching.responseCache.incStores();
@@ -431,6 +458,11 @@ Controller::prepareAppResponseCaching(Client *client, Request *req) {
 			req->cacheKey = HashedStaticString();
 		}
 	}
+	if (req->cacheKey.empty()) {
+		// The response won't be stored, so requests that wait
+		// for it might as well be forwarded to the app now.
+		releaseCoalescedRequests(req);
+	}
 }
 
 void
@@ -985,9 +1017,9 @@ Controller::markResponsePartForTurboCaching(Client *client, Request *req,
 {
 	if (!req->ended() && turboCaching.isEnabled() && !req->cacheKey.empty()) {
 		unsigned int totalSize = req->appResponse.bodyCacheBuffer.size + buffer.size();
-		if (totalSize > ResponseCache<Request>::MAX_BODY_SIZE) {
+		if (totalSize > turboCaching.responseCache.getMaxBodySize()) {
 			SKC_DEBUG(client, "Response body larger than " <<
-				ResponseCache<Request>::MAX_HEADER_SIZE <<
+				turboCaching.responseCache.getMaxBodySize() <<
 				" bytes, so response is not eligible for turbocaching");
 			// Decrease store success ratio.
 			turboCaching.responseCache.incStores();
@@ -1097,41 +1129,85 @@ Controller::keepAliveAppConnection(Client *client, Request *req) {
 	}
 }
 
+/**
+ * Called when the app responded with 304 Not Modified to a conditional request
+ * that we made in order to revalidate a stale turbocache entry. The client did
+ * not ask for a conditional response, so we send it the cached response.
+ */
+void
+Controller::respondFromRevalidatedTurboCacheEntry(Client *client, Request *req) {
+	TRACE_POINT();
+	SKC_DEBUG(client, "Turbocache entry revalidated by application");
+	// The request holds a copy of the entry, so we can serve it even if
+	// turbocaching was disabled or the entry was evicted in the meantime.
+	if (turboCaching.isEnabled()) {
+		turboCaching.responseCache.revalidated(req, ev_now(getLoop()));
+		SKC_TRACE(client, 2, "Turbocache entries:\n" << turboCaching.responseCache.inspect());
+	}
+	releaseCoalescedRequests(req);
+	req->cacheKey = HashedStaticString();
+
+	// A 304 response has no body, so we're done with the application.
+	handleAppResponseBodyEnd(client, req);
+	turboCaching.writeResponse(this, client, req, req->staleCacheEntry);
+	if (!req->ended()) {
+		endRequest(&client, &req);
+	}
+}
+
+/**
+ * Called when the application failed to produce a response, or responded
+ * with a server error. If the request holds a stale turbocache entry that may
+ * still be served according to its stale-if-error window, then we send that
+ * entry instead and return true. Otherwise we return false and the caller
+ * should proceed with reporting the error. `reason` describes the failure
+ * and is only used for logging.
+ */
+bool
+Controller::respondFromStaleTurboCacheEntry(Client *client, Request *req,
+	const StaticString &reason)
+{
+	if (!req->staleCacheEntry.valid()
+	 || req->responseBegun
+	 || !turboCaching.responseCache.canServeStaleIfError(req->staleCacheEntry,
+		ev_now(getLoop())))
+	{
+		return false;
+	}
+
+	TRACE_POINT();
+	SKC_WARN(client, "Serving stale turbocache entry because the " << reason);
+	turboCaching.responseCache.incStaleHits();
+	if (req->session != NULL && !req->session->isClosed()) {
+		req->session->close(false, false);
+	}
+	releaseCoalescedRequests(req);
+	req->cacheKey = HashedStaticString();
+
+	turboCaching.writeResponse(this, client, req, req->staleCacheEntry);
+	if (!req->ended()) {
+		endRequest(&client, &req);
+	}
+	return true;
+}
+
 void
 Controller::storeAppResponseInTurboCache(Client *client, Request *req) {
 	if (turboCaching.isEnabled() && !req->cacheKey.empty()) {
 		TRACE_POINT();
 		AppResponse *resp = &req->appResponse;
-		unsigned int headerSize = 0;
-		unsigned int i;
 
-		for (i = 0; i < resp->nHeaderCacheBuffers; i++) {
-			headerSize += resp->headerCacheBuffers[i].iov_len;
-		}
-		ResponseCache<Request>::Entry entry(
-			turboCaching.responseCache.store(req, ev_now(getLoop()),
-				headerSize, resp->bodyCacheBuffer.size));
-		if (entry.valid()) {
-			UPDATE_TRACE_POINT();
-			SKC_DEBUG(client, "Storing app response in turbocache");
+		if (turboCaching.responseCache.store(req, ev_now(getLoop()),
+			resp->headerCacheBuffers, resp->nHeaderCacheBuffers,
+			&resp->bodyCacheBuffer))
+		{
+			SKC_DEBUG(client, "Stored app response in turbocache");
 			SKC_TRACE(client, 2, "Turbocache entries:\n" << turboCaching.responseCache.inspect());
-
-			gatherBuffers(entry.body->httpHeaderData,
-				ResponseCache<Request>::MAX_HEADER_SIZE,
-				resp->headerCacheBuffers, resp->nHeaderCacheBuffers);
-
-			char *pos = entry.body->httpBodyData;
-			const char *end = entry.body->httpBodyData
-				+ ResponseCache<Request>::MAX_BODY_SIZE;
-			const LString::Part *part = resp->bodyCacheBuffer.start;
-			while (part != NULL) {
-				pos = appendData(pos, end, part->data, part->size);
-				part = part->next;
-			}
 		} else {
 			SKC_DEBUG(client, "Could not store app response for turbocaching");
 		}
 	}
+	releaseCoalescedRequests(req);
 }
 
 
@@ -107,6 +107,15 @@ Controller::onRequestObjectCreated(Client *client, Request *req) {
 	req->bodyBuffer.setContext(getContext());
 	req->bodyBuffer.setHooks(&req->hooks);
 	req->bodyBuffer.setDataCallback(onBodyBufferData);
+
+	#ifdef __linux__
+		req->splicePipe[0] = -1;
+		req->splicePipe[1] = -1;
+		ev_io_init(&req->spliceClientWatcher, onSpliceClientReadable, -1, EV_READ);
+		req->spliceClientWatcher.data = req;
+		ev_io_init(&req->spliceAppWatcher, onSpliceAppWritable, -1, EV_WRITE);
+		req->spliceAppWatcher.data = req;
+	#endif
 }
 
 void
@@ -124,6 +133,7 @@ Controller::reinitializeRequest(Client *client, Request *req) {
 	// appSink and appSource are initialized in Controller::checkoutSession().
 
 	req->startedAt = 0;
+	req->appRequestSentAt = 0;
 	req->state = Request::ANALYZING_REQUEST;
 	req->dechunkResponse = false;
 	req->requestBodyBuffering = false;
@@ -140,8 +150,15 @@ Controller::reinitializeRequest(Client *client, Request *req) {
 	req->cacheKey = HashedStaticString();
 	req->cacheControl = NULL;
 	req->varyCookie = NULL;
+	req->staleCacheEntry = ResponseCacheEntry();
+	req->coalescedRequests = NULL;
 	req->envvars = NULL;
 
+	#ifdef __linux__
+		req->splicePipeSize = 0;
+		req->bodySpliceAttempted = false;
+	#endif
+
 	#ifdef DEBUG_CC_EVENT_LOOP_BLOCKING
 		req->timedAppPoolGet = false;
 		req->timeBeforeAccessingApplicationPool = 0;
@@ -154,6 +171,11 @@ Controller::reinitializeRequest(Client *client, Request *req) {
 
 void
 Controller::deinitializeRequest(Client *client, Request *req) {
+	releaseCoalescedRequests(req);
+	turboCaching.responseCache.releaseStaleEntry(req);
+	#ifdef __linux__
+		stopSplicingBody(req);
+	#endif
 	req->session.reset();
 	req->config.reset();
 
@@ -289,6 +311,33 @@ Controller::supportsUpgrade(Client *client, Request *req) {
 	return true;
 }
 
+Controller *
+Controller::getClientMigrationTarget(Client *client) {
+	unsigned int threshold = mainConfig.clientMigrationThreshold;
+	if (threshold == 0 || clientMigrationPeers.empty()) {
+		return NULL;
+	}
+
+	Controller *target = NULL;
+	unsigned int targetLoad = 0;
+	vector<Controller *>::const_iterator it, end = clientMigrationPeers.end();
+	for (it = clientMigrationPeers.begin(); it != end; it++) {
+		unsigned int load = (*it)->getLoad();
+		if (target == NULL || load < targetLoad) {
+			target = *it;
+			targetLoad = load;
+		}
+	}
+
+	// Requiring a difference of more than the threshold (which is at least 1)
+	// ensures that the target won't immediately want to migrate the client back.
+	if (getLoad() > targetLoad + threshold) {
+		return target;
+	} else {
+		return NULL;
+	}
+}
+
 
 /****************************
  *
@@ -305,7 +354,12 @@ Controller::getClientName(const Client *client, char *buf, size_t size) const {
 	// ApiServer::extractThreadNumberFromClientName() too.
 	pos += uintToString(mainConfig.threadNumber, pos, end - pos);
 	pos = appendData(pos, end, "-", 1);
-	pos += uintToString(client->number, pos, end - pos);
+	if (client != NULL) {
+		pos += uintToString(client->number, pos, end - pos);
+	} else {
+		// Internal requests, such as turbocache refreshes, have no client.
+		pos = appendData(pos, end, "internal");
+	}
 	*pos = '\0';
 	return pos - buf;
 }
@@ -27,9 +27,12 @@
 #include <Core/Controller.h>
 #include <Core/Controller/InitRequest.cpp>
 #include <Core/Controller/BufferBody.cpp>
+#include <Core/Controller/CoalesceRequests.cpp>
 #include <Core/Controller/CheckoutSession.cpp>
 #include <Core/Controller/SendRequest.cpp>
+#include <Core/Controller/SpliceBody.cpp>
 #include <Core/Controller/ForwardResponse.cpp>
+#include <Core/Controller/RefreshTurboCache.cpp>
 #include <Core/Controller/Hooks.cpp>
 #include <Core/Controller/InitializationAndShutdown.cpp>
 #include <Core/Controller/InternalUtils.cpp>
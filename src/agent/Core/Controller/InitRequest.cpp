@@ -115,7 +115,21 @@ Controller::respondFromTurboCache(Client *client, Request *req) {
 		if (entry.valid()) {
 			SKC_TRACE(client, 2, "Turbocaching: cache hit (key \"" <<
 				cEscapeString(req->cacheKey) << "\")");
-			turboCaching.writeResponse(this, client, req, entry);
+			if (entry.needsRefresh) {
+				SKC_TRACE(client, 2, "Turbocaching: entry is stale, serving it while"
+					" refreshing it in the background");
+				refreshTurboCacheEntry(client, req);
+			}
+			// If this request revalidates a stale entry then its conditional
+			// headers were added by us, not by the client.
+			if (!req->staleCacheEntry.valid()
+			 && turboCaching.responseCache.requestIsNotModified(req, entry))
+			{
+				SKC_TRACE(client, 2, "Turbocaching: responding with 304 Not Modified");
+				turboCaching.writeNotModifiedResponse(this, client, req, entry);
+			} else {
+				turboCaching.writeResponse(this, client, req, entry);
+			}
 			if (!req->ended()) {
 				endRequest(&client, &req);
 			}
@@ -124,6 +138,9 @@ Controller::respondFromTurboCache(Client *client, Request *req) {
 			SKC_TRACE(client, 2, "Turbocaching: cache miss: " <<
 				entry.getCacheMissReasonString() <<
 				" (key \"" << cEscapeString(req->cacheKey) << "\")");
+			if (req->staleCacheEntry.valid()) {
+				SKC_TRACE(client, 2, "Turbocaching: revalidating stale entry with the application");
+			}
 			return false;
 		}
 	} else {
@@ -163,19 +180,24 @@ Controller::initializePoolOptions(Client *client, Request *req, RequestAnalysis
 	}
 
 	if (!req->ended()) {
-		// See comment for req->envvars to learn how it is different
-		// from req->options.environmentVariables.
-		req->envvars = req->secureHeaders.lookup(PASSENGER_ENV_VARS);
-		if (req->envvars != NULL && req->envvars->size > 0) {
-			req->envvars = psg_lstr_make_contiguous(req->envvars, req->pool);
-			req->options.environmentVariables = StaticString(
-				req->envvars->start->data,
-				req->envvars->size);
-		}
+		fillPerRequestPoolOptions(req);
+	}
+}
 
-		// Allow certain options to be overridden on a per-request basis
-		fillPoolOption(req, req->options.maxRequests, PASSENGER_MAX_REQUESTS);
+void
+Controller::fillPerRequestPoolOptions(Request *req) {
+	// See comment for req->envvars to learn how it is different
+	// from req->options.environmentVariables.
+	req->envvars = req->secureHeaders.lookup(PASSENGER_ENV_VARS);
+	if (req->envvars != NULL && req->envvars->size > 0) {
+		req->envvars = psg_lstr_make_contiguous(req->envvars, req->pool);
+		req->options.environmentVariables = StaticString(
+			req->envvars->start->data,
+			req->envvars->size);
 	}
+
+	// Allow certain options to be overridden on a per-request basis
+	fillPoolOption(req, req->options.maxRequests, PASSENGER_MAX_REQUESTS);
 }
 
 void
@@ -195,6 +217,9 @@ Controller::fillPoolOptionsFromConfigCaches(Options &options,
 	options.defaultGroup = requestConfig->defaultGroup;
 	options.minProcesses = requestConfig->defaultMinInstances;
 	options.maxPreloaderIdleTime = requestConfig->defaultMaxPreloaderIdleTime;
+	options.spawnConcurrency = requestConfig->defaultSpawnConcurrency;
+	options.predictiveSpawning = requestConfig->defaultPredictiveSpawning;
+	options.scaleDownDelay = requestConfig->defaultScaleDownDelay;
 	options.maxRequestQueueSize = requestConfig->defaultMaxRequestQueueSize;
 	options.abortWebsocketsOnProcessShutdown = requestConfig->defaultAbortWebsocketsOnProcessShutdown;
 	options.forceMaxConcurrentRequestsPerProcess = requestConfig->defaultForceMaxConcurrentRequestsPerProcess;
@@ -204,7 +229,9 @@ Controller::fillPoolOptionsFromConfigCaches(Options &options,
 	options.loadShellEnvvars = requestConfig->defaultLoadShellEnvvars;
 	options.preloadBundler = requestConfig->defaultPreloadBundler;
 	options.statThrottleRate = mainConfig.statThrottleRate;
+	options.routingPolicy = mainConfig.routingPolicy;
 	options.maxRequests = requestConfig->defaultMaxRequests;
+	options.memoryLimit = requestConfig->defaultMemoryLimit;
 	options.stickySessionsCookieAttributes = requestConfig->defaultStickySessionsCookieAttributes;
 
 	/******************************/
@@ -297,11 +324,11 @@ Controller::createNewPoolOptions(Client *client, Request *req,
 
 	options = Options();
 
-	const LString *scriptName = secureHeaders.lookup("!~SCRIPT_NAME");
-	const LString *appRoot = secureHeaders.lookup("!~PASSENGER_APP_ROOT");
+	const LString *scriptName = secureHeaders.lookup(P_HASHED_STATIC_STRING("!~SCRIPT_NAME"));
+	const LString *appRoot = secureHeaders.lookup(P_HASHED_STATIC_STRING("!~PASSENGER_APP_ROOT"));
 	if (scriptName == NULL || scriptName->size == 0) {
 		if (appRoot == NULL || appRoot->size == 0) {
-			const LString *documentRoot = secureHeaders.lookup("!~DOCUMENT_ROOT");
+			const LString *documentRoot = secureHeaders.lookup(P_HASHED_STATIC_STRING("!~DOCUMENT_ROOT"));
 			if (OXT_UNLIKELY(documentRoot == NULL || documentRoot->size == 0)) {
 				disconnectWithError(&client, "client did not send a !~PASSENGER_APP_ROOT or a !~DOCUMENT_ROOT header");
 				return;
@@ -317,7 +344,7 @@ Controller::createNewPoolOptions(Client *client, Request *req,
 		options.appRoot = HashedStaticString(appRoot->start->data, appRoot->size);
 	} else {
 		if (appRoot == NULL || appRoot->size == 0) {
-			const LString *documentRoot = secureHeaders.lookup("!~DOCUMENT_ROOT");
+			const LString *documentRoot = secureHeaders.lookup(P_HASHED_STATIC_STRING("!~DOCUMENT_ROOT"));
 			if (OXT_UNLIKELY(documentRoot == NULL || documentRoot->size == 0)) {
 				disconnectWithError(&client, "client did not send a !~DOCUMENT_ROOT header");
 				return;
@@ -339,9 +366,9 @@ Controller::createNewPoolOptions(Client *client, Request *req,
 
 	fillPoolOptionsFromConfigCaches(options, req->pool, req->config);
 
-	const LString *appType = secureHeaders.lookup("!~PASSENGER_APP_TYPE");
+	const LString *appType = secureHeaders.lookup(P_HASHED_STATIC_STRING("!~PASSENGER_APP_TYPE"));
 	if (appType == NULL || appType->size == 0) {
-		const LString *appStartCommand = secureHeaders.lookup("!~PASSENGER_APP_START_COMMAND");
+		const LString *appStartCommand = secureHeaders.lookup(P_HASHED_STATIC_STRING("!~PASSENGER_APP_START_COMMAND"));
 		if (appStartCommand == NULL || appStartCommand->size == 0) {
 			AppTypeDetector::Detector detector(*wrapperRegistry);
 			AppTypeDetector::Detector::Result result = detector.checkAppRoot(options.appRoot);
@@ -373,6 +400,10 @@ Controller::createNewPoolOptions(Client *client, Request *req,
 	fillPoolOption(req, options.appStartCommand, "!~PASSENGER_APP_START_COMMAND");
 	fillPoolOptionSecToMsec(req, options.startTimeout, "!~PASSENGER_START_TIMEOUT");
 	fillPoolOption(req, options.maxPreloaderIdleTime, "!~PASSENGER_MAX_PRELOADER_IDLE_TIME");
+	fillPoolOption(req, options.spawnConcurrency, "!~PASSENGER_SPAWN_CONCURRENCY");
+	fillPoolOption(req, options.predictiveSpawning, "!~PASSENGER_PREDICTIVE_SPAWNING");
+	fillPoolOption(req, options.scaleDownDelay, "!~PASSENGER_SCALE_DOWN_DELAY");
+	fillPoolOption(req, options.memoryLimit, "!~PASSENGER_MEMORY_LIMIT");
 	fillPoolOption(req, options.maxRequestQueueSize, "!~PASSENGER_MAX_REQUEST_QUEUE_SIZE");
 	fillPoolOption(req, options.abortWebsocketsOnProcessShutdown, "!~PASSENGER_ABORT_WEBSOCKETS_ON_PROCESS_SHUTDOWN");
 	fillPoolOption(req, options.forceMaxConcurrentRequestsPerProcess, "!~PASSENGER_FORCE_MAX_CONCURRENT_REQUESTS_PER_PROCESS");
@@ -482,7 +513,9 @@ Controller::onRequestBegin(Client *client, Request *req) {
 
 	if (!req->hasBody() || !req->requestBodyBuffering) {
 		req->requestBodyBuffering = false;
-		checkoutSession(client, req);
+		if (!coalesceRequest(client, req)) {
+			checkoutSession(client, req);
+		}
 	} else {
 		beginBufferingBody(client, req);
 	}
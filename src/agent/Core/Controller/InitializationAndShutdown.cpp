@@ -45,7 +45,17 @@ using namespace boost;
  ****************************/
 
 Controller::~Controller() {
+	StringMap<CoalescedRequests *>::iterator it, end = coalescedRequests.end();
+	StringMap<TurboCacheRefresh *>::iterator r_it, r_end = turboCacheRefreshes.end();
+
 	ev_check_stop(getLoop(), &checkWatcher);
+	for (it = coalescedRequests.begin(); it != end; it++) {
+		ev_timer_stop(getLoop(), &it->second->timer);
+		delete it->second;
+	}
+	for (r_it = turboCacheRefreshes.begin(); r_it != r_end; r_it++) {
+		destroyTurboCacheRefresh(r_it->second);
+	}
 	delete singleAppModeConfig;
 }
 
@@ -64,27 +74,27 @@ Controller::preinitialize() {
 		timeBeforeBlocking = 0;
 	#endif
 
-	PASSENGER_APP_GROUP_NAME = "!~PASSENGER_APP_GROUP_NAME";
-	PASSENGER_ENV_VARS = "!~PASSENGER_ENV_VARS";
-	PASSENGER_MAX_REQUESTS = "!~PASSENGER_MAX_REQUESTS";
-	PASSENGER_SHOW_VERSION_IN_HEADER = "!~PASSENGER_SHOW_VERSION_IN_HEADER";
-	PASSENGER_STICKY_SESSIONS = "!~PASSENGER_STICKY_SESSIONS";
-	PASSENGER_STICKY_SESSIONS_COOKIE_NAME = "!~PASSENGER_STICKY_SESSIONS_COOKIE_NAME";
-	PASSENGER_STICKY_SESSIONS_COOKIE_ATTRIBUTES = "!~PASSENGER_STICKY_SESSIONS_COOKIE_ATTRIBUTES";
-	PASSENGER_REQUEST_OOB_WORK = "!~Request-OOB-Work";
-	REMOTE_ADDR = "!~REMOTE_ADDR";
-	REMOTE_PORT = "!~REMOTE_PORT";
-	REMOTE_USER = "!~REMOTE_USER";
-	FLAGS = "!~FLAGS";
-	HTTP_COOKIE = "cookie";
-	HTTP_DATE = "date";
-	HTTP_HOST = "host";
-	HTTP_CONTENT_LENGTH = "content-length";
-	HTTP_CONTENT_TYPE = "content-type";
-	HTTP_EXPECT = "expect";
-	HTTP_CONNECTION = "connection";
-	HTTP_STATUS = "status";
-	HTTP_TRANSFER_ENCODING = "transfer-encoding";
+	PASSENGER_APP_GROUP_NAME = P_HASHED_STATIC_STRING("!~PASSENGER_APP_GROUP_NAME");
+	PASSENGER_ENV_VARS = P_HASHED_STATIC_STRING("!~PASSENGER_ENV_VARS");
+	PASSENGER_MAX_REQUESTS = P_HASHED_STATIC_STRING("!~PASSENGER_MAX_REQUESTS");
+	PASSENGER_SHOW_VERSION_IN_HEADER = P_HASHED_STATIC_STRING("!~PASSENGER_SHOW_VERSION_IN_HEADER");
+	PASSENGER_STICKY_SESSIONS = P_HASHED_STATIC_STRING("!~PASSENGER_STICKY_SESSIONS");
+	PASSENGER_STICKY_SESSIONS_COOKIE_NAME = P_HASHED_STATIC_STRING("!~PASSENGER_STICKY_SESSIONS_COOKIE_NAME");
+	PASSENGER_STICKY_SESSIONS_COOKIE_ATTRIBUTES = P_HASHED_STATIC_STRING("!~PASSENGER_STICKY_SESSIONS_COOKIE_ATTRIBUTES");
+	PASSENGER_REQUEST_OOB_WORK = P_HASHED_STATIC_STRING("!~Request-OOB-Work");
+	REMOTE_ADDR = P_HASHED_STATIC_STRING("!~REMOTE_ADDR");
+	REMOTE_PORT = P_HASHED_STATIC_STRING("!~REMOTE_PORT");
+	REMOTE_USER = P_HASHED_STATIC_STRING("!~REMOTE_USER");
+	FLAGS = P_HASHED_STATIC_STRING("!~FLAGS");
+	HTTP_COOKIE = P_HASHED_STATIC_STRING("cookie");
+	HTTP_DATE = P_HASHED_STATIC_STRING("date");
+	HTTP_HOST = P_HASHED_STATIC_STRING("host");
+	HTTP_CONTENT_LENGTH = P_HASHED_STATIC_STRING("content-length");
+	HTTP_CONTENT_TYPE = P_HASHED_STATIC_STRING("content-type");
+	HTTP_EXPECT = P_HASHED_STATIC_STRING("expect");
+	HTTP_CONNECTION = P_HASHED_STATIC_STRING("connection");
+	HTTP_STATUS = P_HASHED_STATIC_STRING("status");
+	HTTP_TRANSFER_ENCODING = P_HASHED_STATIC_STRING("transfer-encoding");
 
 	/**************************/
 }
@@ -103,7 +113,12 @@ Controller::initialize() {
 	}
 
 	ParentClass::initialize();
-	turboCaching.initialize(config["turbocaching"].asBool());
+	turboCaching.initialize(config["turbocaching"].asBool(),
+		config["turbocache_max_entries"].asUInt(),
+		config["turbocache_max_memory"].asUInt(),
+		config["turbocache_max_body_size"].asUInt(),
+		&getContext()->mbuf_pool,
+		sharedResponseCache);
 
 	if (mainConfig.singleAppMode) {
 		boost::shared_ptr<Options> options = boost::make_shared<Options>();
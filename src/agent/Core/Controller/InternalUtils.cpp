@@ -85,7 +85,11 @@ Controller::disconnectWithAppSocketWriteError(Client **client, int e) {
 
 void
 Controller::endRequestWithAppSocketIncompleteResponse(Client **client, Request **req) {
-	if (!(*req)->responseBegun) {
+	if (respondFromStaleTurboCacheEntry(*client, *req,
+		P_STATIC_STRING("application did not send a complete response")))
+	{
+		return;
+	} else if (!(*req)->responseBegun) {
 		// The application might have decided to abort the response because it thinks the client
 		// is already gone (Passenger relays socket half-close events from clients), so don't
 		// make a big warning out of that situation.
@@ -105,7 +109,11 @@ Controller::endRequestWithAppSocketIncompleteResponse(Client **client, Request *
 void
 Controller::endRequestWithAppSocketReadError(Client **client, Request **req, int e) {
 	Client *c = *client;
-	if (!(*req)->responseBegun) {
+	if (respondFromStaleTurboCacheEntry(*client, *req,
+		P_STATIC_STRING("application socket could not be read from")))
+	{
+		return;
+	} else if (!(*req)->responseBegun) {
 		SKC_WARN(*client, "Sending 502 response: application socket read error");
 		endRequestWithSimpleResponse(client, req,
 			getFormattedMessage(*req, "Application socket read error"), 502);
@@ -157,7 +165,11 @@ Controller::endRequestWithSimpleResponse(Client **c, Request **r,
 
 void
 Controller::endRequestAsBadGateway(Client **client, Request **req) {
-	if ((*req)->responseBegun) {
+	if (respondFromStaleTurboCacheEntry(*client, *req,
+		P_STATIC_STRING("application sent an invalid response")))
+	{
+		return;
+	} else if ((*req)->responseBegun) {
 		disconnectWithError(client, "bad gateway");
 	} else {
 		ServerKit::HeaderTable headers = getHeadersWithContentType(*req);
@@ -0,0 +1,578 @@
+/*
+ *  Phusion Passenger - https://www.phusionpassenger.com/
+ *  Copyright (c) 2014-2018 Phusion Holding B.V.
+ *
+ *  "Passenger", "Phusion Passenger" and "Union Station" are registered
+ *  trademarks of Phusion Holding B.V.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#include <Core/Controller.h>
+
+/*************************************************************************
+ *
+ * Implements Core::Controller methods pertaining refreshing stale
+ * turbocache entries in the background (stale-while-revalidate).
+ *
+ *************************************************************************/
+
+namespace Passenger {
+namespace Core {
+
+using namespace std;
+using namespace boost;
+
+
+/**
+ * A refresh is an internal request without a client: a copy of the request
+ * that hit the stale entry is sent to the application through a session
+ * checked out from the pool, and the application's response is stored in
+ * the turbocache instead of being forwarded anywhere.
+ *
+ * The refresh is reference counted. One reference is owned by
+ * `turboCacheRefreshes` until the refresh is finished, one by the pending
+ * session checkout, and one by every appSource or appSink callback in
+ * progress (through `hooks`).
+ */
+struct Controller::TurboCacheRefresh: public ServerKit::HooksImpl {
+	Controller *controller;
+	Request *req;
+	string key;
+	ServerKit::Hooks hooks;
+	unsigned int refcount;
+	bool finished;
+
+	virtual bool hook_isConnected(ServerKit::Hooks *hooks, void *source) {
+		return !finished;
+	}
+
+	virtual void hook_ref(ServerKit::Hooks *hooks, void *source, const char *file,
+		unsigned int line)
+	{
+		refcount++;
+	}
+
+	virtual void hook_unref(ServerKit::Hooks *hooks, void *source, const char *file,
+		unsigned int line)
+	{
+		controller->unrefTurboCacheRefresh(this);
+	}
+};
+
+
+/****************************
+ *
+ * Private methods
+ *
+ ****************************/
+
+
+static void
+copyLStringForTurboCacheRefresh(LString *to, const LString *from, psg_pool_t *pool) {
+	psg_lstr_init(to);
+	if (from->size > 0) {
+		*to = *psg_lstr_null_terminate(from, pool);
+	}
+}
+
+static bool
+shouldCopyHeaderForTurboCacheRefresh(const ServerKit::Header *header) {
+	const LString *key = &header->key;
+	// The secure header end marker ("!~") ends up in the normal headers.
+	return !psg_lstr_cmp(key, P_STATIC_STRING("connection"))
+		&& !psg_lstr_cmp(key, P_STATIC_STRING("!~"))
+		&& !psg_lstr_cmp(key, P_STATIC_STRING("keep-alive"))
+		&& !psg_lstr_cmp(key, P_STATIC_STRING("if-none-match"))
+		&& !psg_lstr_cmp(key, P_STATIC_STRING("if-modified-since"));
+}
+
+/**
+ * Copies headers into `pool`, keeping their original case and hash.
+ */
+static void
+copyHeadersForTurboCacheRefresh(ServerKit::HeaderTable &to, ServerKit::HeaderTable &from,
+	psg_pool_t *pool)
+{
+	ServerKit::HeaderTable::Iterator it(from);
+	while (*it != NULL) {
+		if (shouldCopyHeaderForTurboCacheRefresh(it->header)) {
+			ServerKit::Header *header = (ServerKit::Header *) psg_palloc(pool,
+				sizeof(ServerKit::Header));
+			copyLStringForTurboCacheRefresh(&header->key, &it->header->key, pool);
+			copyLStringForTurboCacheRefresh(&header->origKey, &it->header->origKey, pool);
+			copyLStringForTurboCacheRefresh(&header->val, &it->header->val, pool);
+			header->hash = it->header->hash;
+			to.insert(&header, pool);
+		}
+		it.next();
+	}
+}
+
+void
+Controller::refreshTurboCacheEntry(Client *client, Request *req) {
+	if (coalescedRequests.has(req->cacheKey) || turboCacheRefreshes.has(req->cacheKey)) {
+		SKC_TRACE(client, 2, "Turbocaching: entry is already being refreshed");
+		return;
+	}
+	if (serverState != ACTIVE) {
+		return;
+	}
+
+	TurboCacheRefresh *refresh = new TurboCacheRefresh();
+	refresh->controller = this;
+	refresh->req = createTurboCacheRefreshRequest(req);
+	refresh->key = req->cacheKey;
+	refresh->hooks.impl = refresh;
+	refresh->hooks.userData = refresh;
+	refresh->refcount = 1;
+	refresh->finished = false;
+
+	if (!initializeTurboCacheRefreshPoolOptions(refresh->req)) {
+		// The pool options are only known once a request for this
+		// application has been forwarded to it.
+		SKC_DEBUG(client, "Cannot refresh turbocache entry: application pool options unknown");
+		destroyTurboCacheRefresh(refresh);
+		return;
+	}
+
+	Request *refreshReq = refresh->req;
+	refreshReq->appSink.setHooks(&refresh->hooks);
+	refreshReq->appSource.setHooks(&refresh->hooks);
+	refreshReq->appSource.setDataCallback(onTurboCacheRefreshAppSourceData);
+	turboCacheRefreshes.set(refresh->key, refresh);
+	SKC_DEBUG(client, "Refreshing turbocache entry in the background");
+
+	GetCallback callback;
+	callback.func = turboCacheRefreshSessionCheckedOut;
+	callback.userData = refresh;
+	refreshReq->options.currentTime = SystemTime::getUsec();
+	refresh->refcount++;
+	asyncGetFromApplicationPool(refreshReq, callback);
+}
+
+/**
+ * Creates an unconditional GET request with the same headers as `req`.
+ * The request has no client and is allocated from its own pool.
+ */
+Request *
+Controller::createTurboCacheRefreshRequest(Request *req) {
+	Request *refreshReq = new Request();
+	onRequestObjectCreated(NULL, refreshReq);
+	reinitializeRequest(NULL, refreshReq);
+
+	psg_pool_t *pool = refreshReq->pool;
+	getHeaderParserStatePool().destroy(refreshReq->parserState.headerParser);
+	refreshReq->parserState.headerParser = NULL;
+	refreshReq->httpState = Request::COMPLETE;
+	refreshReq->httpMajor = 1;
+	refreshReq->httpMinor = 1;
+	refreshReq->state = Request::CHECKING_OUT_SESSION;
+
+	copyLStringForTurboCacheRefresh(&refreshReq->path, &req->path, pool);
+	refreshReq->queryStringIndex = req->queryStringIndex;
+	copyHeadersForTurboCacheRefresh(refreshReq->headers, req->headers, pool);
+	copyHeadersForTurboCacheRefresh(refreshReq->secureHeaders, req->secureHeaders, pool);
+	refreshReq->host = refreshReq->headers.lookup(HTTP_HOST);
+	refreshReq->https = req->https;
+	refreshReq->config = req->config;
+
+	char *key = (char *) psg_pnalloc(pool, req->cacheKey.size());
+	memcpy(key, req->cacheKey.data(), req->cacheKey.size());
+	refreshReq->cacheKey = HashedStaticString(key, req->cacheKey.size());
+	if (req->varyCookie != NULL) {
+		refreshReq->varyCookie = psg_lstr_null_terminate(req->varyCookie, pool);
+	}
+
+	return refreshReq;
+}
+
+/**
+ * Like initializePoolOptions(), but only uses cached pool options, because
+ * there is no client to report errors to.
+ */
+bool
+Controller::initializeTurboCacheRefreshPoolOptions(Request *req) {
+	boost::shared_ptr<Options> *options;
+
+	if (mainConfig.singleAppMode) {
+		P_ASSERT_EQ(poolOptionsCache.size(), 1);
+		poolOptionsCache.lookupRandom(NULL, &options);
+		req->options = **options;
+	} else {
+		const LString *appGroupName = req->secureHeaders.lookup(PASSENGER_APP_GROUP_NAME);
+		if (appGroupName == NULL || appGroupName->size == 0) {
+			return false;
+		}
+		appGroupName = psg_lstr_make_contiguous(appGroupName, req->pool);
+		if (!poolOptionsCache.lookup(HashedStaticString(appGroupName->start->data,
+			appGroupName->size), &options))
+		{
+			return false;
+		}
+		req->options = **options;
+		fillPoolOption(req, req->options.baseURI, "!~SCRIPT_NAME");
+	}
+
+	fillPerRequestPoolOptions(req);
+	return true;
+}
+
+void
+Controller::turboCacheRefreshSessionCheckedOut(const AbstractSessionPtr &session,
+	const ExceptionPtr &e, void *userData)
+{
+	TurboCacheRefresh *refresh = static_cast<TurboCacheRefresh *>(userData);
+	Controller *self = refresh->controller;
+
+	if (self->getContext()->libev->onEventLoopThread()) {
+		self->turboCacheRefreshSessionCheckedOutFromEventLoopThread(refresh, session, e);
+	} else {
+		self->getContext()->libev->runLater(
+			boost::bind(&Controller::turboCacheRefreshSessionCheckedOutFromEventLoopThread,
+				self, refresh, session, e));
+	}
+}
+
+void
+Controller::turboCacheRefreshSessionCheckedOutFromEventLoopThread(TurboCacheRefresh *refresh,
+	AbstractSessionPtr session, ExceptionPtr e)
+{
+	TRACE_POINT();
+	Request *req = refresh->req;
+
+	if (e != NULL) {
+		SKC_DEBUG(NULL, "Cannot refresh turbocache entry: " << e->what());
+		finishTurboCacheRefresh(refresh, false);
+	} else {
+		SKC_DEBUG(NULL, "Session checked out for turbocache refresh: pid=" <<
+			session->getPid() << ", gupid=" << session->getGupid());
+		req->session = session;
+		try {
+			req->session->initiate(false);
+			sendTurboCacheRefreshRequest(refresh);
+		} catch (const SystemException &e2) {
+			SKC_DEBUG(NULL, "Cannot refresh turbocache entry: could not initiate"
+				" a session (" << e2.what() << ")");
+			finishTurboCacheRefresh(refresh, false);
+		}
+	}
+	unrefTurboCacheRefresh(refresh);
+}
+
+void
+Controller::sendTurboCacheRefreshRequest(TurboCacheRefresh *refresh) {
+	Request *req = refresh->req;
+
+	req->appSink.reinitialize(req->session->fd());
+	req->appSource.reinitialize(req->session->fd());
+	reinitializeAppResponse(NULL, req);
+	req->state = Request::WAITING_FOR_APP_OUTPUT;
+	req->appRequestSentAt = ev_now(getLoop());
+
+	// The request has no body, so sending the header is all there is to it.
+	if (req->session->getProtocol() == "session") {
+		sendHeaderToAppWithSessionProtocol(NULL, req);
+	} else {
+		HttpHeaderConstructionCache cache;
+		cache.cached = false;
+		sendHeaderToAppWithHttpProtocolWithBuffering(req, 0, cache);
+	}
+	req->appSource.startReading();
+}
+
+ServerKit::Channel::Result
+Controller::onTurboCacheRefreshAppSourceData(Channel *_channel, const MemoryKit::mbuf &buffer,
+	int errcode)
+{
+	FdSourceChannel *channel = reinterpret_cast<FdSourceChannel *>(_channel);
+	TurboCacheRefresh *refresh = static_cast<TurboCacheRefresh *>(
+		channel->getHooks()->userData);
+	return refresh->controller->processTurboCacheRefreshResponse(refresh, buffer, errcode);
+}
+
+/**
+ * The turbocache-only counterpart of onAppSourceData(). A response that turns
+ * out not to be cacheable finishes the refresh successfully, without
+ * reading the rest of it.
+ */
+ServerKit::Channel::Result
+Controller::processTurboCacheRefreshResponse(TurboCacheRefresh *refresh,
+	const MemoryKit::mbuf &buffer, int errcode)
+{
+	TRACE_POINT();
+	Request *req = refresh->req;
+	AppResponse *resp = &req->appResponse;
+
+	if (buffer.empty()) {
+		if (errcode != 0 && errcode != ECONNRESET) {
+			SKC_DEBUG(NULL, "Turbocache refresh: application socket read error: " <<
+				ServerKit::getErrorDesc(errcode) << " (errno=" << errcode << ")");
+			finishTurboCacheRefresh(refresh, false);
+		} else if (resp->httpState == AppResponse::PARSING_BODY_UNTIL_EOF
+			|| (resp->httpState == AppResponse::PARSING_BODY_WITH_LENGTH
+				&& resp->bodyFullyRead()))
+		{
+			finishTurboCacheRefresh(refresh, true);
+		} else {
+			SKC_DEBUG(NULL, "Turbocache refresh: application sent EOF before"
+				" finishing the response");
+			finishTurboCacheRefresh(refresh, false);
+		}
+		return Channel::Result(0, true);
+	}
+
+	switch (resp->httpState) {
+	case AppResponse::PARSING_HEADERS: {
+		size_t ret = createAppResponseHeaderParser(getContext(), req).feed(buffer);
+		if (resp->httpState == AppResponse::PARSING_HEADERS) {
+			// Not yet done parsing.
+			return Channel::Result(buffer.size(), false);
+		}
+
+		getHeaderParserStatePool().destroy(resp->parserState.headerParser);
+		resp->parserState.headerParser = NULL;
+
+		switch (resp->httpState) {
+		case AppResponse::COMPLETE:
+		case AppResponse::PARSING_BODY_WITH_LENGTH:
+		case AppResponse::PARSING_BODY_UNTIL_EOF:
+		case AppResponse::PARSING_CHUNKED_BODY:
+			if (resp->httpState == AppResponse::PARSING_CHUNKED_BODY) {
+				createTurboCacheRefreshChunkedBodyParser(refresh).initialize();
+			}
+			if (!beginTurboCacheRefreshResponse(refresh)
+			 || resp->httpState == AppResponse::COMPLETE)
+			{
+				finishTurboCacheRefresh(refresh, true);
+				return Channel::Result(ret, true);
+			}
+			return Channel::Result(ret, false);
+		case AppResponse::ERROR:
+			SKC_DEBUG(NULL, "Turbocache refresh: error parsing application response header: " <<
+				ServerKit::getErrorDesc(resp->aux.parseError));
+			finishTurboCacheRefresh(refresh, false);
+			return Channel::Result(0, true);
+		default:
+			// Upgrades and 100-Continue responses are not expected, because
+			// the request is a GET request without a body.
+			SKC_DEBUG(NULL, "Turbocache refresh: unexpected application response");
+			finishTurboCacheRefresh(refresh, false);
+			return Channel::Result(ret, true);
+		}
+	}
+
+	case AppResponse::PARSING_BODY_WITH_LENGTH: {
+		boost::uint64_t remaining = std::min<boost::uint64_t>(buffer.size(),
+			resp->aux.bodyInfo.contentLength - resp->bodyAlreadyRead);
+		resp->bodyAlreadyRead += remaining;
+		if (!bufferTurboCacheRefreshResponseBody(refresh,
+			MemoryKit::mbuf(buffer, 0, remaining))
+		 || resp->bodyFullyRead())
+		{
+			finishTurboCacheRefresh(refresh, true);
+			return Channel::Result(remaining, true);
+		}
+		return Channel::Result(remaining, false);
+	}
+
+	case AppResponse::PARSING_CHUNKED_BODY: {
+		ServerKit::HttpChunkedEvent event(createTurboCacheRefreshChunkedBodyParser(refresh)
+			.feed(buffer));
+		resp->bodyAlreadyRead += event.consumed;
+
+		switch (event.type) {
+		case ServerKit::HttpChunkedEvent::NONE:
+			return Channel::Result(event.consumed, false);
+		case ServerKit::HttpChunkedEvent::DATA:
+			if (!bufferTurboCacheRefreshResponseBody(refresh, event.data)) {
+				finishTurboCacheRefresh(refresh, true);
+				return Channel::Result(event.consumed, true);
+			}
+			return Channel::Result(event.consumed, false);
+		case ServerKit::HttpChunkedEvent::END:
+			resp->aux.bodyInfo.endReached = true;
+			finishTurboCacheRefresh(refresh, true);
+			return Channel::Result(event.consumed, true);
+		case ServerKit::HttpChunkedEvent::ERROR:
+			SKC_DEBUG(NULL, "Turbocache refresh: error parsing app response chunked"
+				" encoding: " << ServerKit::getErrorDesc(event.errcode));
+			finishTurboCacheRefresh(refresh, false);
+			return Channel::Result(event.consumed, true);
+		}
+		break; // Never reached, shut up compiler warning.
+	}
+
+	case AppResponse::PARSING_BODY_UNTIL_EOF:
+		resp->bodyAlreadyRead += buffer.size();
+		if (!bufferTurboCacheRefreshResponseBody(refresh, buffer)) {
+			finishTurboCacheRefresh(refresh, true);
+			return Channel::Result(buffer.size(), true);
+		}
+		return Channel::Result(buffer.size(), false);
+
+	default:
+		P_BUG("Invalid response HTTP state " << (int) resp->httpState);
+		return Channel::Result(0, true);
+	}
+
+	return Channel::Result(0, true); // Never reached, shut up compiler warning.
+}
+
+/**
+ * The turbocache-only counterpart of onAppResponseBegin(). Returns whether
+ * the response may be stored in the turbocache.
+ */
+bool
+Controller::beginTurboCacheRefreshResponse(TurboCacheRefresh *refresh) {
+	TRACE_POINT();
+	Request *req = refresh->req;
+	AppResponse *resp = &req->appResponse;
+	struct iovec *buffers;
+	unsigned int nbuffers, dataSize, nCacheableBuffers;
+	bool oobw, ok;
+
+	SKC_TRACE(NULL, 2, "Turbocache refresh: application response headers received");
+	oobw = resp->secureHeaders.lookup(PASSENGER_REQUEST_OOB_WORK) != NULL;
+	prepareAppResponseHeaders(req);
+
+	ev_tstamp responseTime = ev_now(getLoop()) - req->appRequestSentAt;
+	req->session->reportResponseTime(std::max<unsigned long long>(1,
+		(unsigned long long) (responseTime * 1000000)));
+	if (OXT_UNLIKELY(oobw)) {
+		SKC_TRACE(NULL, 2, "Response with OOBW detected");
+		req->session->requestOOBW();
+	}
+
+	prepareAppResponseCaching(NULL, req);
+	if (req->cacheKey.empty()) {
+		return false;
+	}
+
+	ok = constructHeaderBuffersForResponse(req, NULL, 0, nbuffers, dataSize,
+		nCacheableBuffers);
+	assert(ok);
+	buffers = (struct iovec *) psg_palloc(req->pool,
+		sizeof(struct iovec) * nbuffers);
+	ok = constructHeaderBuffersForResponse(req, buffers, nbuffers,
+		nbuffers, dataSize, nCacheableBuffers);
+	assert(ok);
+	(void) ok; // Shut up compiler warning
+
+	markHeaderBuffersForTurboCaching(NULL, req, buffers, nCacheableBuffers);
+	return !req->cacheKey.empty();
+}
+
+/**
+ * The turbocache-only counterpart of markResponsePartForTurboCaching().
+ * Returns whether the response may still be stored in the turbocache.
+ */
+bool
+Controller::bufferTurboCacheRefreshResponseBody(TurboCacheRefresh *refresh,
+	const MemoryKit::mbuf &buffer)
+{
+	Request *req = refresh->req;
+
+	if (!turboCaching.isEnabled() || req->cacheKey.empty()) {
+		return false;
+	}
+
+	unsigned int totalSize = req->appResponse.bodyCacheBuffer.size + buffer.size();
+	if (totalSize > turboCaching.responseCache.getMaxBodySize()) {
+		SKC_DEBUG(NULL, "Response body larger than " <<
+			turboCaching.responseCache.getMaxBodySize() <<
+			" bytes, so response is not eligible for turbocaching");
+		// Decrease store success ratio.
+		turboCaching.responseCache.incStores();
+		req->cacheKey = HashedStaticString();
+		psg_lstr_deinit(&req->appResponse.bodyCacheBuffer);
+		return false;
+	} else {
+		psg_lstr_append(&req->appResponse.bodyCacheBuffer, req->pool, buffer,
+			buffer.start, buffer.size());
+		return true;
+	}
+}
+
+ServerKit::HttpChunkedBodyParser
+Controller::createTurboCacheRefreshChunkedBodyParser(TurboCacheRefresh *refresh) {
+	return ServerKit::HttpChunkedBodyParser(
+		&refresh->req->appResponse.parserState.chunkedBodyParser,
+		formatTurboCacheRefreshChunkedBodyParserLoggingPrefix,
+		refresh);
+}
+
+unsigned int
+Controller::formatTurboCacheRefreshChunkedBodyParserLoggingPrefix(char *buf,
+	unsigned int bufsize, void *userData)
+{
+	return snprintf(buf, bufsize, "[Turbocache refresh] ChunkedBodyParser: ");
+}
+
+/**
+ * Stores the response if `success`, and returns the session to the pool.
+ * The session is only kept alive if the whole response was read.
+ */
+void
+Controller::finishTurboCacheRefresh(TurboCacheRefresh *refresh, bool success) {
+	Request *req = refresh->req;
+
+	if (refresh->finished) {
+		return;
+	}
+	refresh->finished = true;
+
+	if (success) {
+		storeAppResponseInTurboCache(NULL, req);
+	}
+	if (req->session != NULL && !req->session->isClosed()) {
+		req->session->close(success, success && req->appResponseInitialized
+			&& req->appResponse.canKeepAlive());
+	}
+
+	SKC_DEBUG(NULL, "Turbocache refresh " << (success ? "finished" : "failed") <<
+		" (key \"" << cEscapeString(refresh->key) << "\")");
+	turboCacheRefreshes.remove(refresh->key);
+	unrefTurboCacheRefresh(refresh);
+}
+
+void
+Controller::unrefTurboCacheRefresh(TurboCacheRefresh *refresh) {
+	assert(refresh->refcount > 0);
+	refresh->refcount--;
+	if (refresh->refcount == 0) {
+		destroyTurboCacheRefresh(refresh);
+	}
+}
+
+void
+Controller::destroyTurboCacheRefresh(TurboCacheRefresh *refresh) {
+	Request *req = refresh->req;
+
+	deinitializeRequest(NULL, req);
+	if (req->pool != NULL) {
+		psg_destroy_pool(req->pool);
+		req->pool = NULL;
+	}
+	delete req;
+	delete refresh;
+}
+
+
+} // namespace Core
+} // namespace Passenger
@@ -28,6 +28,7 @@
 
 #include <ev++.h>
 #include <string>
+#include <vector>
 #include <cstring>
 
 #include <ServerKit/HttpRequest.h>
@@ -37,6 +38,7 @@
 #include <Core/ApplicationPool/Pool.h>
 #include <Core/Controller/Config.h>
 #include <Core/Controller/AppResponse.h>
+#include <Core/ResponseCache.h>
 
 namespace Passenger {
 namespace Core {
@@ -45,12 +47,31 @@ using namespace std;
 using namespace boost;
 using namespace ApplicationPool2;
 
+class Controller;
+class Request;
+
+
+/**
+ * Requests for the same turbocache key that wait for the application's
+ * response to `leader`, so that they can be served from the turbocache
+ * instead of all being forwarded to the application. See
+ * Controller::coalesceRequest().
+ */
+struct CoalescedRequests {
+	Controller *controller;
+	string key;
+	Request *leader;
+	vector<Request *> waiters;
+	struct ev_timer timer;
+};
+
 
 class Request: public ServerKit::BaseHttpRequest {
 public:
 	enum State {
 		ANALYZING_REQUEST,
 		BUFFERING_REQUEST_BODY,
+		WAITING_FOR_COALESCED_RESPONSE,
 		CHECKING_OUT_SESSION,
 		SENDING_HEADER_TO_APP,
 		FORWARDING_BODY_TO_APP,
@@ -65,6 +86,9 @@ public:
 	};
 
 	ev_tstamp startedAt;
+	/** When the request header was sent to the application. Used for
+	 * measuring the application's response time. */
+	ev_tstamp appRequestSentAt;
 
 	State state: 3;
 	bool dechunkResponse: 1;
@@ -94,6 +118,13 @@ public:
 	HashedStaticString cacheKey;
 	LString *cacheControl;
 	LString *varyCookie;
+	// If this request revalidates a stale turbocache entry, or may fall
+	// back to it when the app fails (stale-if-error), then this is a copy
+	// of that entry, allocated from `pool`.
+	ResponseCacheEntry staleCacheEntry;
+	// Non-NULL if other requests for the same turbocache key are waiting
+	// for the response to this request.
+	CoalescedRequests *coalescedRequests;
 	// Value of the `!~PASSENGER_ENV_VARS` header. This is different
 	// from `options.environmentVariables`. If `!~PASSENGER_ENV_VARS`
 	// is not set or is empty, then `envvars` is NULL, while
@@ -102,6 +133,16 @@ public:
 	// This value is guaranteed to be contiguous.
 	LString *envvars;
 
+	#ifdef __linux__
+		// State for forwarding the request body to the app with splice().
+		// See SpliceBody.cpp. splicePipe[0] is -1 unless splicing.
+		int splicePipe[2];
+		unsigned int splicePipeSize;
+		bool bodySpliceAttempted;
+		struct ev_io spliceClientWatcher;
+		struct ev_io spliceAppWatcher;
+	#endif
+
 	#ifdef DEBUG_CC_EVENT_LOOP_BLOCKING
 		bool timedAppPoolGet;
 		ev_tstamp timeBeforeAccessingApplicationPool;
@@ -120,6 +161,8 @@ public:
 			return "ANALYZING_REQUEST";
 		case BUFFERING_REQUEST_BODY:
 			return "BUFFERING_REQUEST_BODY";
+		case WAITING_FOR_COALESCED_RESPONSE:
+			return "WAITING_FOR_COALESCED_RESPONSE";
 		case CHECKING_OUT_SESSION:
 			return "CHECKING_OUT_SESSION";
 		case SENDING_HEADER_TO_APP:
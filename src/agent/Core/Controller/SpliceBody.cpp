@@ -0,0 +1,305 @@
+/*
+ *  Phusion Passenger - https://www.phusionpassenger.com/
+ *  Copyright (c) 2014-2018 Phusion Holding B.V.
+ *
+ *  "Passenger", "Phusion Passenger" and "Union Station" are registered
+ *  trademarks of Phusion Holding B.V.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#include <Core/Controller.h>
+
+#ifdef __linux__
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+/*************************************************************************
+ *
+ * Implements Core::Controller methods pertaining forwarding large,
+ * fixed-length request bodies to the application with splice(). The body
+ * is moved from the client socket to the application socket through a
+ * pipe, so that it is never copied into userspace. This is only done when
+ * the body doesn't need to be dechunked or buffered; in all other cases
+ * the body goes through `req->bodyChannel` and `req->appSink` as usual.
+ *
+ *************************************************************************/
+
+#ifdef __linux__
+
+namespace Passenger {
+namespace Core {
+
+using namespace std;
+using namespace boost;
+
+
+/****************************
+ *
+ * Private methods
+ *
+ ****************************/
+
+
+/**
+ * Called by whenSendingRequest_onRequestBody() after it has passed a body
+ * chunk to `req->appSink`. If the end of the body has not been reached yet,
+ * then HttpServer has passed all data that the client input channel read
+ * to the body channel, unless it is waiting for the body channel to
+ * consume a previous chunk (in which case it has set `consumedCallback`).
+ * And if `req->appSink` accepts input, then all body data received so far
+ * has been written to the application. So from then on, the rest of the
+ * body can be moved directly between the sockets. That is, unless the
+ * client socket is read through io_uring, which may already have received
+ * more data.
+ */
+bool
+Controller::shouldSpliceBody(Request *req) const {
+	return mainConfig.requestBodySpliceThreshold > 0
+		&& req->bodyType == Request::RBT_CONTENT_LENGTH
+		&& !req->requestBodyBuffering
+		&& !req->bodySpliceAttempted
+		&& !req->bodyFullyRead()
+		&& req->bodyChannel.consumedCallback == NULL
+		&& !static_cast<const Client *>(req->client)->input.usesIoUring()
+		&& req->appSink.acceptingInput()
+		&& req->aux.bodyInfo.contentLength - req->bodyAlreadyRead
+			>= mainConfig.requestBodySpliceThreshold;
+}
+
+void
+Controller::beginSplicingBody(Client *client, Request *req) {
+	req->bodySpliceAttempted = true;
+	if (pipe2(req->splicePipe, O_NONBLOCK | O_CLOEXEC) == -1) {
+		int e = errno;
+		SKC_DEBUG(client, "Cannot create pipe for splicing the request body: "
+			<< strerror(e) << " (errno=" << e << ")");
+		req->splicePipe[0] = -1;
+		req->splicePipe[1] = -1;
+		return;
+	}
+
+	SKC_TRACE(client, 2, "Splicing the remaining " <<
+		(req->aux.bodyInfo.contentLength - req->bodyAlreadyRead) <<
+		" bytes of the request body to the application");
+	req->splicePipeSize = 0;
+	client->input.stop();
+	ev_io_set(&req->spliceClientWatcher, client->getFd(), EV_READ);
+	ev_io_set(&req->spliceAppWatcher, req->session->fd(), EV_WRITE);
+	// We are being called from inside the body channel's data callback,
+	// so don't start splicing until the next event loop iteration.
+	ev_io_start(getLoop(), &req->spliceClientWatcher);
+}
+
+void
+Controller::onSpliceClientReadable(EV_P_ struct ev_io *io, int revents) {
+	Request *req = static_cast<Request *>(io->data);
+	Client *client = static_cast<Client *>(req->client);
+	Controller *self = static_cast<Controller *>(getServerFromClient(client));
+	SKC_LOG_EVENT_FROM_STATIC(self, Controller, client, "onSpliceClientReadable");
+	RequestRef ref(req, __FILE__, __LINE__);
+	self->spliceBody(client, req);
+}
+
+void
+Controller::onSpliceAppWritable(EV_P_ struct ev_io *io, int revents) {
+	Request *req = static_cast<Request *>(io->data);
+	Client *client = static_cast<Client *>(req->client);
+	Controller *self = static_cast<Controller *>(getServerFromClient(client));
+	SKC_LOG_EVENT_FROM_STATIC(self, Controller, client, "onSpliceAppWritable");
+	RequestRef ref(req, __FILE__, __LINE__);
+	self->spliceBody(client, req);
+}
+
+void
+Controller::spliceBody(Client *client, Request *req) {
+	// Return to the event loop every now and then so that a single
+	// fast upload can't starve other clients.
+	const unsigned int MAX_ROUNDS = 16;
+	const size_t MAX_SPLICE_SIZE = 1024 * 64;
+	ssize_t ret;
+
+	for (unsigned int i = 0; i < MAX_ROUNDS; i++) {
+		if (req->splicePipeSize == 0) {
+			boost::uint64_t remaining = req->aux.bodyInfo.contentLength
+				- req->bodyAlreadyRead;
+			if (remaining == 0) {
+				finishSplicingBody(client, req);
+				return;
+			}
+
+			do {
+				ret = spliceData(client->getFd(), req->splicePipe[1],
+					std::min<boost::uint64_t>(remaining, MAX_SPLICE_SIZE));
+			} while (ret == -1 && errno == EINTR);
+
+			if (ret > 0) {
+				req->splicePipeSize = ret;
+				req->bodyAlreadyRead += ret;
+				req->lastDataReceiveTime = ev_now(getLoop());
+				SKC_TRACE(client, 3, "Spliced " << ret << " bytes of client request body ("
+					<< req->bodyAlreadyRead << " of " << req->aux.bodyInfo.contentLength
+					<< " bytes read in total)");
+			} else if (ret == 0) {
+				SKC_DEBUG(client, "Client sent EOF before finishing request body: " <<
+					req->bodyAlreadyRead << " bytes already read, " <<
+					req->aux.bodyInfo.contentLength << " bytes expected");
+				stopSplicingBodyWithClientError(client, req, ServerKit::UNEXPECTED_EOF);
+				return;
+			} else if (errno == EAGAIN) {
+				ev_io_stop(getLoop(), &req->spliceAppWatcher);
+				ev_io_start(getLoop(), &req->spliceClientWatcher);
+				return;
+			} else if (errno == EINVAL) {
+				// This kind of client socket does not support splice().
+				fallBackFromSplicingBody(client, req);
+				return;
+			} else {
+				stopSplicingBodyWithClientError(client, req, errno);
+				return;
+			}
+		} else {
+			do {
+				ret = spliceData(req->splicePipe[0], req->session->fd(),
+					req->splicePipeSize);
+			} while (ret == -1 && errno == EINTR);
+
+			if (ret > 0) {
+				req->splicePipeSize -= ret;
+			} else if (ret == -1 && errno == EAGAIN) {
+				ev_io_stop(getLoop(), &req->spliceClientWatcher);
+				ev_io_start(getLoop(), &req->spliceAppWatcher);
+				return;
+			} else if (ret == -1 && errno == EINVAL) {
+				// This kind of application socket does not support splice().
+				fallBackFromSplicingBody(client, req);
+				return;
+			} else {
+				stopSplicingBodyWithAppError(client, req, (ret == 0) ? EPIPE : errno);
+				return;
+			}
+		}
+	}
+
+	if (req->splicePipeSize == 0) {
+		ev_io_stop(getLoop(), &req->spliceAppWatcher);
+		ev_io_start(getLoop(), &req->spliceClientWatcher);
+	} else {
+		ev_io_stop(getLoop(), &req->spliceClientWatcher);
+		ev_io_start(getLoop(), &req->spliceAppWatcher);
+	}
+}
+
+void
+Controller::finishSplicingBody(Client *client, Request *req) {
+	stopSplicingBody(req);
+	splicedRequestBodyCount++;
+	SKC_TRACE(client, 2, "End of request body reached");
+	// Do what HttpServer does upon reaching the end of the body, so that
+	// early EOF detection and the end of the body work as usual.
+	req->detectingNextRequestEarlyReadError = true;
+	client->input.start();
+	if (req->bodyChannel.acceptingInput()) {
+		req->bodyChannel.feed(MemoryKit::mbuf());
+	}
+}
+
+void
+Controller::stopSplicingBodyWithClientError(Client *client, Request *req, int errcode) {
+	stopSplicingBody(req);
+	SKC_TRACE(client, 2, "Request body receive error: " <<
+		ServerKit::getErrorDesc(errcode) << " (errno=" << errcode << ")");
+	if (req->bodyChannel.acceptingInput()) {
+		req->bodyChannel.feedError(errcode);
+	}
+}
+
+void
+Controller::stopSplicingBodyWithAppError(Client *client, Request *req, int errcode) {
+	// Like in whenSendingRequest_onRequestBody(): ForwardResponse.cpp will
+	// forward the response data and end the request when it's done.
+	stopSplicingBody(req);
+	logAppSocketWriteError(client, errcode);
+	req->state = Request::WAITING_FOR_APP_OUTPUT;
+	stopBodyChannel(client, req);
+}
+
+/**
+ * Continues forwarding the request body through `req->bodyChannel` and
+ * `req->appSink`, after passing on any data that is still in the pipe.
+ */
+void
+Controller::fallBackFromSplicingBody(Client *client, Request *req) {
+	SKC_DEBUG(client, "Cannot splice the request body; forwarding it normally");
+	requestBodySpliceFallbackCount++;
+
+	if (req->splicePipeSize > 0) {
+		char *buffer = (char *) psg_pnalloc(req->pool, req->splicePipeSize);
+		ssize_t ret;
+		do {
+			ret = ::read(req->splicePipe[0], buffer, req->splicePipeSize);
+		} while (ret == -1 && errno == EINTR);
+		if (ret != (ssize_t) req->splicePipeSize) {
+			// A pipe that we filled ourselves can't fail this way.
+			stopSplicingBodyWithAppError(client, req, (ret == -1) ? errno : EIO);
+			return;
+		}
+		stopSplicingBody(req);
+		req->appSink.feed(MemoryKit::mbuf(buffer, ret));
+	} else {
+		stopSplicingBody(req);
+	}
+
+	if (req->appSink.acceptingInput()) {
+		client->input.start();
+	} else if (req->appSink.mayAcceptInputLater()) {
+		req->appSink.setConsumedCallback(resumeRequestBodyChannelWhenAppSinkIdle);
+		stopBodyChannel(client, req);
+		client->input.start();
+	} else {
+		assert(req->appSink.hasError());
+		logAppSocketWriteError(client, req->appSink.getErrcode());
+		req->state = Request::WAITING_FOR_APP_OUTPUT;
+		stopBodyChannel(client, req);
+	}
+}
+
+ssize_t
+Controller::spliceData(int fdIn, int fdOut, size_t size) {
+	return splice(fdIn, NULL, fdOut, NULL, size, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+}
+
+void
+Controller::stopSplicingBody(Request *req) {
+	if (req->splicePipe[0] != -1) {
+		ev_io_stop(getLoop(), &req->spliceClientWatcher);
+		ev_io_stop(getLoop(), &req->spliceAppWatcher);
+		safelyClose(req->splicePipe[0], true);
+		safelyClose(req->splicePipe[1], true);
+		req->splicePipe[0] = -1;
+		req->splicePipe[1] = -1;
+		req->splicePipeSize = 0;
+	}
+}
+
+
+} // namespace Core
+} // namespace Passenger
+
+#endif /* __linux__ */
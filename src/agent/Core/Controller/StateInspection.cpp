@@ -54,6 +54,8 @@ Controller::getThreadNumber() const {
 Json::Value
 Controller::inspectStateAsJson() const {
 	Json::Value doc = ParentClass::inspectStateAsJson();
+	doc["spliced_request_bodies"] = (Json::UInt64) splicedRequestBodyCount;
+	doc["request_body_splice_fallbacks"] = (Json::UInt64) requestBodySpliceFallbackCount;
 	if (turboCaching.isEnabled()) {
 		Json::Value subdoc;
 		subdoc["fetches"] = turboCaching.responseCache.getFetches();
@@ -62,6 +64,14 @@ Controller::inspectStateAsJson() const {
 		subdoc["stores"] = turboCaching.responseCache.getStores();
 		subdoc["store_successes"] = turboCaching.responseCache.getStoreSuccesses();
 		subdoc["store_success_ratio"] = turboCaching.responseCache.getStoreSuccessRatio();
+		subdoc["evictions"] = turboCaching.responseCache.getEvictions();
+		subdoc["revalidations"] = turboCaching.responseCache.getRevalidations();
+		subdoc["stale_hits"] = turboCaching.responseCache.getStaleHits();
+		subdoc["coalesced_requests"] = (Json::UInt64) coalescedRequestCount;
+		subdoc["entries"] = turboCaching.responseCache.getCount();
+		subdoc["max_entries"] = turboCaching.responseCache.getMaxEntries();
+		subdoc["memory_usage"] = (Json::UInt64) turboCaching.responseCache.getMemoryUsage();
+		subdoc["max_memory"] = (Json::UInt64) turboCaching.responseCache.getMaxMemory();
 		doc["turbocaching"] = subdoc;
 	}
 	return doc;
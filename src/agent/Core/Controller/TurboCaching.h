@@ -30,6 +30,8 @@
 #include <ev++.h>
 #include <ctime>
 #include <cstddef>
+#include <cstring>
+#include <strings.h>
 #include <cassert>
 #include <MemoryKit/mbuf.h>
 #include <ServerKit/Context.h>
@@ -95,8 +97,53 @@ private:
 		unsigned int ageValueSize;
 		unsigned int contentLengthStrSize;
 		bool showVersionInHeader;
+		bool notModified;
 	};
 
+	static bool isNotModifiedHeaderLine(const StaticString &line) {
+		// The headers that RFC 7232 section 4.1 requires in a 304
+		// response if they would have been sent in a 200 response.
+		static const char *names[] = {
+			"date:", "etag:", "cache-control:", "expires:",
+			"last-modified:", "content-location:", NULL
+		};
+		for (unsigned int i = 0; names[i] != NULL; i++) {
+			size_t len = strlen(names[i]);
+			if (line.size() >= len && strncasecmp(line.data(), names[i], len) == 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * Copies the header lines from the cached response that belong in
+	 * a 304 response into `output` (if not NULL). Returns the size.
+	 * The cached status line and Status header are skipped.
+	 */
+	static unsigned int filterNotModifiedHeaders(const ResponseCacheEntryType *entry,
+		char *output, const char *end)
+	{
+		const char *pos = entry->body->httpHeaderData;
+		const char *headerEnd = pos + entry->body->httpHeaderSize;
+		unsigned int result = 0;
+
+		while (pos < headerEnd) {
+			const char *lineEnd = (const char *) memchr(pos, '\n', headerEnd - pos);
+			lineEnd = (lineEnd == NULL) ? headerEnd : lineEnd + 1;
+
+			StaticString line(pos, lineEnd - pos);
+			if (isNotModifiedHeaderLine(line)) {
+				result += line.size();
+				if (output != NULL) {
+					output = appendData(output, end, line);
+				}
+			}
+			pos = lineEnd;
+		}
+		return result;
+	}
+
 	template<typename Server>
 	void prepareResponseHeader(ResponsePreparation &prep, Server *server,
 		Request *req, const ResponseCacheEntryType &entry)
@@ -114,6 +161,7 @@ private:
 		prep.ageValueSize = integerSizeInOtherBase<time_t, 10>(prep.age);
 		prep.contentLengthStrSize = uintSizeAsString(entry.body->httpBodySize);
 		prep.showVersionInHeader = req->config->showVersionInHeader;
+		prep.notModified = false;
 	}
 
 	template<typename Server>
@@ -136,19 +184,33 @@ private:
 		char *pos = output;
 		const char *end = output + outputSize;
 
-		result += entry->body->httpHeaderSize;
-		if (output != NULL) {
-			pos = appendData(pos, end, entry->body->httpHeaderData,
-				entry->body->httpHeaderSize);
-		}
+		if (prep.notModified) {
+			if (httpVersion >= 1010) {
+				PUSH_STATIC_STRING("HTTP/1.1 304 Not Modified\r\n");
+			} else {
+				PUSH_STATIC_STRING("HTTP/1.0 304 Not Modified\r\n");
+			}
+			PUSH_STATIC_STRING("Status: 304 Not Modified\r\n");
+			unsigned int size = filterNotModifiedHeaders(entry, pos, end);
+			result += size;
+			if (output != NULL) {
+				pos += size;
+			}
+		} else {
+			result += entry->body->httpHeaderSize;
+			if (output != NULL) {
+				pos = appendData(pos, end, entry->body->httpHeaderData,
+					entry->body->httpHeaderSize);
+			}
 
-		PUSH_STATIC_STRING("Content-Length: ");
-		result += prep.contentLengthStrSize;
-		if (output != NULL) {
-			uintToString(entry->body->httpBodySize, pos, end - pos);
-			pos += prep.contentLengthStrSize;
+			PUSH_STATIC_STRING("Content-Length: ");
+			result += prep.contentLengthStrSize;
+			if (output != NULL) {
+				uintToString(entry->body->httpBodySize, pos, end - pos);
+				pos += prep.contentLengthStrSize;
+			}
+			PUSH_STATIC_STRING("\r\n");
 		}
-		PUSH_STATIC_STRING("\r\n");
 
 		PUSH_STATIC_STRING("Age: ");
 		result += prep.ageValueSize;
@@ -198,8 +260,28 @@ public:
 		  nextTimeout(0)
 		{ }
 
-	void initialize(bool initiallyEnabled) {
+	/**
+	 * If `shared` is given, then entries are stored in that process-wide
+	 * cache and `maxEntries` and `maxMemory` are ignored. Otherwise, large
+	 * entries are allocated from `mbufPool` (if given) so that they can be
+	 * served without copying.
+	 */
+	void initialize(bool initiallyEnabled, unsigned int maxEntries = DEFAULT_TURBOCACHE_MAX_ENTRIES,
+		size_t maxMemory = DEFAULT_TURBOCACHE_MAX_MEMORY,
+		unsigned int maxBodySize = DEFAULT_TURBOCACHE_MAX_BODY_SIZE,
+		MemoryKit::mbuf_pool *mbufPool = NULL,
+		SharedResponseCache *shared = NULL)
+	{
 		state = initiallyEnabled ? ENABLED : DISABLED;
+		if (initiallyEnabled) {
+			responseCache.setMaxBodySize(maxBodySize);
+			if (shared != NULL) {
+				responseCache.setShared(shared);
+			} else {
+				responseCache.setLimits(maxEntries, maxMemory);
+				responseCache.setMbufPool(mbufPool);
+			}
+		}
 		lastTimeout = (ev_tstamp) time(NULL);
 		nextTimeout = (ev_tstamp) time(NULL) + ENABLED_TIMEOUT;
 	}
@@ -243,11 +325,15 @@ public:
 				state = TEMPORARILY_DISABLED;
 				nextTimeout = now + TEMPORARY_DISABLE_TIMEOUT;
 			} else {
-				P_DEBUG("Clearing turbocache");
 				nextTimeout = now + ENABLED_TIMEOUT;
 			}
 			responseCache.resetStatistics();
-			responseCache.clear();
+			// A shared cache is used by other threads too, so we don't
+			// clear it here. Stale entries are dropped upon fetching.
+			if (!responseCache.isShared()) {
+				P_DEBUG("Clearing turbocache");
+				responseCache.purge(now);
+			}
 			break;
 		case TEMPORARILY_DISABLED:
 			P_INFO("Re-enabling turbocaching");
@@ -262,6 +348,27 @@ public:
 		lastTimeout = now;
 	}
 
+	/**
+	 * Responds to a conditional request that matches the given entry
+	 * (see ResponseCache::requestIsNotModified()) with 304 Not Modified.
+	 */
+	template<typename Server, typename Client>
+	void writeNotModifiedResponse(Server *server, Client *client, Request *req,
+		ResponseCacheEntryType &entry)
+	{
+		MemoryKit::mbuf_pool &mbuf_pool = server->getContext()->mbuf_pool;
+		ResponsePreparation prep;
+		unsigned int headerSize;
+
+		prepareResponseHeader(prep, server, req, entry);
+		prep.notModified = true;
+		headerSize = buildResponseHeader(prep, server, NULL, 0);
+
+		MemoryKit::mbuf buffer(MemoryKit::mbuf_get_with_size(&mbuf_pool, headerSize));
+		buildResponseHeader(prep, server, buffer.start, buffer.size());
+		server->writeResponse(client, buffer);
+	}
+
 	template<typename Server, typename Client>
 	void writeResponse(Server *server, Client *client, Request *req, ResponseCacheEntryType &entry) {
 		MemoryKit::mbuf_pool &mbuf_pool = server->getContext()->mbuf_pool;
@@ -272,7 +379,20 @@ public:
 		prepareResponseHeader(prep, server, req, entry);
 		headerSize = buildResponseHeader(prep, server, NULL, 0);
 
-		if (headerSize + entry.body->httpBodySize <= MBUF_MAX_SIZE) {
+		if (entry.body->dataBlock != NULL) {
+			// The body lives in an mbuf_block owned by the cache, so
+			// we only copy the header and send the body by reference.
+			// The reference keeps the body alive even if the entry is
+			// evicted before the client has received everything.
+			MemoryKit::mbuf buffer(MemoryKit::mbuf_get_with_size(&mbuf_pool, headerSize));
+			buildResponseHeader(prep, server, buffer.start, buffer.size());
+			server->writeResponse(client, buffer);
+			if (!req->ended() && entry.body->httpBodySize > 0) {
+				server->writeResponse(client, MemoryKit::mbuf_block_subset(
+					entry.body->dataBlock, entry.body->httpHeaderSize,
+					entry.body->httpBodySize));
+			}
+		} else if (headerSize + entry.body->httpBodySize <= MBUF_MAX_SIZE) {
 			// Header and body fit inside a single mbuf
 			MemoryKit::mbuf buffer(MemoryKit::mbuf_get(&mbuf_pool));
 			buffer = MemoryKit::mbuf(buffer, 0, headerSize + entry.body->httpBodySize);
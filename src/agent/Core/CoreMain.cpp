@@ -29,8 +29,10 @@
 #endif
 #ifdef __linux__
 	#define SUPPORTS_PER_THREAD_CPU_AFFINITY
+	#define SUPPORTS_REUSEPORT_LOAD_BALANCING
 	#include <sched.h>
 	#include <pthread.h>
+	#include <linux/filter.h>
 #endif
 #ifdef USE_SELINUX
 	#include <selinux/selinux.h>
@@ -139,6 +141,12 @@ namespace Core {
 
 	struct WorkingObjects {
 		int serverFds[SERVER_KIT_MAX_SERVER_ENDPOINTS];
+		/**
+		 * For addresses that are listened on with per-thread SO_REUSEPORT
+		 * sockets: the socket of each controller thread. The first one is
+		 * the same as the corresponding `serverFds` entry.
+		 */
+		vector<int> reusePortServerFds[SERVER_KIT_MAX_SERVER_ENDPOINTS];
 		int apiServerFds[SERVER_KIT_MAX_SERVER_ENDPOINTS];
 		string controllerSecureHeadersPassword;
 
@@ -153,6 +161,7 @@ namespace Core {
 
 		ServerKit::AcceptLoadBalancer<Controller> loadBalancer;
 		vector<ThreadWorkingObjects> threadWorkingObjects;
+		SharedResponseCache *sharedResponseCache;
 		struct ev_signal sigintWatcher;
 		struct ev_signal sigtermWatcher;
 		struct ev_signal sigquitWatcher;
@@ -171,7 +180,8 @@ namespace Core {
 		oxt::thread *adminPanelConnectorThread;
 
 		WorkingObjects()
-			: exitEvent(__FILE__, __LINE__, "WorkingObjects: exitEvent"),
+			: sharedResponseCache(NULL),
+			  exitEvent(__FILE__, __LINE__, "WorkingObjects: exitEvent"),
 			  allClientsDisconnectedEvent(__FILE__, __LINE__, "WorkingObjects: allClientsDisconnectedEvent"),
 			  terminationCount(0),
 			  shutdownCounter(0),
@@ -204,6 +214,8 @@ namespace Core {
 				delete it->serverKitContext;
 				delete it->bgloop;
 			}
+			// Must be deleted after the controllers, which use it.
+			delete sharedResponseCache;
 
 			delete apiWorkingObjects.apiServer;
 			delete apiWorkingObjects.serverKitContext;
@@ -444,6 +456,82 @@ makeFileWorldReadableAndWritable(const string &path) {
 	}
 #endif
 
+/**
+ * Whether each controller thread should listen on its own SO_REUSEPORT
+ * socket for the given address, instead of having the AcceptLoadBalancer
+ * distribute clients. Unix domain sockets don't support this.
+ */
+static bool
+shouldUseReusePort(const string &address) {
+	#ifdef SUPPORTS_REUSEPORT_LOAD_BALANCING
+		return coreConfig->get("controller_reuse_port").asBool()
+			&& coreConfig->get("controller_threads").asUInt() > 1
+			&& getSocketAddressType(address) == SAT_TCP;
+	#else
+		return false;
+	#endif
+}
+
+#if defined(SUPPORTS_REUSEPORT_LOAD_BALANCING) && defined(SO_ATTACH_REUSEPORT_CBPF)
+	/**
+	 * Makes the kernel pass a new connection to the socket with index
+	 * `cpu % nsockets` in the SO_REUSEPORT group, where `cpu` is the CPU
+	 * that received the connection. Combined with `controller_cpu_affine`,
+	 * connections are then handled by a thread on the CPU that received
+	 * them, or on the same CPU for every connection from that CPU at least.
+	 */
+	static void
+	attachReusePortCpuSteeringProgram(int fd, unsigned int nsockets) {
+		struct sock_filter code[] = {
+			// A = current CPU
+			{ BPF_LD | BPF_W | BPF_ABS, 0, 0, (__u32) (SKF_AD_OFF + SKF_AD_CPU) },
+			// A = A % nsockets
+			{ BPF_ALU | BPF_MOD | BPF_K, 0, 0, nsockets },
+			// Return A
+			{ BPF_RET | BPF_A, 0, 0, 0 }
+		};
+		struct sock_fprog prog;
+		prog.len = sizeof(code) / sizeof(code[0]);
+		prog.filter = code;
+
+		if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog,
+			sizeof(prog)) == -1)
+		{
+			int e = errno;
+			P_WARN("Cannot attach a CPU steering program to SO_REUSEPORT sockets: "
+				<< strerror(e) << " (errno=" << e << "). The kernel will "
+				"distribute connections by hash instead");
+		}
+	}
+#endif
+
+static void
+createReusePortServers(unsigned int index, const string &address) {
+	WorkingObjects *wo = workingObjects;
+	unsigned int nthreads = coreConfig->get("controller_threads").asUInt();
+	vector<int> &fds = wo->reusePortServerFds[index];
+
+	// The kernel assigns the sockets in a SO_REUSEPORT group indexes in
+	// the order in which they start listening. So fds[i] has index i,
+	// which the CPU steering program relies on.
+	fds.reserve(nthreads);
+	fds.push_back(wo->serverFds[index]);
+	for (unsigned int i = 1; i < nthreads; i++) {
+		int fd = createServer(address,
+			coreConfig->get("controller_socket_backlog").asUInt(), true,
+			__FILE__, __LINE__, true);
+		P_LOG_FILE_DESCRIPTOR_PURPOSE(fd, "Server address: " << address
+			<< " (thread " << (i + 1) << ")");
+		fds.push_back(fd);
+	}
+
+	#if defined(SUPPORTS_REUSEPORT_LOAD_BALANCING) && defined(SO_ATTACH_REUSEPORT_CBPF)
+		if (coreConfig->get("controller_cpu_affine").asBool()) {
+			attachReusePortCpuSteeringProgram(fds[0], nthreads);
+		}
+	#endif
+}
+
 static void
 startListening() {
 	TRACE_POINT();
@@ -453,6 +541,13 @@ startListening() {
 	Json::Value::const_iterator it;
 	unsigned int i;
 
+	#ifndef SUPPORTS_REUSEPORT_LOAD_BALANCING
+		if (coreConfig->get("controller_reuse_port").asBool()) {
+			P_WARN("Per-thread SO_REUSEPORT sockets are only supported on Linux. "
+				"Ignoring the 'controller_reuse_port' option");
+		}
+	#endif
+
 	#ifdef USE_SELINUX
 		// Set SELinux context on the first socket that we create
 		// so that the web server can access it.
@@ -460,9 +555,10 @@ startListening() {
 	#endif
 
 	for (it = addresses.begin(), i = 0; it != addresses.end(); it++, i++) {
+		bool reusePort = shouldUseReusePort(it->asString());
 		wo->serverFds[i] = createServer(it->asString(),
 			coreConfig->get("controller_socket_backlog").asUInt(), true,
-			__FILE__, __LINE__);
+			__FILE__, __LINE__, reusePort);
 		#ifdef USE_SELINUX
 			resetSelinuxSocketContext();
 			if (i == 0 && getSocketAddressType(it->asString()) == SAT_UNIX) {
@@ -478,6 +574,9 @@ startListening() {
 		if (getSocketAddressType(it->asString()) == SAT_UNIX) {
 			makeFileWorldReadableAndWritable(parseUnixSocketAddress(it->asString()));
 		}
+		if (reusePort) {
+			createReusePortServers(i, it->asString());
+		}
 	}
 	for (it = apiAddresses.begin(), i = 0; it != apiAddresses.end(); it++, i++) {
 		wo->apiServerFds[i] = createServer(it->asString(), 0, true,
@@ -731,6 +830,16 @@ initializeNonPrivilegedWorkingObjects() {
 	wo->appPool->enableSelfChecking(coreConfig->get("pool_selfchecks").asBool());
 	wo->appPool->abortLongRunningConnectionsCallback = abortLongRunningConnections;
 
+	UPDATE_TRACE_POINT();
+	if (coreConfig->get("turbocaching").asBool() && coreConfig->get("turbocache_shared").asBool()) {
+		wo->sharedResponseCache = new SharedResponseCache(
+			coreConfig->get("turbocache_max_entries").asUInt(),
+			coreConfig->get("turbocache_max_memory").asUInt(),
+			ResponseCache<Request>::MAX_HEADER_SIZE
+				+ coreConfig->get("turbocache_max_body_size").asUInt()
+				+ 2 * ResponseCache<Request>::MAX_VALIDATOR_SIZE);
+	}
+
 	UPDATE_TRACE_POINT();
 	unsigned int nthreads = coreConfig->get("controller_threads").asUInt();
 	BackgroundEventLoop *firstLoop = NULL; // Avoid compiler warning
@@ -771,6 +880,7 @@ initializeNonPrivilegedWorkingObjects() {
 		two.controller->resourceLocator = Agent::Fundamentals::context->resourceLocator;
 		two.controller->wrapperRegistry = coreWrapperRegistry;
 		two.controller->appPool = wo->appPool;
+		two.controller->sharedResponseCache = wo->sharedResponseCache;
 		two.controller->shutdownFinishCallback = controllerShutdownFinished;
 		two.controller->initialize();
 		wo->shutdownCounter.fetch_add(1, boost::memory_order_relaxed);
@@ -778,6 +888,18 @@ initializeNonPrivilegedWorkingObjects() {
 		wo->threadWorkingObjects.push_back(two);
 	}
 
+	UPDATE_TRACE_POINT();
+	for (unsigned int i = 0; i < wo->threadWorkingObjects.size(); i++) {
+		Core::Controller *controller = wo->threadWorkingObjects[i].controller;
+		controller->clientMigrationPeers.reserve(wo->threadWorkingObjects.size() - 1);
+		for (unsigned int j = 0; j < wo->threadWorkingObjects.size(); j++) {
+			if (j != i) {
+				controller->clientMigrationPeers.push_back(
+					wo->threadWorkingObjects[j].controller);
+			}
+		}
+	}
+
 	UPDATE_TRACE_POINT();
 	ev_signal_init(&wo->sigquitWatcher, printInfo, SIGQUIT);
 	ev_signal_start(firstLoop->libev_loop, &wo->sigquitWatcher);
@@ -831,6 +953,11 @@ initializeNonPrivilegedWorkingObjects() {
 		if (nthreads == 1) {
 			ThreadWorkingObjects *two = &wo->threadWorkingObjects[0];
 			two->controller->listen(wo->serverFds[i]);
+		} else if (!wo->reusePortServerFds[i].empty()) {
+			for (unsigned int j = 0; j < nthreads; j++) {
+				ThreadWorkingObjects *two = &wo->threadWorkingObjects[j];
+				two->controller->listen(wo->reusePortServerFds[i][j]);
+			}
 		} else {
 			wo->loadBalancer.listen(wo->serverFds[i]);
 		}
@@ -1123,7 +1250,7 @@ mainLoop() {
 	if (wo->apiWorkingObjects.apiServer != NULL) {
 		wo->apiWorkingObjects.bgloop->start("API event loop", 0);
 	}
-	if (wo->threadWorkingObjects.size() > 1) {
+	if (wo->threadWorkingObjects.size() > 1 && wo->loadBalancer.getEndpointCount() > 0) {
 		wo->loadBalancer.start();
 	}
 	waitForExitEvent();
@@ -1312,6 +1439,9 @@ cleanup() {
 		if (wo->serverFds[i] != -1) {
 			close(wo->serverFds[i]);
 		}
+		for (unsigned int j = 1; j < wo->reusePortServerFds[i].size(); j++) {
+			close(wo->reusePortServerFds[i][j]);
+		}
 		if (wo->apiServerFds[i] != -1) {
 			close(wo->apiServerFds[i]);
 		}
@@ -114,6 +114,15 @@ coreUsage() {
 	printf("                            (single-app mode only)\n");
 	printf("      --spawn-method NAME   Spawn method to use. Can either be 'smart' or\n");
 	printf("                            'direct'. Default: %s\n", DEFAULT_SPAWN_METHOD);
+	printf("      --spawn-concurrency NUMBER\n");
+	printf("                            Maximum number of processes that may be spawned\n");
+	printf("                            at the same time for an app. Default: %d\n", DEFAULT_SPAWN_CONCURRENCY);
+	printf("      --predictive-spawning Spawn processes ahead of demand based on recent\n");
+	printf("                            load trends\n");
+	printf("      --scale-down-delay SECONDS\n");
+	printf("                            With predictive spawning: how long an app must be\n");
+	printf("                            over-provisioned before an idle process is shut\n");
+	printf("                            down. Default: %d\n", DEFAULT_SCALE_DOWN_DELAY);
 	printf("      --load-shell-envvars  Load shell startup files before loading application\n");
 	printf("      --preload-bundler     Tell Ruby to load bundler gem before loading application\n");
 	printf("      --concurrency-model   The concurrency model to use for the app, either\n");
@@ -159,8 +168,9 @@ coreUsage() {
 	printf("                            process can handle the given number of concurrent\n");
 	printf("                            requests per process\n");
 	printf("      --min-instances N     Minimum number of application processes. Default: 1\n");
-	printf("      --memory-limit MB     Restart application processes that go over the\n");
-	printf("                            given memory limit (Enterprise only)\n");
+	printf("      --memory-limit MB     Gracefully restart application processes whose\n");
+	printf("                            private memory usage goes over the given limit.\n");
+	printf("                            Default: 0 (no limit)\n");
 	printf("\n");
 	printf("Request handling options (optional):\n");
 	printf("      --max-requests        Restart application processes that have handled\n");
@@ -170,6 +180,18 @@ coreUsage() {
 	printf("      --max-request-queue-size NUMBER\n");
 	printf("                            Specify request queue size. Default: %d\n",
 		DEFAULT_MAX_REQUEST_QUEUE_SIZE);
+	printf("      --request-body-splice-threshold BYTES\n");
+	printf("                            On Linux, forward request bodies of at least this\n");
+	printf("                            size to the app with splice(), without copying\n");
+	printf("                            them through Passenger. 0 disables. Default: %d\n",
+		DEFAULT_REQUEST_BODY_SPLICE_THRESHOLD);
+	printf("      --client-migration-threshold NUMBER\n");
+	printf("                            Move idle keep-alive connections to another\n");
+	printf("                            thread when this thread has more than NUMBER\n");
+	printf("                            more clients and requests. 0 disables. Default: 0\n");
+	printf("      --routing-policy NAME How to pick a process for a request: least_busy,\n");
+	printf("                            power_of_two_choices or least_latency.\n");
+	printf("                            Default: least_busy\n");
 	printf("      --sticky-sessions     Enable sticky sessions\n");
 	printf("      --sticky-sessions-cookie-name NAME\n");
 	printf("                            Cookie name to use for sticky sessions.\n");
@@ -181,6 +203,25 @@ coreUsage() {
 	printf("                            Vary the turbocache by the cookie of the given name\n");
 	printf("      --disable-turbocaching\n");
 	printf("                            Disable turbocaching\n");
+	printf("      --turbocache-max-entries N\n");
+	printf("                            Maximum number of turbocache entries per\n");
+	printf("                            controller thread. Default: %d\n", DEFAULT_TURBOCACHE_MAX_ENTRIES);
+	printf("      --turbocache-max-memory BYTES\n");
+	printf("                            Maximum amount of response data stored in the\n");
+	printf("                            turbocache per controller thread.\n");
+	printf("                            Default: %d\n", DEFAULT_TURBOCACHE_MAX_MEMORY);
+	printf("      --turbocache-max-body-size BYTES\n");
+	printf("                            Do not turbocache responses with a larger body.\n");
+	printf("                            Default: %d\n", DEFAULT_TURBOCACHE_MAX_BODY_SIZE);
+	printf("      --turbocache-shared   Share a single turbocache between all controller\n");
+	printf("                            threads. The turbocache limits then apply to the\n");
+	printf("                            whole process instead of per thread\n");
+	printf("      --turbocache-coalescing-timeout MSEC\n");
+	printf("                            How long a request waits for the response to\n");
+	printf("                            another request for the same turbocache key,\n");
+	printf("                            before it is forwarded to the app as well.\n");
+	printf("                            0 disables coalescing. Default: %d\n",
+		DEFAULT_TURBOCACHE_COALESCING_TIMEOUT);
 	printf("      --no-abort-websockets-on-process-shutdown\n");
 	printf("                            Do not abort WebSocket connections on process\n");
 	printf("                            shutdown or restart\n");
@@ -210,6 +251,8 @@ coreUsage() {
 	printf("                            Default: number of CPU cores (%d)\n",
 		boost::thread::hardware_concurrency());
 	printf("      --cpu-affine          Enable per-thread CPU affinity (Linux only)\n");
+	printf("      --reuse-port          Give each thread its own SO_REUSEPORT socket\n");
+	printf("                            for TCP addresses (Linux only)\n");
 	printf("      --core-file-descriptor-ulimit NUMBER\n");
 	printf("                            Set custom file descriptor ulimit for the core\n");
 	printf("      --admin-panel-url URL\n");
@@ -330,6 +373,15 @@ parseCoreOption(int argc, const char *argv[], int &i, Json::Value &updates) {
 	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--spawn-method")) {
 		updates["default_spawn_method"] = argv[i + 1];
 		i += 2;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--spawn-concurrency")) {
+		updates["default_spawn_concurrency"] = atoi(argv[i + 1]);
+		i += 2;
+	} else if (p.isFlag(argv[i], '\0', "--predictive-spawning")) {
+		updates["default_predictive_spawning"] = true;
+		i++;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--scale-down-delay")) {
+		updates["default_scale_down_delay"] = atoi(argv[i + 1]);
+		i += 2;
 	} else if (p.isFlag(argv[i], '\0', "--load-shell-envvars")) {
 		updates["default_load_shell_envvars"] = true;
 		i++;
@@ -351,9 +403,21 @@ parseCoreOption(int argc, const char *argv[], int &i, Json::Value &updates) {
 	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--max-requests")) {
 		updates["default_max_requests"] = atoi(argv[i + 1]);
 		i += 2;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--memory-limit")) {
+		updates["default_memory_limit"] = atoi(argv[i + 1]);
+		i += 2;
 	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--max-request-queue-size")) {
 		updates["default_max_request_queue_size"] = atoi(argv[i + 1]);
 		i += 2;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--request-body-splice-threshold")) {
+		updates["request_body_splice_threshold"] = atoi(argv[i + 1]);
+		i += 2;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--client-migration-threshold")) {
+		updates["client_migration_threshold"] = atoi(argv[i + 1]);
+		i += 2;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--routing-policy")) {
+		updates["routing_policy"] = argv[i + 1];
+		i += 2;
 	} else if (p.isFlag(argv[i], '\0', "--sticky-sessions")) {
 		updates["default_sticky_sessions"] = true;
 		i++;
@@ -366,6 +430,21 @@ parseCoreOption(int argc, const char *argv[], int &i, Json::Value &updates) {
 	} else if (p.isFlag(argv[i], '\0', "--disable-turbocaching")) {
 		updates["turbocaching"] = false;
 		i++;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--turbocache-max-entries")) {
+		updates["turbocache_max_entries"] = atoi(argv[i + 1]);
+		i += 2;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--turbocache-max-memory")) {
+		updates["turbocache_max_memory"] = atoi(argv[i + 1]);
+		i += 2;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--turbocache-max-body-size")) {
+		updates["turbocache_max_body_size"] = atoi(argv[i + 1]);
+		i += 2;
+	} else if (p.isFlag(argv[i], '\0', "--turbocache-shared")) {
+		updates["turbocache_shared"] = true;
+		i++;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--turbocache-coalescing-timeout")) {
+		updates["turbocache_coalescing_timeout"] = atoi(argv[i + 1]);
+		i += 2;
 	} else if (p.isFlag(argv[i], '\0', "--no-abort-websockets-on-process-shutdown")) {
 		updates["default_abort_websockets_on_process_shutdown"] = false;
 		i++;
@@ -417,6 +496,9 @@ parseCoreOption(int argc, const char *argv[], int &i, Json::Value &updates) {
 	} else if (p.isFlag(argv[i], '\0', "--cpu-affine")) {
 		updates["controller_cpu_affine"] = true;
 		i++;
+	} else if (p.isFlag(argv[i], '\0', "--reuse-port")) {
+		updates["controller_reuse_port"] = true;
+		i++;
 	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--core-file-descriptor-ulimit")) {
 		updates["file_descriptor_ulimit"] = atoi(argv[i + 1]);
 		i += 2;
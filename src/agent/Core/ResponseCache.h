@@ -27,9 +27,17 @@
 #define _PASSENGER_RESPONSE_CACHE_H_
 
 #include <boost/cstdint.hpp>
+#include <sys/uio.h>
 #include <time.h>
 #include <cassert>
 #include <cstring>
+#include <cstdlib>
+#include <new>
+#include <algorithm>
+#include <oxt/macros.hpp>
+#include <Constants.h>
+#include <MemoryKit/mbuf.h>
+#include <Core/SharedResponseCache.h>
 #include <DataStructures/HashedStaticString.h>
 #include <ServerKit/url_parser.h>
 #include <ServerKit/CookieUtils.h>
@@ -39,6 +47,131 @@
 
 namespace Passenger {
 
+/*
+ * The entry types don't depend on the Request type, so that requests can
+ * hold on to an entry (see Request::staleCacheEntry).
+ */
+
+struct ResponseCacheEntryHeader {
+	bool valid;
+	/** CLOCK reference bit. Set on every hit, cleared by the eviction hand. */
+	bool referenced;
+	unsigned short keySize;
+	boost::uint32_t hash;
+	/** Next entry in the same hash bucket, or ResponseCache::NO_INDEX. */
+	unsigned int nextInBucket;
+	time_t date;
+
+	ResponseCacheEntryHeader()
+		: valid(false),
+		  referenced(false),
+		  keySize(0),
+		  hash(0),
+		  nextInBucket(~0u),
+		  date(0)
+		{ }
+};
+
+struct ResponseCacheEntryBody {
+	unsigned short httpHeaderSize;
+	unsigned int httpBodySize;
+	/* Validators for revalidating the entry with the app. Empty if
+	 * the response had no such header.
+	 */
+	unsigned short etagSize;
+	unsigned short lastModifiedSize;
+	time_t expiryDate;
+	/* For how many seconds after expiryDate the entry may still be served
+	 * (RFC 5861): while it is being refreshed, or when the app fails.
+	 */
+	unsigned int staleWhileRevalidate;
+	unsigned int staleIfError;
+	char key[SharedResponseCache::MAX_KEY_LENGTH];
+	/* All of these point into a single block of
+	 * httpHeaderSize + httpBodySize + etagSize + lastModifiedSize bytes,
+	 * which is owned by the cache. Small entries are malloc()ed.
+	 * Entries that don't fit in a single mbuf are allocated as a
+	 * standalone mbuf_block (`dataBlock`), so that a cache hit can send
+	 * the body by referencing the block instead of copying it.
+	 */
+	char *httpHeaderData;
+	// This data is dechunked.
+	char *httpBodyData;
+	char *etagData;
+	char *lastModifiedData;
+	MemoryKit::mbuf_block *dataBlock;
+
+	ResponseCacheEntryBody()
+		: httpHeaderSize(0),
+		  httpBodySize(0),
+		  etagSize(0),
+		  lastModifiedSize(0),
+		  expiryDate(0),
+		  staleWhileRevalidate(0),
+		  staleIfError(0),
+		  httpHeaderData(NULL),
+		  httpBodyData(NULL),
+		  etagData(NULL),
+		  lastModifiedData(NULL),
+		  dataBlock(NULL)
+	{
+		key[0] = '\0';
+	}
+
+	unsigned int dataSize() const {
+		return httpHeaderSize + httpBodySize + etagSize + lastModifiedSize;
+	}
+
+	bool hasValidators() const {
+		return etagSize > 0 || lastModifiedSize > 0;
+	}
+};
+
+struct ResponseCacheEntry {
+	unsigned int index;
+	ResponseCacheEntryHeader *header;
+	ResponseCacheEntryBody *body;
+	enum {
+		NOT_FOUND,
+		NOT_FRESH
+	} cacheMissReason;
+	/* Set by ResponseCache::fetch() if the entry is stale but may be
+	 * served while it is refreshed in the background.
+	 */
+	bool needsRefresh;
+
+	ResponseCacheEntry()
+		: index(0),
+		  header(NULL),
+		  body(NULL),
+		  needsRefresh(false)
+		{ }
+
+	ResponseCacheEntry(unsigned int i, ResponseCacheEntryHeader *h, ResponseCacheEntryBody *b)
+		: index(i),
+		  header(h),
+		  body(b),
+		  needsRefresh(false)
+		{ }
+
+	OXT_FORCE_INLINE
+	bool valid() const {
+		return header != NULL;
+	}
+
+	const char *getCacheMissReasonString() const {
+		switch (cacheMissReason) {
+		case NOT_FOUND:
+			return "NOT_FOUND";
+		case NOT_FRESH:
+			return "NOT_FRESH";
+		default:
+			return "UNKNOWN";
+		}
+	}
+};
+
+
 /**
  * Relevant RFCs:
  * https://tools.ietf.org/html/rfc7234    HTTP 1.1 Caching
@@ -47,82 +180,17 @@ namespace Passenger {
 template<typename Request>
 class ResponseCache {
 public:
-	static const unsigned int MAX_ENTRIES     = 8; // Fits in exactly 2 cache lines
-	static const unsigned int MAX_KEY_LENGTH  = 256;
+	static const unsigned int MAX_KEY_LENGTH  = SharedResponseCache::MAX_KEY_LENGTH;
 	static const unsigned int MAX_HEADER_SIZE = 4096;
-	static const unsigned int MAX_BODY_SIZE   = 1024 * 32;
+	/** ETag and Last-Modified values larger than this are not stored. */
+	static const unsigned int MAX_VALIDATOR_SIZE = 256;
 	static const unsigned int DEFAULT_HEURISTIC_FRESHNESS = 10;
 	static const unsigned int MIN_HEURISTIC_FRESHNESS = 1;
+	static const unsigned int NO_INDEX = ~0u;
 
-	struct Header {
-		bool valid;
-		unsigned short keySize;
-		boost::uint32_t hash;
-		time_t date;
-
-		Header()
-			: valid(false),
-			  keySize(0),
-			  hash(0),
-			  date(0)
-			{ }
-	};
-
-	struct Body {
-		unsigned short httpHeaderSize;
-		unsigned short httpBodySize;
-		time_t expiryDate;
-		char key[MAX_KEY_LENGTH];
-		char httpHeaderData[MAX_HEADER_SIZE];
-		// This data is dechunked.
-		char httpBodyData[MAX_BODY_SIZE];
-
-		Body()
-			: httpHeaderSize(0),
-			  httpBodySize(0),
-			  expiryDate(0)
-		{
-			key[0] = httpHeaderData[0] = httpBodyData[0] = '\0';
-		}
-	};
-
-	struct Entry {
-		unsigned int index;
-		Header *header;
-		Body *body;
-		enum {
-			NOT_FOUND,
-			NOT_FRESH
-		} cacheMissReason;
-
-		Entry()
-			: index(0),
-			  header(NULL),
-			  body(NULL)
-			{ }
-
-		Entry(unsigned int i, Header *h, Body *b)
-			: index(i),
-			  header(h),
-			  body(b)
-			{ }
-
-		OXT_FORCE_INLINE
-		bool valid() const {
-			return header != NULL;
-		}
-
-		const char *getCacheMissReasonString() const {
-			switch (cacheMissReason) {
-			case NOT_FOUND:
-				return "NOT_FOUND";
-			case NOT_FRESH:
-				return "NOT_FRESH";
-			default:
-				return "UNKNOWN";
-			}
-		}
-	};
+	typedef ResponseCacheEntryHeader Header;
+	typedef ResponseCacheEntryBody Body;
+	typedef ResponseCacheEntry Entry;
 
 private:
 	HashedStaticString HOST;
@@ -135,15 +203,142 @@ private:
 	HashedStaticString X_ACCEL_REDIRECT;
 	HashedStaticString EXPIRES;
 	HashedStaticString LAST_MODIFIED;
+	HashedStaticString ETAG;
+	HashedStaticString IF_NONE_MATCH;
+	HashedStaticString IF_MODIFIED_SINCE;
 	HashedStaticString LOCATION;
 	HashedStaticString CONTENT_LOCATION;
 	HashedStaticString COOKIE;
 	HashedStaticString PASSENGER_VARY_TURBOCACHE_BY_COOKIE;
 
-	unsigned int fetches, hits, stores, storeSuccesses;
+	unsigned int fetches, hits, stores, storeSuccesses, evictions, revalidations;
+	unsigned int staleHits;
+
+	/*
+	 * Entries live in two parallel arrays of `maxEntries` slots, which are
+	 * allocated on the first store so that a disabled cache costs nothing.
+	 * Lookups go through a chained hash index (`buckets`, whose size is a
+	 * power of two) instead of scanning all slots. Free slots are kept on a
+	 * stack, and when the cache is full (either in number of entries or in
+	 * memory usage) an entry is evicted using the CLOCK algorithm: recently
+	 * hit entries get a second chance.
+	 */
+	unsigned int maxEntries;
+	unsigned int nbuckets;
+	unsigned int count;
+	unsigned int clockHand;
+	size_t maxMemory;
+	size_t memoryUsage;
+	unsigned int maxBodySize;
+	MemoryKit::mbuf_pool *mbufPool;
+	Header *headers;
+	Body *bodies;
+	unsigned int *buckets;
+	unsigned int *freeSlots;
+	unsigned int nFreeSlots;
+
+	/*
+	 * If set, entries are stored in this process-wide cache instead of in
+	 * the slots above, and this object only implements the caching policy
+	 * and keeps per-thread statistics.
+	 */
+	SharedResponseCache *shared;
+	SharedResponseCache::Reader *sharedReader;
+
+	// Non-copyable.
+	ResponseCache(const ResponseCache &);
+	ResponseCache &operator=(const ResponseCache &);
+
+	void allocateSlots() {
+		nbuckets = 1;
+		while (nbuckets < maxEntries) {
+			nbuckets <<= 1;
+		}
+		headers   = new Header[maxEntries];
+		bodies    = new Body[maxEntries];
+		buckets   = new unsigned int[nbuckets];
+		freeSlots = new unsigned int[maxEntries];
+		resetSlots();
+	}
+
+	void freeSlotsAndData() {
+		if (headers != NULL) {
+			releaseAllData();
+			delete[] headers;
+			delete[] bodies;
+			delete[] buckets;
+			delete[] freeSlots;
+			headers   = NULL;
+			bodies    = NULL;
+			buckets   = NULL;
+			freeSlots = NULL;
+			nFreeSlots  = 0;
+			count       = 0;
+			clockHand   = 0;
+			memoryUsage = 0;
+		}
+	}
+
+	void releaseAllData() {
+		for (unsigned int i = 0; i < maxEntries; i++) {
+			headers[i].valid = false;
+			releaseData(bodies[i]);
+		}
+	}
+
+	/**
+	 * Allocates `size` bytes of entry data and assigns it to the given body.
+	 * Returns NULL if out of memory.
+	 */
+	char *allocateData(Body &body, size_t size) {
+		char *data;
+
+		if (mbufPool != NULL && size > mbuf_pool_data_size(mbufPool)) {
+			// Standalone mbuf_block sizes must be aligned.
+			size_t alignment = alignof(MemoryKit::mbuf_block);
+			size_t blockSize = (size + alignment - 1) / alignment * alignment;
+			body.dataBlock = MemoryKit::mbuf_block_new_standalone(mbufPool, blockSize);
+			if (OXT_UNLIKELY(body.dataBlock == NULL)) {
+				return NULL;
+			}
+			data = body.dataBlock->start;
+		} else {
+			data = (char *) malloc(std::max<size_t>(size, 1));
+		}
+		return data;
+	}
+
+	void releaseData(Body &body) {
+		if (body.dataBlock != NULL) {
+			// Responses that are still being written out may hold
+			// references to the block, in which case it's freed later.
+			MemoryKit::mbuf_block_unref(body.dataBlock);
+			body.dataBlock = NULL;
+		} else {
+			free(body.httpHeaderData);
+		}
+		body.httpHeaderData = NULL;
+		body.httpBodyData = NULL;
+	}
+
+	void resetSlots() {
+		for (unsigned int i = 0; i < nbuckets; i++) {
+			buckets[i] = NO_INDEX;
+		}
+		// Push in reverse order so that slot 0 is handed out first.
+		for (unsigned int i = 0; i < maxEntries; i++) {
+			freeSlots[i] = maxEntries - i - 1;
+		}
+		nFreeSlots  = maxEntries;
+		count       = 0;
+		clockHand   = 0;
+		memoryUsage = 0;
+	}
 
-	Header headers[MAX_ENTRIES];
-	Body bodies[MAX_ENTRIES];
+	OXT_FORCE_INLINE
+	unsigned int bucketFor(boost::uint32_t hash) const {
+		return hash & (nbuckets - 1);
+	}
 
 	unsigned int calculateKeyLength(const LString * restrict host,
 		const LString * restrict varyCookie,
@@ -217,34 +412,286 @@ private:
 	}
 
 	Entry lookup(const HashedStaticString &cacheKey) {
-		for (unsigned int i = 0; i < MAX_ENTRIES; i++) {
-			if (headers[i].valid
-			 && headers[i].hash == cacheKey.hash()
+		if (OXT_UNLIKELY(headers == NULL)) {
+			return Entry();
+		}
+
+		unsigned int i = buckets[bucketFor(cacheKey.hash())];
+		while (i != NO_INDEX) {
+			if (headers[i].hash == cacheKey.hash()
 			 && cacheKey == StaticString(bodies[i].key, headers[i].keySize))
 			{
 				return Entry(i, &headers[i], &bodies[i]);
 			}
+			i = headers[i].nextInBucket;
 		}
 		return Entry();
 	}
 
-	Entry lookupInvalidOrOldest() {
-		int oldest = -1;
+	void erase(unsigned int index) {
+		Header &header = headers[index];
+		Body &body = bodies[index];
+		unsigned int *link = &buckets[bucketFor(header.hash)];
+
+		assert(header.valid);
+		while (*link != index) {
+			assert(*link != NO_INDEX);
+			link = &headers[*link].nextInBucket;
+		}
+		*link = header.nextInBucket;
+
+		header.valid = false;
+		header.referenced = false;
+		header.nextInBucket = NO_INDEX;
+		memoryUsage -= body.dataSize();
+		releaseData(body);
+		freeSlots[nFreeSlots] = index;
+		nFreeSlots++;
+		count--;
+	}
 
-		for (unsigned int i = 0; i < MAX_ENTRIES; i++) {
+	/**
+	 * Evicts one entry using the CLOCK algorithm.
+	 *
+	 * @pre count > 0
+	 */
+	void evictOne() {
+		assert(count > 0);
+		while (true) {
+			unsigned int i = clockHand;
+			clockHand = (clockHand + 1) % maxEntries;
 			if (!headers[i].valid) {
-				return Entry(i, &headers[i], &bodies[i]);
-			} else if (oldest == -1 || headers[i].date < headers[oldest].date) {
-				oldest = i;
+				continue;
+			} else if (headers[i].referenced) {
+				headers[i].referenced = false;
+			} else {
+				erase(i);
+				evictions++;
+				return;
 			}
 		}
+	}
 
-		return Entry(oldest, &headers[oldest], &bodies[oldest]);
+	/**
+	 * Finds a free slot, evicting entries until the given amount of
+	 * data fits in the memory budget. Returns NO_INDEX if that's
+	 * not possible.
+	 */
+	unsigned int allocateSlot(size_t dataSize) {
+		if (dataSize > maxMemory) {
+			return NO_INDEX;
+		}
+		while (nFreeSlots == 0 || memoryUsage + dataSize > maxMemory) {
+			evictOne();
+		}
+		nFreeSlots--;
+		return freeSlots[nFreeSlots];
 	}
 
-	OXT_FORCE_INLINE
-	void erase(unsigned int index) {
-		headers[index].valid = false;
+	/**
+	 * Inserts a local entry for the given key, replacing any existing one.
+	 * The caller must fill the header and body data. Returns an invalid
+	 * entry if there is not enough room.
+	 */
+	Entry insert(const HashedStaticString &cacheKey, time_t date, time_t expiryDate,
+		unsigned int headerSize, unsigned int bodySize,
+		const StaticString &etag, const StaticString &lastModified)
+	{
+		if (OXT_UNLIKELY(headers == NULL)) {
+			allocateSlots();
+		}
+
+		Entry entry(lookup(cacheKey));
+		if (entry.valid()) {
+			erase(entry.index);
+		}
+
+		unsigned int dataSize = headerSize + bodySize + etag.size() + lastModified.size();
+		unsigned int index = allocateSlot(dataSize);
+		if (index == NO_INDEX) {
+			return Entry();
+		}
+
+		char *data = allocateData(bodies[index], dataSize);
+		if (OXT_UNLIKELY(data == NULL)) {
+			freeSlots[nFreeSlots] = index;
+			nFreeSlots++;
+			return Entry();
+		}
+
+		entry = Entry(index, &headers[index], &bodies[index]);
+		entry.header->valid      = true;
+		entry.header->referenced = false;
+		entry.header->hash       = cacheKey.hash();
+		entry.header->keySize    = cacheKey.size();
+		entry.header->nextInBucket = buckets[bucketFor(cacheKey.hash())];
+		buckets[bucketFor(cacheKey.hash())] = index;
+		memcpy(entry.body->key, cacheKey.data(), cacheKey.size());
+		entry.header->date     = date;
+		entry.body->expiryDate = expiryDate;
+		entry.body->httpHeaderSize = headerSize;
+		entry.body->httpBodySize   = bodySize;
+		entry.body->etagSize       = etag.size();
+		entry.body->lastModifiedSize = lastModified.size();
+		entry.body->httpHeaderData = data;
+		entry.body->httpBodyData   = data + headerSize;
+		entry.body->etagData       = data + headerSize + bodySize;
+		entry.body->lastModifiedData = entry.body->etagData + etag.size();
+		memcpy(entry.body->etagData, etag.data(), etag.size());
+		memcpy(entry.body->lastModifiedData, lastModified.data(), lastModified.size());
+		memoryUsage += dataSize;
+		count++;
+		return entry;
+	}
+
+	/**
+	 * Returns a copy of the given entry's header and body fields, allocated
+	 * from `pool`. Revalidation only modifies those fields, so the entry data
+	 * is shared with the cache when it lives in an mbuf_block: the copy then
+	 * holds a reference to that block, which must be released with
+	 * releaseStaleEntry(). Small malloc()ed data is copied.
+	 */
+	Entry copyEntry(psg_pool_t *pool, const Entry &entry) const {
+		Header *header = new (psg_palloc(pool, sizeof(Header))) Header(*entry.header);
+		Body *body = new (psg_palloc(pool, sizeof(Body))) Body(*entry.body);
+
+		header->nextInBucket = NO_INDEX;
+		if (body->dataBlock != NULL) {
+			MemoryKit::mbuf_block_ref(body->dataBlock);
+		} else {
+			char *data = (char *) psg_pnalloc(pool, std::max(body->dataSize(), 1u));
+			memcpy(data, entry.body->httpHeaderData, body->dataSize());
+			body->httpHeaderData = data;
+			body->httpBodyData   = data + body->httpHeaderSize;
+			body->etagData       = body->httpBodyData + body->httpBodySize;
+			body->lastModifiedData = body->etagData + body->etagSize;
+		}
+		return Entry(0, header, body);
+	}
+
+	StaticString lookupValidator(Request *req, const HashedStaticString &name) const {
+		const LString *value = req->appResponse.headers.lookup(name);
+		if (value == NULL || value->size == 0 || value->size > MAX_VALIDATOR_SIZE) {
+			return StaticString();
+		}
+		value = psg_lstr_make_contiguous(value, req->pool);
+		return StaticString(value->start->data, value->size);
+	}
+
+	/**
+	 * Looks up an entry in the shared cache. The returned entry is a
+	 * private copy allocated from the request's pool.
+	 */
+	Entry lookupShared(Request *req) {
+		SharedResponseCache::Snapshot snapshot;
+		if (!shared->lookup(sharedReader, req->cacheKey, req->pool, snapshot)) {
+			return Entry();
+		}
+
+		Header *header = new (psg_palloc(req->pool, sizeof(Header))) Header();
+		Body *body = new (psg_palloc(req->pool, sizeof(Body))) Body();
+		header->valid   = true;
+		header->hash    = req->cacheKey.hash();
+		header->keySize = req->cacheKey.size();
+		header->date    = snapshot.date;
+		memcpy(body->key, req->cacheKey.data(), req->cacheKey.size());
+		body->expiryDate     = snapshot.expiryDate;
+		body->staleWhileRevalidate = snapshot.staleWhileRevalidate;
+		body->staleIfError   = snapshot.staleIfError;
+		body->httpHeaderSize = snapshot.headerSize;
+		body->httpBodySize   = snapshot.bodySize;
+		body->etagSize       = snapshot.etagSize;
+		body->lastModifiedSize = snapshot.lastModifiedSize;
+		body->httpHeaderData = snapshot.data;
+		body->httpBodyData   = snapshot.data + snapshot.headerSize;
+		body->etagData       = body->httpBodyData + snapshot.bodySize;
+		body->lastModifiedData = body->etagData + snapshot.etagSize;
+		return Entry(0, header, body);
+	}
+
+	void remove(const Entry &entry, const HashedStaticString &cacheKey) {
+		if (shared != NULL) {
+			shared->erase(cacheKey);
+		} else {
+			erase(entry.index);
+		}
+	}
+
+	void remove(const HashedStaticString &cacheKey) {
+		if (shared != NULL) {
+			shared->erase(cacheKey);
+		} else {
+			Entry entry(lookup(cacheKey));
+			if (entry.valid()) {
+				erase(entry.index);
+			}
+		}
+	}
+
+	bool requestAllowsRevalidation(Request *req) const {
+		// If the client sent its own conditional request then the app's
+		// response is meant for the client, so we pass it through.
+		return req->headers.lookup(IF_NONE_MATCH) == NULL
+			&& req->headers.lookup(IF_MODIFIED_SINCE) == NULL;
+	}
+
+	/**
+	 * Keeps a copy of the stale entry in the request, and makes the request
+	 * conditional so that the app can respond with 304 Not Modified if the
+	 * entry is still valid.
+	 */
+	void prepareRevalidation(Request *req, const Entry &entry) {
+		// Shared cache entries are already private copies.
+		req->staleCacheEntry = (shared != NULL) ? entry : copyEntry(req->pool, entry);
+
+		const Body *body = req->staleCacheEntry.body;
+		if (body->etagSize > 0) {
+			req->headers.insert(req->pool, P_STATIC_STRING("If-None-Match"),
+				StaticString(body->etagData, body->etagSize));
+		}
+		if (body->lastModifiedSize > 0) {
+			req->headers.insert(req->pool, P_STATIC_STRING("If-Modified-Since"),
+				StaticString(body->lastModifiedData, body->lastModifiedSize));
+		}
+	}
+
+	static StaticString stripWeakEtagPrefix(const StaticString &etag) {
+		if (etag.size() >= 2 && etag[0] == 'W' && etag[1] == '/') {
+			return etag.substr(2);
+		} else {
+			return etag;
+		}
+	}
+
+	/**
+	 * Checks whether the given If-None-Match value matches the ETag,
+	 * using the weak comparison function (RFC 7232 section 2.3.2).
+	 */
+	static bool etagListMatches(const StaticString &list, const StaticString &etag) {
+		StaticString target = stripWeakEtagPrefix(etag);
+		const char *pos = list.data();
+		const char *end = list.data() + list.size();
+
+		while (pos < end) {
+			while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == ',')) {
+				pos++;
+			}
+			const char *itemEnd = (const char *) memchr(pos, ',', end - pos);
+			if (itemEnd == NULL) {
+				itemEnd = end;
+			}
+			const char *trimmedEnd = itemEnd;
+			while (trimmedEnd > pos && (trimmedEnd[-1] == ' ' || trimmedEnd[-1] == '\t')) {
+				trimmedEnd--;
+			}
+
+			StaticString item(pos, trimmedEnd - pos);
+			if (item == "*" || (!item.empty() && stripWeakEtagPrefix(item) == target)) {
+				return true;
+			}
+			pos = itemEnd;
+		}
+		return false;
 	}
 
 	time_t parseDate(psg_pool_t *pool, const LString *date, ev_tstamp now) const {
@@ -313,10 +760,124 @@ private:
 		return lround(now) + DEFAULT_HEURISTIC_FRESHNESS;
 	}
 
+	bool determineDates(Request *req, ev_tstamp now, time_t &responseDate,
+		time_t &expiryDate) const
+	{
+		responseDate = parseDate(req->pool, req->appResponse.date, now);
+		if (responseDate == (time_t) -1) {
+			return false;
+		}
+
+		expiryDate = determineExpiryDate(req, responseDate, now);
+		return expiryDate != (time_t) -1;
+	}
+
+	bool parseHttpDate(const StaticString &value, time_t &result) const {
+		struct tm tm;
+		int zone;
+
+		if (parseImfFixdate(value.data(), value.data() + value.size(), tm, zone)) {
+			result = parsedDateToTimestamp(tm, zone);
+			return true;
+		} else {
+			return false;
+		}
+	}
+
+	/**
+	 * Checks the response headers that determine whether a response may be
+	 * stored, and looks up the headers that determine its freshness.
+	 */
+	bool prepareResponseHeadersForStoring(Request *req) {
+		ServerKit::HeaderTable &respHeaders = req->appResponse.headers;
+
+		req->appResponse.cacheControl = respHeaders.lookup(CACHE_CONTROL);
+		if (req->appResponse.cacheControl != NULL && req->appResponse.cacheControl->size > 0) {
+			req->appResponse.cacheControl = psg_lstr_make_contiguous(
+				req->appResponse.cacheControl,
+				req->pool);
+			StaticString cacheControl = StaticString(
+				req->appResponse.cacheControl->start->data,
+				req->appResponse.cacheControl->size);
+			if (cacheControl.find(P_STATIC_STRING("no-store")) != string::npos
+			 || cacheControl.find(P_STATIC_STRING("private")) != string::npos
+			 || cacheControl.find(P_STATIC_STRING("no-cache")) != string::npos)
+			{
+				return false;
+			}
+		}
+
+		if (req->headers.lookup(AUTHORIZATION) != NULL
+		 || respHeaders.lookup(VARY) != NULL
+		 || respHeaders.lookup(WWW_AUTHENTICATE) != NULL
+		 || respHeaders.lookup(X_SENDFILE) != NULL
+		 || respHeaders.lookup(X_ACCEL_REDIRECT) != NULL)
+		{
+			return false;
+		}
+
+		req->appResponse.expiresHeader = respHeaders.lookup(EXPIRES);
+		if (req->appResponse.expiresHeader == NULL) {
+			// lastModifiedHeader is only used in determineExpiryDate(),
+			// and only if expiresHeader is not present, and Cache-Control
+			// does not contain max-age.
+			req->appResponse.lastModifiedHeader =
+				respHeaders.lookup(LAST_MODIFIED);
+			if (req->appResponse.lastModifiedHeader != NULL) {
+				req->appResponse.lastModifiedHeader =
+					psg_lstr_make_contiguous(req->appResponse.lastModifiedHeader,
+						req->pool);
+			}
+		} else {
+			req->appResponse.expiresHeader =
+				psg_lstr_make_contiguous(req->appResponse.expiresHeader,
+					req->pool);
+		}
+
+		return true;
+	}
+
 	bool isFresh(const Entry &entry, ev_tstamp now) const {
 		return entry.body->expiryDate > now;
 	}
 
+	static bool mayServeStale(const Body &body, ev_tstamp now) {
+		return body.expiryDate + (time_t) std::max(body.staleWhileRevalidate,
+			body.staleIfError) > now;
+	}
+
+	/**
+	 * Parses the value of a Cache-Control directive with a number of
+	 * seconds as argument, such as `stale-if-error=60`. Returns 0 if
+	 * the directive is absent.
+	 */
+	static unsigned int parseCacheControlSeconds(const LString *cacheControl,
+		const StaticString &directive)
+	{
+		if (cacheControl == NULL || cacheControl->size == 0) {
+			return 0;
+		}
+
+		StaticString value(cacheControl->start->data, cacheControl->size);
+		string::size_type pos = value.find(directive);
+		if (pos == string::npos || value.size() <= pos + directive.size()
+		 || value[pos + directive.size()] != '=')
+		{
+			return 0;
+		}
+		return stringToUint(value.substr(pos + directive.size() + 1));
+	}
+
+	// @pre prepareResponseHeadersForStoring()
+	void determineStaleWindows(Request *req, unsigned int &staleWhileRevalidate,
+		unsigned int &staleIfError) const
+	{
+		staleWhileRevalidate = parseCacheControlSeconds(req->appResponse.cacheControl,
+			P_STATIC_STRING("stale-while-revalidate"));
+		staleIfError = parseCacheControlSeconds(req->appResponse.cacheControl,
+			P_STATIC_STRING("stale-if-error"));
+	}
+
 	StaticString extractHostNameWithPortFromParsedUrl(struct http_parser_url &url,
 		const LString *value) const
 	{
@@ -403,32 +964,136 @@ private:
 		char *key = (char *) psg_pnalloc(req->pool, keySize);
 		generateKey(https, path, req->host, req->varyCookie, key, keySize);
 
-		Entry entry(lookup(StaticString(key, keySize)));
-		if (entry.valid()) {
-			entry.header->valid = false;
-		}
+		remove(HashedStaticString(key, keySize));
 	}
 
 public:
-	ResponseCache()
-		: CACHE_CONTROL("cache-control"),
-		  PRAGMA_CONST("pragma"),
-		  AUTHORIZATION("authorization"),
-		  VARY("vary"),
-		  WWW_AUTHENTICATE("www-authenticate"),
-		  X_SENDFILE("x-sendfile"),
-		  X_ACCEL_REDIRECT("x-accel-redirect"),
-		  EXPIRES("expires"),
-		  LAST_MODIFIED("last-modified"),
-		  LOCATION("location"),
-		  CONTENT_LOCATION("content-location"),
-		  COOKIE("cookie"),
-		  PASSENGER_VARY_TURBOCACHE_BY_COOKIE("!~PASSENGER_VARY_TURBOCACHE_COOKIE"),
+	ResponseCache(unsigned int _maxEntries = DEFAULT_TURBOCACHE_MAX_ENTRIES,
+		size_t _maxMemory = DEFAULT_TURBOCACHE_MAX_MEMORY)
+		: CACHE_CONTROL(P_HASHED_STATIC_STRING("cache-control")),
+		  PRAGMA_CONST(P_HASHED_STATIC_STRING("pragma")),
+		  AUTHORIZATION(P_HASHED_STATIC_STRING("authorization")),
+		  VARY(P_HASHED_STATIC_STRING("vary")),
+		  WWW_AUTHENTICATE(P_HASHED_STATIC_STRING("www-authenticate")),
+		  X_SENDFILE(P_HASHED_STATIC_STRING("x-sendfile")),
+		  X_ACCEL_REDIRECT(P_HASHED_STATIC_STRING("x-accel-redirect")),
+		  EXPIRES(P_HASHED_STATIC_STRING("expires")),
+		  LAST_MODIFIED(P_HASHED_STATIC_STRING("last-modified")),
+		  ETAG(P_HASHED_STATIC_STRING("etag")),
+		  IF_NONE_MATCH(P_HASHED_STATIC_STRING("if-none-match")),
+		  IF_MODIFIED_SINCE(P_HASHED_STATIC_STRING("if-modified-since")),
+		  LOCATION(P_HASHED_STATIC_STRING("location")),
+		  CONTENT_LOCATION(P_HASHED_STATIC_STRING("content-location")),
+		  COOKIE(P_HASHED_STATIC_STRING("cookie")),
+		  PASSENGER_VARY_TURBOCACHE_BY_COOKIE(P_HASHED_STATIC_STRING("!~PASSENGER_VARY_TURBOCACHE_COOKIE")),
 		  fetches(0),
 		  hits(0),
 		  stores(0),
-		  storeSuccesses(0)
-		{ }
+		  storeSuccesses(0),
+		  evictions(0),
+		  revalidations(0),
+		  staleHits(0),
+		  maxEntries(std::max(_maxEntries, 1u)),
+		  nbuckets(0),
+		  count(0),
+		  clockHand(0),
+		  maxMemory(_maxMemory),
+		  memoryUsage(0),
+		  maxBodySize(DEFAULT_TURBOCACHE_MAX_BODY_SIZE),
+		  mbufPool(NULL),
+		  headers(NULL),
+		  bodies(NULL),
+		  buckets(NULL),
+		  freeSlots(NULL),
+		  nFreeSlots(0),
+		  shared(NULL),
+		  sharedReader(NULL)
+	{
+		// Do nothing.
+	}
+
+	~ResponseCache() {
+		if (shared != NULL) {
+			shared->unregisterReader(sharedReader);
+		}
+		freeSlotsAndData();
+	}
+
+	/**
+	 * Makes this cache store its entries in the given process-wide cache,
+	 * so that entries are shared with other threads. Must be called before
+	 * any caching operations, from the thread that will use this object.
+	 * `shared` must outlive this object.
+	 */
+	void setShared(SharedResponseCache *_shared) {
+		assert(shared == NULL);
+		shared = _shared;
+		sharedReader = shared->registerReader();
+		// The local slots are no longer used.
+		freeSlotsAndData();
+		maxEntries = 1;
+	}
+
+	OXT_FORCE_INLINE
+	bool isShared() const {
+		return shared != NULL;
+	}
+
+	/**
+	 * Makes the cache allocate entries that are larger than a single
+	 * mbuf from the given pool, so that they can be served without
+	 * copying. `pool` must outlive this object. Has no effect on
+	 * entries stored in a shared cache, because mbufs may only be
+	 * used by the thread that owns their pool.
+	 */
+	void setMbufPool(MemoryKit::mbuf_pool *pool) {
+		assert(count == 0);
+		mbufPool = pool;
+	}
+
+	/**
+	 * Sets the maximum size of a response body that may be cached.
+	 */
+	void setMaxBodySize(unsigned int size) {
+		maxBodySize = size;
+	}
+
+	OXT_FORCE_INLINE
+	unsigned int getMaxBodySize() const {
+		return maxBodySize;
+	}
+
+	/**
+	 * Changes the maximum number of entries and the memory budget
+	 * (in bytes of stored header and body data). All existing
+	 * entries are dropped.
+	 */
+	void setLimits(unsigned int _maxEntries, size_t _maxMemory) {
+		assert(shared == NULL);
+		freeSlotsAndData();
+		maxEntries = std::max(_maxEntries, 1u);
+		maxMemory = _maxMemory;
+	}
+
+	OXT_FORCE_INLINE
+	unsigned int getMaxEntries() const {
+		return (shared != NULL) ? shared->getMaxEntries() : maxEntries;
+	}
+
+	OXT_FORCE_INLINE
+	size_t getMaxMemory() const {
+		return (shared != NULL) ? shared->getMaxMemory() : maxMemory;
+	}
+
+	OXT_FORCE_INLINE
+	unsigned int getCount() const {
+		return (shared != NULL) ? shared->getCount() : count;
+	}
+
+	OXT_FORCE_INLINE
+	size_t getMemoryUsage() const {
+		return (shared != NULL) ? shared->getMemoryUsage() : memoryUsage;
+	}
 
 	OXT_FORCE_INLINE
 	unsigned int getFetches() const {
@@ -460,22 +1125,73 @@ public:
 		return storeSuccesses / (double) stores;
 	}
 
+	OXT_FORCE_INLINE
+	unsigned int getEvictions() const {
+		return evictions;
+	}
+
+	OXT_FORCE_INLINE
+	unsigned int getRevalidations() const {
+		return revalidations;
+	}
+
+	/**
+	 * The number of times that a stale entry was served, because of
+	 * stale-while-revalidate or stale-if-error.
+	 */
+	OXT_FORCE_INLINE
+	unsigned int getStaleHits() const {
+		return staleHits;
+	}
+
 	// For decreasing the store success ratio without calling store().
 	OXT_FORCE_INLINE
 	void incStores() {
 		stores++;
 	}
 
+	// For counting stale entries that are served because of an error.
+	OXT_FORCE_INLINE
+	void incStaleHits() {
+		staleHits++;
+	}
+
 	void resetStatistics() {
 		fetches = 0;
 		hits = 0;
 		stores = 0;
 		storeSuccesses = 0;
+		evictions = 0;
+		revalidations = 0;
+		staleHits = 0;
 	}
 
 	void clear() {
-		for (unsigned int i = 0; i < MAX_ENTRIES; i++) {
-			headers[i].valid = false;
+		if (shared != NULL) {
+			shared->clear();
+		} else if (headers != NULL && (count > 0 || nFreeSlots != maxEntries)) {
+			releaseAllData();
+			resetSlots();
+		}
+	}
+
+	/**
+	 * Like clear(), but keeps the local entries that may still be served
+	 * stale (see canServeStaleIfError()), so that they outlive the periodic
+	 * clearing until their stale-while-revalidate or stale-if-error
+	 * period is over.
+	 *
+	 * @pre !isShared()
+	 */
+	void purge(ev_tstamp now) {
+		assert(shared == NULL);
+		if (headers == NULL) {
+			return;
+		}
+		for (unsigned int i = 0; i < maxEntries; i++) {
+			if (headers[i].valid && !mayServeStale(bodies[i], now)) {
+				erase(i);
+			}
 		}
 	}
 
@@ -538,7 +1254,17 @@ public:
 			&& !req->hasPragmaHeader;
 	}
 
-	// @pre requestAllowsFetching()
+	/**
+	 * Looks up a fresh entry for the request. If the entry is stale but
+	 * within its stale-while-revalidate period, then it is returned anyway
+	 * with `needsRefresh` set. If the entry is stale but can be revalidated,
+	 * or served in case of an error (stale-if-error), then it is kept in the
+	 * cache, a copy is stored in `req->staleCacheEntry` and the request is
+	 * made conditional if possible (see revalidated()). The result is a
+	 * NOT_FRESH miss in that case too.
+	 *
+	 * @pre requestAllowsFetching()
+	 */
 	Entry fetch(Request *req, ev_tstamp now) {
 		fetches++;
 		if (OXT_UNLIKELY(fetches == 0)) {
@@ -547,13 +1273,28 @@ public:
 			hits = 0;
 		}
 
-		Entry entry(lookup(req->cacheKey));
+		Entry entry(shared != NULL ? lookupShared(req) : lookup(req->cacheKey));
 		if (entry.valid()) {
 			hits++;
 			if (isFresh(entry, now)) {
+				entry.header->referenced = true;
+				return entry;
+			} else if (entry.body->expiryDate + (time_t) entry.body->staleWhileRevalidate > now) {
+				staleHits++;
+				entry.header->referenced = true;
+				entry.needsRefresh = true;
 				return entry;
 			} else {
-				erase(entry.index);
+				if (req->staleCacheEntry.valid()) {
+					// This request already revalidates the entry. This happens
+					// when a coalesced request retries the lookup.
+				} else if (entry.body->hasValidators() || canServeStaleIfError(entry, now)) {
+					if (requestAllowsRevalidation(req)) {
+						prepareRevalidation(req, entry);
+					}
+				} else {
+					remove(entry, req->cacheKey);
+				}
 				Entry result;
 				result.cacheMissReason = Entry::NOT_FRESH;
 				return result;
@@ -577,89 +1318,105 @@ public:
 			return false;
 		}
 
-		ServerKit::HeaderTable &respHeaders = req->appResponse.headers;
+		return prepareResponseHeadersForStoring(req)
+			&& (req->appResponse.cacheControl != NULL
+				|| req->appResponse.expiresHeader != NULL);
+	}
 
-		req->appResponse.cacheControl = respHeaders.lookup(CACHE_CONTROL);
-		if (req->appResponse.cacheControl != NULL && req->appResponse.cacheControl->size > 0) {
-			req->appResponse.cacheControl = psg_lstr_make_contiguous(
-				req->appResponse.cacheControl,
-				req->pool);
-			StaticString cacheControl = StaticString(
-				req->appResponse.cacheControl->start->data,
-				req->appResponse.cacheControl->size);
-			if (cacheControl.find(P_STATIC_STRING("no-store")) != string::npos
-			 || cacheControl.find(P_STATIC_STRING("private")) != string::npos
-			 || cacheControl.find(P_STATIC_STRING("no-cache")) != string::npos)
-			{
-				return false;
-			}
-		}
+	/**
+	 * Reserves an entry for the response, which the caller must fill
+	 * with exactly `headerSize` bytes of header data and `bodySize` bytes of
+	 * body data.
+	 *
+	 * @pre requestAllowsStoring()
+	 * @pre prepareRequestForStoring()
+	 * @pre !isShared()
+	 */
+	Entry store(Request *req, ev_tstamp now, unsigned int headerSize, unsigned int bodySize) {
+		assert(shared == NULL);
+		stores++;
 
-		if (req->headers.lookup(AUTHORIZATION) != NULL
-		 || respHeaders.lookup(VARY) != NULL
-		 || respHeaders.lookup(WWW_AUTHENTICATE) != NULL
-		 || respHeaders.lookup(X_SENDFILE) != NULL
-		 || respHeaders.lookup(X_ACCEL_REDIRECT) != NULL)
-		{
-			return false;
+		if (headerSize > MAX_HEADER_SIZE || bodySize > maxBodySize) {
+			return Entry();
 		}
 
-		req->appResponse.expiresHeader = respHeaders.lookup(EXPIRES);
-		if (req->appResponse.expiresHeader == NULL) {
-			// lastModifiedHeader is only used in determineExpiryDate(),
-			// and only if expiresHeader is not present, and Cache-Control
-			// does not contain max-age.
-			req->appResponse.lastModifiedHeader =
-				respHeaders.lookup(LAST_MODIFIED);
-			if (req->appResponse.lastModifiedHeader != NULL) {
-				req->appResponse.lastModifiedHeader =
-					psg_lstr_make_contiguous(req->appResponse.lastModifiedHeader,
-						req->pool);
-			}
-		} else {
-			req->appResponse.expiresHeader =
-				psg_lstr_make_contiguous(req->appResponse.expiresHeader,
-					req->pool);
+		time_t responseDate, expiryDate;
+		if (!determineDates(req, now, responseDate, expiryDate)) {
+			return Entry();
 		}
 
-		return req->appResponse.cacheControl != NULL
-			|| req->appResponse.expiresHeader != NULL;
+		Entry entry(insert(req->cacheKey, responseDate, expiryDate, headerSize, bodySize,
+			lookupValidator(req, ETAG), lookupValidator(req, LAST_MODIFIED)));
+		if (!entry.valid()) {
+			return Entry();
+		}
+		determineStaleWindows(req, entry.body->staleWhileRevalidate,
+			entry.body->staleIfError);
+		storeSuccesses++;
+		return entry;
 	}
 
-	// @pre requestAllowsStoring()
-	// @pre prepareRequestForStoring()
-	Entry store(Request *req, ev_tstamp now, unsigned int headerSize, unsigned int bodySize) {
-		stores++;
+	/**
+	 * Stores a copy of the given response header and (dechunked) body data.
+	 * Returns whether storing succeeded.
+	 *
+	 * @pre requestAllowsStoring()
+	 * @pre prepareRequestForStoring()
+	 */
+	bool store(Request *req, ev_tstamp now, const struct iovec *headerBuffers,
+		unsigned int nHeaderBuffers, const LString *body)
+	{
+		unsigned int headerSize = 0;
+		for (unsigned int i = 0; i < nHeaderBuffers; i++) {
+			headerSize += headerBuffers[i].iov_len;
+		}
 
-		if (headerSize > MAX_HEADER_SIZE || bodySize > MAX_BODY_SIZE) {
-			return Entry();
+		if (shared == NULL) {
+			Entry entry(store(req, now, headerSize, body->size));
+			if (!entry.valid()) {
+				return false;
+			}
+
+			char *pos = entry.body->httpHeaderData;
+			const char *end = entry.body->httpHeaderData + headerSize;
+			for (unsigned int i = 0; i < nHeaderBuffers; i++) {
+				pos = appendData(pos, end, (const char *) headerBuffers[i].iov_base,
+					headerBuffers[i].iov_len);
+			}
+
+			pos = entry.body->httpBodyData;
+			end = entry.body->httpBodyData + body->size;
+			const LString::Part *part = body->start;
+			while (part != NULL) {
+				pos = appendData(pos, end, part->data, part->size);
+				part = part->next;
+			}
+			return true;
 		}
 
-		time_t responseDate = parseDate(req->pool, req->appResponse.date, now);
-		if (responseDate == (time_t) -1) {
-			return Entry();
+		stores++;
+
+		if (headerSize > MAX_HEADER_SIZE || body->size > maxBodySize) {
+			return false;
 		}
 
-		time_t expiryDate = determineExpiryDate(req, responseDate, now);
-		if (expiryDate == (time_t) -1) {
-			return Entry();
+		time_t responseDate, expiryDate;
+		unsigned int staleWhileRevalidate, staleIfError;
+		if (!determineDates(req, now, responseDate, expiryDate)) {
+			return false;
 		}
+		determineStaleWindows(req, staleWhileRevalidate, staleIfError);
 
-		const HashedStaticString &cacheKey = req->cacheKey;
-		Entry entry(lookup(cacheKey));
-		if (!entry.valid()) {
-			entry = lookupInvalidOrOldest();
-			entry.header->valid   = true;
-			entry.header->hash    = cacheKey.hash();
-			entry.header->keySize = cacheKey.size();
-			memcpy(entry.body->key, cacheKey.data(), cacheKey.size());
+		if (shared->store(req->cacheKey, responseDate, expiryDate,
+			headerBuffers, nHeaderBuffers, body,
+			lookupValidator(req, ETAG), lookupValidator(req, LAST_MODIFIED),
+			staleWhileRevalidate, staleIfError))
+		{
+			storeSuccesses++;
+			return true;
+		} else {
+			return false;
 		}
-		entry.header->date     = responseDate;
-		entry.body->expiryDate = expiryDate;
-		entry.body->httpHeaderSize = headerSize;
-		entry.body->httpBodySize   = bodySize;
-		storeSuccesses++;
-		return entry;
 	}
 
 
@@ -669,12 +1426,148 @@ public:
 		return req->method != HTTP_GET;
 	}
 
-	// @pre requestAllowsInvalidating()
-	void invalidate(Request *req) {
+	/**
+	 * Checks whether the client's conditional request headers match
+	 * the given (fresh) entry, so that the client can be sent a
+	 * 304 Not Modified response. If-None-Match takes precedence
+	 * over If-Modified-Since (RFC 7232 section 6).
+	 */
+	bool requestIsNotModified(Request *req, const Entry &entry) const {
+		const LString *value = req->headers.lookup(IF_NONE_MATCH);
+		if (value != NULL) {
+			if (entry.body->etagSize == 0 || value->size == 0) {
+				return false;
+			}
+			value = psg_lstr_make_contiguous(value, req->pool);
+			return etagListMatches(StaticString(value->start->data, value->size),
+				StaticString(entry.body->etagData, entry.body->etagSize));
+		}
+
+		value = req->headers.lookup(IF_MODIFIED_SINCE);
+		if (value != NULL && value->size > 0 && entry.body->lastModifiedSize > 0) {
+			time_t ifModifiedSince, lastModified;
+			value = psg_lstr_make_contiguous(value, req->pool);
+			return parseHttpDate(StaticString(value->start->data, value->size), ifModifiedSince)
+				&& parseHttpDate(StaticString(entry.body->lastModifiedData,
+					entry.body->lastModifiedSize), lastModified)
+				&& lastModified <= ifModifiedSince;
+		}
+
+		return false;
+	}
+
+	/**
+	 * Checks whether the given stale entry may be served instead of
+	 * an error response (stale-if-error).
+	 */
+	bool canServeStaleIfError(const Entry &entry, ev_tstamp now) const {
+		return entry.body->expiryDate + (time_t) entry.body->staleIfError > now;
+	}
+
+	/**
+	 * Must be called when the app responded with 304 Not Modified to
+	 * a request that revalidates `req->staleCacheEntry`. Updates the
+	 * freshness of that copy and of the cached entry based on the 304
+	 * response, after which the copy may be served to the client.
+	 *
+	 * @pre req->staleCacheEntry.valid()
+	 */
+	void revalidated(Request *req, ev_tstamp now) {
+		Entry &stale = req->staleCacheEntry;
+		time_t responseDate, expiryDate;
+
+		revalidations++;
+
+		if (!prepareResponseHeadersForStoring(req)) {
+			// The app no longer allows caching this response.
+			remove(req->cacheKey);
+			return;
+		}
+
+		if (req->appResponse.cacheControl != NULL || req->appResponse.expiresHeader != NULL) {
+			if (!determineDates(req, now, responseDate, expiryDate)) {
+				remove(req->cacheKey);
+				return;
+			}
+		} else {
+			// The 304 response doesn't say anything about freshness,
+			// so the stored response's freshness lifetime still applies.
+			responseDate = parseDate(req->pool, req->appResponse.date, now);
+			if (responseDate == (time_t) -1) {
+				responseDate = (time_t) now;
+			}
+			expiryDate = responseDate + std::max<time_t>(
+				stale.body->expiryDate - stale.header->date,
+				MIN_HEURISTIC_FRESHNESS);
+		}
+
+		stale.header->date     = responseDate;
+		stale.body->expiryDate = expiryDate;
+		if (req->appResponse.cacheControl != NULL) {
+			determineStaleWindows(req, stale.body->staleWhileRevalidate,
+				stale.body->staleIfError);
+		}
+
+		StaticString etag(stale.body->etagData, stale.body->etagSize);
+		StaticString lastModified(stale.body->lastModifiedData, stale.body->lastModifiedSize);
+
+		if (shared != NULL) {
+			struct iovec headerBuffer;
+			LString body;
+
+			headerBuffer.iov_base = stale.body->httpHeaderData;
+			headerBuffer.iov_len  = stale.body->httpHeaderSize;
+			psg_lstr_init(&body);
+			psg_lstr_append(&body, req->pool, stale.body->httpBodyData,
+				stale.body->httpBodySize);
+			shared->store(req->cacheKey, responseDate, expiryDate,
+				&headerBuffer, 1, &body, etag, lastModified,
+				stale.body->staleWhileRevalidate, stale.body->staleIfError);
+			return;
+		}
+
 		Entry entry(lookup(req->cacheKey));
 		if (entry.valid()) {
-			entry.header->valid = false;
+			// Only refresh the entry if it's still the version that
+			// was revalidated, and not one that was stored meanwhile.
+			if (StaticString(entry.body->etagData, entry.body->etagSize) == etag
+			 && StaticString(entry.body->lastModifiedData, entry.body->lastModifiedSize) == lastModified)
+			{
+				entry.header->date     = responseDate;
+				entry.body->expiryDate = expiryDate;
+				entry.body->staleWhileRevalidate = stale.body->staleWhileRevalidate;
+				entry.body->staleIfError = stale.body->staleIfError;
+			}
+		} else {
+			entry = insert(req->cacheKey, responseDate, expiryDate,
+				stale.body->httpHeaderSize, stale.body->httpBodySize,
+				etag, lastModified);
+			if (entry.valid()) {
+				memcpy(entry.body->httpHeaderData, stale.body->httpHeaderData,
+					stale.body->httpHeaderSize + stale.body->httpBodySize);
+				entry.body->staleWhileRevalidate = stale.body->staleWhileRevalidate;
+				entry.body->staleIfError = stale.body->staleIfError;
+			}
 		}
+	}
+
+	/**
+	 * Releases the reference that `req->staleCacheEntry` may hold on the
+	 * cached entry data. Must be called when the request is deinitialized.
+	 */
+	void releaseStaleEntry(Request *req) {
+		Entry &stale = req->staleCacheEntry;
+		if (stale.valid() && stale.body->dataBlock != NULL) {
+			MemoryKit::mbuf_block_unref(stale.body->dataBlock);
+			stale.body->dataBlock = NULL;
+		}
+		stale = Entry();
+	}
+
+
+	// @pre requestAllowsInvalidating()
+	void invalidate(Request *req) {
+		remove(req->cacheKey);
 
 		invalidateLocation(req, LOCATION);
 		invalidateLocation(req, CONTENT_LOCATION);
@@ -682,10 +1575,19 @@ public:
 
 
 	string inspect() const {
+		if (shared != NULL) {
+			return shared->inspect();
+		}
+
 		stringstream stream;
-		for (unsigned int i = 0; i < MAX_ENTRIES; i++) {
+		stream << " count=" << count << "/" << maxEntries
+			<< ", memoryUsage=" << memoryUsage << "/" << maxMemory << "\n";
+		for (unsigned int i = 0; headers != NULL && i < maxEntries; i++) {
+			if (!headers[i].valid) {
+				continue;
+			}
 			time_t expiryDate = bodies[i].expiryDate;
-			stream << " #" << i << ": valid=" << headers[i].valid
+			stream << " #" << i << ": referenced=" << headers[i].referenced
 				<< ", hash=" << headers[i].hash
 				<< ", expiryDate=" << expiryDate
 				<< ", keySize=" << headers[i].keySize << ", key=\""
@@ -0,0 +1,572 @@
+/*
+ *  Phusion Passenger - https://www.phusionpassenger.com/
+ *  Copyright (c) 2014-2018 Phusion Holding B.V.
+ *
+ *  "Passenger", "Phusion Passenger" and "Union Station" are registered
+ *  trademarks of Phusion Holding B.V.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#ifndef _PASSENGER_SHARED_RESPONSE_CACHE_H_
+#define _PASSENGER_SHARED_RESPONSE_CACHE_H_
+
+#include <boost/thread.hpp>
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <sys/uio.h>
+#include <time.h>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <sstream>
+#include <oxt/macros.hpp>
+#include <MemoryKit/palloc.h>
+#include <DataStructures/LString.h>
+#include <DataStructures/HashedStaticString.h>
+#include <StaticString.h>
+#include <StrIntTools/StrIntUtils.h>
+
+namespace Passenger {
+
+using namespace std;
+
+
+/**
+ * Storage for turbocache entries that is shared by all Controller threads,
+ * so that a response only has to be fetched from the app (and stored) once
+ * regardless of the number of controller threads. The caching policy
+ * (what may be cached, for how long, statistics) stays in ResponseCache.
+ *
+ * Lookups never lock. The table is set-associative: a key can only live in
+ * one of WAYS slots, determined by its hash. Each slot is protected by a
+ * sequence lock: writers make the sequence number odd while they modify the
+ * slot's metadata, and readers retry-or-miss when the sequence number
+ * changed underneath them. Stored header and body data is immutable once
+ * published. When an entry is replaced or removed, its data block is
+ * retired and only freed after all readers that could still be copying it
+ * have left their read-side critical section (epoch-based reclamation).
+ *
+ * Writers (store, erase, clear) are serialized by a mutex. They are much
+ * rarer than lookups.
+ */
+class SharedResponseCache {
+public:
+	static const unsigned int MAX_KEY_LENGTH = 256;
+	static const unsigned int WAYS = 4;
+
+	/**
+	 * Every thread that performs lookups must register a Reader and use it
+	 * exclusively from that thread.
+	 */
+	struct Reader {
+		/** The epoch at which the reader entered its critical section, or 0. */
+		boost::atomic<boost::uint64_t> activeEpoch;
+		char padding[64 - sizeof(boost::uint64_t)];
+
+		Reader()
+			: activeEpoch(0)
+			{ }
+	};
+
+	/** A private copy of an entry, as returned by lookup(). */
+	struct Snapshot {
+		unsigned int headerSize;
+		unsigned int bodySize;
+		// The ETag and Last-Modified values follow the body in `data`.
+		unsigned short etagSize;
+		unsigned short lastModifiedSize;
+		time_t date;
+		time_t expiryDate;
+		unsigned int staleWhileRevalidate;
+		unsigned int staleIfError;
+		// Allocated from the pool that was passed to lookup().
+		char *data;
+	};
+
+private:
+	struct Slot {
+		boost::atomic<boost::uint32_t> seq;
+		boost::atomic<bool> referenced;
+		bool valid;
+		unsigned short keySize;
+		boost::uint32_t hash;
+		unsigned int headerSize;
+		unsigned int bodySize;
+		unsigned short etagSize;
+		unsigned short lastModifiedSize;
+		time_t date;
+		time_t expiryDate;
+		unsigned int staleWhileRevalidate;
+		unsigned int staleIfError;
+		char *data;
+		char key[MAX_KEY_LENGTH];
+
+		unsigned int dataSize() const {
+			return headerSize + bodySize + etagSize + lastModifiedSize;
+		}
+
+		Slot()
+			: seq(0),
+			  referenced(false),
+			  valid(false),
+			  keySize(0),
+			  hash(0),
+			  headerSize(0),
+			  bodySize(0),
+			  etagSize(0),
+			  lastModifiedSize(0),
+			  date(0),
+			  expiryDate(0),
+			  staleWhileRevalidate(0),
+			  staleIfError(0),
+			  data(NULL)
+			{ }
+	};
+
+	struct RetiredBlock {
+		boost::uint64_t epoch;
+		char *data;
+
+		RetiredBlock(boost::uint64_t e, char *d)
+			: epoch(e),
+			  data(d)
+			{ }
+	};
+
+	const unsigned int nsets;
+	const size_t maxMemory;
+	const unsigned int maxEntrySize;
+	Slot *slots;
+
+	boost::atomic<boost::uint64_t> globalEpoch;
+
+	mutable boost::mutex syncher;
+	vector<Reader *> readers;
+	vector<RetiredBlock> retiredBlocks;
+	unsigned int clockHand;
+	unsigned int count;
+	size_t memoryUsage;
+	unsigned int evictions;
+
+	// Non-copyable.
+	SharedResponseCache(const SharedResponseCache &);
+	SharedResponseCache &operator=(const SharedResponseCache &);
+
+	static unsigned int calculateNumberOfSets(unsigned int maxEntries) {
+		unsigned int result = 1;
+		while (result * WAYS < maxEntries) {
+			result <<= 1;
+		}
+		return result;
+	}
+
+	OXT_FORCE_INLINE
+	Slot *setFor(boost::uint32_t hash) const {
+		return &slots[(hash & (nsets - 1)) * WAYS];
+	}
+
+	Slot *findUnlocked(const HashedStaticString &key) const {
+		Slot *set = setFor(key.hash());
+		for (unsigned int i = 0; i < WAYS; i++) {
+			Slot *slot = &set[i];
+			if (slot->valid
+			 && slot->hash == key.hash()
+			 && key == StaticString(slot->key, slot->keySize))
+			{
+				return slot;
+			}
+		}
+		return NULL;
+	}
+
+	OXT_FORCE_INLINE
+	void beginWrite(Slot *slot) {
+		slot->seq.store(slot->seq.load(boost::memory_order_relaxed) + 1,
+			boost::memory_order_relaxed);
+		boost::atomic_thread_fence(boost::memory_order_release);
+	}
+
+	OXT_FORCE_INLINE
+	void endWrite(Slot *slot) {
+		slot->seq.store(slot->seq.load(boost::memory_order_relaxed) + 1,
+			boost::memory_order_release);
+	}
+
+	void retire(char *data) {
+		// Readers that enter after this increment cannot observe `data`
+		// anymore, because the slot was already updated.
+		boost::uint64_t epoch = globalEpoch.fetch_add(1, boost::memory_order_seq_cst);
+		retiredBlocks.push_back(RetiredBlock(epoch, data));
+	}
+
+	void reclaimUnlocked() {
+		if (retiredBlocks.empty()) {
+			return;
+		}
+
+		// Pairs with the fence in lookup(): either we see that a reader
+		// is active, or that reader sees the slot modifications we made
+		// before retiring the block.
+		boost::atomic_thread_fence(boost::memory_order_seq_cst);
+		boost::uint64_t minActive = globalEpoch.load(boost::memory_order_seq_cst);
+		vector<Reader *>::const_iterator it, end = readers.end();
+		for (it = readers.begin(); it != end; it++) {
+			boost::uint64_t active = (*it)->activeEpoch.load(boost::memory_order_seq_cst);
+			if (active != 0 && active < minActive) {
+				minActive = active;
+			}
+		}
+
+		vector<RetiredBlock>::iterator rit = retiredBlocks.begin();
+		while (rit != retiredBlocks.end()) {
+			if (rit->epoch < minActive) {
+				free(rit->data);
+				rit = retiredBlocks.erase(rit);
+			} else {
+				rit++;
+			}
+		}
+	}
+
+	void eraseUnlocked(Slot *slot) {
+		char *data = slot->data;
+		beginWrite(slot);
+		slot->valid = false;
+		slot->referenced.store(false, boost::memory_order_relaxed);
+		slot->data = NULL;
+		endWrite(slot);
+		memoryUsage -= slot->dataSize();
+		count--;
+		retire(data);
+	}
+
+	/**
+	 * Picks the slot in which to store a new entry: a free one if available,
+	 * otherwise one that has not been hit recently.
+	 */
+	Slot *pickVictimInSet(Slot *set) {
+		for (unsigned int i = 0; i < WAYS; i++) {
+			if (!set[i].valid) {
+				return &set[i];
+			}
+		}
+		for (unsigned int pass = 0; pass < 2; pass++) {
+			for (unsigned int i = 0; i < WAYS; i++) {
+				if (!set[i].referenced.load(boost::memory_order_relaxed)) {
+					return &set[i];
+				}
+				set[i].referenced.store(false, boost::memory_order_relaxed);
+			}
+		}
+		return &set[0];
+	}
+
+	/** CLOCK-based eviction over the whole table, for the memory budget. */
+	void evictOneUnlocked(const Slot *exclude) {
+		unsigned int nslots = nsets * WAYS;
+		assert(count > 0);
+		while (true) {
+			Slot *slot = &slots[clockHand];
+			clockHand = (clockHand + 1) % nslots;
+			if (!slot->valid || slot == exclude) {
+				continue;
+			} else if (slot->referenced.load(boost::memory_order_relaxed)) {
+				slot->referenced.store(false, boost::memory_order_relaxed);
+			} else {
+				eraseUnlocked(slot);
+				evictions++;
+				return;
+			}
+		}
+	}
+
+public:
+	SharedResponseCache(unsigned int maxEntries, size_t _maxMemory,
+		unsigned int _maxEntrySize)
+		: nsets(calculateNumberOfSets(std::max(maxEntries, 1u))),
+		  maxMemory(_maxMemory),
+		  maxEntrySize(_maxEntrySize),
+		  slots(new Slot[nsets * WAYS]),
+		  globalEpoch(1),
+		  clockHand(0),
+		  count(0),
+		  memoryUsage(0),
+		  evictions(0)
+		{ }
+
+	~SharedResponseCache() {
+		unsigned int nslots = nsets * WAYS;
+		for (unsigned int i = 0; i < nslots; i++) {
+			free(slots[i].data);
+		}
+		delete[] slots;
+
+		vector<RetiredBlock>::iterator rit, rend = retiredBlocks.end();
+		for (rit = retiredBlocks.begin(); rit != rend; rit++) {
+			free(rit->data);
+		}
+
+		vector<Reader *>::iterator it, end = readers.end();
+		for (it = readers.begin(); it != end; it++) {
+			delete *it;
+		}
+	}
+
+	Reader *registerReader() {
+		boost::lock_guard<boost::mutex> l(syncher);
+		Reader *reader = new Reader();
+		readers.push_back(reader);
+		return reader;
+	}
+
+	void unregisterReader(Reader *reader) {
+		boost::lock_guard<boost::mutex> l(syncher);
+		vector<Reader *>::iterator it, end = readers.end();
+		for (it = readers.begin(); it != end; it++) {
+			if (*it == reader) {
+				readers.erase(it);
+				delete reader;
+				return;
+			}
+		}
+	}
+
+	/**
+	 * Looks up the entry for the given key and copies it into `pool`.
+	 * Never blocks. Returns false if there is no such entry, or if it was
+	 * being modified concurrently.
+	 */
+	bool lookup(Reader *reader, const HashedStaticString &key, psg_pool_t *pool,
+		Snapshot &result) const
+	{
+		bool found = false;
+
+		reader->activeEpoch.store(globalEpoch.load(boost::memory_order_seq_cst),
+			boost::memory_order_relaxed);
+		boost::atomic_thread_fence(boost::memory_order_seq_cst);
+
+		Slot *set = setFor(key.hash());
+		for (unsigned int i = 0; i < WAYS && !found; i++) {
+			Slot *slot = &set[i];
+			boost::uint32_t seq = slot->seq.load(boost::memory_order_acquire);
+			if ((seq & 1) != 0 || !slot->valid
+			 || slot->hash != key.hash()
+			 || slot->keySize != key.size())
+			{
+				continue;
+			}
+
+			const char *data = slot->data;
+			unsigned int headerSize = slot->headerSize;
+			unsigned int bodySize = slot->bodySize;
+			unsigned short etagSize = slot->etagSize;
+			unsigned short lastModifiedSize = slot->lastModifiedSize;
+			unsigned int dataSize = headerSize + bodySize + etagSize + lastModifiedSize;
+			time_t date = slot->date;
+			time_t expiryDate = slot->expiryDate;
+			unsigned int staleWhileRevalidate = slot->staleWhileRevalidate;
+			unsigned int staleIfError = slot->staleIfError;
+			bool keyMatches = memcmp(slot->key, key.data(), key.size()) == 0;
+
+			boost::atomic_thread_fence(boost::memory_order_acquire);
+			if (slot->seq.load(boost::memory_order_relaxed) != seq) {
+				// Modified concurrently. The metadata we read may be
+				// inconsistent, so treat it as a miss.
+				break;
+			}
+			if (!keyMatches || data == NULL || dataSize > maxEntrySize) {
+				continue;
+			}
+
+			// `data` is immutable and will not be freed while we're
+			// in our critical section, so this is safe even if the
+			// slot is modified from now on.
+			result.headerSize = headerSize;
+			result.bodySize   = bodySize;
+			result.etagSize   = etagSize;
+			result.lastModifiedSize = lastModifiedSize;
+			result.date       = date;
+			result.expiryDate = expiryDate;
+			result.staleWhileRevalidate = staleWhileRevalidate;
+			result.staleIfError = staleIfError;
+			result.data       = (char *) psg_pnalloc(pool, dataSize);
+			memcpy(result.data, data, dataSize);
+			if (!slot->referenced.load(boost::memory_order_relaxed)) {
+				slot->referenced.store(true, boost::memory_order_relaxed);
+			}
+			found = true;
+		}
+
+		reader->activeEpoch.store(0, boost::memory_order_release);
+		return found;
+	}
+
+	/**
+	 * Stores a copy of the given header and body data, and of the given
+	 * validators, under the given key, replacing any existing entry.
+	 * `staleWhileRevalidate` and `staleIfError` are stored along as is.
+	 * Returns whether storing succeeded.
+	 */
+	bool store(const HashedStaticString &key, time_t date, time_t expiryDate,
+		const struct iovec *headerBuffers, unsigned int nHeaderBuffers,
+		const LString *body, const StaticString &etag = StaticString(),
+		const StaticString &lastModified = StaticString(),
+		unsigned int staleWhileRevalidate = 0, unsigned int staleIfError = 0)
+	{
+		unsigned int headerSize = 0;
+		for (unsigned int i = 0; i < nHeaderBuffers; i++) {
+			headerSize += headerBuffers[i].iov_len;
+		}
+		unsigned int dataSize = headerSize + body->size + etag.size() + lastModified.size();
+
+		if (key.size() > MAX_KEY_LENGTH || dataSize > maxMemory || dataSize > maxEntrySize) {
+			return false;
+		}
+
+		// Prepare the immutable data block before publishing it.
+		char *data = (char *) malloc(std::max(dataSize, 1u));
+		if (OXT_UNLIKELY(data == NULL)) {
+			return false;
+		}
+		char *pos = data;
+		const char *end = data + dataSize;
+		for (unsigned int i = 0; i < nHeaderBuffers; i++) {
+			pos = appendData(pos, end, (const char *) headerBuffers[i].iov_base,
+				headerBuffers[i].iov_len);
+		}
+		const LString::Part *part = body->start;
+		while (part != NULL) {
+			pos = appendData(pos, end, part->data, part->size);
+			part = part->next;
+		}
+		pos = appendData(pos, end, etag);
+		pos = appendData(pos, end, lastModified);
+
+		boost::lock_guard<boost::mutex> l(syncher);
+		Slot *slot = findUnlocked(key);
+		if (slot == NULL) {
+			slot = pickVictimInSet(setFor(key.hash()));
+		}
+		if (slot->valid) {
+			if (slot->hash != key.hash()
+			 || key != StaticString(slot->key, slot->keySize))
+			{
+				evictions++;
+			}
+			eraseUnlocked(slot);
+		}
+		while (memoryUsage + dataSize > maxMemory) {
+			evictOneUnlocked(slot);
+		}
+
+		beginWrite(slot);
+		slot->valid      = true;
+		slot->referenced.store(false, boost::memory_order_relaxed);
+		slot->hash       = key.hash();
+		slot->keySize    = key.size();
+		slot->headerSize = headerSize;
+		slot->bodySize   = body->size;
+		slot->etagSize   = etag.size();
+		slot->lastModifiedSize = lastModified.size();
+		slot->date       = date;
+		slot->expiryDate = expiryDate;
+		slot->staleWhileRevalidate = staleWhileRevalidate;
+		slot->staleIfError = staleIfError;
+		slot->data       = data;
+		memcpy(slot->key, key.data(), key.size());
+		endWrite(slot);
+		memoryUsage += dataSize;
+		count++;
+
+		reclaimUnlocked();
+		return true;
+	}
+
+	void erase(const HashedStaticString &key) {
+		boost::lock_guard<boost::mutex> l(syncher);
+		Slot *slot = findUnlocked(key);
+		if (slot != NULL) {
+			eraseUnlocked(slot);
+		}
+		reclaimUnlocked();
+	}
+
+	void clear() {
+		boost::lock_guard<boost::mutex> l(syncher);
+		unsigned int nslots = nsets * WAYS;
+		for (unsigned int i = 0; i < nslots; i++) {
+			if (slots[i].valid) {
+				eraseUnlocked(&slots[i]);
+			}
+		}
+		reclaimUnlocked();
+	}
+
+	unsigned int getMaxEntries() const {
+		return nsets * WAYS;
+	}
+
+	size_t getMaxMemory() const {
+		return maxMemory;
+	}
+
+	unsigned int getCount() const {
+		boost::lock_guard<boost::mutex> l(syncher);
+		return count;
+	}
+
+	size_t getMemoryUsage() const {
+		boost::lock_guard<boost::mutex> l(syncher);
+		return memoryUsage;
+	}
+
+	unsigned int getEvictions() const {
+		boost::lock_guard<boost::mutex> l(syncher);
+		return evictions;
+	}
+
+	string inspect() const {
+		boost::lock_guard<boost::mutex> l(syncher);
+		stringstream stream;
+		unsigned int nslots = nsets * WAYS;
+
+		stream << " shared, count=" << count << "/" << nslots
+			<< ", memoryUsage=" << memoryUsage << "/" << maxMemory
+			<< ", retiredBlocks=" << retiredBlocks.size() << "\n";
+		for (unsigned int i = 0; i < nslots; i++) {
+			const Slot &slot = slots[i];
+			if (!slot.valid) {
+				continue;
+			}
+			time_t expiryDate = slot.expiryDate;
+			stream << " #" << i << ": referenced=" << slot.referenced.load(boost::memory_order_relaxed)
+				<< ", hash=" << slot.hash
+				<< ", expiryDate=" << expiryDate
+				<< ", keySize=" << slot.keySize << ", key=\""
+				<< cEscapeString(StaticString(slot.key, slot.keySize)) << "\"\n";
+		}
+		return stream.str();
+	}
+};
+
+
+} // namespace Passenger
+
+#endif /* _PASSENGER_SHARED_RESPONSE_CACHE_H_ */
@@ -33,6 +33,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <algorithm>
 #include <exception>
 #include <dirent.h>
 #include <sys/types.h>
@@ -87,8 +88,12 @@ private:
 	StringKeyTable<string> preloaderAnnotations;
 	AppPoolOptions options;
 
+	struct ForkRequest;
+
 	// Protects m_lastUsed and pid.
 	mutable boost::mutex simpleFieldSyncher;
+	// Protects pendingForks.
+	boost::mutex pendingForksSyncher;
 	// Protects everything else.
 	mutable boost::mutex syncher;
 
@@ -97,6 +102,18 @@ private:
 	FileDescriptor preloaderStdin;
 	string socketAddress;
 	unsigned long long m_lastUsed;
+	/**
+	 * Whether the preloader may understand the "spawn_batch" command.
+	 * Set to false as soon as it rejects one, and reset when the
+	 * preloader is (re)started.
+	 */
+	bool preloaderSupportsBatchFork;
+
+	/**
+	 * Fork requests of spawn() calls that are waiting for their turn to
+	 * talk to the preloader. See forkThroughPreloader().
+	 */
+	vector<ForkRequest *> pendingForks;
 
 
 	/**
@@ -452,6 +469,7 @@ private:
 				this->preloaderAnnotations = loadAnnotationsFromEnvDumpDir(
 					session.envDumpDir, session.envDumpAnnotationsDirFd);
 			}
+			preloaderSupportsBatchFork = true;
 
 			PipeWatcherPtr watcher = boost::make_shared<PipeWatcher>(
 				stdoutAndErrChannel.first, "output", config.appGroupName,
@@ -465,6 +483,45 @@ private:
 			P_INFO("Preloader for " << options.appRoot <<
 				" started on PID " << pid <<
 				", listening on " << socketAddress);
+
+			UPDATE_TRACE_POINT();
+			prepareForFork(session);
+		}
+	}
+
+	/**
+	 * Tells the preloader that it's about to fork its first process, so
+	 * that it can get its memory into a copy-on-write friendly state
+	 * (warming up the app, collecting garbage, compacting the heap) once,
+	 * instead of every process unsharing those pages on its own later.
+	 *
+	 * This is only an optimization: preloaders that don't support the
+	 * command reply with an error, and any other failure is left for the
+	 * fork command to detect and handle.
+	 */
+	void prepareForFork(HandshakeSession &session) {
+		TRACE_POINT();
+		Json::Value doc;
+		Json::Reader reader;
+		string line;
+
+		doc["command"] = "prepare_for_fork";
+		try {
+			FileDescriptor fd(connectToPreloader(session));
+			writeExact(fd, Json::FastWriter().write(doc), &session.timeoutUsec);
+			line = BufferedIO(fd).readLine(10240, &session.timeoutUsec);
+		} catch (const std::exception &e) {
+			P_WARN("Error preparing the preloader for forking: " << e.what());
+			return;
+		}
+
+		UPDATE_TRACE_POINT();
+		if (!reader.parse(line, doc) || !doc.isObject() || !doc.isMember("result")) {
+			P_WARN("The preloader sent an invalid response to the"
+				" prepare_for_fork command: " << line);
+		} else if (doc["result"].asString() != "ok") {
+			P_DEBUG("The preloader did not prepare for forking: "
+				<< doc.get("message", "unknown error").asString());
 		}
 	}
 
@@ -531,6 +588,20 @@ private:
 			{ }
 	};
 
+	struct ForkRequest {
+		HandshakeSession *session;
+		JourneyStep *stepToMarkAsErrored;
+		ForkResult result;
+		boost::shared_ptr<SpawnException> exception;
+		bool finished;
+
+		ForkRequest(HandshakeSession *_session, JourneyStep *_stepToMarkAsErrored)
+			: session(_session),
+			  stepToMarkAsErrored(_stepToMarkAsErrored),
+			  finished(false)
+			{ }
+	};
+
 	struct PreloaderCrashed {
 		SystemException *systemException;
 		IOException *ioException;
@@ -983,6 +1054,294 @@ private:
 		throw e.finalize();
 	}
 
+	/**
+	 * Asks the preloader to fork a process for the given session.
+	 *
+	 * spawn() calls for the same preloader may run concurrently, e.g. when a
+	 * group spawns multiple processes in parallel. Their fork requests are
+	 * batched: every caller queues its request in `pendingForks` and then
+	 * waits for its turn to talk to the preloader. Whoever gets that turn
+	 * forks all requests that have been queued by then with a single
+	 * command, so the callers that come after it usually find their
+	 * process already forked.
+	 */
+	ForkResult forkThroughPreloader(HandshakeSession &session,
+		JourneyStep &stepToMarkAsErrored)
+	{
+		TRACE_POINT();
+		ForkRequest request(&session, &stepToMarkAsErrored);
+		vector<ForkRequest *> batch;
+
+		{
+			boost::lock_guard<boost::mutex> l(pendingForksSyncher);
+			pendingForks.push_back(&request);
+		}
+
+		{
+			boost::lock_guard<boost::mutex> l(syncher);
+			{
+				boost::lock_guard<boost::mutex> l2(pendingForksSyncher);
+				batch.swap(pendingForks);
+			}
+			if (!batch.empty()) {
+				try {
+					invokeForkCommands(batch);
+				} catch (...) {
+					// We've been interrupted. Put the other callers'
+					// requests back so that one of them forks them.
+					boost::lock_guard<boost::mutex> l2(pendingForksSyncher);
+					vector<ForkRequest *>::const_iterator it, end = batch.end();
+					for (it = batch.begin(); it != end; it++) {
+						if (*it != &request && !(*it)->finished) {
+							pendingForks.push_back(*it);
+						}
+					}
+					throw;
+				}
+			}
+		}
+
+		assert(request.finished);
+		if (request.exception != NULL) {
+			throw *request.exception;
+		} else {
+			return request.result;
+		}
+	}
+
+	/**
+	 * Forks a process for every request in the batch and marks them as
+	 * finished, either with a result or with an exception. Never throws.
+	 * Batches of multiple requests are forked with a single "spawn_batch"
+	 * command if the preloader supports it; otherwise, and if that fails,
+	 * the requests are forked one by one with the "spawn" command.
+	 */
+	void invokeForkCommands(const vector<ForkRequest *> &batch) {
+		TRACE_POINT();
+		if (batch.size() > 1 && preloaderSupportsBatchFork) {
+			P_DEBUG("Forking " << batch.size() << " processes in one batch: appRoot="
+				<< options.appRoot);
+			invokeBatchForkCommand(batch);
+		}
+
+		vector<ForkRequest *>::const_iterator it, end = batch.end();
+		for (it = batch.begin(); it != end; it++) {
+			ForkRequest *request = *it;
+			if (request->finished) {
+				continue;
+			}
+
+			UPDATE_TRACE_POINT();
+			try {
+				request->result = invokeForkCommand(*request->session,
+					*request->stepToMarkAsErrored);
+			} catch (const SpawnException &e) {
+				request->exception = boost::make_shared<SpawnException>(e);
+			} catch (const std::exception &originalException) {
+				request->session->journey.setStepErrored(
+					*request->stepToMarkAsErrored, true);
+				SpawnException e(originalException, request->session->journey,
+					request->session->config);
+				request->exception = boost::make_shared<SpawnException>(
+					e.finalize());
+			}
+			request->finished = true;
+		}
+	}
+
+	/**
+	 * Sends a single "spawn_batch" command for all requests in the batch.
+	 * Requests for which the preloader forked a process are processed and
+	 * marked as finished. If the preloader could not be connected to, or if
+	 * it rejected the command, then no request is marked as finished, so
+	 * that the caller falls back to the "spawn" command.
+	 *
+	 * Once the command has been sent, the preloader may already have forked
+	 * some processes, so falling back would leak them. Any error after that
+	 * point stops the preloader (the next spawn restarts it) and fails all
+	 * requests in the batch.
+	 */
+	void invokeBatchForkCommand(const vector<ForkRequest *> &batch) {
+		TRACE_POINT();
+		vector<StdChannelsAsyncOpenStatePtr> stdChannelsAsyncOpenStates;
+		Json::Value doc;
+		Json::Reader reader;
+		string line;
+		unsigned int i;
+
+		stdChannelsAsyncOpenStates.reserve(batch.size());
+		doc["command"] = "spawn_batch";
+		doc["work_dirs"] = Json::Value(Json::arrayValue);
+		for (i = 0; i < batch.size(); i++) {
+			HandshakeSession &session = *batch[i]->session;
+			P_ASSERT_EQ(session.journey.getStepInfo(SPAWNING_KIT_PREPARATION).state,
+				STEP_PERFORMED);
+			doc["work_dirs"].append(session.workDir->getPath());
+		}
+
+		// The batch is only sent once, so talking to the preloader must
+		// not take longer than the shortest timeout in the batch.
+		unsigned long long timeout = batch[0]->session->timeoutUsec;
+		for (i = 1; i < batch.size(); i++) {
+			timeout = std::min(timeout, batch[i]->session->timeoutUsec);
+		}
+
+		FileDescriptor fd;
+		try {
+			for (i = 0; i < batch.size(); i++) {
+				stdChannelsAsyncOpenStates.push_back(
+					openStdChannelsFifosAsynchronously(*batch[i]->session));
+			}
+			fd = connectToPreloader(*batch[0]->session);
+		} catch (const std::exception &e) {
+			P_WARN("Error connecting to the preloader for a batched fork command"
+				" (falling back to forking one process at a time): " << e.what());
+			return;
+		}
+
+		UPDATE_TRACE_POINT();
+		JourneyStep step = SPAWNING_KIT_SEND_COMMAND_TO_PRELOADER;
+		try {
+			writeExact(fd, Json::FastWriter().write(doc), &timeout);
+			step = SPAWNING_KIT_READ_RESPONSE_FROM_PRELOADER;
+			line = BufferedIO(fd).readLine(10240, &timeout);
+		} catch (const std::exception &e) {
+			failBatch(batch, step, e);
+			return;
+		}
+
+		UPDATE_TRACE_POINT();
+		if (!reader.parse(line, doc) || !validateBatchForkCommandResponse(doc)) {
+			failBatch(batch, SPAWNING_KIT_PARSE_RESPONSE_FROM_PRELOADER,
+				RuntimeException("The preloader sent an invalid response to a"
+					" batched fork command: " + line));
+			return;
+		} else if (doc["result"].asString() == "error") {
+			P_DEBUG("The preloader does not support batched fork commands: "
+				<< doc["message"].asString());
+			preloaderSupportsBatchFork = false;
+			return;
+		}
+
+		UPDATE_TRACE_POINT();
+		const Json::Value &pids = doc["pids"];
+		for (i = 0; i < batch.size(); i++) {
+			ForkRequest *request = batch[i];
+			HandshakeSession &session = *request->session;
+			Json::Value forkDoc;
+
+			session.journey.setStepPerformed(SPAWNING_KIT_CONNECT_TO_PRELOADER, true);
+			session.journey.setStepPerformed(SPAWNING_KIT_SEND_COMMAND_TO_PRELOADER, true);
+			session.journey.setStepPerformed(SPAWNING_KIT_READ_RESPONSE_FROM_PRELOADER, true);
+			session.journey.setStepPerformed(SPAWNING_KIT_PARSE_RESPONSE_FROM_PRELOADER, true);
+			session.journey.setStepInProgress(SPAWNING_KIT_PROCESS_RESPONSE_FROM_PRELOADER);
+			*request->stepToMarkAsErrored = SPAWNING_KIT_PROCESS_RESPONSE_FROM_PRELOADER;
+
+			if (i < pids.size()) {
+				forkDoc["result"] = "ok";
+				forkDoc["pid"] = pids[i];
+			} else {
+				// The preloader failed to fork the rest of the batch.
+				forkDoc["result"] = "error";
+				forkDoc["message"] = doc.get("message",
+					"The preloader did not fork a process for this request").asString();
+			}
+
+			try {
+				request->result = handleForkCommandResponse(session,
+					stdChannelsAsyncOpenStates[i], forkDoc);
+			} catch (const SpawnException &e) {
+				request->exception = boost::make_shared<SpawnException>(e);
+			} catch (const std::exception &originalException) {
+				session.journey.setStepErrored(SPAWNING_KIT_PROCESS_RESPONSE_FROM_PRELOADER,
+					true);
+				SpawnException e(originalException, session.journey, session.config);
+				request->exception = boost::make_shared<SpawnException>(e.finalize());
+			}
+			request->finished = true;
+		}
+	}
+
+	/**
+	 * Handles an error that occurred after a "spawn_batch" command was sent.
+	 * We cannot tell which processes the preloader has already forked, so
+	 * we stop it, just like when a single fork command fails, and fail all
+	 * requests in the batch. Never throws.
+	 */
+	void failBatch(const vector<ForkRequest *> &batch, JourneyStep step,
+		const std::exception &originalException)
+	{
+		TRACE_POINT();
+		P_WARN("Error sending a batched fork command to the preloader,"
+			" stopping it: " << originalException.what());
+
+		try {
+			stopPreloader();
+		} catch (const std::exception &e) {
+			P_WARN("Error stopping the preloader: " << e.what());
+		}
+
+		UPDATE_TRACE_POINT();
+		vector<ForkRequest *>::const_iterator it, end = batch.end();
+		for (it = batch.begin(); it != end; it++) {
+			ForkRequest *request = *it;
+			HandshakeSession &session = *request->session;
+
+			session.journey.setStepPerformed(SPAWNING_KIT_CONNECT_TO_PRELOADER, true);
+			if (step != SPAWNING_KIT_SEND_COMMAND_TO_PRELOADER) {
+				session.journey.setStepPerformed(SPAWNING_KIT_SEND_COMMAND_TO_PRELOADER, true);
+			}
+			if (step == SPAWNING_KIT_PARSE_RESPONSE_FROM_PRELOADER) {
+				session.journey.setStepPerformed(SPAWNING_KIT_READ_RESPONSE_FROM_PRELOADER, true);
+			}
+			session.journey.setStepErrored(step, true);
+			*request->stepToMarkAsErrored = step;
+
+			SpawnException e(originalException, session.journey, session.config);
+			addPreloaderEnvDumps(e);
+			e.setSummary(StaticString("An error occurred while communicating with"
+				" the application preloader: ") + originalException.what());
+			e.setProblemDescriptionHTML(
+				"<p>The " PROGRAM_NAME " application server tried"
+				" to start the web application by communicating with a"
+				" helper process that we call a \"preloader\". However,"
+				" the following error occurred while doing so. "
+				SHORT_PROGRAM_NAME " has stopped the preloader and will"
+				" restart it the next time it spawns a process.</p>"
+				"<pre>" + escapeHTML(originalException.what()) + "</pre>");
+			request->exception = boost::make_shared<SpawnException>(e.finalize());
+			request->finished = true;
+		}
+	}
+
+	bool validateBatchForkCommandResponse(const Json::Value &doc) const {
+		if (!doc.isObject()) {
+			return false;
+		}
+		if (!doc.isMember("result") || !doc["result"].isString()) {
+			return false;
+		}
+		if (doc.isMember("message") && !doc["message"].isString()) {
+			return false;
+		}
+		if (doc["result"].asString() == "ok") {
+			if (!doc.isMember("pids") || !doc["pids"].isArray()) {
+				return false;
+			}
+			Json::Value::const_iterator it, end = doc["pids"].end();
+			for (it = doc["pids"].begin(); it != end; it++) {
+				if (!(*it).isInt()) {
+					return false;
+				}
+			}
+			return true;
+		} else if (doc["result"].asString() == "error") {
+			return doc.isMember("message");
+		} else {
+			return false;
+		}
+	}
+
 	void createStdChannelFifos(const HandshakeSession &session) {
 		const string &workDir = session.workDir->getPath();
 		createFifo(session, workDir + "/stdin");
@@ -1260,6 +1619,7 @@ public:
 		options    = _options.copyAndPersist();
 		pid        = -1;
 		m_lastUsed = SystemTime::getUsec();
+		preloaderSupportsBatchFork = true;
 	}
 
 	virtual ~SmartSpawner() {
@@ -1280,10 +1640,16 @@ public:
 			m_lastUsed = SystemTime::getUsec();
 		}
 		UPDATE_TRACE_POINT();
-		boost::lock_guard<boost::mutex> l(syncher);
-		if (!preloaderStarted()) {
-			UPDATE_TRACE_POINT();
-			startPreloader();
+		// The lock is only held while talking to the preloader. Preparing
+		// the work directory and the handshake with the forked process
+		// don't involve the preloader, so multiple spawn() calls can do
+		// those in parallel, and have their forks batched.
+		{
+			boost::lock_guard<boost::mutex> l(syncher);
+			if (!preloaderStarted()) {
+				UPDATE_TRACE_POINT();
+				startPreloader();
+			}
 		}
 
 		UPDATE_TRACE_POINT();
@@ -1295,6 +1661,7 @@ public:
 			Journey journey(SPAWN_THROUGH_PRELOADER, true);
 			journey.setStepErrored(SPAWNING_KIT_PREPARATION, true);
 			SpawnException e(originalException, journey, &config);
+			boost::lock_guard<boost::mutex> l(syncher);
 			addPreloaderEnvDumps(e);
 			throw e.finalize();
 		}
@@ -1313,7 +1680,7 @@ public:
 			session.journey.setStepPerformed(SPAWNING_KIT_PREPARATION, true);
 
 			UPDATE_TRACE_POINT();
-			ForkResult forkResult = invokeForkCommand(session, stepToMarkAsErrored);
+			ForkResult forkResult = forkThroughPreloader(session, stepToMarkAsErrored);
 
 			UPDATE_TRACE_POINT();
 			ScopeGuard guard(boost::bind(nonInterruptableKillAndWaitpid, forkResult.pid));
@@ -1333,12 +1700,14 @@ public:
 				", pid=" << forkResult.pid);
 			return session.result;
 		} catch (SpawnException &e) {
+			boost::lock_guard<boost::mutex> l(syncher);
 			addPreloaderEnvDumps(e);
 			throw e;
 		} catch (const std::exception &originalException) {
 			session.journey.setStepErrored(stepToMarkAsErrored, true);
 			SpawnException e(originalException, session.journey,
 				&config);
+			boost::lock_guard<boost::mutex> l(syncher);
 			addPreloaderEnvDumps(e);
 			throw e.finalize();
 		}
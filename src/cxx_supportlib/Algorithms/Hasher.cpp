@@ -28,6 +28,10 @@
 
 #include <Algorithms/Hasher.h>
 
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
+
 namespace Passenger {
 
 void
@@ -42,6 +46,58 @@ JenkinsHash::update(const char *data, unsigned int size) {
 	}
 }
 
+#define JENKINS_HASH_UPDATE(hash, c) \
+	do { \
+		hash += (c); \
+		hash += (hash << 10); \
+		hash ^= (hash >> 6); \
+	} while (false)
+
+void
+JenkinsHash::updateLowerCase(const char *data, char *output, unsigned int size) {
+	const char *end = data + size;
+	boost::uint32_t h = hash;
+
+	#ifdef __SSE2__
+		// SSE2 is always available on x86_64, so no runtime dispatch is needed.
+		// Lowercase 16 bytes at a time, then hash them while they're still hot.
+		// Bytes >= 0x80 are negative as signed chars and are left untouched.
+		const __m128i lowerBound = _mm_set1_epi8('A' - 1);
+		const __m128i upperBound = _mm_set1_epi8('Z' + 1);
+		const __m128i caseBit = _mm_set1_epi8(0x20);
+
+		while (end - data >= 16) {
+			__m128i input = _mm_loadu_si128((const __m128i *) data);
+			__m128i isUpper = _mm_and_si128(
+				_mm_cmpgt_epi8(input, lowerBound),
+				_mm_cmplt_epi8(input, upperBound));
+			_mm_storeu_si128((__m128i *) output,
+				_mm_or_si128(input, _mm_and_si128(isUpper, caseBit)));
+
+			for (unsigned int i = 0; i < 16; i++) {
+				JENKINS_HASH_UPDATE(h, output[i]);
+			}
+			data += 16;
+			output += 16;
+		}
+	#endif
+
+	while (data < end) {
+		char c = *data;
+		if (c >= 'A' && c <= 'Z') {
+			c |= 0x20;
+		}
+		*output = c;
+		JENKINS_HASH_UPDATE(h, c);
+		data++;
+		output++;
+	}
+
+	hash = h;
+}
+
+#undef JENKINS_HASH_UPDATE
+
 boost::uint32_t
 JenkinsHash::finalize() {
 	hash += (hash << 3);
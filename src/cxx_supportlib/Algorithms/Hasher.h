@@ -39,13 +39,65 @@ struct JenkinsHash {
 
 	boost::uint32_t hash;
 
+private:
+	// C++11 constexpr functions may only consist of a single return
+	// statement, so every step of the algorithm is a separate function.
+
+	static constexpr boost::uint32_t constantMix2(boost::uint32_t h) {
+		return h ^ (h >> 6);
+	}
+
+	static constexpr boost::uint32_t constantMix1(boost::uint32_t h) {
+		return constantMix2(h + (h << 10));
+	}
+
+	static constexpr boost::uint32_t constantUpdate(boost::uint32_t h,
+		const char *data, unsigned int size)
+	{
+		return (size == 0)
+			? h
+			: constantUpdate(constantMix1(h + *data), data + 1, size - 1);
+	}
+
+	static constexpr boost::uint32_t constantFinalize2(boost::uint32_t h) {
+		return h + (h << 15);
+	}
+
+	static constexpr boost::uint32_t constantFinalize1(boost::uint32_t h) {
+		return constantFinalize2(h ^ (h >> 11));
+	}
+
+	static constexpr boost::uint32_t constantFinalize(boost::uint32_t h) {
+		return constantFinalize1(h + (h << 3));
+	}
+
+public:
+
 	JenkinsHash()
 		: hash(0)
 		{ }
 
 	void update(const char *data, unsigned int size);
+
+	/**
+	 * Converts `data` to lowercase, writes the result to `output` and
+	 * updates the hash with the lowercased data. Equivalent to calling
+	 * convertLowerCase() followed by update(output, size), but reads the
+	 * input only once.
+	 */
+	void updateLowerCase(const char *data, char *output, unsigned int size);
+
 	boost::uint32_t finalize();
 
+	/**
+	 * Equivalent to calling update(data, size) on a fresh hasher followed by
+	 * finalize(), but usable in constant expressions, so that the hashes of
+	 * string literals can be computed at compile time.
+	 */
+	static constexpr boost::uint32_t hashConstant(const char *data, unsigned int size) {
+		return constantFinalize(constantUpdate(0, data, size));
+	}
+
 	void reset() {
 		hash = 0;
 	}
@@ -37,6 +37,9 @@
  */
 
 #define AGENT_EXE "PassengerAgent"
+#define APP_CONNECTION_IDLE_TIMEOUT 60
+#define APP_CONNECTION_POOL_SHARDS 8
+#define APP_CONNECTION_PREWARM_LIMIT 4
 #define DEB_APACHE_MODULE_PACKAGE "libapache2-mod-passenger"
 #define DEB_DEV_PACKAGE "passenger-dev"
 #define DEB_MAIN_PACKAGE "passenger"
@@ -53,6 +56,7 @@
 #define DEFAULT_FILE_BUFFERED_CHANNEL_THRESHOLD 131072
 #define DEFAULT_HTTP_SERVER_LISTEN_ADDRESS "tcp://127.0.0.1:3000"
 #define DEFAULT_INTEGRATION_MODE "standalone"
+#define DEFAULT_IO_URING_RECV_BUFFERS 256
 #define DEFAULT_LOG_LEVEL 3
 #define DEFAULT_LOG_LEVEL_NAME "notice"
 #define DEFAULT_LVE_MIN_UID 500
@@ -63,14 +67,21 @@
 #define DEFAULT_NODEJS "node"
 #define DEFAULT_POOL_IDLE_TIME 300
 #define DEFAULT_PYTHON "python"
+#define DEFAULT_REQUEST_BODY_SPLICE_THRESHOLD 131072
 #define DEFAULT_RESPONSE_BUFFER_HIGH_WATERMARK 134217728
 #define DEFAULT_RUBY "ruby"
+#define DEFAULT_SCALE_DOWN_DELAY 60
 #define DEFAULT_SOCKET_BACKLOG 2048
+#define DEFAULT_SPAWN_CONCURRENCY 1
 #define DEFAULT_SPAWN_METHOD "smart"
 #define DEFAULT_START_TIMEOUT 90000
 #define DEFAULT_STAT_THROTTLE_RATE 10
 #define DEFAULT_STICKY_SESSIONS_COOKIE_ATTRIBUTES "SameSite=Lax; Secure;"
 #define DEFAULT_STICKY_SESSIONS_COOKIE_NAME "_passenger_route"
+#define DEFAULT_TURBOCACHE_COALESCING_TIMEOUT 5000
+#define DEFAULT_TURBOCACHE_MAX_BODY_SIZE 524288
+#define DEFAULT_TURBOCACHE_MAX_ENTRIES 1024
+#define DEFAULT_TURBOCACHE_MAX_MEMORY 16777216
 #define DEFAULT_WEB_APP_USER "nobody"
 #define ENTERPRISE_URL "https://www.phusionpassenger.com/features#premium-features"
 #define FEEDBACK_FD 3
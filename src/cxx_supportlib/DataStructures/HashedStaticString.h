@@ -29,9 +29,18 @@
 #include <boost/cstdint.hpp>
 #include <oxt/macros.hpp>
 #include <string>
+#include <type_traits>
 #include <StaticString.h>
 #include <Algorithms/Hasher.h>
 
+/**
+ * Constructs a HashedStaticString from a string literal. The hash is
+ * computed at compile time.
+ */
+#define P_HASHED_STATIC_STRING(x) Passenger::HashedStaticString(x, sizeof(x) - 1, \
+	std::integral_constant<boost::uint32_t, \
+		Passenger::Hasher::hashConstant(x, sizeof(x) - 1)>::value)
+
 namespace Passenger {
 
 using namespace std;
@@ -0,0 +1,157 @@
+/*
+ *  Phusion Passenger - https://www.phusionpassenger.com/
+ *  Copyright (c) 2018 Phusion Holding B.V.
+ *
+ *  "Passenger", "Phusion Passenger" and "Union Station" are registered
+ *  trademarks of Phusion Holding B.V.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#ifndef _PASSENGER_DATA_STRUCTURES_INDEXED_MIN_HEAP_H_
+#define _PASSENGER_DATA_STRUCTURES_INDEXED_MIN_HEAP_H_
+
+#include <boost/container/vector.hpp>
+#include <cassert>
+
+namespace Passenger {
+
+
+/**
+ * A binary min-heap over the items 0..size()-1, each of which has an integer
+ * key. Unlike std::priority_queue, the key of any item can be changed in
+ * O(log n) because the heap keeps track of where each item is.
+ *
+ * Ties are broken by item number, so `top()` returns the lowest-numbered item
+ * among those with the lowest key. That is the same item that a linear scan
+ * for the first minimum would find.
+ */
+class IndexedMinHeap {
+private:
+	boost::container::vector<int> keys;
+	/** The heap itself, containing item numbers. */
+	boost::container::vector<unsigned int> heap;
+	/** For every item, its position in `heap`. */
+	boost::container::vector<unsigned int> positions;
+
+	bool less(unsigned int a, unsigned int b) const {
+		return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);
+	}
+
+	void place(unsigned int pos, unsigned int item) {
+		heap[pos] = item;
+		positions[item] = pos;
+	}
+
+	void siftUp(unsigned int pos) {
+		unsigned int item = heap[pos];
+		while (pos > 0) {
+			unsigned int parent = (pos - 1) / 2;
+			if (!less(item, heap[parent])) {
+				break;
+			}
+			place(pos, heap[parent]);
+			pos = parent;
+		}
+		place(pos, item);
+	}
+
+	void siftDown(unsigned int pos) {
+		unsigned int item = heap[pos];
+		unsigned int size = heap.size();
+		while (true) {
+			unsigned int child = 2 * pos + 1;
+			if (child >= size) {
+				break;
+			}
+			if (child + 1 < size && less(heap[child + 1], heap[child])) {
+				child++;
+			}
+			if (!less(heap[child], item)) {
+				break;
+			}
+			place(pos, heap[child]);
+			pos = child;
+		}
+		place(pos, item);
+	}
+
+public:
+	unsigned int size() const {
+		return keys.size();
+	}
+
+	bool empty() const {
+		return keys.empty();
+	}
+
+	void clear() {
+		keys.clear();
+		heap.clear();
+		positions.clear();
+	}
+
+	void shrink_to_fit() {
+		keys.shrink_to_fit();
+		heap.shrink_to_fit();
+		positions.shrink_to_fit();
+	}
+
+	/**
+	 * Adds a new item with the given key. The item's number is the
+	 * value of `size()` before this call.
+	 */
+	void push(int key) {
+		unsigned int item = keys.size();
+		keys.push_back(key);
+		heap.push_back(item);
+		positions.push_back(item);
+		siftUp(item);
+	}
+
+	int get(unsigned int item) const {
+		assert(item < keys.size());
+		return keys[item];
+	}
+
+	void set(unsigned int item, int key) {
+		assert(item < keys.size());
+		int oldKey = keys[item];
+		keys[item] = key;
+		if (key < oldKey) {
+			siftUp(positions[item]);
+		} else if (key > oldKey) {
+			siftDown(positions[item]);
+		}
+	}
+
+	/**
+	 * Returns the item with the lowest key.
+	 *
+	 * @pre !empty()
+	 */
+	unsigned int top() const {
+		assert(!empty());
+		return heap[0];
+	}
+};
+
+
+} // namespace Passenger
+
+#endif /* _PASSENGER_DATA_STRUCTURES_INDEXED_MIN_HEAP_H_ */
@@ -292,7 +292,7 @@ resolveHostname(const string &hostname, unsigned int port, bool shuffle) {
 
 int
 createServer(const StaticString &address, unsigned int backlogSize, bool autoDelete,
-	const char *file, unsigned int line)
+	const char *file, unsigned int line, bool reusePort)
 {
 	TRACE_POINT();
 	switch (getSocketAddressType(address)) {
@@ -304,7 +304,7 @@ createServer(const StaticString &address, unsigned int backlogSize, bool autoDel
 		unsigned short port;
 
 		parseTcpSocketAddress(address, host, port);
-		return createTcpServer(host.c_str(), port, backlogSize, file, line);
+		return createTcpServer(host.c_str(), port, backlogSize, file, line, reusePort);
 	}
 	default:
 		throw ArgumentException(string("Unknown address type for '") + address + "'");
@@ -370,7 +370,7 @@ createUnixServer(const StaticString &filename, unsigned int backlogSize, bool au
 
 int
 createTcpServer(const char *address, unsigned short port, unsigned int backlogSize,
-	const char *file, unsigned int line)
+	const char *file, unsigned int line, bool reusePort)
 {
 	union {
 		struct sockaddr_in v4;
@@ -423,6 +423,18 @@ createTcpServer(const char *address, unsigned short port, unsigned int backlogSi
 	// Ignore SO_REUSEADDR error, it's not fatal.
 
 	FdGuard guard(fd, file, line, true);
+	if (reusePort) {
+		#ifdef SO_REUSEPORT
+			if (syscalls::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT,
+				&optval, sizeof(optval)) == -1)
+			{
+				int e = errno;
+				throw SystemException("Cannot set SO_REUSEPORT on a TCP socket", e);
+			}
+		#else
+			throw SystemException("Cannot set SO_REUSEPORT on a TCP socket", ENOTSUP);
+		#endif
+	}
 	if (family == AF_INET) {
 		ret = syscalls::bind(fd, (const struct sockaddr *) &addr.v4, sizeof(struct sockaddr_in));
 	} else {
@@ -150,6 +150,8 @@ vector<string> resolveHostname(const string &hostname,
  * @param file The name of the source file that called this function,
  *             for file descriptor logging purposes.
  * @param line The line in the source file that called this function.
+ * @param reusePort Whether to set SO_REUSEPORT on the socket. Only
+ *                  applicable to TCP addresses.
  * @return The file descriptor of the newly created server socket.
  * @throws ArgumentException The given address cannot be parsed.
  * @throws RuntimeException Something went wrong.
@@ -161,7 +163,8 @@ int createServer(const StaticString &address,
 	unsigned int backlogSize = 0,
 	bool autoDelete = true,
 	const char *file = __FILE__,
-	unsigned int line = __LINE__);
+	unsigned int line = __LINE__,
+	bool reusePort = false);
 
 /**
  * Create a new Unix server socket which is bounded to <tt>filename</tt>.
@@ -197,6 +200,10 @@ int createUnixServer(const StaticString &filename,
  * @param file The name of the source file that called this function,
  *             for file descriptor logging purposes.
  * @param line The line in the source file that called this function.
+ * @param reusePort Whether to set SO_REUSEPORT on the socket, so that
+ *                  multiple sockets can listen on the same address and
+ *                  port. On Linux, the kernel load balances incoming
+ *                  connections over those sockets.
  * @return The file descriptor of the newly created server socket.
  * @throws SystemException Something went wrong while creating the server socket.
  * @throws ArgumentException The given address cannot be parsed.
@@ -207,7 +214,8 @@ int createTcpServer(const char *address = "0.0.0.0",
 	unsigned short port = 0,
 	unsigned int backlogSize = 0,
 	const char *file = __FILE__,
-	unsigned int line = __LINE__);
+	unsigned int line = __LINE__,
+	bool reusePort = false);
 
 /**
  * Connect to a server at the given address in a blocking manner.
@@ -0,0 +1,160 @@
+/*
+ *  Phusion Passenger - https://www.phusionpassenger.com/
+ *  Copyright (c) 2018 Phusion Holding B.V.
+ *
+ *  "Passenger", "Phusion Passenger" and "Union Station" are registered
+ *  trademarks of Phusion Holding B.V.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#ifndef _PASSENGER_LOGGING_KIT_ASYNC_WRITER_H_
+#define _PASSENGER_LOGGING_KIT_ASYNC_WRITER_H_
+
+#include <vector>
+#include <pthread.h>
+
+#include <boost/noncopyable.hpp>
+#include <boost/thread.hpp>
+#include <boost/atomic.hpp>
+#include <oxt/thread.hpp>
+#include <LoggingKit/Forward.h>
+#include <SystemTools/SystemTime.h>
+
+namespace Passenger {
+namespace LoggingKit {
+
+using namespace std;
+
+
+/**
+ * Writes log entries to their target file descriptors in the background,
+ * so that threads which log a lot (e.g. the Core controller threads when
+ * an app is chatty at debug level) do not stall on write().
+ *
+ * Every thread that logs gets its own single-producer/single-consumer
+ * ring buffer, which it appends records to without taking any locks.
+ * A dedicated writer thread drains all rings and coalesces consecutive
+ * records that go to the same file descriptor into a single writev().
+ *
+ * Log entries from a single thread are written in order. Entries from
+ * different threads may be reordered relative to each other by at most
+ * the time it takes for the writer thread to make one pass over all rings.
+ *
+ * When a thread's ring is full, the AsyncOverflowPolicy passed to `write()`
+ * decides whether the thread waits for the writer thread, or whether the
+ * entry is dropped.
+ *
+ * LoggingKit writes entries at level ERROR and CRIT with `writeNow()`, so
+ * that they are not lost when the process aborts right after logging them.
+ *
+ * In a child process created with fork(), the writer thread does not exist,
+ * so all writes fall back to synchronous write() calls.
+ */
+class AsyncWriter: public boost::noncopyable {
+private:
+	struct RecordHeader {
+		/** The target file descriptor, or -1 for a padding record. */
+		int fd;
+		unsigned int size;
+	};
+
+	struct Ring {
+		char *buffer;
+		unsigned int capacity;
+		boost::atomic<bool> abandoned;
+		// `head` is only written by the owning thread and `tail` only by
+		// the writer thread. Keep them on separate cache lines.
+		char padding1[64];
+		boost::atomic<unsigned long long> head;
+		char padding2[64];
+		boost::atomic<unsigned long long> tail;
+
+		Ring(unsigned int capacity);
+		~Ring();
+
+		OXT_FORCE_INLINE
+		unsigned int freeSpace() const {
+			return capacity - (unsigned int) (head.load(boost::memory_order_relaxed)
+				- tail.load(boost::memory_order_acquire));
+		}
+	};
+
+	const unsigned int ringSize;
+	const unsigned int forkGeneration;
+	pthread_key_t ringKey;
+
+	mutable boost::mutex syncher;
+	boost::condition_variable dataAvailableCond;
+	boost::condition_variable spaceAvailableCond;
+	vector<Ring *> rings;
+	vector<Ring *> drainList;
+	bool shuttingDown;
+	bool threadExited;
+	oxt::thread *thread;
+
+	boost::atomic<bool> writerSleeping;
+	boost::atomic<unsigned int> blockedThreads;
+	boost::atomic<unsigned long long> droppedEntries;
+	boost::atomic<unsigned long long> unreportedDroppedEntries;
+	boost::atomic<int> lastDroppedFd;
+	MonotonicTimeUsec lastDropReportTime;
+
+	static void onThreadExit(void *ring);
+	static unsigned int alignRecordSize(unsigned int size);
+
+	Ring *getRingForCurrentThread();
+	void drop(int fd, AsyncOverflowPolicy policy);
+	bool waitForSpace(Ring *ring, unsigned int size);
+	void wakeUpWriterThread();
+
+	void threadMain();
+	bool drainRing(Ring *ring);
+	void reportDroppedEntries(bool force);
+	void freeAbandonedRings();
+	bool hasPendingData() const;
+
+public:
+	AsyncWriter(unsigned int ringSize);
+	~AsyncWriter();
+
+	void write(int fd, const char *data, unsigned int size, AsyncOverflowPolicy policy);
+
+	/**
+	 * Writes the given data synchronously, after waiting until the entries
+	 * that the calling thread queued earlier have been written. Used for
+	 * entries that must have been written by the time this call returns.
+	 */
+	void writeNow(int fd, const char *data, unsigned int size);
+
+	/**
+	 * Waits until all entries that were written before this call
+	 * have been written to their file descriptors.
+	 */
+	void flush();
+
+	unsigned long long getDroppedEntries() const {
+		return droppedEntries.load(boost::memory_order_relaxed);
+	}
+};
+
+
+} // namespace LoggingKit
+} // namespace Passenger
+
+#endif /* _PASSENGER_LOGGING_KIT_ASYNC_WRITER_H_ */
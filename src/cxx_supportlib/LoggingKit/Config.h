@@ -49,13 +49,16 @@ using namespace std;
  * (do not edit: following text is automatically generated
  * by 'rake configkit_schemas_inline_comments')
  *
- *   app_output_log_level         string    -   default("notice")
- *   buffer_logs                  boolean   -   default(false)
- *   disable_log_prefix           boolean   -   default(false)
- *   file_descriptor_log_target   any       -   -
- *   level                        string    -   default("notice")
- *   redirect_stderr              boolean   -   default(true)
- *   target                       any       -   default({"stderr": true})
+ *   app_output_log_level            string             -   default("notice")
+ *   async_logging                   boolean            -   default(false)
+ *   async_logging_buffer_size       unsigned integer   -   default(131072),read_only
+ *   async_logging_overflow_policy   string             -   default("block")
+ *   buffer_logs                     boolean            -   default(false)
+ *   disable_log_prefix              boolean            -   default(false)
+ *   file_descriptor_log_target      any                -   -
+ *   level                           string             -   default("notice")
+ *   redirect_stderr                 boolean            -   default(true)
+ *   target                          any                -   default({"stderr": true})
  *
  * END
  */
@@ -66,6 +69,8 @@ private:
 		vector<ConfigKit::Error> &errors);
 	static void validateTarget(const string &key, const ConfigKit::Store &store,
 		vector<ConfigKit::Error> &errors);
+	static void validateAsyncOverflowPolicy(const ConfigKit::Store &store,
+		vector<ConfigKit::Error> &errors);
 
 public:
 	Schema();
@@ -90,6 +95,9 @@ struct ConfigRealization {
 	FdClosePolicy fileDescriptorLogTargetFdClosePolicy;
 	bool finalized;
 	bool disableLogPrefix;
+	/** Owned by the Context. NULL if async logging is disabled. */
+	AsyncWriter *asyncWriter;
+	AsyncOverflowPolicy asyncOverflowPolicy;
 
 	ConfigRealization(const ConfigKit::Store &store);
 	~ConfigRealization();
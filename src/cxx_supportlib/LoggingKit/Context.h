@@ -94,6 +94,7 @@ private:
 	ConfigKit::Store config;
 	boost::atomic<ConfigRealization *> configRlz;
 	LogStore logStore;
+	AsyncWriter *asyncWriter;
 
 	mutable boost::mutex gcSyncher;
 	boost::condition_variable gcSyncherCond;
@@ -103,6 +104,7 @@ private:
 
 	void freeOldConfigRlzLater(ConfigRealization *oldConfigRlz, MonotonicTimeUsec monotonicNow);
 	void gcThreadMain();
+	void setupAsyncWriter(ConfigRealization *configRlz, const ConfigKit::Store &config);
 
 public:
 	Context(const Json::Value &initialConfig = Json::Value(),
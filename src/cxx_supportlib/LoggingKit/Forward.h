@@ -50,6 +50,7 @@ namespace LoggingKit {
 class Schema;
 struct ConfigRealization;
 class Context;
+class AsyncWriter;
 
 enum Level {
 	CRIT   = 0,
@@ -71,19 +72,27 @@ enum TargetType {
 	UNKNOWN_TARGET
 };
 
+enum AsyncOverflowPolicy {
+	BLOCK_ON_OVERFLOW,
+	DROP_ON_OVERFLOW,
+	COUNT_ON_OVERFLOW,
+	UNKNOWN_OVERFLOW_POLICY
+};
+
 extern Context *context;
 
 const char *_strdupFastStringStream(const FastStringStream<> &stream);
 bool _passesLogLevel(const Context *context, Level level, const ConfigRealization **outputConfigRlz);
 bool _shouldLogFileDescriptors(const Context *context, const ConfigRealization **outputConfigRlz);
 void _prepareLogEntry(FastStringStream<> &sstream, Level level, const char *file, unsigned int line);
-void _writeLogEntry(const ConfigRealization *configRlz, const char *str, unsigned int size);
+void _writeLogEntry(const ConfigRealization *configRlz, Level level, const char *str, unsigned int size);
 void _writeFileDescriptorLogEntry(const ConfigRealization *configRlz, const char *str, unsigned int size);
 
 Level getLevel();
 void setLevel(Level level);
 Level parseLevel(const StaticString &name);
 StaticString levelToString(Level level);
+AsyncOverflowPolicy parseAsyncOverflowPolicy(const StaticString &name);
 
 
 } // namespace LoggingKit
@@ -34,6 +34,7 @@
 #include <cassert>
 #include <queue>
 #include <sys/time.h>
+#include <sys/uio.h>
 #include <fcntl.h>
 #include <utility>
 #include <unistd.h>
@@ -53,6 +54,7 @@
 #include <LoggingKit/Assert.h>
 #include <LoggingKit/Config.h>
 #include <LoggingKit/Context.h>
+#include <LoggingKit/AsyncWriter.h>
 #include <ConfigKit/ConfigKit.h>
 #include <FileTools/PathManip.h>
 #include <Utils.h>
@@ -150,6 +152,19 @@ levelToString(Level level) {
 	}
 }
 
+AsyncOverflowPolicy
+parseAsyncOverflowPolicy(const StaticString &name) {
+	if (name == "block") {
+		return BLOCK_ON_OVERFLOW;
+	} else if (name == "drop") {
+		return DROP_ON_OVERFLOW;
+	} else if (name == "count") {
+		return COUNT_ON_OVERFLOW;
+	} else {
+		return UNKNOWN_OVERFLOW_POLICY;
+	}
+}
+
 
 const char *
 _strdupFastStringStream(const FastStringStream<> &stream) {
@@ -290,10 +305,31 @@ writeExactWithoutOXT(int fd, const char *str, unsigned int size) {
 	}
 }
 
+static void
+writeLogData(const ConfigRealization *configRealization, int fd,
+	const char *str, unsigned int size)
+{
+	if (configRealization->asyncWriter != NULL) {
+		configRealization->asyncWriter->write(fd, str, size,
+			configRealization->asyncOverflowPolicy);
+	} else {
+		writeExactWithoutOXT(fd, str, size);
+	}
+}
+
 void
-_writeLogEntry(const ConfigRealization *configRealization, const char *str, unsigned int size) {
+_writeLogEntry(const ConfigRealization *configRealization, Level level,
+	const char *str, unsigned int size)
+{
 	if (OXT_LIKELY(configRealization != NULL)) {
-		writeExactWithoutOXT(configRealization->targetFd, str, size);
+		if (OXT_UNLIKELY(level <= ERROR && configRealization->asyncWriter != NULL)) {
+			// Errors are often followed by abort() (see P_BUG), which
+			// would lose anything that is still queued.
+			configRealization->asyncWriter->writeNow(configRealization->targetFd,
+				str, size);
+		} else {
+			writeLogData(configRealization, configRealization->targetFd, str, size);
+		}
 	} else {
 		writeExactWithoutOXT(STDERR_FILENO, str, size);
 	}
@@ -306,7 +342,8 @@ _writeFileDescriptorLogEntry(const ConfigRealization *configRealization,
 	assert(configRealization != NULL);
 	assert(configRealization->fileDescriptorLogTargetType != UNKNOWN_TARGET);
 	assert(configRealization->fileDescriptorLogTargetFd != -1);
-	writeExactWithoutOXT(configRealization->fileDescriptorLogTargetFd, str, size);
+	writeLogData(configRealization, configRealization->fileDescriptorLogTargetFd,
+		str, size);
 }
 
 void
@@ -404,7 +441,8 @@ Context::convertLog(){
 }
 
 static void
-realLogAppOutput(const HashedStaticString &groupName, int targetFd,
+realLogAppOutput(const HashedStaticString &groupName,
+	const ConfigRealization *configRealization,
     char *buf, unsigned int bufSize,
 	const char *pidStr, unsigned int pidStrLen,
 	const char *channelName, unsigned int channelNameLen,
@@ -428,30 +466,30 @@ realLogAppOutput(const HashedStaticString &groupName, int targetFd,
 		context->saveNewLog(groupName, pidStr, pidStrLen, message, messageLen);
 	}
 	if (appLogFile > -1) {
+		// This file descriptor is closed as soon as we return,
+		// so it can't be written to asynchronously.
 		writeExactWithoutOXT(appLogFile, buf, pos - buf);
 	}
-	writeExactWithoutOXT(targetFd, buf, pos - buf);
+	// App output is never followed by an abort, so it can always be queued.
+	_writeLogEntry(configRealization, INFO, buf, pos - buf);
 }
 
 void
 logAppOutput(const HashedStaticString &groupName, pid_t pid, const StaticString &channelName,
 	const char *message, unsigned int size, const StaticString &appLogFile)
 {
-	int targetFd;
+	const ConfigRealization *configRealization = NULL;
 	bool saveLog = false;
 	bool prefixLogs = true;
 
 	if (OXT_LIKELY(context != NULL)) {
-		const ConfigRealization *configRealization = context->getConfigRealization();
+		configRealization = context->getConfigRealization();
 		if (configRealization->level < configRealization->appOutputLogLevel) {
 			return;
 		}
 
-		targetFd = configRealization->targetFd;
 		saveLog = configRealization->saveLog;
 		prefixLogs = !configRealization->disableLogPrefix;
-	} else {
-		targetFd = STDERR_FILENO;
 	}
 
 	int fd = -1;
@@ -476,14 +514,14 @@ logAppOutput(const HashedStaticString &groupName, pid_t pid, const StaticString
 	totalLen = (sizeof("App X Y: \n") - 2) + pidStrLen + channelName.size() + size;
 	if (totalLen < 1024) {
 		char buf[1024];
-		realLogAppOutput(groupName, targetFd,
+		realLogAppOutput(groupName, configRealization,
 			buf, sizeof(buf),
 			pidStr, pidStrLen,
 			channelName.data(), channelName.size(),
 			message, size, fd, saveLog, prefixLogs);
 	} else {
 		DynamicBuffer buf(totalLen);
-		realLogAppOutput(groupName, targetFd,
+		realLogAppOutput(groupName, configRealization,
 			buf.data, totalLen,
 			pidStr, pidStrLen,
 			channelName.data(), channelName.size(),
@@ -493,6 +531,413 @@ logAppOutput(const HashedStaticString &groupName, pid_t pid, const StaticString
 }
 
 
+static void
+writevExactWithoutOXT(int fd, struct iovec *iov, unsigned int count) {
+	// See writeExactWithoutOXT() for why write errors are ignored.
+	while (count > 0) {
+		ssize_t ret;
+		do {
+			ret = writev(fd, iov, count);
+		} while (ret == -1 && errno == EINTR);
+		if (ret == -1) {
+			break;
+		}
+
+		size_t written = ret;
+		while (count > 0 && written >= iov->iov_len) {
+			written -= iov->iov_len;
+			iov++;
+			count--;
+		}
+		if (count > 0) {
+			iov->iov_base = (char *) iov->iov_base + written;
+			iov->iov_len -= written;
+		}
+	}
+}
+
+static unsigned int asyncWriterForkGeneration = 0;
+static pthread_once_t asyncWriterAtforkOnce = PTHREAD_ONCE_INIT;
+
+static void
+asyncWriterAfterForkInChild() {
+	asyncWriterForkGeneration++;
+}
+
+static void
+registerAsyncWriterAtforkHandler() {
+	pthread_atfork(NULL, NULL, asyncWriterAfterForkInChild);
+}
+
+AsyncWriter::Ring::Ring(unsigned int _capacity)
+	: buffer(new char[_capacity]),
+	  capacity(_capacity),
+	  abandoned(false),
+	  head(0),
+	  tail(0)
+{
+	// Do nothing.
+}
+
+AsyncWriter::Ring::~Ring() {
+	delete[] buffer;
+}
+
+AsyncWriter::AsyncWriter(unsigned int _ringSize)
+	: ringSize(std::max<unsigned int>(alignRecordSize(_ringSize), 4096)),
+	  forkGeneration(asyncWriterForkGeneration),
+	  shuttingDown(false),
+	  threadExited(false),
+	  thread(NULL),
+	  writerSleeping(false),
+	  blockedThreads(0),
+	  droppedEntries(0),
+	  unreportedDroppedEntries(0),
+	  lastDroppedFd(-1),
+	  lastDropReportTime(0)
+{
+	pthread_once(&asyncWriterAtforkOnce, registerAsyncWriterAtforkHandler);
+
+	int ret = pthread_key_create(&ringKey, onThreadExit);
+	if (ret != 0) {
+		throw SystemException("Cannot create a thread-local storage key", ret);
+	}
+
+	try {
+		thread = new oxt::thread(boost::bind(&AsyncWriter::threadMain, this),
+			"LoggingKit async writer thread",
+			128 * 1024);
+	} catch (...) {
+		pthread_key_delete(ringKey);
+		throw;
+	}
+}
+
+AsyncWriter::~AsyncWriter() {
+	if (forkGeneration != asyncWriterForkGeneration) {
+		// The writer thread does not exist in this process.
+		return;
+	}
+
+	{
+		boost::lock_guard<boost::mutex> l(syncher);
+		shuttingDown = true;
+		dataAvailableCond.notify_one();
+	}
+	thread->join();
+	delete thread;
+	pthread_key_delete(ringKey);
+
+	reportDroppedEntries(true);
+	vector<Ring *>::iterator it, end = rings.end();
+	for (it = rings.begin(); it != end; it++) {
+		// Write out anything that was queued while the writer thread was exiting.
+		drainRing(*it);
+		delete *it;
+	}
+}
+
+void
+AsyncWriter::onThreadExit(void *ring) {
+	// The writer thread frees the ring once it has been drained.
+	static_cast<Ring *>(ring)->abandoned.store(true, boost::memory_order_release);
+}
+
+unsigned int
+AsyncWriter::alignRecordSize(unsigned int size) {
+	return (size + 7) & ~7u;
+}
+
+AsyncWriter::Ring *
+AsyncWriter::getRingForCurrentThread() {
+	Ring *ring = static_cast<Ring *>(pthread_getspecific(ringKey));
+	if (OXT_UNLIKELY(ring == NULL)) {
+		try {
+			ring = new Ring(ringSize);
+			boost::lock_guard<boost::mutex> l(syncher);
+			rings.push_back(ring);
+		} catch (const std::bad_alloc &) {
+			delete ring;
+			return NULL;
+		}
+		pthread_setspecific(ringKey, ring);
+	}
+	return ring;
+}
+
+void
+AsyncWriter::write(int fd, const char *data, unsigned int size, AsyncOverflowPolicy policy) {
+	Ring *ring;
+
+	if (OXT_UNLIKELY(forkGeneration != asyncWriterForkGeneration
+		|| (ring = getRingForCurrentThread()) == NULL))
+	{
+		writeExactWithoutOXT(fd, data, size);
+		return;
+	}
+
+	if (OXT_UNLIKELY(size >= ring->capacity / 4)) {
+		// Not worth queuing. Wait until the entries that this thread
+		// queued earlier are written, so that the order is preserved.
+		waitForSpace(ring, ring->capacity);
+		writeExactWithoutOXT(fd, data, size);
+		return;
+	}
+
+	unsigned int recordSize = alignRecordSize(sizeof(RecordHeader) + size);
+	unsigned long long head = ring->head.load(boost::memory_order_relaxed);
+	unsigned int pos = head % ring->capacity;
+	// Records never wrap around the end of the buffer. If there isn't
+	// enough room left, fill the remainder with a padding record.
+	unsigned int padding = (ring->capacity - pos < recordSize)
+		? ring->capacity - pos
+		: 0;
+
+	if (OXT_UNLIKELY(ring->freeSpace() < padding + recordSize)) {
+		if (policy != BLOCK_ON_OVERFLOW) {
+			drop(fd, policy);
+			return;
+		} else if (!waitForSpace(ring, padding + recordSize)) {
+			writeExactWithoutOXT(fd, data, size);
+			return;
+		}
+	}
+
+	RecordHeader *header;
+	if (padding > 0) {
+		header = reinterpret_cast<RecordHeader *>(ring->buffer + pos);
+		header->fd = -1;
+		header->size = padding - sizeof(RecordHeader);
+		pos = 0;
+	}
+	header = reinterpret_cast<RecordHeader *>(ring->buffer + pos);
+	header->fd = fd;
+	header->size = size;
+	memcpy(header + 1, data, size);
+	ring->head.store(head + padding + recordSize, boost::memory_order_release);
+
+	wakeUpWriterThread();
+}
+
+void
+AsyncWriter::writeNow(int fd, const char *data, unsigned int size) {
+	if (OXT_LIKELY(forkGeneration == asyncWriterForkGeneration)) {
+		Ring *ring = static_cast<Ring *>(pthread_getspecific(ringKey));
+		if (ring != NULL) {
+			waitForSpace(ring, ring->capacity);
+		}
+	}
+	writeExactWithoutOXT(fd, data, size);
+}
+
+void
+AsyncWriter::drop(int fd, AsyncOverflowPolicy policy) {
+	droppedEntries.fetch_add(1, boost::memory_order_relaxed);
+	if (policy == COUNT_ON_OVERFLOW) {
+		lastDroppedFd.store(fd, boost::memory_order_relaxed);
+		unreportedDroppedEntries.fetch_add(1, boost::memory_order_relaxed);
+	}
+}
+
+bool
+AsyncWriter::waitForSpace(Ring *ring, unsigned int size) {
+	boost::unique_lock<boost::mutex> l(syncher);
+	blockedThreads.fetch_add(1, boost::memory_order_relaxed);
+	dataAvailableCond.notify_one();
+	while (!threadExited && ring->freeSpace() < size) {
+		spaceAvailableCond.wait(l);
+	}
+	blockedThreads.fetch_sub(1, boost::memory_order_relaxed);
+	return ring->freeSpace() >= size;
+}
+
+void
+AsyncWriter::wakeUpWriterThread() {
+	// Pairs with the fence in threadMain(): either the writer thread
+	// sees our new head, or we see that it is going to sleep.
+	boost::atomic_thread_fence(boost::memory_order_seq_cst);
+	if (writerSleeping.load(boost::memory_order_relaxed)) {
+		boost::lock_guard<boost::mutex> l(syncher);
+		dataAvailableCond.notify_one();
+	}
+}
+
+void
+AsyncWriter::flush() {
+	if (forkGeneration != asyncWriterForkGeneration) {
+		return;
+	}
+
+	boost::unique_lock<boost::mutex> l(syncher);
+	vector< pair<Ring *, unsigned long long> > targets;
+	vector<Ring *>::const_iterator it, end = rings.end();
+
+	targets.reserve(rings.size());
+	for (it = rings.begin(); it != end; it++) {
+		targets.push_back(make_pair(*it, (*it)->head.load(boost::memory_order_acquire)));
+	}
+
+	// While blockedThreads > 0, the writer thread does not free any rings,
+	// so the pointers in `targets` stay valid.
+	blockedThreads.fetch_add(1, boost::memory_order_relaxed);
+	dataAvailableCond.notify_one();
+	vector< pair<Ring *, unsigned long long> >::const_iterator target = targets.begin();
+	while (!threadExited && target != targets.end()) {
+		if (target->first->tail.load(boost::memory_order_acquire) >= target->second) {
+			target++;
+		} else {
+			spaceAvailableCond.wait(l);
+		}
+	}
+	blockedThreads.fetch_sub(1, boost::memory_order_relaxed);
+}
+
+void
+AsyncWriter::threadMain() {
+	boost::unique_lock<boost::mutex> l(syncher);
+
+	while (true) {
+		bool didWork = false;
+		drainList = rings;
+		l.unlock();
+
+		vector<Ring *>::iterator it, end = drainList.end();
+		for (it = drainList.begin(); it != end; it++) {
+			didWork = drainRing(*it) || didWork;
+		}
+		if (unreportedDroppedEntries.load(boost::memory_order_relaxed) > 0) {
+			reportDroppedEntries(false);
+		}
+
+		l.lock();
+		freeAbandonedRings();
+		if (blockedThreads.load(boost::memory_order_relaxed) > 0) {
+			spaceAvailableCond.notify_all();
+		}
+
+		if (didWork) {
+			if (!shuttingDown && blockedThreads.load(boost::memory_order_relaxed) == 0) {
+				// Give other threads a moment to queue more entries, so
+				// that they can be coalesced into fewer writev() calls.
+				// Producers don't wake us up during this time.
+				dataAvailableCond.timed_wait(l, boost::posix_time::milliseconds(1));
+			}
+		} else if (shuttingDown) {
+			break;
+		} else {
+			writerSleeping.store(true, boost::memory_order_relaxed);
+			boost::atomic_thread_fence(boost::memory_order_seq_cst);
+			if (!hasPendingData()) {
+				dataAvailableCond.wait(l);
+			}
+			writerSleeping.store(false, boost::memory_order_relaxed);
+		}
+	}
+
+	threadExited = true;
+	spaceAvailableCond.notify_all();
+}
+
+bool
+AsyncWriter::drainRing(Ring *ring) {
+	unsigned long long tail = ring->tail.load(boost::memory_order_relaxed);
+	unsigned long long head = ring->head.load(boost::memory_order_acquire);
+	struct iovec iov[64];
+
+	if (tail == head) {
+		return false;
+	}
+
+	while (tail != head) {
+		unsigned long long end = tail;
+		unsigned int count = 0;
+		int fd = -1;
+
+		// Coalesce consecutive records with the same target.
+		while (end != head && count < sizeof(iov) / sizeof(struct iovec)) {
+			const RecordHeader *header = reinterpret_cast<const RecordHeader *>(
+				ring->buffer + end % ring->capacity);
+			if (header->fd != -1) {
+				if (fd != -1 && header->fd != fd) {
+					break;
+				}
+				fd = header->fd;
+				iov[count].iov_base = (void *) (header + 1);
+				iov[count].iov_len = header->size;
+				count++;
+			}
+			end += alignRecordSize(sizeof(RecordHeader) + header->size);
+		}
+
+		if (count > 0) {
+			writevExactWithoutOXT(fd, iov, count);
+		}
+		tail = end;
+		ring->tail.store(tail, boost::memory_order_release);
+	}
+
+	return true;
+}
+
+void
+AsyncWriter::reportDroppedEntries(bool force) {
+	MonotonicTimeUsec now = SystemTime::getMonotonicUsecWithGranularity<SystemTime::GRAN_1SEC>();
+	if (!force && now < lastDropReportTime + 1000000) {
+		return;
+	}
+
+	unsigned long long count = unreportedDroppedEntries.exchange(0,
+		boost::memory_order_relaxed);
+	if (count == 0) {
+		return;
+	}
+
+	FastStringStream<> stream;
+	_prepareLogEntry(stream, WARN, __FILE__, __LINE__);
+	stream << count << " log entries were dropped because the"
+		" async logging buffer was full\n";
+	writeExactWithoutOXT(lastDroppedFd.load(boost::memory_order_relaxed),
+		stream.data(), stream.size());
+	lastDropReportTime = now;
+}
+
+void
+AsyncWriter::freeAbandonedRings() {
+	if (blockedThreads.load(boost::memory_order_relaxed) > 0) {
+		// flush() may be referring to them.
+		return;
+	}
+
+	vector<Ring *>::iterator it = rings.begin();
+	while (it != rings.end()) {
+		Ring *ring = *it;
+		if (ring->abandoned.load(boost::memory_order_acquire)
+			&& ring->head.load(boost::memory_order_relaxed)
+				== ring->tail.load(boost::memory_order_relaxed))
+		{
+			delete ring;
+			it = rings.erase(it);
+		} else {
+			it++;
+		}
+	}
+}
+
+bool
+AsyncWriter::hasPendingData() const {
+	vector<Ring *>::const_iterator it, end = rings.end();
+	for (it = rings.begin(); it != end; it++) {
+		const Ring *ring = *it;
+		if (ring->head.load(boost::memory_order_acquire)
+			!= ring->tail.load(boost::memory_order_relaxed))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
 static Json::Value
 normalizeConfig(const Json::Value &effectiveValues) {
 	Json::Value updates(Json::objectValue);
@@ -527,9 +972,11 @@ normalizeConfig(const Json::Value &effectiveValues) {
 Context::Context(const Json::Value &initialConfig,
 	const ConfigKit::Translator &translator)
 	: config(schema, initialConfig, translator),
+	  asyncWriter(NULL),
 	  gcShuttingDown(false)
 {
 	configRlz.store(new ConfigRealization(config));
+	setupAsyncWriter(configRlz.load(), config);
 	configRlz.load()->apply(config, NULL);
 	configRlz.load()->finalize();
 	gcThread = new oxt::thread(boost::bind(&Context::gcThreadMain, this),
@@ -546,6 +993,9 @@ Context::~Context() {
 	gcThread->join();
 
 	delete gcThread;
+	// Deleting the AsyncWriter writes out all pending log entries,
+	// so it must happen before the file descriptors are closed.
+	delete asyncWriter;
 	delete configRlz.load();
 
 	while (!oldConfigRlzs.empty()) {
@@ -573,6 +1023,7 @@ Context::prepareConfigChange(const Json::Value &updates,
 	}
 
 	req.configRlz = new ConfigRealization(*req.config);
+	setupAsyncWriter(req.configRlz, *req.config);
 	return true;
 }
 
@@ -592,6 +1043,21 @@ Context::commitConfigChange(LoggingKit::ConfigChangeRequest &req) BOOST_NOEXCEPT
 	newConfigRlz->finalize();
 }
 
+void
+Context::setupAsyncWriter(ConfigRealization *configRlz, const ConfigKit::Store &config) {
+	if (!config["async_logging"].asBool()) {
+		return;
+	}
+
+	// The AsyncWriter is created on first use and lives as long as the
+	// Context, because older ConfigRealizations may still refer to it.
+	boost::lock_guard<boost::mutex> l(syncher);
+	if (asyncWriter == NULL) {
+		asyncWriter = new AsyncWriter(config["async_logging_buffer_size"].asUInt());
+	}
+	configRlz->asyncWriter = asyncWriter;
+}
+
 Json::Value
 Context::inspectConfig() const {
 	boost::lock_guard<boost::mutex> l(syncher);
@@ -728,6 +1194,19 @@ Schema::validateTarget(const string &key, const ConfigKit::Store &store,
 	}
 }
 
+void
+Schema::validateAsyncOverflowPolicy(const ConfigKit::Store &store,
+	vector<ConfigKit::Error> &errors)
+{
+	typedef ConfigKit::Error Error;
+	if (parseAsyncOverflowPolicy(store["async_logging_overflow_policy"].asString())
+		== UNKNOWN_OVERFLOW_POLICY)
+	{
+		errors.push_back(Error("'{{async_logging_overflow_policy}}' must be one of"
+			" 'block', 'drop' or 'count'"));
+	}
+}
+
 static Json::Value
 filterTargetFd(const Json::Value &value) {
 	Json::Value result = value;
@@ -747,6 +1226,9 @@ Schema::Schema() {
 	add("app_output_log_level", STRING_TYPE, OPTIONAL, DEFAULT_APP_OUTPUT_LOG_LEVEL_NAME);
 	add("buffer_logs", BOOL_TYPE, OPTIONAL, false);
 	add("disable_log_prefix", BOOL_TYPE, OPTIONAL, false);
+	add("async_logging", BOOL_TYPE, OPTIONAL, false);
+	add("async_logging_buffer_size", UINT_TYPE, OPTIONAL | READ_ONLY, 128 * 1024);
+	add("async_logging_overflow_policy", STRING_TYPE, OPTIONAL, "block");
 
 	addValidator(boost::bind(validateLogLevel, "level",
 		boost::placeholders::_1, boost::placeholders::_2));
@@ -756,6 +1238,7 @@ Schema::Schema() {
 		boost::placeholders::_1, boost::placeholders::_2));
 	addValidator(boost::bind(validateTarget, "file_descriptor_log_target",
 		boost::placeholders::_1, boost::placeholders::_2));
+	addValidator(validateAsyncOverflowPolicy);
 
 	addNormalizer(normalizeConfig);
 
@@ -768,7 +1251,10 @@ ConfigRealization::ConfigRealization(const ConfigKit::Store &store)
 	  appOutputLogLevel(parseLevel(store["app_output_log_level"].asString())),
 	  saveLog(store["buffer_logs"].asBool()),
 	  finalized(false),
-	  disableLogPrefix(store["disable_log_prefix"].asBool())
+	  disableLogPrefix(store["disable_log_prefix"].asBool()),
+	  asyncWriter(NULL),
+	  asyncOverflowPolicy(parseAsyncOverflowPolicy(
+		store["async_logging_overflow_policy"].asString()))
 {
 	if (store["target"].isMember("stderr")) {
 		targetType = STDERR_TARGET;
@@ -28,6 +28,8 @@
 
 #include <boost/bind/bind.hpp>
 #include <boost/cstdint.hpp>
+#include <boost/atomic.hpp>
+#include <boost/scoped_array.hpp>
 #include <oxt/thread.hpp>
 #include <oxt/macros.hpp>
 #include <vector>
@@ -55,7 +57,7 @@ using namespace boost;
 
 /**
  * Listens for client connections and load balances them to multiple
- * Server objects in a round-robin manner.
+ * Server objects, by passing each client to the least loaded Server.
  *
  * Normally, the Server class listens for client connections directly.
  * But this is inefficient in multithreaded situations where you are
@@ -72,12 +74,18 @@ using namespace boost;
  *
  * The AcceptLoadBalancer solves this problem by being the sole entity
  * that listens on the server socket. All client sockets that it
- * accepts are distributed to all registered Server objects, in a
- * round-robin manner.
+ * accepts are distributed to all registered Server objects. Each client
+ * goes to the Server with the lowest `getLoad()`, so that a thread that
+ * is stuck with many long-running requests (e.g. WebSockets) doesn't
+ * receive as many new clients as idle threads. Servers with the same
+ * load receive clients in a round-robin manner.
  *
  * Inside the "PassengerAgent core", we activate AcceptLoadBalancer
  * only if `core_threads > 1`, which is often the case because
- * `core_threads` defaults to the number of CPU cores.
+ * `core_threads` defaults to the number of CPU cores. If
+ * `controller_reuse_port` is enabled, then TCP addresses are not
+ * load balanced by this class: every thread listens on its own
+ * SO_REUSEPORT socket instead, and the kernel distributes clients.
  */
 template<typename Server>
 class AcceptLoadBalancer {
@@ -86,11 +94,8 @@ private:
 
 	int endpoints[SERVER_KIT_MAX_SERVER_ENDPOINTS];
 	struct pollfd pollers[1 + SERVER_KIT_MAX_SERVER_ENDPOINTS];
-	int newClients[ACCEPT_BURST_COUNT];
 
 	unsigned int nEndpoints;
-	boost::uint8_t newClientCount;
-	boost::uint8_t nextServer;
 	bool accept4Available;
 	bool quit;
 
@@ -155,23 +160,9 @@ private:
 		}
 	}
 
-	void distributeNewClients() {
-		unsigned int i;
-
-		for (i = 0; i < newClientCount; i++) {
-			ServerKit::Context *ctx = servers[nextServer]->getContext();
-			P_TRACE(2, "Feeding client to server thread " << (int) nextServer <<
-				": file descriptor " << newClients[i]);
-			ctx->libev->runLater(boost::bind(feedNewClient, servers[nextServer],
-				newClients[i]));
-			nextServer = (nextServer + 1) % servers.size();
-		}
-
-		newClientCount = 0;
-	}
-
-	static void feedNewClient(Server *server, int fd) {
-		server->feedNewClients(&fd, 1);
+	void feedNewClient(unsigned int serverIndex, int fd) {
+		servers[serverIndex]->feedNewClients(&fd, 1);
+		inFlightClients[serverIndex].fetch_sub(1, boost::memory_order_release);
 	}
 
 	int acceptNonBlockingSocket(int serverFd) {
@@ -242,16 +233,66 @@ private:
 		}
 	}
 
+// Actually private, but marked public so that unit tests can access the fields.
+public:
+	int newClients[ACCEPT_BURST_COUNT];
+	boost::uint8_t newClientCount;
+	boost::uint8_t nextServer;
+
+	/**
+	 * For each server: the number of clients that we passed to it, but
+	 * that it hasn't picked up yet. Its `getLoad()` doesn't include those.
+	 */
+	boost::scoped_array< boost::atomic<unsigned int> > inFlightClients;
+	vector<unsigned int> loads;
+
+	void distributeNewClients() {
+		unsigned int nServers = servers.size();
+		unsigned int i, j;
+
+		if (newClientCount == 0) {
+			return;
+		}
+
+		for (j = 0; j < nServers; j++) {
+			// Load the in-flight count first: once feedNewClient() has
+			// decremented it, the server's load includes the client.
+			unsigned int inFlight = inFlightClients[j].load(boost::memory_order_acquire);
+			loads[j] = servers[j]->getLoad() + inFlight;
+		}
+
+		for (i = 0; i < newClientCount; i++) {
+			unsigned int best = nextServer;
+			for (j = 1; j < nServers; j++) {
+				unsigned int candidate = (nextServer + j) % nServers;
+				if (loads[candidate] < loads[best]) {
+					best = candidate;
+				}
+			}
+
+			ServerKit::Context *ctx = servers[best]->getContext();
+			P_TRACE(2, "Feeding client to server thread " << best <<
+				" (load " << loads[best] << "): file descriptor " << newClients[i]);
+			loads[best]++;
+			inFlightClients[best].fetch_add(1, boost::memory_order_relaxed);
+			ctx->libev->runLater(boost::bind(&AcceptLoadBalancer<Server>::feedNewClient,
+				this, best, newClients[i]));
+			nextServer = (best + 1) % nServers;
+		}
+
+		newClientCount = 0;
+	}
+
 public:
 	vector<Server *> servers;
 
 	AcceptLoadBalancer()
 		: nEndpoints(0),
-		  newClientCount(0),
-		  nextServer(0),
 		  accept4Available(true),
 		  quit(false),
-		  thread(NULL)
+		  thread(NULL),
+		  newClientCount(0),
+		  nextServer(0)
 	{
 		if (pipe(exitPipe) == -1) {
 			int e = errno;
@@ -300,7 +341,17 @@ public:
 		#undef EXTENSION_EOPNOTSUPP
 	}
 
+	unsigned int getEndpointCount() const {
+		return nEndpoints;
+	}
+
 	void start() {
+		inFlightClients.reset(new boost::atomic<unsigned int>[servers.size()]);
+		for (unsigned int i = 0; i < servers.size(); i++) {
+			inFlightClients[i].store(0, boost::memory_order_relaxed);
+		}
+		loads.resize(servers.size());
+
 		boost::function<void ()> func = boost::bind(&AcceptLoadBalancer<Server>::mainLoop, this);
 		thread = new oxt::thread(boost::bind(runAndPrintExceptions, func, true),
 			"Load balancer");
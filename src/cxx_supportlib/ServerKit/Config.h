@@ -58,6 +58,8 @@ using namespace std;
  *   file_buffered_channel_delay_in_file_mode_switching   unsigned integer   -   default(0)
  *   file_buffered_channel_max_disk_chunk_read_size       unsigned integer   -   default(0)
  *   file_buffered_channel_threshold                      unsigned integer   -   default(131072)
+ *   io_uring                                             boolean            -   default(false),read_only
+ *   io_uring_recv_buffers                                unsigned integer   -   default(256),read_only
  *   mbuf_block_chunk_size                                unsigned integer   -   default(4096),read_only
  *   secure_mode_password                                 string             -   secret
  *
@@ -94,6 +96,9 @@ public:
 
 		add("mbuf_block_chunk_size", UINT_TYPE, OPTIONAL | READ_ONLY,
 			DEFAULT_MBUF_CHUNK_SIZE);
+		add("io_uring", BOOL_TYPE, OPTIONAL | READ_ONLY, false);
+		add("io_uring_recv_buffers", UINT_TYPE, OPTIONAL | READ_ONLY,
+			DEFAULT_IO_URING_RECV_BUFFERS);
 		add("secure_mode_password", STRING_TYPE, OPTIONAL | SECRET);
 
 		addNormalizer(normalize);
@@ -28,10 +28,13 @@
 
 #include <string>
 #include <boost/config.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include <ServerKit/Config.h>
+#include <ServerKit/IoUring.h>
 #include <ConfigKit/ConfigKit.h>
 #include <MemoryKit/mbuf.h>
+#include <LoggingKit/LoggingKit.h>
 #include <LoggingKit/Assert.h>
 #include <SafeLibev.h>
 #include <Exceptions.h>
@@ -62,6 +65,10 @@ public:
 	// Others
 	Config config;
 	struct MemoryKit::mbuf_pool mbuf_pool;
+	#ifdef PASSENGER_IO_URING_SUPPORTED
+		/** Only set if the `io_uring` option is enabled and the kernel supports it. */
+		boost::scoped_ptr<IoUring> ioUring;
+	#endif
 
 	Context(const Schema &schema, const Json::Value &initialConfig = Json::Value(),
 		const ConfigKit::Translator &translator = ConfigKit::DummyTranslator())
@@ -71,6 +78,10 @@ public:
 		{ }
 
 	~Context() {
+		#ifdef PASSENGER_IO_URING_SUPPORTED
+			// Returns the receive buffers to the pool.
+			ioUring.reset();
+		#endif
 		MemoryKit::mbuf_pool_deinit(&mbuf_pool);
 	}
 
@@ -90,6 +101,21 @@ public:
 								   " must be a multiple of " + toString(alignof(struct MemoryKit::mbuf_block)));
 		}
 		MemoryKit::mbuf_pool_init(&mbuf_pool);
+
+		if (configStore["io_uring"].asBool()) {
+			#ifdef PASSENGER_IO_URING_SUPPORTED
+				try {
+					ioUring.reset(new IoUring(libev->getLoop(), &mbuf_pool,
+						configStore["io_uring_recv_buffers"].asUInt()));
+				} catch (const SystemException &e) {
+					P_WARN("Cannot use io_uring, falling back to readiness-based"
+						" socket I/O: " << e.what());
+				}
+			#else
+				P_WARN("io_uring is not supported on this platform, falling back"
+					" to readiness-based socket I/O");
+			#endif
+		}
 	}
 
 	bool configure(const Json::Value &updates, vector<ConfigKit::Error> &errors) {
@@ -154,6 +180,11 @@ public:
 		#endif
 
 		doc["mbuf_pool"] = mbufDoc;
+		#ifdef PASSENGER_IO_URING_SUPPORTED
+			if (ioUring != NULL) {
+				doc["io_uring"] = ioUring->inspectStateAsJson();
+			}
+		#endif
 
 		return doc;
 	}
@@ -28,13 +28,16 @@
 
 #include <oxt/macros.hpp>
 #include <boost/move/move.hpp>
+#include <vector>
 #include <sys/types.h>
 #include <unistd.h>
+#include <cerrno>
 #include <ev.h>
 #include <jsoncpp/json.h>
 #include <MemoryKit/mbuf.h>
 #include <ServerKit/Context.h>
 #include <ServerKit/Channel.h>
+#include <ServerKit/IoUring.h>
 
 namespace Passenger {
 namespace ServerKit {
@@ -42,10 +45,30 @@ namespace ServerKit {
 using namespace oxt;
 
 
+/**
+ * A Channel that reads from a file descriptor.
+ *
+ * Normally, an ev_io watcher tells us when the file descriptor is readable,
+ * after which we read() from it. If the Context has an IoUring, sockets are
+ * read with a multishot recv() operation instead, which passes received data
+ * to us without any readiness notifications or further syscalls. The
+ * operation keeps receiving while the channel is busy or stopped, so data
+ * received in the mean time is kept in `pendingBuffers` until the channel
+ * accepts input again. The operation is cancelled in that case, to apply
+ * backpressure just like the readiness-based approach does.
+ */
 class FdSourceChannel: protected Channel {
 private:
 	ev_io watcher;
 	MemoryKit::mbuf buffer;
+	#ifdef PASSENGER_IO_URING_SUPPORTED
+		IoUringRecv *recv;
+		vector<MemoryKit::mbuf> pendingBuffers;
+		unsigned int pendingBuffersStart;
+		/** -1: no pending EOF or error, 0: pending EOF, > 0: pending error. */
+		int pendingErrcode;
+		bool ioUringEnabled;
+	#endif
 
 	static void _onReadable(EV_P_ ev_io *io, int revents) {
 		static_cast<FdSourceChannel *>(io->data)->onReadable(io, revents);
@@ -128,16 +151,167 @@ private:
 	static void onChannelConsumed(Channel *channel, unsigned int size) {
 		FdSourceChannel *self = static_cast<FdSourceChannel *>(channel);
 		self->consumedCallback = NULL;
+		#ifdef PASSENGER_IO_URING_SUPPORTED
+			if (self->ioUringEnabled) {
+				self->feedPendingInput();
+				return;
+			}
+		#endif
 		if (self->acceptingInput()) {
 			ev_io_start(self->ctx->libev->getLoop(), &self->watcher);
 		}
 	}
 
+	#ifdef PASSENGER_IO_URING_SUPPORTED
+		static void _onRecvCompleted(IoUringRecv *recv, const MemoryKit::mbuf &buffer,
+			int result, bool finished)
+		{
+			static_cast<FdSourceChannel *>(recv->userData)->onRecvCompleted(
+				buffer, result, finished);
+		}
+
+		void onRecvCompleted(const MemoryKit::mbuf &buffer, int result, bool finished) {
+			RefGuard guard(hooks, this, __FILE__, __LINE__);
+			unsigned int generation = this->generation;
+
+			if (finished) {
+				recv = NULL;
+			}
+
+			if (result > 0) {
+				if (hasPendingInput() || !acceptingInput()) {
+					pendingBuffers.push_back(buffer);
+				} else {
+					feedWithoutRefGuard(buffer);
+					if (generation != this->generation) {
+						// Callback deinitialized this object.
+						return;
+					}
+				}
+			} else if (result == -ECANCELED || result == -ENOBUFS) {
+				// We cancelled the operation, or the kernel ran out of
+				// receive buffers. updateRecv() restarts it if necessary.
+			} else if (result == -EINVAL || result == -ENOTSOCK || result == -EOPNOTSUPP) {
+				// Multishot recv() is not supported on this file descriptor.
+				ioUringEnabled = false;
+				if (hasPendingInput()) {
+					if (mayAcceptInputLater()) {
+						consumedCallback = onChannelConsumed;
+					}
+				} else if (acceptingInput()) {
+					ev_io_start(ctx->libev->getLoop(), &watcher);
+				} else if (mayAcceptInputLater()) {
+					consumedCallback = onChannelConsumed;
+				}
+				return;
+			} else {
+				// EOF or error. The kernel has ended the operation.
+				int errcode = (result == 0) ? 0 : -result;
+				if (hasPendingInput() || !acceptingInput()) {
+					pendingErrcode = errcode;
+				} else {
+					feedEndWithoutRefGuard(errcode);
+					return;
+				}
+			}
+
+			updateRecv();
+		}
+
+		bool hasPendingInput() const {
+			return pendingBuffersStart < pendingBuffers.size() || pendingErrcode != -1;
+		}
+
+		void feedEndWithoutRefGuard(int errcode) {
+			if (errcode == 0) {
+				feedWithoutRefGuard(MemoryKit::mbuf());
+			} else {
+				feedError(errcode);
+			}
+		}
+
+		/**
+		 * Passes data that was received while the channel wasn't accepting
+		 * input, and resumes receiving once all of it has been consumed.
+		 */
+		void feedPendingInput() {
+			unsigned int generation = this->generation;
+
+			while (acceptingInput() && hasPendingInput()) {
+				if (pendingBuffersStart < pendingBuffers.size()) {
+					MemoryKit::mbuf buffer(boost::move(pendingBuffers[pendingBuffersStart]));
+					pendingBuffersStart++;
+					if (pendingBuffersStart == pendingBuffers.size()) {
+						pendingBuffers.clear();
+						pendingBuffersStart = 0;
+					}
+					feedWithoutRefGuard(boost::move(buffer));
+				} else {
+					int errcode = pendingErrcode;
+					pendingErrcode = -1;
+					feedEndWithoutRefGuard(errcode);
+				}
+				if (generation != this->generation) {
+					// Callback deinitialized this object.
+					return;
+				}
+			}
+
+			if (!ioUringEnabled) {
+				// We fell back to readiness-based I/O while data was pending.
+				if (!hasPendingInput() && acceptingInput()) {
+					ev_io_start(ctx->libev->getLoop(), &watcher);
+				} else if (mayAcceptInputLater()) {
+					consumedCallback = onChannelConsumed;
+				}
+			} else {
+				updateRecv();
+			}
+		}
+
+		/**
+		 * Ensures that a recv() operation is active if and only if
+		 * the channel accepts input.
+		 */
+		void updateRecv() {
+			if (acceptingInput()) {
+				if (recv == NULL && !hasPendingInput()) {
+					recv = ctx->ioUring->startRecv(watcher.fd, _onRecvCompleted, this);
+				}
+			} else {
+				if (recv != NULL) {
+					ctx->ioUring->cancelRecv(recv);
+				}
+				if (mayAcceptInputLater()) {
+					consumedCallback = onChannelConsumed;
+				}
+			}
+		}
+	#endif
+
 	void initialize() {
 		burstReadCount = 1;
 		watcher.active = false;
 		watcher.fd = -1;
 		watcher.data = this;
+		#ifdef PASSENGER_IO_URING_SUPPORTED
+			recv = NULL;
+			pendingBuffersStart = 0;
+			pendingErrcode = -1;
+			ioUringEnabled = false;
+		#endif
+	}
+
+	void detachRecv() {
+		#ifdef PASSENGER_IO_URING_SUPPORTED
+			if (recv != NULL) {
+				ctx->ioUring->detachRecv(recv);
+				recv = NULL;
+			}
+			pendingBuffers.clear();
+			pendingBuffersStart = 0;
+			pendingErrcode = -1;
+		#endif
 	}
 
 public:
@@ -157,6 +331,7 @@ public:
 		if (ctx != NULL && ev_is_active(&watcher)) {
 			ev_io_stop(ctx->libev->getLoop(), &watcher);
 		}
+		detachRecv();
 	}
 
 	// May only be called right after construction.
@@ -168,6 +343,9 @@ public:
 	void reinitialize(int fd) {
 		Channel::reinitialize();
 		ev_io_init(&watcher, _onReadable, fd, EV_READ);
+		#ifdef PASSENGER_IO_URING_SUPPORTED
+			ioUringEnabled = ctx->ioUring != NULL;
+		#endif
 	}
 
 	void deinitialize() {
@@ -175,6 +353,7 @@ public:
 		if (ev_is_active(&watcher)) {
 			ev_io_stop(ctx->libev->getLoop(), &watcher);
 		}
+		detachRecv();
 		watcher.fd = -1;
 		consumedCallback = NULL;
 		Channel::deinitialize();
@@ -182,6 +361,15 @@ public:
 
 	// May only be called right after the constructor or reinitialize().
 	void startReading() {
+		#ifdef PASSENGER_IO_URING_SUPPORTED
+			if (ioUringEnabled) {
+				// The recv() operation is submitted before the event loop
+				// polls for events, and completes right away if data is
+				// available, so there is nothing to be gained from reading now.
+				startReadingInNextTick();
+				return;
+			}
+		#endif
 		startReadingInNextTick();
 		onReadableWithoutRefGuard();
 	}
@@ -189,9 +377,43 @@ public:
 	// May only be called right after the constructor or reinitialize().
 	void startReadingInNextTick() {
 		assert(Channel::acceptingInput());
+		#ifdef PASSENGER_IO_URING_SUPPORTED
+			if (ioUringEnabled) {
+				updateRecv();
+				return;
+			}
+		#endif
 		ev_io_start(ctx->libev->getLoop(), &watcher);
 	}
 
+	/**
+	 * Like `startReading()`, but first passes `data` to the data callback as
+	 * if it had just been read from the file descriptor. This is used for
+	 * taking over a file descriptor from another FdSourceChannel, which had
+	 * already read `data` without consuming it.
+	 *
+	 * May only be called right after the constructor or reinitialize().
+	 */
+	void startReadingWithData(const MemoryKit::mbuf &data) {
+		unsigned int generation = this->generation;
+
+		if (data.empty()) {
+			startReading();
+			return;
+		}
+
+		feedWithoutRefGuard(data);
+		if (generation != this->generation) {
+			// Callback deinitialized this object.
+			return;
+		}
+		if (acceptingInput()) {
+			startReadingInNextTick();
+		} else if (mayAcceptInputLater()) {
+			consumedCallback = onChannelConsumed;
+		}
+	}
+
 	OXT_FORCE_INLINE
 	void start() {
 		Channel::start();
@@ -212,6 +434,16 @@ public:
 		return watcher.fd;
 	}
 
+	/**
+	 * Returns the data that was passed to the data callback, but that the
+	 * data callback has not consumed yet, for example because it stopped
+	 * the channel.
+	 */
+	OXT_FORCE_INLINE
+	const MemoryKit::mbuf &getUnconsumedData() const {
+		return Channel::buffer;
+	}
+
 	OXT_FORCE_INLINE
 	State getState() const {
 		return Channel::getState();
@@ -222,6 +454,19 @@ public:
 		return Channel::isStarted();
 	}
 
+	/**
+	 * Whether the file descriptor is read through io_uring. If so, the
+	 * kernel may have received data on our behalf even while the channel
+	 * is stopped, so the file descriptor must not be read by anybody else.
+	 */
+	bool usesIoUring() const {
+		#ifdef PASSENGER_IO_URING_SUPPORTED
+			return ioUringEnabled;
+		#else
+			return false;
+		#endif
+	}
+
 	OXT_FORCE_INLINE
 	void setDataCallback(DataCallback callback) {
 		Channel::dataCallback = callback;
@@ -241,6 +486,13 @@ public:
 		Json::Value doc = Channel::inspectAsJson();
 		doc["initialized"] = watcher.fd != -1;
 		doc["io_watcher_active"] = (bool) watcher.active;
+		#ifdef PASSENGER_IO_URING_SUPPORTED
+			if (ioUringEnabled) {
+				doc["io_uring_recv_active"] = recv != NULL;
+				doc["io_uring_pending_buffers"] = (Json::UInt)
+					(pendingBuffers.size() - pendingBuffersStart);
+			}
+		#endif
 		return doc;
 	}
 };
@@ -43,6 +43,44 @@ using namespace std;
 extern const HashedStaticString HTTP_COOKIE;
 extern const HashedStaticString HTTP_SET_COOKIE;
 
+/**
+ * Well-known, downcased header names. Every HeaderTable keeps track of where
+ * these headers are, so that looking them up is a single indexed load
+ * instead of a probe sequence, even when the header is absent.
+ */
+static const unsigned int NUM_KNOWN_HEADERS = 43;
+extern const HashedStaticString KNOWN_HEADERS[NUM_KNOWN_HEADERS];
+
+/**
+ * Perfect hash from the hashes of KNOWN_HEADERS to their indices: the
+ * slot of a hash is `(hash * KNOWN_HEADER_HASH_MULTIPLIER) >> (32 - KNOWN_HEADER_SLOT_BITS)`,
+ * and each slot contains the index of the known header with that slot, or
+ * NO_KNOWN_HEADER. The multiplier has been chosen so that no two known
+ * headers share a slot; this is verified on startup.
+ */
+static const unsigned int KNOWN_HEADER_SLOT_BITS = 7;
+static const boost::uint32_t KNOWN_HEADER_HASH_MULTIPLIER = 0x3ced;
+static const boost::uint8_t NO_KNOWN_HEADER = 0xff;
+extern boost::uint8_t knownHeaderSlots[1 << KNOWN_HEADER_SLOT_BITS];
+
+/**
+ * Returns the index in KNOWN_HEADERS of the known header whose hash is
+ * `hash`, or NO_KNOWN_HEADER if there is none. Since different names may
+ * have the same hash, the caller must still compare the name.
+ */
+OXT_FORCE_INLINE
+inline unsigned int
+lookupKnownHeaderIndex(boost::uint32_t hash) {
+	unsigned int index = knownHeaderSlots[
+		(boost::uint32_t) (hash * KNOWN_HEADER_HASH_MULTIPLIER)
+		>> (32 - KNOWN_HEADER_SLOT_BITS)];
+	if (index != NO_KNOWN_HEADER && KNOWN_HEADERS[index].hash() == hash) {
+		return index;
+	} else {
+		return NO_KNOWN_HEADER;
+	}
+}
+
 struct Header {
 	/** Downcased version of the key, for case-insensitive lookup. */
 	LString key;
@@ -70,6 +108,9 @@ struct Header {
  * The hash table never shrinks in size, even after clear(), unless you explicitly call
  * compact(). This allows you to reuse hash table memory over multiple requests.
  *
+ * Headers whose names are in KNOWN_HEADERS are additionally indexed by their
+ * position in that list, so that lookups of those names don't need to probe.
+ *
  * This implementation is based on https://github.com/preshing/CompareIntegerMaps.
  * See also http://preshing.com/20130107/this-hash-table-is-faster-than-a-judy-array
  */
@@ -90,6 +131,7 @@ private:
 	Cell *m_cells;
 	boost::uint16_t m_arraySize;
 	boost::uint16_t m_population;
+	Header *m_knownHeaders[NUM_KNOWN_HEADERS];
 
 	bool shouldRepopulateOnInsert() const {
 		return (m_population + 1) * 4 >= m_arraySize * 3;
@@ -123,6 +165,30 @@ private:
 			&& psg_lstr_cmp(&header->key, HTTP_SET_COOKIE);
 	}
 
+	OXT_FORCE_INLINE
+	static unsigned int knownHeaderIndex(const HashedStaticString &key) {
+		unsigned int index = lookupKnownHeaderIndex(key.hash());
+		if (index != NO_KNOWN_HEADER && key == KNOWN_HEADERS[index]) {
+			return index;
+		} else {
+			return NO_KNOWN_HEADER;
+		}
+	}
+
+	OXT_FORCE_INLINE
+	static unsigned int knownHeaderIndex(const Header *header) {
+		unsigned int index = lookupKnownHeaderIndex(header->hash);
+		if (index != NO_KNOWN_HEADER && psg_lstr_cmp(&header->key, KNOWN_HEADERS[index])) {
+			return index;
+		} else {
+			return NO_KNOWN_HEADER;
+		}
+	}
+
+	void clearKnownHeaders() {
+		memset(m_knownHeaders, 0, sizeof(m_knownHeaders));
+	}
+
 	void repopulate(unsigned int desiredSize) {
 		assert((desiredSize & (desiredSize - 1)) == 0);   // Must be a power of 2
 		assert(m_population * 4  <= desiredSize * 3);
@@ -166,6 +232,7 @@ private:
 		m_population = other.m_population;
 		m_cells      = new Cell[other.m_arraySize];
 		memcpy(m_cells, other.m_cells, other.m_arraySize * sizeof(Cell));
+		memcpy(m_knownHeaders, other.m_knownHeaders, sizeof(m_knownHeaders));
 	}
 
 public:
@@ -199,6 +266,7 @@ public:
 			memset(m_cells, 0, sizeof(Cell) * m_arraySize);
 		}
 		m_population = 0;
+		clearKnownHeaders();
 	}
 
 	const Cell *lookupCell(const HashedStaticString &key) const {
@@ -229,9 +297,13 @@ public:
 		return const_cast<Cell *>(static_cast<const HeaderTable *>(this)->lookupCell(key));
 	}
 
-	OXT_FORCE_INLINE
-	Header *lookupHeader(const HashedStaticString &key) {
-		Cell *cell = lookupCell(key);
+	const Header *lookupHeader(const HashedStaticString &key) const {
+		unsigned int index = knownHeaderIndex(key);
+		if (index != NO_KNOWN_HEADER) {
+			return m_knownHeaders[index];
+		}
+
+		const Cell * const cell = lookupCell(key);
 		if (cell != NULL) {
 			return cell->header;
 		} else {
@@ -239,10 +311,15 @@ public:
 		}
 	}
 
+	OXT_FORCE_INLINE
+	Header *lookupHeader(const HashedStaticString &key) {
+		return const_cast<Header *>(static_cast<const HeaderTable *>(this)->lookupHeader(key));
+	}
+
 	const LString *lookup(const HashedStaticString &key) const {
-		const Cell * const cell = lookupCell(key);
-		if (cell != NULL) {
-			return &cell->header->val;
+		const Header * const header = lookupHeader(key);
+		if (header != NULL) {
+			return &header->val;
 		} else {
 			return NULL;
 		}
@@ -279,6 +356,10 @@ public:
 					m_population++;
 
 					cell->header = header;
+					unsigned int index = knownHeaderIndex(header);
+					if (index != NO_KNOWN_HEADER) {
+						m_knownHeaders[index] = header;
+					}
 					*headerPtr = NULL;
 					return;
 				} else if (psg_lstr_cmp(&cell->header->key, &header->key)) {
@@ -329,6 +410,11 @@ public:
 		assert(cell >= m_cells && cell - m_cells < m_arraySize);
 		assert(!cellIsEmpty(cell));
 
+		unsigned int index = knownHeaderIndex(cell->header);
+		if (index != NO_KNOWN_HEADER) {
+			m_knownHeaders[index] = NULL;
+		}
+
 		// Remove this cell by shuffling neighboring cells so there are no gaps in anyone's probe chain
 		Cell *neighbor = PHT_CIRCULAR_NEXT(cell);
 		while (true) {
@@ -376,6 +462,7 @@ public:
 	void clear() {
 		if (m_cells != NULL && m_population != 0) {
 			memset(m_cells, 0, sizeof(Cell) * m_arraySize);
+			clearKnownHeaders();
 		}
 		m_population = 0;
 	}
@@ -385,6 +472,7 @@ public:
 		m_cells = NULL;
 		m_arraySize  = 0;
 		m_population = 0;
+		clearKnownHeaders();
 	}
 
 	void compact() {
@@ -224,11 +224,9 @@ private:
 			self->state->hasher.update(data, len);
 		} else {
 			char *downcasedData = (char *) psg_pnalloc(self->pool, len);
-			convertLowerCase((const unsigned char *) data,
-				(unsigned char *) downcasedData, len);
+			self->state->hasher.updateLowerCase(data, downcasedData, len);
 			psg_lstr_append(&self->state->currentHeader->key, self->pool,
 				downcasedData, len);
-			self->state->hasher.update(downcasedData, len);
 		}
 
 		return 0;
@@ -250,9 +248,10 @@ private:
 
 		}
 
+		// The value is not part of the header's hash, so there's no need to
+		// scan it here. This matters for large values such as cookies.
 		psg_lstr_append(&self->state->currentHeader->val, self->pool,
 			*self->currentBuffer, data, len);
-		self->state->hasher.update(data, len);
 
 		return 0;
 	}
@@ -103,6 +103,8 @@ public:
 	bool wantKeepAlive: 1;
 	bool responseBegun: 1;
 	bool detectingNextRequestEarlyReadError: 1;
+	/** Whether this request is included in HttpServer's `activeRequestCount`. */
+	bool countedAsActive: 1;
 
 	boost::atomic<int> refcount;
 
@@ -126,6 +126,12 @@ public:
 	unsigned int freeRequestCount;
 	unsigned long totalRequestsBegun, lastTotalRequestsBegun;
 	double requestBeginSpeed1m, requestBeginSpeed1h;
+	/** The number of requests that have begun but not yet ended. */
+	unsigned int activeRequestCount;
+	/** A copy of `activeRequestCount` that other threads may read. */
+	boost::atomic<unsigned int> sharedActiveRequestCount;
+	/** The number of keep-alive clients that were moved to another server. */
+	unsigned long totalClientsMigrated;
 
 private:
 	/***** Types and nested classes *****/
@@ -315,6 +321,61 @@ private:
 		client->currentRequest = req = checkoutRequestObject(client);
 		req->client = client;
 		reinitializeRequest(client, req);
+
+		if (client->requestsBegun > 0) {
+			DerivedServer *target = getClientMigrationTarget(client);
+			if (target != NULL && target != static_cast<DerivedServer *>(this)) {
+				// We may be inside a data callback, which may still pass
+				// pipelined data to the new request, so we decide later.
+				this->getContext()->libev->runLater(boost::bind(
+					&HttpServer::migrateIdleClient, this,
+					this->getClientRef(client, __FILE__, __LINE__), target));
+			}
+		}
+	}
+
+	/**
+	 * Moves a keep-alive client to `target` if it is still waiting for
+	 * its next request, and if that request hasn't received any data yet.
+	 * The file descriptor, and any input that was read but not yet passed
+	 * to the request (e.g. a pipelined request), are passed to `target`'s
+	 * event loop, which continues as if it had accepted the client itself.
+	 */
+	void migrateIdleClient(typename ParentClass::ClientRefType clientRef,
+		DerivedServer *target)
+	{
+		Client *client = clientRef.get();
+		Request *req = client->currentRequest;
+		Channel::State inputState = client->input.getState();
+
+		// If the kernel receives data on our behalf with io_uring, then
+		// there may be data in flight that only our event loop will see.
+		if (this->serverState != ParentClass::ACTIVE
+		 || !client->connected()
+		 || client->input.usesIoUring()
+		 || req == NULL
+		 || req->httpState != Request::PARSING_HEADERS
+		 || req->lastDataReceiveTime != 0
+		 || (inputState != Channel::IDLE
+			&& inputState != Channel::STOPPED
+			&& inputState != Channel::PLANNING_TO_CALL))
+		{
+			return;
+		}
+
+		// mbufs belong to this thread's pool, so copy the data.
+		const MemoryKit::mbuf &unconsumed = client->input.getUnconsumedData();
+		string bufferedInput(unconsumed.start, unconsumed.size());
+
+		SKC_DEBUG(client, "Migrating client to another server with " <<
+			bufferedInput.size() << " bytes of buffered input");
+		int fd = this->detachClient(&client);
+		if (fd == -1) {
+			return;
+		}
+		totalClientsMigrated++;
+		target->getContext()->libev->runLater(boost::bind(
+			&DerivedServer::feedMigratedClient, target, fd, bufferedInput));
 	}
 
 
@@ -894,6 +955,9 @@ protected:
 	virtual void onRequestBegin(Client *client, Request *req) {
 		totalRequestsBegun++;
 		client->requestsBegun++;
+		req->countedAsActive = true;
+		activeRequestCount++;
+		sharedActiveRequestCount.store(activeRequestCount, boost::memory_order_relaxed);
 	}
 
 	virtual Channel::Result onRequestBody(Client *client, Request *req,
@@ -927,6 +991,16 @@ protected:
 		return true;
 	}
 
+	/**
+	 * Called when a keep-alive client is done with a request, and starts
+	 * waiting for the next one. Returning another server, which runs on
+	 * another event loop, moves the client to that server (e.g. because
+	 * that server is less busy). The default implementation never does.
+	 */
+	virtual DerivedServer *getClientMigrationTarget(Client *client) {
+		return NULL;
+	}
+
 	virtual void reinitializeClient(Client *client, int fd) {
 		ParentClass::reinitializeClient(client, fd);
 		client->requestsBegun = 0;
@@ -942,6 +1016,7 @@ protected:
 		req->wantKeepAlive = false;
 		req->responseBegun = false;
 		req->detectingNextRequestEarlyReadError = false;
+		req->countedAsActive = false;
 		req->parserState.headerParser = headerParserStatePool.construct();
 		createRequestHeaderParser(this->getContext(), req).initialize();
 		if (OXT_UNLIKELY(req->pool == NULL)) {
@@ -965,6 +1040,12 @@ protected:
 	 * after endRequest() is called.
 	 */
 	virtual void deinitializeRequest(Client *client, Request *req) {
+		if (req->countedAsActive) {
+			req->countedAsActive = false;
+			activeRequestCount--;
+			sharedActiveRequestCount.store(activeRequestCount, boost::memory_order_relaxed);
+		}
+
 		if (req->httpState == Request::PARSING_HEADERS
 		 && req->parserState.headerParser != NULL)
 		{
@@ -1020,6 +1101,9 @@ public:
 		  lastTotalRequestsBegun(0),
 		  requestBeginSpeed1m(-1),
 		  requestBeginSpeed1h(-1),
+		  activeRequestCount(0),
+		  sharedActiveRequestCount(0),
+		  totalClientsMigrated(0),
 		  configRlz(ParentClass::config),
 		  headerParserStatePool(16, 256)
 	{
@@ -1281,10 +1365,23 @@ public:
 		configRlz.swap(*req.configRlz);
 	}
 
+	/**
+	 * Like BaseServer::getLoad(), but also counts active requests. A client
+	 * with a request in progress (e.g. one that is waiting for a slow
+	 * application, or a WebSocket) thus weighs more than an idle
+	 * keep-alive client.
+	 */
+	unsigned int getLoad() const {
+		return ParentClass::getLoad()
+			+ sharedActiveRequestCount.load(boost::memory_order_relaxed);
+	}
+
 	virtual Json::Value inspectStateAsJson() const {
 		Json::Value doc = ParentClass::inspectStateAsJson();
 		doc["free_request_count"] = freeRequestCount;
 		doc["total_requests_begun"] = (Json::UInt64) totalRequestsBegun;
+		doc["active_request_count"] = activeRequestCount;
+		doc["total_clients_migrated"] = (Json::UInt64) totalClientsMigrated;
 		doc["request_begin_speed"]["1m"] = averageSpeedToJson(
 			capFloatPrecision(requestBeginSpeed1m * 60),
 			"minute", "1 minute", -1);
@@ -1352,7 +1449,7 @@ public:
 			}
 			doc["path"] = str;
 
-			const LString *host = req->headers.lookup("host");
+			const LString *host = req->headers.lookup(P_HASHED_STATIC_STRING("host"));
 			if (host != NULL) {
 				str.clear();
 				str.reserve(host->size);
@@ -23,6 +23,9 @@
  *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  *  THE SOFTWARE.
  */
+#include <cstdlib>
+#include <cstring>
+#include <ServerKit/HeaderTable.h>
 #include <DataStructures/HashedStaticString.h>
 
 namespace Passenger {
@@ -48,12 +51,76 @@ const char DEFAULT_INTERNAL_SERVER_ERROR_RESPONSE[] =
 	"Internal server error\n";
 const unsigned int DEFAULT_INTERNAL_SERVER_ERROR_RESPONSE_SIZE =
 	sizeof(DEFAULT_INTERNAL_SERVER_ERROR_RESPONSE) - 1;
-const HashedStaticString HTTP_COOKIE("cookie");
-const HashedStaticString HTTP_SET_COOKIE("set-cookie");
-const HashedStaticString HTTP_CONTENT_LENGTH("content-length");
-const HashedStaticString HTTP_TRANSFER_ENCODING("transfer-encoding");
-const HashedStaticString HTTP_X_SENDFILE("x-sendfile");
-const HashedStaticString HTTP_X_ACCEL_REDIRECT("x-accel-redirect");
+const HashedStaticString HTTP_COOKIE = P_HASHED_STATIC_STRING("cookie");
+const HashedStaticString HTTP_SET_COOKIE = P_HASHED_STATIC_STRING("set-cookie");
+const HashedStaticString HTTP_CONTENT_LENGTH = P_HASHED_STATIC_STRING("content-length");
+const HashedStaticString HTTP_TRANSFER_ENCODING = P_HASHED_STATIC_STRING("transfer-encoding");
+const HashedStaticString HTTP_X_SENDFILE = P_HASHED_STATIC_STRING("x-sendfile");
+const HashedStaticString HTTP_X_ACCEL_REDIRECT = P_HASHED_STATIC_STRING("x-accel-redirect");
+
+const HashedStaticString KNOWN_HEADERS[NUM_KNOWN_HEADERS] = {
+	P_HASHED_STATIC_STRING("host"),
+	P_HASHED_STATIC_STRING("connection"),
+	P_HASHED_STATIC_STRING("content-length"),
+	P_HASHED_STATIC_STRING("content-type"),
+	P_HASHED_STATIC_STRING("transfer-encoding"),
+	P_HASHED_STATIC_STRING("expect"),
+	P_HASHED_STATIC_STRING("upgrade"),
+	P_HASHED_STATIC_STRING("cookie"),
+	P_HASHED_STATIC_STRING("set-cookie"),
+	P_HASHED_STATIC_STRING("date"),
+	P_HASHED_STATIC_STRING("status"),
+	P_HASHED_STATIC_STRING("cache-control"),
+	P_HASHED_STATIC_STRING("pragma"),
+	P_HASHED_STATIC_STRING("authorization"),
+	P_HASHED_STATIC_STRING("vary"),
+	P_HASHED_STATIC_STRING("www-authenticate"),
+	P_HASHED_STATIC_STRING("x-sendfile"),
+	P_HASHED_STATIC_STRING("x-accel-redirect"),
+	P_HASHED_STATIC_STRING("expires"),
+	P_HASHED_STATIC_STRING("last-modified"),
+	P_HASHED_STATIC_STRING("etag"),
+	P_HASHED_STATIC_STRING("if-none-match"),
+	P_HASHED_STATIC_STRING("if-modified-since"),
+	P_HASHED_STATIC_STRING("if-match"),
+	P_HASHED_STATIC_STRING("if-unmodified-since"),
+	P_HASHED_STATIC_STRING("location"),
+	P_HASHED_STATIC_STRING("content-location"),
+	P_HASHED_STATIC_STRING("content-encoding"),
+	P_HASHED_STATIC_STRING("accept"),
+	P_HASHED_STATIC_STRING("accept-encoding"),
+	P_HASHED_STATIC_STRING("accept-language"),
+	P_HASHED_STATIC_STRING("user-agent"),
+	P_HASHED_STATIC_STRING("referer"),
+	P_HASHED_STATIC_STRING("origin"),
+	P_HASHED_STATIC_STRING("keep-alive"),
+	P_HASHED_STATIC_STRING("range"),
+	P_HASHED_STATIC_STRING("age"),
+	P_HASHED_STATIC_STRING("x-forwarded-for"),
+	P_HASHED_STATIC_STRING("x-forwarded-proto"),
+	P_HASHED_STATIC_STRING("x-forwarded-host"),
+	P_HASHED_STATIC_STRING("x-real-ip"),
+	P_HASHED_STATIC_STRING("x-request-id"),
+	P_HASHED_STATIC_STRING("x-request-start")
+};
+
+boost::uint8_t knownHeaderSlots[1 << KNOWN_HEADER_SLOT_BITS];
+
+static struct KnownHeaderSlotsInitializer {
+	KnownHeaderSlotsInitializer() {
+		memset(knownHeaderSlots, NO_KNOWN_HEADER, sizeof(knownHeaderSlots));
+		for (unsigned int i = 0; i < NUM_KNOWN_HEADERS; i++) {
+			boost::uint32_t slot = (boost::uint32_t) (KNOWN_HEADERS[i].hash()
+				* KNOWN_HEADER_HASH_MULTIPLIER) >> (32 - KNOWN_HEADER_SLOT_BITS);
+			if (knownHeaderSlots[slot] != NO_KNOWN_HEADER) {
+				// KNOWN_HEADERS has been changed without finding
+				// a new KNOWN_HEADER_HASH_MULTIPLIER.
+				abort();
+			}
+			knownHeaderSlots[slot] = i;
+		}
+	}
+} knownHeaderSlotsInitializer;
 
 
 } // namespace ServerKit
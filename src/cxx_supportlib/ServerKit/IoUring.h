@@ -0,0 +1,517 @@
+/*
+ *  Phusion Passenger - https://www.phusionpassenger.com/
+ *  Copyright (c) 2014-2018 Phusion Holding B.V.
+ *
+ *  "Passenger", "Phusion Passenger" and "Union Station" are registered
+ *  trademarks of Phusion Holding B.V.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#ifndef _PASSENGER_SERVER_KIT_IO_URING_H_
+#define _PASSENGER_SERVER_KIT_IO_URING_H_
+
+#if defined(__linux__) && defined(__has_include)
+	#if __has_include(<linux/io_uring.h>)
+		#include <linux/io_uring.h>
+		// Multishot recv and provided buffer rings appeared together
+		// (Linux 6.0), so this is the only feature check we need.
+		#ifdef IORING_RECV_MULTISHOT
+			#define PASSENGER_IO_URING_SUPPORTED
+		#endif
+	#endif
+#endif
+
+#ifdef PASSENGER_IO_URING_SUPPORTED
+
+#include <boost/cstdint.hpp>
+#include <oxt/macros.hpp>
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <cerrno>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ev.h>
+#include <jsoncpp/json.h>
+
+#include <MemoryKit/mbuf.h>
+#include <Exceptions.h>
+
+namespace Passenger {
+namespace ServerKit {
+
+using namespace std;
+
+
+/**
+ * A multishot recv() operation started with `IoUring::startRecv()`. The
+ * callback is called once for every completion. `buffer` contains the
+ * received data if `result > 0`; otherwise `result` is 0 (EOF) or a
+ * negative errno. `finished` is true on the last completion, after which
+ * the operation object is invalid.
+ */
+struct IoUringRecv {
+	typedef void (*Callback)(IoUringRecv *recv, const MemoryKit::mbuf &buffer,
+		int result, bool finished);
+
+	Callback callback;
+	void *userData;
+	bool cancelled;
+};
+
+
+/**
+ * A per-event loop io_uring instance, used as an optional completion-based
+ * backend for reading from sockets (see FdSourceChannel).
+ *
+ * Sockets are read with multishot recv() operations, which keep delivering
+ * data until they are cancelled, so that no readiness notification nor
+ * read() call is needed per chunk. The kernel picks the buffer to receive
+ * into from a provided buffer ring, which is filled with mbufs from the
+ * Context's mbuf pool. Idle connections therefore don't tie up any buffer
+ * memory. Each buffer is replaced with a fresh mbuf as soon as it has been
+ * handed out, so that the data can be passed on without copying.
+ *
+ * Submissions are batched: they are only passed to the kernel right before
+ * the event loop polls for events. Completions are processed when the ring
+ * file descriptor becomes readable.
+ */
+class IoUring {
+private:
+	static const unsigned int SQ_ENTRIES = 256;
+	static const unsigned short BUFFER_GROUP_ID = 0;
+
+	struct ev_loop *loop;
+	struct MemoryKit::mbuf_pool *pool;
+	int fd;
+
+	void *ringPtr;
+	size_t ringSize;
+	struct io_uring_sqe *sqes;
+	size_t sqesSize;
+	unsigned int *sqHead, *sqTail, *sqFlags, *sqArray;
+	unsigned int sqMask, sqEntries;
+	unsigned int sqLocalTail, sqUnsubmitted;
+	unsigned int *cqHead, *cqTail;
+	unsigned int cqMask;
+	struct io_uring_cqe *cqes;
+
+	// The buffer ring is accessed through these pointers instead of through
+	// `struct io_uring_buf_ring`: when compiled as C++, that struct's
+	// flexible array member does not start at offset 0 like the kernel
+	// expects. The ring tail overlays the first entry's `resv` field.
+	struct io_uring_buf *bufRing;
+	unsigned short *bufRingTailPtr;
+	size_t bufRingSize;
+	unsigned int bufRingMask;
+	unsigned short bufRingTail;
+	vector<MemoryKit::mbuf> buffers;
+
+	vector<IoUringRecv *> recvs;
+	vector<IoUringRecv *> freeRecvs;
+
+	struct ev_io ringWatcher;
+	struct ev_prepare prepareWatcher;
+
+	static void _onRingReadable(EV_P_ struct ev_io *io, int revents) {
+		static_cast<IoUring *>(io->data)->processCompletions();
+	}
+
+	static void _onPrepare(EV_P_ struct ev_prepare *w, int revents) {
+		static_cast<IoUring *>(w->data)->submit();
+	}
+
+	int enter(unsigned int toSubmit, unsigned int flags) {
+		int ret;
+		do {
+			ret = (int) syscall(__NR_io_uring_enter, fd, toSubmit, 0, flags, NULL, 0);
+		} while (OXT_UNLIKELY(ret == -1 && errno == EINTR));
+		return ret;
+	}
+
+	void setupRings(unsigned int bufferCount) {
+		struct io_uring_params params;
+		memset(&params, 0, sizeof(params));
+		params.flags = IORING_SETUP_CQSIZE;
+		params.cq_entries = SQ_ENTRIES * 4;
+
+		fd = (int) syscall(__NR_io_uring_setup, SQ_ENTRIES, &params);
+		if (fd == -1) {
+			int e = errno;
+			throw SystemException("Cannot create an io_uring instance", e);
+		}
+		if (!(params.features & IORING_FEAT_SINGLE_MMAP)
+		 || !(params.features & IORING_FEAT_NODROP))
+		{
+			throw SystemException("The kernel's io_uring implementation is too old",
+				ENOTSUP);
+		}
+
+		ringSize = std::max<size_t>(
+			params.sq_off.array + params.sq_entries * sizeof(unsigned int),
+			params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe));
+		ringPtr = mmap(NULL, ringSize, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+		if (ringPtr == MAP_FAILED) {
+			int e = errno;
+			ringPtr = NULL;
+			throw SystemException("Cannot map the io_uring rings", e);
+		}
+		sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+		sqes = (struct io_uring_sqe *) mmap(NULL, sqesSize, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+		if (sqes == MAP_FAILED) {
+			int e = errno;
+			sqes = NULL;
+			throw SystemException("Cannot map the io_uring submission queue entries", e);
+		}
+
+		char *base = (char *) ringPtr;
+		sqHead  = (unsigned int *) (base + params.sq_off.head);
+		sqTail  = (unsigned int *) (base + params.sq_off.tail);
+		sqFlags = (unsigned int *) (base + params.sq_off.flags);
+		sqArray = (unsigned int *) (base + params.sq_off.array);
+		sqMask  = *(unsigned int *) (base + params.sq_off.ring_mask);
+		sqEntries = params.sq_entries;
+		sqLocalTail = *sqTail;
+		cqHead  = (unsigned int *) (base + params.cq_off.head);
+		cqTail  = (unsigned int *) (base + params.cq_off.tail);
+		cqMask  = *(unsigned int *) (base + params.cq_off.ring_mask);
+		cqes    = (struct io_uring_cqe *) (base + params.cq_off.cqes);
+
+		bufRingSize = bufferCount * sizeof(struct io_uring_buf);
+		void *bufRingPtr = mmap(NULL, bufRingSize, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (bufRingPtr == MAP_FAILED) {
+			int e = errno;
+			throw SystemException("Cannot allocate the io_uring buffer ring", e);
+		}
+		bufRing = (struct io_uring_buf *) bufRingPtr;
+		bufRingTailPtr = (unsigned short *) ((char *) bufRingPtr
+			+ offsetof(struct io_uring_buf, resv));
+
+		struct io_uring_buf_reg reg;
+		memset(&reg, 0, sizeof(reg));
+		reg.ring_addr = (boost::uint64_t) (uintptr_t) bufRing;
+		reg.ring_entries = bufferCount;
+		reg.bgid = BUFFER_GROUP_ID;
+		if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PBUF_RING, &reg, 1) == -1) {
+			int e = errno;
+			throw SystemException("Cannot register the io_uring buffer ring", e);
+		}
+
+		bufRingMask = bufferCount - 1;
+		bufRingTail = 0;
+		buffers.reserve(bufferCount);
+		for (unsigned int i = 0; i < bufferCount; i++) {
+			buffers.push_back(MemoryKit::mbuf_get(pool));
+			addBuffer(i);
+		}
+	}
+
+	void cleanup() {
+		if (ev_is_active(&ringWatcher)) {
+			ev_ref(loop);
+			ev_io_stop(loop, &ringWatcher);
+		}
+		if (ev_is_active(&prepareWatcher)) {
+			ev_ref(loop);
+			ev_prepare_stop(loop, &prepareWatcher);
+		}
+		if (fd != -1) {
+			// Closing the ring cancels outstanding operations asynchronously,
+			// so cancel them synchronously first: afterwards, the kernel won't
+			// touch the buffers anymore.
+			struct io_uring_sync_cancel_reg reg;
+			memset(&reg, 0, sizeof(reg));
+			reg.fd = -1;
+			reg.flags = IORING_ASYNC_CANCEL_ANY;
+			reg.timeout.tv_sec = -1;
+			reg.timeout.tv_nsec = -1;
+			syscall(__NR_io_uring_register, fd, IORING_REGISTER_SYNC_CANCEL, &reg, 1);
+			if (bufRing != NULL) {
+				struct io_uring_buf_reg bufReg;
+				memset(&bufReg, 0, sizeof(bufReg));
+				bufReg.bgid = BUFFER_GROUP_ID;
+				syscall(__NR_io_uring_register, fd, IORING_UNREGISTER_PBUF_RING, &bufReg, 1);
+			}
+			close(fd);
+			fd = -1;
+		}
+		if (bufRing != NULL) {
+			munmap(bufRing, bufRingSize);
+			bufRing = NULL;
+		}
+		if (sqes != NULL) {
+			munmap(sqes, sqesSize);
+			sqes = NULL;
+		}
+		if (ringPtr != NULL) {
+			munmap(ringPtr, ringSize);
+			ringPtr = NULL;
+		}
+		buffers.clear();
+
+		vector<IoUringRecv *>::iterator it, end = recvs.end();
+		for (it = recvs.begin(); it != end; it++) {
+			delete *it;
+		}
+		recvs.clear();
+		freeRecvs.clear();
+	}
+
+	void addBuffer(unsigned int bid) {
+		struct io_uring_buf *buf = &bufRing[bufRingTail & bufRingMask];
+		buf->addr = (boost::uint64_t) (uintptr_t) buffers[bid].start;
+		buf->len = buffers[bid].size();
+		buf->bid = bid;
+		bufRingTail++;
+		__atomic_store_n(bufRingTailPtr, bufRingTail, __ATOMIC_RELEASE);
+	}
+
+	struct io_uring_sqe *getSqe() {
+		if (sqLocalTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries) {
+			submit();
+			if (sqLocalTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries) {
+				// The kernel refuses new submissions until we
+				// have made room in the completion queue.
+				processCompletions();
+				submit();
+			}
+		}
+
+		unsigned int index = sqLocalTail & sqMask;
+		struct io_uring_sqe *sqe = &sqes[index];
+		memset(sqe, 0, sizeof(*sqe));
+		sqArray[index] = index;
+		sqLocalTail++;
+		sqUnsubmitted++;
+		return sqe;
+	}
+
+	void processCompletion(IoUringRecv *recv, int result, unsigned int flags) {
+		MemoryKit::mbuf buffer;
+		bool finished = !(flags & IORING_CQE_F_MORE);
+
+		if (flags & IORING_CQE_F_BUFFER) {
+			unsigned int bid = flags >> IORING_CQE_BUFFER_SHIFT;
+			if (result > 0) {
+				buffer = MemoryKit::mbuf(buffers[bid], 0, result);
+				buffers[bid] = MemoryKit::mbuf_get(pool);
+			}
+			addBuffer(bid);
+		}
+		if (result == -ENOBUFS) {
+			totalBufferExhaustions++;
+		}
+
+		if (recv->callback != NULL) {
+			recv->callback(recv, buffer, result, finished);
+		}
+		if (finished) {
+			freeRecvs.push_back(recv);
+		}
+	}
+
+public:
+	boost::uint64_t totalSubmitCalls;
+	boost::uint64_t totalCompletions;
+	boost::uint64_t totalBufferExhaustions;
+
+	/**
+	 * @throws SystemException The kernel doesn't support io_uring, or
+	 *   doesn't allow us to use it.
+	 */
+	IoUring(struct ev_loop *_loop, struct MemoryKit::mbuf_pool *_pool,
+		unsigned int bufferCount)
+		: loop(_loop),
+		  pool(_pool),
+		  fd(-1),
+		  ringPtr(NULL),
+		  sqes(NULL),
+		  sqUnsubmitted(0),
+		  bufRing(NULL),
+		  totalSubmitCalls(0),
+		  totalCompletions(0),
+		  totalBufferExhaustions(0)
+	{
+		ev_io_init(&ringWatcher, _onRingReadable, -1, EV_READ);
+		ringWatcher.data = this;
+		ev_prepare_init(&prepareWatcher, _onPrepare);
+		prepareWatcher.data = this;
+
+		if (bufferCount == 0 || (bufferCount & (bufferCount - 1)) != 0
+		 || bufferCount > 32768)
+		{
+			throw ArgumentException("The number of io_uring receive buffers "
+				"must be a power of 2, and at most 32768");
+		}
+
+		try {
+			setupRings(bufferCount);
+		} catch (...) {
+			cleanup();
+			throw;
+		}
+
+		// Neither watcher should keep the event loop alive.
+		ev_io_set(&ringWatcher, fd, EV_READ);
+		ev_io_start(loop, &ringWatcher);
+		ev_unref(loop);
+		ev_prepare_start(loop, &prepareWatcher);
+		ev_unref(loop);
+	}
+
+	~IoUring() {
+		cleanup();
+	}
+
+	/**
+	 * Starts receiving from the given socket until the operation is
+	 * cancelled, or until EOF or an error occurs.
+	 */
+	IoUringRecv *startRecv(int sockfd, IoUringRecv::Callback callback, void *userData) {
+		IoUringRecv *recv;
+		if (freeRecvs.empty()) {
+			recv = new IoUringRecv();
+			recvs.push_back(recv);
+		} else {
+			recv = freeRecvs.back();
+			freeRecvs.pop_back();
+		}
+		recv->callback = callback;
+		recv->userData = userData;
+		recv->cancelled = false;
+
+		struct io_uring_sqe *sqe = getSqe();
+		sqe->opcode = IORING_OP_RECV;
+		sqe->fd = sockfd;
+		sqe->ioprio = IORING_RECV_MULTISHOT;
+		sqe->flags = IOSQE_BUFFER_SELECT;
+		sqe->buf_group = BUFFER_GROUP_ID;
+		sqe->user_data = (boost::uint64_t) (uintptr_t) recv;
+		return recv;
+	}
+
+	/**
+	 * Asks the kernel to stop the operation. Data that the kernel had
+	 * already received is still passed to the callback, followed by a
+	 * final completion.
+	 */
+	void cancelRecv(IoUringRecv *recv) {
+		if (recv->cancelled) {
+			return;
+		}
+		recv->cancelled = true;
+
+		struct io_uring_sqe *sqe = getSqe();
+		sqe->opcode = IORING_OP_ASYNC_CANCEL;
+		sqe->fd = -1;
+		sqe->addr = (boost::uint64_t) (uintptr_t) recv;
+		sqe->user_data = 0;
+	}
+
+	/**
+	 * Cancels the operation and makes sure that the callback is not called
+	 * anymore. The operation object is released once the kernel is done
+	 * with it.
+	 */
+	void detachRecv(IoUringRecv *recv) {
+		recv->callback = NULL;
+		recv->userData = NULL;
+		cancelRecv(recv);
+	}
+
+	/**
+	 * Passes all queued submissions to the kernel. Called automatically
+	 * before the event loop polls for events.
+	 */
+	void submit() {
+		if (sqUnsubmitted == 0) {
+			return;
+		}
+
+		unsigned int flags = 0;
+		__atomic_store_n(sqTail, sqLocalTail, __ATOMIC_RELEASE);
+		if (__atomic_load_n(sqFlags, __ATOMIC_RELAXED) & IORING_SQ_CQ_OVERFLOW) {
+			flags |= IORING_ENTER_GETEVENTS;
+		}
+		int ret = enter(sqUnsubmitted, flags);
+		totalSubmitCalls++;
+		if (ret > 0) {
+			sqUnsubmitted -= std::min<unsigned int>(ret, sqUnsubmitted);
+		}
+		// On failure (e.g. EBUSY or EAGAIN), the remaining entries are
+		// submitted again on the next event loop iteration.
+	}
+
+	void processCompletions() {
+		if (__atomic_load_n(sqFlags, __ATOMIC_RELAXED) & IORING_SQ_CQ_OVERFLOW) {
+			// Have the kernel move overflowed completions into the ring.
+			enter(0, IORING_ENTER_GETEVENTS);
+		}
+
+		// Only process the completions that are available now. Newer
+		// completions make the ring readable again, so they are
+		// processed in the next event loop iteration. The head is reloaded
+		// every time because a callback may end up in getSqe(), which may
+		// process completions too.
+		unsigned int tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+		while (true) {
+			unsigned int head = *cqHead;
+			if ((int) (tail - head) <= 0) {
+				break;
+			}
+
+			struct io_uring_cqe *cqe = &cqes[head & cqMask];
+			boost::uint64_t userData = cqe->user_data;
+			int result = cqe->res;
+			unsigned int flags = cqe->flags;
+
+			head++;
+			__atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+			totalCompletions++;
+
+			if (userData != 0) {
+				processCompletion((IoUringRecv *) (uintptr_t) userData,
+					result, flags);
+			}
+		}
+	}
+
+	Json::Value inspectStateAsJson() const {
+		Json::Value doc;
+		doc["receive_buffers"] = (Json::UInt) buffers.size();
+		doc["active_recvs"] = (Json::UInt) (recvs.size() - freeRecvs.size());
+		doc["total_submit_calls"] = (Json::UInt64) totalSubmitCalls;
+		doc["total_completions"] = (Json::UInt64) totalCompletions;
+		doc["total_buffer_exhaustions"] = (Json::UInt64) totalBufferExhaustions;
+		return doc;
+	}
+};
+
+
+} // namespace ServerKit
+} // namespace Passenger
+
+#endif /* PASSENGER_IO_URING_SUPPORTED */
+
+#endif /* _PASSENGER_SERVER_KIT_IO_URING_H_ */
@@ -31,6 +31,7 @@
 #include <boost/cstdint.hpp>
 #include <boost/config.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/atomic.hpp>
 #include <oxt/system_calls.hpp>
 #include <oxt/backtrace.hpp>
 #include <oxt/macros.hpp>
@@ -286,6 +287,11 @@ public:
 	FreeClientList freeClients;
 	ClientList activeClients, disconnectedClients;
 	unsigned int freeClientCount, activeClientCount, disconnectedClientCount;
+	/**
+	 * A copy of `activeClientCount` that other threads may read.
+	 * See `getLoad()`.
+	 */
+	boost::atomic<unsigned int> sharedActiveClientCount;
 	unsigned int peakActiveClientCount;
 	unsigned long totalClientsAccepted, lastTotalClientsAccepted;
 	unsigned long long totalBytesConsumed;
@@ -350,6 +356,7 @@ private:
 			activeClientCount++;
 			acceptCount++;
 			totalClientsAccepted++;
+			sharedActiveClientCount.store(activeClientCount, boost::memory_order_relaxed);
 			client->number = getNextClientNumber();
 			reinitializeClient(client, fd);
 			P_LOG_FILE_DESCRIPTOR_PURPOSE(fd, "Server " << getServerName()
@@ -599,6 +606,19 @@ private:
 		server->onClientOutputError(client, errcode);
 	}
 
+	void deactivateClient(Client *c) {
+		onClientDisconnecting(c);
+
+		c->setConnState(ClientType::DISCONNECTED);
+		TAILQ_REMOVE(&activeClients, c, nextClient.activeOrDisconnectedClient);
+		activeClientCount--;
+		sharedActiveClientCount.store(activeClientCount, boost::memory_order_relaxed);
+		TAILQ_INSERT_HEAD(&disconnectedClients, c, nextClient.activeOrDisconnectedClient);
+		disconnectedClientCount++;
+
+		deinitializeClient(c);
+	}
+
 protected:
 	/***** Hooks *****/
 
@@ -733,6 +753,7 @@ public:
 		  freeClientCount(0),
 		  activeClientCount(0),
 		  disconnectedClientCount(0),
+		  sharedActiveClientCount(0),
 		  peakActiveClientCount(0),
 		  totalClientsAccepted(0),
 		  lastTotalClientsAccepted(0),
@@ -849,6 +870,17 @@ public:
 	}
 
 
+	/**
+	 * Returns how busy this server is, for the purpose of load balancing
+	 * new clients over multiple servers (see AcceptLoadBalancer). This is
+	 * the number of active clients, but subclasses may take more into
+	 * account. May be called from any thread; the result is a recent
+	 * value, not necessarily the current one.
+	 */
+	unsigned int getLoad() const {
+		return sharedActiveClientCount.load(boost::memory_order_relaxed);
+	}
+
 	void feedNewClients(const int *fds, unsigned int size) {
 		Client *client;
 		Client *acceptedClients[MAX_ACCEPT_BURST_COUNT];
@@ -859,6 +891,7 @@ public:
 
 		activeClientCount += size;
 		totalClientsAccepted += size;
+		sharedActiveClientCount.store(activeClientCount, boost::memory_order_relaxed);
 
 		for (unsigned int i = 0; i < size; i++) {
 			client = checkoutClientObject();
@@ -876,6 +909,51 @@ public:
 		onClientsAccepted(acceptedClients, size);
 	}
 
+	/**
+	 * Starts serving a client connection that was previously served by
+	 * another server, which handed over the file descriptor with
+	 * `detachClient()`. `bufferedInput` is data that the other server had
+	 * already read from the connection, but not yet processed. It is
+	 * processed before anything else is read from the file descriptor.
+	 */
+	void feedMigratedClient(int fd, const string &bufferedInput) {
+		Client *client;
+
+		if (serverState != ACTIVE) {
+			SKS_DEBUG("Server is shutting down; closing migrated client " << fd);
+			safelyClose(fd, true);
+			return;
+		}
+
+		activeClientCount++;
+		peakActiveClientCount = std::max(peakActiveClientCount, activeClientCount);
+		sharedActiveClientCount.store(activeClientCount, boost::memory_order_relaxed);
+
+		client = checkoutClientObject();
+		TAILQ_INSERT_HEAD(&activeClients, client, nextClient.activeOrDisconnectedClient);
+		client->number = getNextClientNumber();
+		reinitializeClient(client, fd);
+		P_LOG_FILE_DESCRIPTOR_PURPOSE(fd, "Server " << getServerName()
+			<< ", client " << getClientName(client));
+
+		SKC_DEBUG(client, "Client migrated from another server with " <<
+			bufferedInput.size() << " bytes of buffered input; there are now " <<
+			activeClientCount << " active client(s)");
+
+		onClientAccepted(client);
+		if (client->connected()) {
+			MemoryKit::mbuf buffer;
+			if (!bufferedInput.empty()) {
+				buffer = MemoryKit::mbuf_get_with_size(&ctx->mbuf_pool,
+					bufferedInput.size());
+				memcpy(buffer.start, bufferedInput.data(), bufferedInput.size());
+			}
+			client->input.startReadingWithData(buffer);
+		}
+		// See the comment in onClientsAccepted().
+		unrefClient(client, __FILE__, __LINE__);
+	}
+
 
 	/***** Server management *****/
 
@@ -1038,15 +1116,7 @@ public:
 		int fdnum = c->getFd();
 		SKC_TRACE(c, 2, "Disconnecting; there are now " << (activeClientCount - 1) <<
 			" active clients");
-		onClientDisconnecting(c);
-
-		c->setConnState(ClientType::DISCONNECTED);
-		TAILQ_REMOVE(&activeClients, c, nextClient.activeOrDisconnectedClient);
-		activeClientCount--;
-		TAILQ_INSERT_HEAD(&disconnectedClients, c, nextClient.activeOrDisconnectedClient);
-		disconnectedClientCount++;
-
-		deinitializeClient(c);
+		deactivateClient(c);
 		SKC_TRACE(c, 2, "Closing client file descriptor: " << fdnum);
 		try {
 			safelyClose(fdnum);
@@ -1062,6 +1132,29 @@ public:
 		return true;
 	}
 
+	/**
+	 * Like `disconnect()`, but instead of closing the client's file
+	 * descriptor, returns it to the caller, who may pass it to another
+	 * server with `feedMigratedClient()`. Returns -1 if the client was
+	 * already disconnected.
+	 */
+	int detachClient(Client **client) {
+		Client *c = *client;
+		if (c->getConnState() != Client::ACTIVE) {
+			return -1;
+		}
+
+		int fdnum = c->getFd();
+		SKC_TRACE(c, 2, "Detaching file descriptor " << fdnum << "; there are now " <<
+			(activeClientCount - 1) << " active clients");
+		deactivateClient(c);
+
+		*client = NULL;
+		onClientDisconnected(c);
+		unrefClient(c, __FILE__, __LINE__);
+		return fdnum;
+	}
+
 	void disconnectWithWarning(Client **client, const StaticString &message) {
 		SKC_WARN(*client, "Disconnecting client with warning: " << message);
 		disconnect(client);
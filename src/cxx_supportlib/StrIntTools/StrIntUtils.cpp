@@ -27,6 +27,7 @@
 #include <boost/cstdint.hpp>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <cctype>
 #include <cmath>
 #include <cassert>
@@ -36,6 +37,10 @@
 #include <SystemTools/SystemTime.h>
 #include <StrIntTools/StrIntUtils.h>
 
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
+
 namespace Passenger {
 
 string
@@ -511,6 +516,82 @@ atol(const string &s) {
 	}
 #endif
 
+#ifdef __SSE2__
+	/**
+	 * Converts 16 header name bytes at once. Returns a bitmask with a bit set
+	 * for every byte that is an alphanumeric or a dash.
+	 */
+	static OXT_FORCE_INLINE int
+	convertHttpHeaderNameToScgi16(const char *data, char *output) {
+		const __m128i input = _mm_loadu_si128((const __m128i *) data);
+		const __m128i isLower = _mm_and_si128(
+			_mm_cmpgt_epi8(input, _mm_set1_epi8('a' - 1)),
+			_mm_cmplt_epi8(input, _mm_set1_epi8('z' + 1)));
+		const __m128i isUpper = _mm_and_si128(
+			_mm_cmpgt_epi8(input, _mm_set1_epi8('A' - 1)),
+			_mm_cmplt_epi8(input, _mm_set1_epi8('Z' + 1)));
+		const __m128i isDigit = _mm_and_si128(
+			_mm_cmpgt_epi8(input, _mm_set1_epi8('0' - 1)),
+			_mm_cmplt_epi8(input, _mm_set1_epi8('9' + 1)));
+		const __m128i isDash = _mm_cmpeq_epi8(input, _mm_set1_epi8('-'));
+
+		__m128i result = _mm_sub_epi8(input,
+			_mm_and_si128(isLower, _mm_set1_epi8(0x20)));
+		result = _mm_or_si128(_mm_andnot_si128(isDash, result),
+			_mm_and_si128(isDash, _mm_set1_epi8('_')));
+		_mm_storeu_si128((__m128i *) output, result);
+
+		return _mm_movemask_epi8(_mm_or_si128(
+			_mm_or_si128(isLower, isUpper),
+			_mm_or_si128(isDigit, isDash)));
+	}
+#endif
+
+bool
+convertHttpHeaderNameToScgi(const char * restrict data, char * restrict output, size_t len) {
+	#ifdef __SSE2__
+		while (len >= 16) {
+			if (convertHttpHeaderNameToScgi16(data, output) != 0xffff) {
+				return false;
+			}
+			data += 16;
+			output += 16;
+			len -= 16;
+		}
+		if (len > 0) {
+			// Most header names are shorter than 16 bytes. Process the
+			// remainder through a padded buffer so that we never read
+			// or write outside the caller's buffers.
+			char in[16], out[16];
+			memset(in, 0, sizeof(in));
+			memcpy(in, data, len);
+			int mask = (1 << len) - 1;
+			if ((convertHttpHeaderNameToScgi16(in, out) & mask) != mask) {
+				return false;
+			}
+			memcpy(output, out, len);
+		}
+		return true;
+	#else
+		const char *end = data + len;
+		while (data < end) {
+			char ch = *data;
+			if (ch >= 'a' && ch <= 'z') {
+				*output = ch - 0x20;
+			} else if (ch == '-') {
+				*output = '_';
+			} else if ((ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9')) {
+				*output = ch;
+			} else {
+				return false;
+			}
+			data++;
+			output++;
+		}
+		return true;
+	#endif
+}
+
 bool
 constantTimeCompare(const StaticString &a, const StaticString &b) {
 	// http://blog.jasonmooberry.com/2010/10/constant-time-string-comparison/
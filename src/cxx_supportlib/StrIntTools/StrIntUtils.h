@@ -427,6 +427,15 @@ roundUp(IntegerType number, IntegerType multiple) {
  */
 void convertLowerCase(const unsigned char * restrict data, unsigned char * restrict output, size_t len);
 
+/**
+ * Copies an HTTP header name to `output` in the form used for CGI and SCGI
+ * environment variable names: letters are uppercased and dashes are replaced
+ * by underscores. Returns false if the name contains anything other than
+ * alphanumerics and dashes, in which case the contents of `output` are
+ * undefined.
+ */
+bool convertHttpHeaderNameToScgi(const char * restrict data, char * restrict output, size_t len);
+
 /**
  * Compare two strings using a constant time algorithm to avoid timing attacks.
  */
@@ -33,6 +33,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <algorithm>
 
 #ifdef __APPLE__
 	#include <mach/mach_traps.h>
@@ -53,7 +54,9 @@
 #include <sys/time.h>
 #include <sys/resource.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <signal.h>
+#include <cstdio>
 #include <cstdlib>
 #include <cerrno>
 #include <cstring>
@@ -89,6 +92,10 @@ struct ProcessMetrics {
 	 * -1 if unknown, 0 if completely swapped out.
 	 */
 	ssize_t  privateDirty;
+	/** Unique Set Size, see measureRealMemory(). Does not include swap.
+	 * -1 if unknown, 0 if completely swapped out.
+	 */
+	ssize_t  uss;
 	/** Amount of memory in swap.
 	 * -1 if unknown, 0 if no swap used.
 	 */
@@ -106,6 +113,7 @@ struct ProcessMetrics {
 		rss = -1;
 		pss = -1;
 		privateDirty = -1;
+		uss = -1;
 		swap = -1;
 		vmsize = -1;
 		processGroupId = (pid_t) -1;
@@ -116,6 +124,32 @@ struct ProcessMetrics {
 		return pid != (pid_t) -1;
 	}
 
+	/**
+	 * Returns the amount of memory in KB that this process uses on its own,
+	 * i.e. that would be freed if it exited: its unique set size plus swap.
+	 * Falls back to realMemory() if the unique set size is unknown.
+	 */
+	size_t privateMemory() const {
+		if (uss != -1) {
+			return uss + (swap != -1 ? swap : 0);
+		} else {
+			return realMemory();
+		}
+	}
+
+	/**
+	 * Returns the amount of this process's resident memory in KB that
+	 * is shared with at least one other process, e.g. pages that are
+	 * still shared copy-on-write with a preloader. -1 if unknown.
+	 */
+	ssize_t shared() const {
+		if (rss != -1 && uss != -1 && rss >= uss) {
+			return rss - uss;
+		} else {
+			return -1;
+		}
+	}
+
 	/**
 	 * Returns an estimate of the "real" memory usage of a process in KB.
 	 * We don't use the PSS here because that would mean if another
@@ -194,6 +228,9 @@ public:
 class ProcessMetricsCollector {
 private:
 	bool canMeasureRealMemory;
+	bool useProcFilesystem;
+	long clockTicksPerSecond;
+	long pageSize;
 	string psOutput;
 
 	template<typename Collection, typename ConstIterator>
@@ -250,6 +287,140 @@ private:
 		return result;
 	}
 
+	/**
+	 * Fills `metrics` with the same fields that 'ps' would have reported.
+	 * Returns false if the process doesn't exist (anymore).
+	 *
+	 * @throws ParseException
+	 */
+	bool readProcessMetricsFromProcFilesystem(pid_t pid, double uptime,
+		char *buf, size_t bufsize, ProcessMetrics &metrics) const
+	{
+		char path[64];
+		ssize_t size;
+		unsigned long long fields[25];
+		unsigned int i;
+
+		snprintf(path, sizeof(path), "/proc/%ld/stat", (long) pid);
+		if (readProcFile(path, buf, bufsize) <= 0) {
+			return false;
+		}
+
+		// The command name is in parentheses, but may itself contain
+		// spaces and parentheses, so the other fields are parsed from
+		// the last closing parenthesis onwards.
+		char *commStart = strchr(buf, '(');
+		char *commEnd = strrchr(buf, ')');
+		if (commStart == NULL || commEnd == NULL || commEnd < commStart) {
+			throw ParseException();
+		}
+		string comm(commStart + 1, commEnd - commStart - 1);
+
+		// Field 3 is the process state, a single character.
+		char *pos = commEnd + 1;
+		while (*pos == ' ') {
+			pos++;
+		}
+		if (*pos == '\0') {
+			throw ParseException();
+		}
+		pos++;
+		for (i = 4; i < 25; i++) {
+			char *end;
+			fields[i] = strtoull(pos, &end, 10);
+			if (end == pos) {
+				throw ParseException();
+			}
+			pos = end;
+		}
+
+		// Like 'ps', report the CPU usage as the percentage of time that
+		// the process has spent on the CPU since it started.
+		double cpuTime = (double) (fields[14] + fields[15]) / clockTicksPerSecond;
+		double elapsedTime = uptime - (double) fields[22] / clockTicksPerSecond;
+		double cpu = (elapsedTime > 0) ? cpuTime * 100 / elapsedTime : 0;
+
+		metrics.pid = pid;
+		metrics.ppid = (pid_t) fields[4];
+		metrics.processGroupId = (pid_t) fields[5];
+		metrics.cpu = (boost::uint8_t) std::min<double>(cpu, 255);
+		metrics.vmsize = fields[23] / 1024;
+		metrics.rss = fields[24] * pageSize / 1024;
+
+		// 'ps' reports the effective UID.
+		snprintf(path, sizeof(path), "/proc/%ld/status", (long) pid);
+		if (readProcFile(path, buf, bufsize) <= 0) {
+			return false;
+		}
+		// The Uid line contains the real, effective, saved and filesystem
+		// UIDs, separated by tabs.
+		char *uidLine = strstr(buf, "\nUid:");
+		if (uidLine == NULL) {
+			throw ParseException();
+		}
+		pos = uidLine + sizeof("\nUid:") - 1;
+		for (i = 0; i < 2; i++) {
+			char *end;
+			fields[i] = strtoull(pos, &end, 10);
+			if (end == pos) {
+				throw ParseException();
+			}
+			pos = end;
+		}
+		metrics.uid = (uid_t) fields[1];
+
+		// The command line's arguments are separated by NULs. Processes
+		// without a command line, such as zombies, are shown by 'ps' as
+		// their command name in brackets.
+		snprintf(path, sizeof(path), "/proc/%ld/cmdline", (long) pid);
+		size = readProcFile(path, buf, bufsize);
+		while (size > 0 && buf[size - 1] == '\0') {
+			size--;
+		}
+		if (size > 0) {
+			for (i = 0; i < (unsigned int) size; i++) {
+				if (buf[i] == '\0') {
+					buf[i] = ' ';
+				}
+			}
+			metrics.command.assign(buf, size);
+		} else {
+			metrics.command = "[" + comm + "]";
+		}
+
+		return true;
+	}
+
+	/**
+	 * Reads at most `size - 1` bytes from the given file into `buf` and
+	 * NUL-terminates it. Returns the number of bytes read, or -1 on error.
+	 */
+	static ssize_t readProcFile(const char *path, char *buf, size_t size) {
+		int fd = syscalls::open(path, O_RDONLY);
+		if (fd == -1) {
+			return -1;
+		}
+
+		size_t total = 0;
+		ssize_t ret;
+		do {
+			ret = syscalls::read(fd, buf + total, size - 1 - total);
+			if (ret > 0) {
+				total += ret;
+			}
+		} while (ret > 0 && total < size - 1);
+		int e = errno;
+		syscalls::close(fd);
+
+		buf[total] = '\0';
+		if (ret == -1) {
+			errno = e;
+			return -1;
+		} else {
+			return total;
+		}
+	}
+
 	static void afterFork() {
 		// Make ps nicer, we want to have as little impact on the rest
 		// of the system as possible while collecting the metrics.
@@ -268,6 +439,13 @@ public:
 		#else
 			canMeasureRealMemory = fileExists("/proc/self/smaps");
 		#endif
+		#ifdef __linux__
+			useProcFilesystem = fileExists("/proc/self/stat");
+		#else
+			useProcFilesystem = false;
+		#endif
+		clockTicksPerSecond = sysconf(_SC_CLK_TCK);
+		pageSize = sysconf(_SC_PAGESIZE);
 	}
 
 	/** Mock 'ps' output, used by unit tests. */
@@ -281,7 +459,10 @@ public:
 	 *
 	 * Returns a map which maps a given PID to its collected metrics.
 	 *
-	 * @throws ParseException The ps output cannot be parsed.
+	 * On Linux, metrics are read from /proc. Elsewhere, or when mock 'ps'
+	 * output has been set, they're parsed from the output of 'ps'.
+	 *
+	 * @throws ParseException The ps output or a /proc file cannot be parsed.
 	 * @throws SystemException Error collecting the ps output or error querying memory usage.
 	 */
 	template<typename Collection, typename ConstIterator>
@@ -290,6 +471,29 @@ public:
 			return ProcessMetricMap();
 		}
 
+		ProcessMetricMap result;
+		if (useProcFilesystem && psOutput.empty()) {
+			result = collectFromProcFilesystem<Collection, ConstIterator>(pids);
+		} else {
+			result = collectFromPs<Collection, ConstIterator>(pids);
+		}
+		if (canMeasureRealMemory) {
+			ProcessMetricMap::iterator it;
+			for (it = result.begin(); it != result.end(); it++) {
+				ProcessMetrics &metric = it->second;
+				measureRealMemory(metric.pid, metric.pss,
+					metric.privateDirty, metric.uss, metric.swap);
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * Collects metrics by parsing the output of 'ps', or the mock output
+	 * set with setPsOutput(). Doesn't measure the real memory usage.
+	 */
+	template<typename Collection, typename ConstIterator>
+	ProcessMetricMap collectFromPs(const Collection &pids) const {
 		ConstIterator it;
 		// The list of PIDs must follow -p without a space.
 		// https://groups.google.com/forum/#!topic/phusion-passenger/WKXy61nJBMA
@@ -336,12 +540,32 @@ public:
 		ProcessMetricMap result = parsePsOutput<Collection, ConstIterator>(
 			psOutput.data, pids);
 		psOutput.data.resize(0);
-		if (canMeasureRealMemory) {
-			ProcessMetricMap::iterator it;
-			for (it = result.begin(); it != result.end(); it++) {
-				ProcessMetrics &metric = it->second;
-				measureRealMemory(metric.pid, metric.pss,
-					metric.privateDirty, metric.swap);
+		return result;
+	}
+
+	/**
+	 * Collects metrics by reading /proc/<pid>/stat, /proc/<pid>/status and
+	 * /proc/<pid>/cmdline directly, instead of forking 'ps'. Only a single
+	 * buffer on the stack is used for all files of all processes.
+	 */
+	template<typename Collection, typename ConstIterator>
+	ProcessMetricMap collectFromProcFilesystem(const Collection &pids) const {
+		ProcessMetricMap result;
+		char buf[1024 * 8];
+		ConstIterator it;
+
+		if (readProcFile("/proc/uptime", buf, sizeof(buf)) <= 0) {
+			int e = errno;
+			throw SystemException("Cannot read /proc/uptime", e);
+		}
+		double uptime = atof(buf);
+
+		for (it = pids.begin(); it != pids.end(); it++) {
+			ProcessMetrics metrics;
+			if (readProcessMetricsFromProcFilesystem(*it, uptime, buf,
+				sizeof(buf), metrics))
+			{
+				result[metrics.pid] = metrics;
 			}
 		}
 		return result;
@@ -359,16 +583,27 @@ public:
 	 *   memory, where the size of each page is divided by the number of processes
 	 *   sharing it.
 	 * - The private dirty RSS.
+	 * - The unique set size: total size of a process's pages that are in
+	 *   memory and not shared with any other process, whether clean or
+	 *   dirty. This is the amount of memory that would be freed if the
+	 *   process exited.
 	 * - Amount of memory in swap.
 	 *
 	 * At this time only OS X and recent Linux versions (>= 2.6.25) support
 	 * measuring the proportional set size. Usually root privileges are required.
 	 *
-	 * pss, privateDirty and swap can each be individually set to -1 if that
-	 * part cannot be measured, e.g. because we do not have permission
+	 * pss, privateDirty, uss and swap can each be individually set to -1 if
+	 * that part cannot be measured, e.g. because we do not have permission
 	 * to do so or because the OS does not support measuring it.
 	 */
 	static void measureRealMemory(pid_t pid, ssize_t &pss, ssize_t &privateDirty, ssize_t &swap) {
+		ssize_t uss;
+		measureRealMemory(pid, pss, privateDirty, uss, swap);
+	}
+
+	static void measureRealMemory(pid_t pid, ssize_t &pss, ssize_t &privateDirty,
+		ssize_t &uss, ssize_t &swap)
+	{
 		#ifdef __APPLE__
 			kern_return_t ret;
 			mach_port_t task;
@@ -379,6 +614,7 @@ public:
 			if (ret != KERN_SUCCESS) {
 				pss = -1;
 				privateDirty = -1;
+				uss = -1;
 				return;
 			}
 
@@ -388,6 +624,7 @@ public:
 			// In bytes.
 			pss = 0;
 			privateDirty = 0;
+			uss = 0;
 
 			while (true) {
 				mach_vm_address_t size;
@@ -407,10 +644,13 @@ public:
 					pss += info.private_pages_resident * pagesize;
 					pss += info.shared_pages_resident * pagesize;
 					privateDirty += info.private_pages_resident * pagesize;
+					uss += info.private_pages_resident * pagesize;
+					uss += info.shared_pages_resident * pagesize;
 				} else if (info.share_mode == SM_COW) {
 					pss += info.private_pages_resident * pagesize;
 					pss += info.shared_pages_resident * pagesize / info.ref_count;
 					privateDirty += info.private_pages_resident * pagesize;
+					uss += info.private_pages_resident * pagesize;
 				} else if (info.share_mode == SM_SHARED) {
 					pss += info.shared_pages_resident * pagesize / info.ref_count;
 				}
@@ -423,84 +663,132 @@ public:
 			// Convert result back to KB.
 			pss /= 1024;
 			privateDirty /= 1024;
+			uss /= 1024;
 		#else
-			string smapsFilename = "/proc/";
-			smapsFilename.append(toString(pid));
-			smapsFilename.append("/smaps");
-
-			FILE *f = syscalls::fopen(smapsFilename.c_str(), "r");
-			if (f == NULL) {
-				error:
-				pss = -1;
-				privateDirty = -1;
-				swap = -1;
-				return;
+			string prefix = "/proc/";
+			prefix.append(toString(pid));
+
+			/* Linux >= 4.14 also provides smaps_rollup, which contains the
+			 * same fields as smaps, but already summed up over all mappings
+			 * by the kernel. That's much cheaper to read and parse than smaps
+			 * for processes with many mappings, such as Ruby apps.
+			 */
+			if (!measureRealMemoryFromSmaps(prefix + "/smaps_rollup", pss,
+				privateDirty, uss, swap) && errno == ENOENT)
+			{
+				measureRealMemoryFromSmaps(prefix + "/smaps", pss,
+					privateDirty, uss, swap);
 			}
+		#endif
+	}
 
-			StdioGuard guard(f, NULL, 0);
-			bool hasPss = false;
-			bool hasPrivateDirty = false;
-			bool hasSwap = false;
-
-			// In KB.
-			pss = 0;
-			privateDirty = 0;
-			swap = 0;
-
-			while (!feof(f)) {
-				char line[1024 * 4];
-				const char *buf;
+	#ifndef __APPLE__
+	/**
+	 * Sums up the proportional set size, private dirty RSS, unique set size
+	 * and swap from the given Linux smaps or smaps_rollup file. Each of them
+	 * is set to -1 if it cannot be determined. Returns false if the file
+	 * cannot be opened, in which case errno is set.
+	 */
+	static bool measureRealMemoryFromSmaps(const string &filename, ssize_t &pss,
+		ssize_t &privateDirty, ssize_t &uss, ssize_t &swap)
+	{
+		FILE *f = syscalls::fopen(filename.c_str(), "r");
+		if (f == NULL) {
+			int e = errno;
+			pss = -1;
+			privateDirty = -1;
+			uss = -1;
+			swap = -1;
+			errno = e;
+			return false;
+		}
 
-				buf = fgets(line, sizeof(line), f);
-				if (buf == NULL) {
-					if (ferror(f)) {
+		StdioGuard guard(f, NULL, 0);
+		bool hasPss = false;
+		bool hasPrivateDirty = false;
+		bool hasPrivateClean = false;
+		bool hasSwap = false;
+
+		// In KB.
+		pss = 0;
+		privateDirty = 0;
+		uss = 0;
+		swap = 0;
+
+		while (!feof(f)) {
+			char line[1024 * 4];
+			const char *buf;
+
+			buf = fgets(line, sizeof(line), f);
+			if (buf == NULL) {
+				if (ferror(f)) {
+					goto error;
+				} else {
+					break;
+				}
+			}
+			try {
+				if (startsWith(line, "Pss:")) {
+					/* Linux supports Proportional Set Size since kernel 2.6.25.
+					 * See kernel commit ec4dd3eb35759f9fbeb5c1abb01403b2fde64cc9.
+					 */
+					hasPss = true;
+					readNextWord(&buf);
+					pss += readNextWordAsLongLong(&buf);
+					if (readNextWord(&buf) != "kB") {
 						goto error;
-					} else {
-						break;
 					}
-				}
-				try {
-					if (startsWith(line, "Pss:")) {
-						/* Linux supports Proportional Set Size since kernel 2.6.25.
-						 * See kernel commit ec4dd3eb35759f9fbeb5c1abb01403b2fde64cc9.
-						 */
-						hasPss = true;
-						readNextWord(&buf);
-						pss += readNextWordAsLongLong(&buf);
-						if (readNextWord(&buf) != "kB") {
-							goto error;
-						}
-					} else if (startsWith(line, "Private_Dirty:")) {
-						hasPrivateDirty = true;
-						readNextWord(&buf);
-						privateDirty += readNextWordAsLongLong(&buf);
-						if (readNextWord(&buf) != "kB") {
-							goto error;
-						}
-					} else if (startsWith(line, "Swap:")) {
-						hasSwap = true;
-						readNextWord(&buf);
-						swap += readNextWordAsLongLong(&buf);
-						if (readNextWord(&buf) != "kB") {
-							goto error;
-						}
+				} else if (startsWith(line, "Private_Dirty:")) {
+					hasPrivateDirty = true;
+					readNextWord(&buf);
+					long long size = readNextWordAsLongLong(&buf);
+					privateDirty += size;
+					uss += size;
+					if (readNextWord(&buf) != "kB") {
+						goto error;
+					}
+				} else if (startsWith(line, "Private_Clean:")) {
+					hasPrivateClean = true;
+					readNextWord(&buf);
+					uss += readNextWordAsLongLong(&buf);
+					if (readNextWord(&buf) != "kB") {
+						goto error;
+					}
+				} else if (startsWith(line, "Swap:")) {
+					hasSwap = true;
+					readNextWord(&buf);
+					swap += readNextWordAsLongLong(&buf);
+					if (readNextWord(&buf) != "kB") {
+						goto error;
 					}
-				} catch (const ParseException &) {
-					goto error;
 				}
+			} catch (const ParseException &) {
+				goto error;
 			}
+		}
 
-			if (!hasPss) {
-				pss = -1;
-			}
-			if (!hasPrivateDirty) {
-				privateDirty = -1;
-			}
-			if (!hasSwap) {
-				swap = -1;
-			}
-		#endif
+		if (!hasPss) {
+			pss = -1;
+		}
+		if (!hasPrivateDirty) {
+			privateDirty = -1;
+		}
+		if (!hasPrivateDirty || !hasPrivateClean) {
+			uss = -1;
+		}
+		if (!hasSwap) {
+			swap = -1;
+		}
+		return true;
+
+		error:
+		pss = -1;
+		privateDirty = -1;
+		uss = -1;
+		swap = -1;
+		return true;
 	}
+	#endif
 };
 
 } // namespace Passenger
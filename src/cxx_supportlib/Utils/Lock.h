@@ -12,17 +12,20 @@ typedef boost::lock_guard<boost::mutex> LockGuard;
 typedef boost::unique_lock<boost::mutex> ScopedLock;
 
 /** Nicer syntax for conditionally locking the mutex during construction. */
-class DynamicScopedLock: public boost::unique_lock<boost::mutex> {
+template<typename Mutex>
+class BasicDynamicScopedLock: public boost::unique_lock<Mutex> {
 public:
-	DynamicScopedLock(boost::mutex &m, bool lockNow = true)
-		: boost::unique_lock<boost::mutex>(m, boost::defer_lock)
+	BasicDynamicScopedLock(Mutex &m, bool lockNow = true)
+		: boost::unique_lock<Mutex>(m, boost::defer_lock)
 	{
 		if (lockNow) {
-			lock();
+			this->lock();
 		}
 	}
 };
 
+typedef BasicDynamicScopedLock<boost::mutex> DynamicScopedLock;
+
 } // namespace Passenger
 
 #endif /* _PASSENGER_LOCK_H_ */
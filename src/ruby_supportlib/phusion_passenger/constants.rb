@@ -58,6 +58,8 @@ module SharedConstants
     DEFAULT_WEB_APP_USER = "nobody"
     DEFAULT_APP_ENV = "production"
     DEFAULT_SPAWN_METHOD = "smart"
+    DEFAULT_SPAWN_CONCURRENCY = 1
+    DEFAULT_SCALE_DOWN_DELAY = 60
     DEFAULT_BIND_ADDRESS = "127.0.0.1"
     # Apache's unixd.h also defines DEFAULT_USER, so we avoid naming clash here.
     PASSENGER_DEFAULT_USER = "nobody"
@@ -66,8 +68,13 @@ module SharedConstants
     DEFAULT_STICKY_SESSIONS_COOKIE_ATTRIBUTES = "SameSite=Lax; Secure;"
     DEFAULT_APP_THREAD_COUNT = 1
     DEFAULT_RESPONSE_BUFFER_HIGH_WATERMARK = 1024 * 1024 * 128
+    DEFAULT_REQUEST_BODY_SPLICE_THRESHOLD = 1024 * 128
     DEFAULT_MAX_REQUEST_QUEUE_SIZE = 100
     DEFAULT_STAT_THROTTLE_RATE = 10
+    DEFAULT_TURBOCACHE_MAX_ENTRIES = 1024
+    DEFAULT_TURBOCACHE_MAX_MEMORY = 1024 * 1024 * 16
+    DEFAULT_TURBOCACHE_MAX_BODY_SIZE = 1024 * 512
+    DEFAULT_TURBOCACHE_COALESCING_TIMEOUT = 5000
     DEFAULT_ANALYTICS_LOG_USER = DEFAULT_WEB_APP_USER
     DEFAULT_ANALYTICS_LOG_GROUP = ""
     DEFAULT_ANALYTICS_LOG_PERMISSIONS = "u=rwx,g=rx,o=rx"
@@ -92,12 +99,19 @@ module SharedConstants
     # high concurrency with low mem overhead. On the upload side there is a penalty
     # but there's no real average upload size anyway so we choose mem safety instead.
     DEFAULT_FILE_BUFFERED_CHANNEL_THRESHOLD = 1024 * 128
+    # Number of mbufs that the kernel can receive socket data into when io_uring is
+    # enabled. Shared by all connections of an event loop, so it only needs to cover
+    # the data that arrives within a single event loop iteration.
+    DEFAULT_IO_URING_RECV_BUFFERS = 256
     SERVER_KIT_MAX_SERVER_ENDPOINTS = 4
     LOG_MONITORING_MAX_LINES = 200
+    APP_CONNECTION_POOL_SHARDS = 8
+    APP_CONNECTION_PREWARM_LIMIT = 4
 
     # Time limits
     PROCESS_SHUTDOWN_TIMEOUT = 60 # In seconds
     PROCESS_SHUTDOWN_TIMEOUT_DISPLAY = "1 minute"
+    APP_CONNECTION_IDLE_TIMEOUT = 60 # In seconds
 
     # Versions
     PASSENGER_VERSION = PhusionPassenger::VERSION_STRING
@@ -76,6 +76,10 @@ def accept_and_process_next_client(server_socket)
 
       if doc['command'] == 'spawn'
         handle_spawn_command(client, doc)
+      elsif doc['command'] == 'spawn_batch'
+        handle_spawn_batch_command(client, doc)
+      elsif doc['command'] == 'prepare_for_fork'
+        handle_prepare_for_fork_command(client, doc)
       else
         client.write(Utils::JSON.generate(
           :result => 'error',
@@ -137,6 +141,118 @@ def handle_spawn_command(client, doc)
       end
     end
 
+    # Gets the preloader into a copy-on-write friendly state before the
+    # first process is forked from it. The app gets to warm up first through
+    # the `prepare_for_fork` event (e.g. by eager loading code or filling
+    # caches), so that whatever that allocates ends up in shared pages too.
+    # Then all garbage is freed and the heap is compacted, so that the live
+    # objects are packed into as few pages as possible and GC runs in the
+    # children dirty as few of them as possible.
+    def handle_prepare_for_fork_command(client, doc)
+      begin
+        PhusionPassenger.call_event(:prepare_for_fork)
+        prepare_heap_for_fork
+      rescue StandardError => e
+        client.write(Utils::JSON.generate(
+          :result => 'error',
+          :message => "Error preparing for fork: #{e} (#{e.class})"
+        ) + "\n")
+        return nil
+      end
+      client.write(Utils::JSON.generate(:result => 'ok') + "\n")
+      nil
+    end
+
+    def prepare_heap_for_fork
+      if ::Process.respond_to?(:warmup)
+        # Ruby >= 3.3. Besides a full GC and a compaction, this also
+        # promotes all surviving objects to the old generation and
+        # releases free heap pages, so that minor GCs in the children
+        # don't touch the shared heap at all.
+        ::Process.warmup
+      else
+        GC.start
+        begin
+          GC.compact if GC.respond_to?(:compact)
+        rescue NotImplementedError
+          # Compaction is not supported on this platform.
+        end
+      end
+    end
+
+    # Like handle_spawn_command, but forks a child for every work directory
+    # in the batch. The GC only has to run once for the whole batch, and
+    # the preloader itself reports the PIDs, in the same order as the work
+    # directories, so that the children don't have to take turns writing
+    # to the client socket.
+    def handle_spawn_batch_command(client, doc)
+      work_dirs = doc['work_dirs']
+      if !work_dirs.is_a?(Array) || work_dirs.empty?
+        client.write(Utils::JSON.generate(
+          :result => 'error',
+          :message => "'work_dirs' must be a non-empty array"
+        ))
+        return nil
+      end
+
+      work_dirs.each do |work_dir|
+        LoaderSharedHelpers.record_journey_step_end('PRELOADER_PREPARATION',
+          'STEP_PERFORMED', work_dir)
+        LoaderSharedHelpers.record_journey_step_begin('PRELOADER_FORK_SUBPROCESS',
+          'STEP_IN_PROGRESS', work_dir)
+      end
+
+      # Improve copy-on-write friendliness.
+      GC.start
+
+      pids = []
+      error = nil
+      work_dirs.each do |work_dir|
+        begin
+          pid = fork
+        rescue SystemCallError => e
+          error = e
+          break
+        end
+
+        if pid.nil?
+          begin
+            $0 = "#{$0} (forking...)"
+            LoaderSharedHelpers.record_journey_step_end('PRELOADER_FORK_SUBPROCESS',
+              'STEP_PERFORMED', work_dir)
+            LoaderSharedHelpers.record_journey_step_begin('PRELOADER_SEND_RESPONSE',
+              'STEP_IN_PROGRESS', work_dir)
+            LoaderSharedHelpers.record_journey_step_end('PRELOADER_SEND_RESPONSE',
+              'STEP_PERFORMED', work_dir)
+            LoaderSharedHelpers.record_journey_step_end('PRELOADER_FINISH',
+              'STEP_PERFORMED', work_dir)
+            return [:forked, work_dir]
+          rescue Exception => e
+            STDERR.puts("Error: #{e}\n#{e.backtrace.join("\n")}")
+            exit!(1)
+          end
+        elsif defined?(NativeSupport)
+          NativeSupport.detach_process(pid)
+        else
+          Process.detach(pid)
+        end
+        pids << pid
+      end
+
+      work_dirs[pids.size .. -1].each do |work_dir|
+        LoaderSharedHelpers.record_journey_step_end('PRELOADER_FORK_SUBPROCESS',
+          'STEP_ERRORED', work_dir)
+      end
+      raise error if pids.empty?
+
+      response = { :result => 'ok', :pids => pids }
+      response[:message] = "Cannot fork: #{error}" if error
+      # Terminate the response with a newline, because the children also
+      # hold the client socket open for a while.
+      client.write(Utils::JSON.generate(response) + "\n")
+      nil
+    end
+
     def advertise_sockets(_options, server)
       json = {
         :sockets => [
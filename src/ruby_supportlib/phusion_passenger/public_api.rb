@@ -30,6 +30,7 @@ class << self
     @@event_credentials = []
     @@event_after_installing_signal_handlers = []
     @@event_oob_work = []
+    @@event_prepare_for_fork = []
     @@event_unhandled_exception_before_exit = []
     @@advertised_concurrency_level = nil
 
@@ -70,6 +71,8 @@ def callback_list_for_event(name)
         @@event_after_installing_signal_handlers
       when :oob_work
         @@event_oob_work
+      when :prepare_for_fork
+        @@event_prepare_for_fork
       when :unhandled_exception_before_exit
         @@event_unhandled_exception_before_exit
       else
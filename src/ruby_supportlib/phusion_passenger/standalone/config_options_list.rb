@@ -404,8 +404,9 @@ module Standalone
         :name      => :memory_limit,
         :type      => :integer,
         :type_desc => 'MB',
-        :desc      => "Restart application processes that go over\n" \
-                      "the given memory limit (Enterprise only)"
+        :desc      => "Gracefully restart application processes\n" \
+                      "whose private memory usage goes over the\n" \
+                      "given limit. Default: 0 (no limit)"
       },
       {
         :name      => :rolling_restarts,
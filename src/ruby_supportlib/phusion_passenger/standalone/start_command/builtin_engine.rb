@@ -170,7 +170,7 @@ def build_daemon_controller_options
           add_enterprise_param(command, :thread_count, "--app-thread-count")
           add_param(command, :max_requests, "--max-requests")
           add_enterprise_param(command, :max_request_time, "--max-request-time")
-          add_enterprise_param(command, :memory_limit, "--memory-limit")
+          add_param(command, :memory_limit, "--memory-limit")
           add_enterprise_flag_param(command, :rolling_restarts, "--rolling-restarts")
           add_enterprise_flag_param(command, :resist_deployment_errors, "--resist-deployment-errors")
           add_enterprise_flag_param(command, :debugger, "--debugger")
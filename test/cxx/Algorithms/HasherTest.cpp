@@ -0,0 +1,81 @@
+#include <TestSupport.h>
+#include <Algorithms/Hasher.h>
+#include <StrIntTools/StrIntUtils.h>
+
+using namespace Passenger;
+using namespace std;
+
+namespace tut {
+	struct Algorithms_HasherTest: public TestBase {
+		string input;
+
+		Algorithms_HasherTest() {
+			const char pattern[] = "Content-TYPE_x-Forwarded-For\xc3\x89@[`{";
+			for (unsigned int i = 0; i < 100; i++) {
+				input.append(1, pattern[i % (sizeof(pattern) - 1)]);
+			}
+		}
+
+		/**
+		 * Checks that Hasher::updateLowerCase() produces the same output and
+		 * hash as convertLowerCase() followed by Hasher::update(), for `len`
+		 * bytes read from `data` and written to `output`.
+		 */
+		void checkUpdateLowerCase(const string &context, const char *data,
+			char *output, unsigned int len)
+		{
+			string expected(len, '\0');
+			convertLowerCase((const unsigned char *) data,
+				(unsigned char *) &expected[0], len);
+			Hasher expectedHasher;
+			expectedHasher.update(expected.data(), len);
+
+			Hasher actualHasher;
+			actualHasher.updateLowerCase(data, output, len);
+
+			ensure_equals((context + " Output").c_str(), string(output, len), expected);
+			ensure_equals((context + " Hash").c_str(),
+				actualHasher.finalize(), expectedHasher.finalize());
+		}
+	};
+
+	DEFINE_TEST_GROUP(Algorithms_HasherTest);
+
+	TEST_METHOD(1) {
+		set_test_name("updateLowerCase() is equivalent to convertLowerCase() followed by update()");
+		for (unsigned int len = 0; len <= input.size(); len++) {
+			string output(len, '\0');
+			checkUpdateLowerCase("(" + toString(len) + ")", input.data(),
+				&output[0], len);
+		}
+	}
+
+	TEST_METHOD(2) {
+		set_test_name("updateLowerCase() handles lengths around the 16-byte block size");
+		const unsigned int lengths[] = { 15, 16, 17, 31 };
+		for (unsigned int i = 0; i < sizeof(lengths) / sizeof(unsigned int); i++) {
+			string output(lengths[i], '\0');
+			checkUpdateLowerCase("(" + toString(lengths[i]) + ")", input.data(),
+				&output[0], lengths[i]);
+		}
+	}
+
+	TEST_METHOD(3) {
+		set_test_name("updateLowerCase() handles input and output that are not 16-byte aligned");
+		const unsigned int lengths[] = { 15, 16, 17, 31 };
+		char inputBuf[64 + 16];
+		char outputBuf[64 + 16];
+		// Round up to a 16-byte boundary so that we know which offsets are unaligned.
+		char *alignedInput = (char *) (((uintptr_t) inputBuf + 15) & ~(uintptr_t) 15);
+		char *alignedOutput = (char *) (((uintptr_t) outputBuf + 15) & ~(uintptr_t) 15);
+
+		for (unsigned int i = 0; i < sizeof(lengths) / sizeof(unsigned int); i++) {
+			for (unsigned int offset = 0; offset < 16; offset++) {
+				memcpy(alignedInput + offset, input.data(), lengths[i]);
+				checkUpdateLowerCase("(" + toString(lengths[i]) + ", "
+					+ toString(offset) + ")",
+					alignedInput + offset, alignedOutput + (15 - offset), lengths[i]);
+			}
+		}
+	}
+}
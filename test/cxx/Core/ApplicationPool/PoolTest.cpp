@@ -217,6 +217,13 @@ namespace tut {
 			return options;
 		}
 
+		static void getAndCloseSessions(Pool *pool, Options options, unsigned int iterations) {
+			Ticket ticket;
+			for (unsigned int i = 0; i < iterations; i++) {
+				pool->get(options, &ticket).reset();
+			}
+		}
+
 		void disableProcess(ProcessPtr process, AtomicInt *result) {
 			*result = (int) pool->disableProcess(process->getGupid());
 		}
@@ -239,7 +246,7 @@ namespace tut {
 		// as the new process is done spawning.
 		Options options = createOptions();
 
-		ScopedLock l(pool->syncher);
+		PoolScopedLock l(pool->syncher);
 		pool->asyncGet(options, callback, false);
 		ensure_equals("(1)", number, 0);
 		ensure("(2)", pool->getWaitlist.empty());
@@ -274,7 +281,7 @@ namespace tut {
 		ensure(!process->isTotallyBusy());
 
 		// Verify test assertion.
-		ScopedLock l(pool->syncher);
+		PoolScopedLock l(pool->syncher);
 		pool->asyncGet(options, callback, false);
 		ensure_equals("callback is immediately called", number, 2);
 	}
@@ -395,7 +402,7 @@ namespace tut {
 
 		// Now open another session. It should complete immediately
 		// and should not use the first process.
-		ScopedLock l(pool->syncher);
+		PoolScopedLock l(pool->syncher);
 		pool->asyncGet(options, callback, false);
 		ensure_equals("asyncGet() completed immediately", number, 2);
 		SessionPtr session2 = currentSession;
@@ -428,7 +435,7 @@ namespace tut {
 		pool->setMax(2);
 		GroupPtr group = pool->findOrCreateGroup(options);
 		{
-			LockGuard l(pool->syncher);
+			PoolLockGuard l(pool->syncher);
 			group->spawn();
 		}
 		EVENTUALLY(5,
@@ -547,7 +554,7 @@ namespace tut {
 		);
 
 		// The next asyncGet() should spawn a new process and the action should be queued.
-		ScopedLock l(pool->syncher);
+		PoolScopedLock l(pool->syncher);
 		skDebugSupport.dummySpawnDelay = 5000000;
 		pool->asyncGet(options, callback, false);
 		ensure(group->spawning());
@@ -848,7 +855,7 @@ namespace tut {
 		SystemTime::force(2);
 		GroupPtr barGroup = pool->get(options2, &ticket)->getGroup()->shared_from_this();
 		{
-			LockGuard l(pool->syncher);
+			PoolLockGuard l(pool->syncher);
 			ensure_equals("(1)", barGroup->spawn(), SR_OK);
 		}
 		debug->debugger->recv("Begin spawn loop iteration 1");
@@ -871,7 +878,7 @@ namespace tut {
 		debug->messages->send("Proceed with spawn loop iteration 2");
 		debug->debugger->recv("Spawn loop done");
 		EVENTUALLY(5,
-			LockGuard l(pool->syncher);
+			PoolLockGuard l(pool->syncher);
 			vector<ProcessPtr> processes = pool->getProcesses(false);
 			if (processes.size() == 1) {
 				GroupPtr group = processes[0]->getGroup()->shared_from_this();
@@ -933,7 +940,7 @@ namespace tut {
 		debug->messages->send("Proceed with spawn loop iteration 2");
 		debug->debugger->recv("Spawn loop done");
 		EVENTUALLY(5,
-			LockGuard l(pool->syncher);
+			PoolLockGuard l(pool->syncher);
 			vector<ProcessPtr> processes = pool->getProcesses(false);
 			if (processes.size() == 1) {
 				GroupPtr group = processes[0]->getGroup()->shared_from_this();
@@ -968,7 +975,7 @@ namespace tut {
 		ProcessPtr process = currentSession->getProcess()->shared_from_this();
 		pool->detachProcess(process);
 		{
-			LockGuard l(pool->syncher);
+			PoolLockGuard l(pool->syncher);
 			ensure(process->enabled == Process::DETACHED);
 		}
 		EVENTUALLY(5,
@@ -999,13 +1006,13 @@ namespace tut {
 		pool->asyncGet(options, callback);
 
 		{
-			LockGuard l(pool->syncher);
+			PoolLockGuard l(pool->syncher);
 			ensure_equals(pool->groups.lookupCopy("test")->getWaitlist.size(), 1u);
 		}
 
 		pool->detachProcess(session1->getProcess()->shared_from_this());
 		{
-			LockGuard l(pool->syncher);
+			PoolLockGuard l(pool->syncher);
 			ensure(pool->groups.lookupCopy("test")->spawning());
 			ensure_equals(pool->groups.lookupCopy("test")->enabledCount, 0);
 			ensure_equals(pool->groups.lookupCopy("test")->getWaitlist.size(), 1u);
@@ -1037,7 +1044,7 @@ namespace tut {
 		skDebugSupport.dummySpawnDelay = 90000;
 		pool->asyncGet(options2, callback);
 		{
-			LockGuard l(pool->syncher);
+			PoolLockGuard l(pool->syncher);
 			ensure_equals(pool->getWaitlist.size(), 1u);
 		}
 
@@ -1050,7 +1057,7 @@ namespace tut {
 		currentSession.reset();
 		pool->detachProcess(session1->getProcess()->shared_from_this());
 		{
-			LockGuard l(pool->syncher);
+			PoolLockGuard l(pool->syncher);
 			ensure(pool->groups.lookupCopy("test2") != NULL);
 			ensure_equals(pool->getWaitlist.size(), 0u);
 		}
@@ -1071,7 +1078,7 @@ namespace tut {
 		currentSession.reset();
 		GroupPtr group = process->getGroup()->shared_from_this();
 		pool->detachProcess(process);
-		LockGuard l(pool->syncher);
+		PoolLockGuard l(pool->syncher);
 		ensure_equals(pool->groups.size(), 1u);
 		ensure(group->isAlive());
 		ensure(!group->garbageCollectable());
@@ -1088,18 +1095,18 @@ namespace tut {
 
 		ensure(pool->detachProcess(process));
 		{
-			LockGuard l(pool->syncher);
+			PoolLockGuard l(pool->syncher);
 			ensure_equals(process->enabled, Process::DETACHED);
 		}
 		SHOULD_NEVER_HAPPEN(100,
-			LockGuard l(pool->syncher);
+			PoolLockGuard l(pool->syncher);
 			result = !process->isAlive()
 				|| !process->osProcessExists();
 		);
 
 		session.reset();
 		EVENTUALLY(1,
-			LockGuard l(pool->syncher);
+			PoolLockGuard l(pool->syncher);
 			result = process->enabled == Process::DETACHED
 				&& !process->osProcessExists()
 				&& process->isDead();
@@ -1119,7 +1126,7 @@ namespace tut {
 
 		ensure(pool->detachProcess(process));
 		{
-			LockGuard l(pool->syncher);
+			PoolLockGuard l(pool->syncher);
 			ensure_equals(process->enabled, Process::DETACHED);
 		}
 		EVENTUALLY(1,
@@ -1127,7 +1134,7 @@ namespace tut {
 		);
 
 		SHOULD_NEVER_HAPPEN(100,
-			LockGuard l(pool->syncher);
+			PoolLockGuard l(pool->syncher);
 			result = process->isDead()
 				|| !process->osProcessExists();
 		);
@@ -1136,7 +1143,7 @@ namespace tut {
 		g.clear();
 
 		EVENTUALLY(1,
-			LockGuard l(pool->syncher);
+			PoolLockGuard l(pool->syncher);
 			result = process->enabled == Process::DETACHED
 				&& !process->osProcessExists()
 				&& process->isDead();
@@ -1166,7 +1173,7 @@ namespace tut {
 		pool->detachProcess(process);
 		debug->debugger->recv("About to start detached processes checker");
 		{
-			LockGuard l(pool->syncher);
+			PoolLockGuard l(pool->syncher);
 			ensure(process->enabled == Process::DETACHED);
 		}
 
@@ -1198,7 +1205,7 @@ namespace tut {
 		ensure_equals("Disabling succeeds",
 			pool->disableProcess(processes[0]->getGupid()), DR_SUCCESS);
 
-		LockGuard l(pool->syncher);
+		PoolLockGuard l(pool->syncher);
 		ensure(processes[0]->isAlive());
 		ensure_equals("Process is disabled",
 			processes[0]->enabled,
@@ -1278,7 +1285,7 @@ namespace tut {
 		TempThread thr2(boost::bind(&Core_ApplicationPool_PoolTest::disableProcess,
 			this, process2, &code2));
 		EVENTUALLY(5,
-			LockGuard l(pool->syncher);
+			PoolLockGuard l(pool->syncher);
 			result = group->enabledCount == 0
 				&& group->disablingCount == 2
 				&& group->disabledCount == 0;
@@ -1297,7 +1304,7 @@ namespace tut {
 			result = code2 == DR_SUCCESS;
 		);
 		{
-			LockGuard l(pool->syncher);
+			PoolLockGuard l(pool->syncher);
 			ensure_equals(group->enabledCount, 1);
 			ensure_equals(group->disablingCount, 0);
 			ensure_equals(group->disabledCount, 2);
@@ -1325,7 +1332,7 @@ namespace tut {
 			this, session2->getProcess()->shared_from_this(), &code2));
 		EVENTUALLY(2,
 			GroupPtr group = session1->getGroup()->shared_from_this();
-			LockGuard l(pool->syncher);
+			PoolLockGuard l(pool->syncher);
 			result = group->enabledCount == 0
 				&& group->disablingCount == 2
 				&& group->disabledCount == 0;
@@ -1348,7 +1355,7 @@ namespace tut {
 		);
 		{
 			GroupPtr group = session1->getGroup()->shared_from_this();
-			LockGuard l(pool->syncher);
+			PoolLockGuard l(pool->syncher);
 			ensure_equals(group->enabledCount, 2);
 			ensure_equals(group->disablingCount, 0);
 			ensure_equals(group->disabledCount, 0);
@@ -1407,7 +1414,7 @@ namespace tut {
 		ensure_equals(result, DR_SUCCESS);
 
 		{
-			ScopedLock l(pool->syncher);
+			PoolScopedLock l(pool->syncher);
 			GroupPtr group = processes[0]->getGroup()->shared_from_this();
 			ensure_equals(group->enabledCount, 1);
 			ensure_equals(group->disablingCount, 0);
@@ -1971,7 +1978,7 @@ namespace tut {
 		}
 		ensure_equals(number, 0);
 		{
-			LockGuard l(pool->syncher);
+			PoolLockGuard l(pool->syncher);
 			ensure_equals(group->getWaitlist.size(),
 				3u);
 		}
@@ -2061,6 +2068,245 @@ namespace tut {
 		currentSession.reset();
 	}
 
+	TEST_METHOD(80) {
+		// Contention benchmark: threads that check out and close sessions
+		// for different groups should not serialize on the pool lock.
+		ONLY_RUN_AS_BENCHMARK();
+		const unsigned int GROUPS = 4;
+		const unsigned int ITERATIONS = 20000;
+		skDebugSupport.dummyConcurrency = 0;
+		pool->setMax(GROUPS);
+
+		vector<string> names;
+		vector<Options> options;
+		for (unsigned int i = 0; i < GROUPS; i++) {
+			names.push_back("test" + toString(i));
+		}
+		for (unsigned int i = 0; i < GROUPS; i++) {
+			options.push_back(createOptions());
+			options.back().appGroupName = names[i];
+			pool->get(options.back(), &ticket).reset();
+		}
+		ensure_equals(pool->getProcessCount(), GROUPS);
+
+		MonotonicTimeUsec durations[2];
+		for (unsigned int round = 0; round < 2; round++) {
+			unsigned int nthreads = (round == 0) ? 1 : GROUPS;
+			boost::thread_group threads;
+			MonotonicTimeUsec begin = SystemTime::getMonotonicUsec();
+			for (unsigned int i = 0; i < nthreads; i++) {
+				threads.create_thread(boost::bind(getAndCloseSessions,
+					pool.get(), options[i], ITERATIONS));
+			}
+			threads.join_all();
+			durations[round] = SystemTime::getMonotonicUsec() - begin;
+		}
+
+		fprintf(stderr, "  Pool contention benchmark: %u gets/sec with 1 thread, "
+			"%u gets/sec with %u threads on %u groups\n",
+			(unsigned int) (ITERATIONS * 1000000ull / std::max<MonotonicTimeUsec>(durations[0], 1)),
+			(unsigned int) (GROUPS * ITERATIONS * 1000000ull / std::max<MonotonicTimeUsec>(durations[1], 1)),
+			GROUPS, GROUPS);
+
+		ensure_equals(pool->getProcessCount(), GROUPS);
+		vector<ProcessPtr> processes = pool->getProcesses();
+		unsigned int processed = 0;
+		for (unsigned int i = 0; i < processes.size(); i++) {
+			PoolLockGuard l(pool->syncher);
+			ensure_equals(processes[i]->sessions, 0);
+			processed += processes[i]->processed;
+		}
+		ensure_equals(processed, GROUPS + ITERATIONS + GROUPS * ITERATIONS);
+	}
+
+	TEST_METHOD(81) {
+		// The power of two choices routing policy never routes to a totally
+		// busy process while another process can still handle the request.
+		ensureMinProcesses(3);
+		Options options = createOptions();
+		options.routingPolicy = RP_POWER_OF_TWO_CHOICES;
+
+		for (unsigned int i = 0; i < 20; i++) {
+			SessionPtr session1 = pool->get(options, &ticket);
+			SessionPtr session2 = pool->get(options, &ticket);
+			SessionPtr session3 = pool->get(options, &ticket);
+			ensure(session1->getPid() != session2->getPid());
+			ensure(session1->getPid() != session3->getPid());
+			ensure(session2->getPid() != session3->getPid());
+		}
+	}
+
+	TEST_METHOD(82) {
+		// The least latency routing policy prefers processes with a lower
+		// reported response time, until they have enough sessions open
+		// to make them more expensive than slower processes.
+		skDebugSupport.dummyConcurrency = 0;
+		ensureMinProcesses(2);
+		Options options = createOptions();
+
+		SessionPtr slowSession = pool->get(options, &ticket);
+		SessionPtr fastSession = pool->get(options, &ticket);
+		pid_t slowPid = slowSession->getPid();
+		pid_t fastPid = fastSession->getPid();
+		ensure(slowPid != fastPid);
+		slowSession->reportResponseTime(10000);
+		fastSession->reportResponseTime(1000);
+		slowSession.reset();
+		fastSession.reset();
+
+		options.routingPolicy = RP_LEAST_LATENCY;
+		vector<SessionPtr> sessions;
+		for (unsigned int i = 0; i < 9; i++) {
+			sessions.push_back(pool->get(options, &ticket));
+			ensure_equals(("Request " + toString(i) + " goes to the fast process").c_str(),
+				sessions.back()->getPid(), fastPid);
+		}
+		sessions.push_back(pool->get(options, &ticket));
+		ensure_equals("Request 9 goes to the slow process",
+			sessions.back()->getPid(), slowPid);
+	}
+
+	TEST_METHOD(83) {
+		// With spawnConcurrency > 1, processes are spawned in parallel
+		// until the demand is satisfied, but never more than
+		// spawnConcurrency at the same time.
+		skDebugSupport.dummySpawnDelay = 300000;
+		pool->setMax(6);
+		Options options = createOptions();
+		options.minProcesses = 4;
+		options.spawnConcurrency = 3;
+
+		PoolScopedLock l(pool->syncher);
+		pool->asyncGet(options, callback, false);
+		Group *group = pool->findMatchingGroup(options);
+		ensure_equals(group->processesBeingSpawned, 3);
+		l.unlock();
+
+		EVENTUALLY(5,
+			result = number == 1;
+		);
+		EVENTUALLY(5,
+			result = pool->getProcessCount() == 4;
+		);
+		SHOULD_NEVER_HAPPEN(400,
+			result = pool->getProcessCount() > 4;
+		);
+		l.lock();
+		ensure_equals(group->processesBeingSpawned, 0);
+		ensure(!group->spawning());
+	}
+
+	TEST_METHOD(84) {
+		// With predictiveSpawning, processes are spawned ahead of a rising
+		// demand, and the group is scaled down one process per scaleDownDelay
+		// once the demand has dropped.
+		pool->setMax(4);
+		pool->setMaxIdleTime(0);
+		Options options = createOptions();
+		options.predictiveSpawning = true;
+		options.scaleDownDelay = 10;
+
+		// A demand of 1 calls for 2 processes because of the headroom.
+		SystemTime::forceUsec(500000);
+		pool->get(options, &ticket);
+		EVENTUALLY(5,
+			result = pool->getProcessCount() == 2;
+		);
+
+		PoolScopedLock l(pool->syncher);
+		Group *group = pool->findMatchingGroup(options);
+		for (unsigned int i = 1; i <= 60; i++) {
+			group->recordDemand(1, i * 1000000ull);
+		}
+		ensure_equals(group->predictedProcessesNeeded(60000000), 2u);
+		for (unsigned int i = 61; i <= 63; i++) {
+			group->recordDemand(3, i * 1000000ull);
+		}
+		ensure_equals(group->predictedProcessesNeeded(63000000), 4u);
+		l.unlock();
+
+		SystemTime::forceUsec(63000000);
+		pool->get(options, &ticket);
+		EVENTUALLY(5,
+			result = pool->getProcessCount() == 4;
+		);
+
+		// Without demand the prediction decays. The first garbage collection
+		// notices that the group is over-provisioned, but processes are
+		// only shut down after the scale down delay.
+		SystemTime::forceUsec(263000000);
+		pool->realGarbageCollect();
+		ensure_equals(pool->getProcessCount(), 4u);
+		SystemTime::forceUsec(273000000);
+		pool->realGarbageCollect();
+		ensure_equals(pool->getProcessCount(), 3u);
+		SystemTime::forceUsec(278000000);
+		pool->realGarbageCollect();
+		ensure_equals(pool->getProcessCount(), 3u);
+		SystemTime::forceUsec(283000000);
+		pool->realGarbageCollect();
+		ensure_equals(pool->getProcessCount(), 2u);
+		SystemTime::forceUsec(293000000);
+		pool->realGarbageCollect();
+		ensure_equals(pool->getProcessCount(), 1u);
+		SystemTime::forceUsec(303000000);
+		pool->realGarbageCollect();
+		ensure_equals(pool->getProcessCount(), 1u);
+	}
+
+	TEST_METHOD(86) {
+		// Processes whose private memory exceeds the memory limit are
+		// gracefully restarted and replaced, at most one per group per
+		// analytics collection cycle.
+		Options options = createOptions();
+		options.minProcesses = 3;
+		options.memoryLimit = 100;
+		pool->setMax(3);
+		GroupPtr group = pool->findOrCreateGroup(options);
+		{
+			PoolLockGuard l(pool->syncher);
+			group->spawn();
+		}
+		EVENTUALLY(5,
+			result = pool->getProcessCount() == 3;
+		);
+
+		PoolScopedLock l(pool->syncher);
+		ProcessList processes = group->enabledProcesses;
+		for (unsigned int i = 0; i < processes.size(); i++) {
+			processes[i]->metrics.pid = processes[i]->getPid();
+			processes[i]->metrics.rss = 300 * 1024;
+			processes[i]->metrics.uss = 50 * 1024;
+			processes[i]->metrics.swap = 0;
+		}
+		// Shared memory doesn't count towards the limit.
+		boost::container::vector<Callback> actions;
+		pool->recycleProcessesExceedingMemoryLimits(actions);
+		ensure_equals(group->enabledCount, 3);
+
+		processes[0]->metrics.uss = 150 * 1024;
+		processes[1]->metrics.uss = 90 * 1024;
+		processes[1]->metrics.swap = 20 * 1024;
+		pool->recycleProcessesExceedingMemoryLimits(actions);
+		ensure("(1)", processes[0]->enabled == Process::DETACHED);
+		ensure("(2)", processes[1]->enabled == Process::ENABLED);
+		ensure("(3)", processes[2]->enabled == Process::ENABLED);
+		ensure("(4)", group->spawning());
+		l.unlock();
+		Pool::runAllActions(actions);
+		actions.clear();
+
+		EVENTUALLY(5,
+			PoolScopedLock l2(pool->syncher);
+			result = group->enabledCount == 3;
+		);
+		l.lock();
+		pool->recycleProcessesExceedingMemoryLimits(actions);
+		ensure("(5)", processes[1]->enabled == Process::DETACHED);
+		l.unlock();
+		Pool::runAllActions(actions);
+	}
+
 	// TODO: Persistent connections.
 	// TODO: If one closes the session before it has reached EOF, and process's maximum concurrency
 	//       has already been reached, then the pool should ping the process so that it can detect
@@ -40,7 +40,7 @@ namespace tut {
 
 			server1.assign(createTcpServer("127.0.0.1", 0, 0, __FILE__, __LINE__), NULL, 0);
 			getsockname(server1, (struct sockaddr *) &addr, &len);
-			socket.address = "tcp://127.0.0.1:" + toString(addr.sin_port);
+			socket.address = "tcp://127.0.0.1:" + toString(ntohs(addr.sin_port));
 			socket.protocol = "session";
 			socket.concurrency = 3;
 			socket.acceptHttpRequests = true;
@@ -49,7 +49,7 @@ namespace tut {
 			server2.assign(createTcpServer("127.0.0.1", 0, 0, __FILE__, __LINE__), NULL, 0);
 			getsockname(server2, (struct sockaddr *) &addr, &len);
 			socket = SpawningKit::Result::Socket();
-			socket.address = "tcp://127.0.0.1:" + toString(addr.sin_port);
+			socket.address = "tcp://127.0.0.1:" + toString(ntohs(addr.sin_port));
 			socket.protocol = "session";
 			socket.concurrency = 3;
 			socket.acceptHttpRequests = true;
@@ -58,7 +58,7 @@ namespace tut {
 			server3.assign(createTcpServer("127.0.0.1", 0, 0, __FILE__, __LINE__), NULL, 0);
 			getsockname(server3, (struct sockaddr *) &addr, &len);
 			socket = SpawningKit::Result::Socket();
-			socket.address = "tcp://127.0.0.1:" + toString(addr.sin_port);
+			socket.address = "tcp://127.0.0.1:" + toString(ntohs(addr.sin_port));
 			socket.protocol = "session";
 			socket.concurrency = 3;
 			socket.acceptHttpRequests = true;
@@ -238,4 +238,154 @@ namespace tut {
 				&& contents.find("stdout and err 4\n") != string::npos;
 		);
 	}
+
+	TEST_METHOD(6) {
+		set_test_name("Connections that are checked in with keep-alive are pooled and reused");
+		Socket socket(123, sockets[0].address, "session", "", 3, true);
+
+		Connection connection = socket.checkoutConnection(false);
+		ensure("(1)", connection.fd != -1);
+		ensure("(2)", !connection.blocking);
+		int fd = connection.fd;
+		connection.fail = false;
+		connection.wantKeepAlive = true;
+		socket.checkinConnection(connection);
+		ensure_equals("(3)", socket.totalConnections.load(), 1);
+		ensure_equals("(4)", socket.totalIdleConnections.load(), 1);
+
+		connection = socket.checkoutConnection();
+		ensure_equals("(5)", connection.fd, fd);
+		ensure_equals("(6)", socket.totalIdleConnections.load(), 0);
+		connection.fail = true;
+		socket.checkinConnection(connection);
+		ensure_equals("(7)", socket.totalConnections.load(), 0);
+	}
+
+	TEST_METHOD(7) {
+		set_test_name("prewarmConnections() fills the connection pool up to its limit");
+		Socket socket(123, sockets[0].address, "session", "", 3, true);
+
+		socket.prewarmConnections(2);
+		ensure_equals("(1)", socket.totalConnections.load(), 2);
+		ensure_equals("(2)", socket.totalIdleConnections.load(), 2);
+		socket.prewarmConnections(10);
+		ensure_equals("(3)", socket.totalConnections.load(), 3);
+		ensure_equals("(4)", socket.totalIdleConnections.load(), 3);
+		socket.closeAllConnections();
+	}
+
+	TEST_METHOD(8) {
+		set_test_name("reapIdleConnections() closes pooled connections that have been idle for too long");
+		Socket socket(123, sockets[0].address, "session", "", 3, true);
+		unsigned long long now = SystemTime::getUsec();
+
+		socket.prewarmConnections(2);
+		ensure("(1)", socket.reapIdleConnections(now, 60000000) > now);
+		ensure_equals("(2)", socket.totalIdleConnections.load(), 2);
+		ensure_equals("(3)", socket.reapIdleConnections(now + 61000000, 60000000), 0ull);
+		ensure_equals("(4)", socket.totalConnections.load(), 0);
+		ensure_equals("(5)", socket.totalIdleConnections.load(), 0);
+	}
+
+	TEST_METHOD(9) {
+		set_test_name("Blocking checkouts receive prewarmed connections, made blocking");
+		Socket socket(123, sockets[0].address, "session", "", 3, true);
+
+		socket.prewarmConnections(1);
+		Connection connection = socket.checkoutConnection(false);
+		ensure("(1)", !connection.blocking);
+		ensure_equals("(2)", socket.totalIdleConnections.load(), 0);
+		connection.fail = true;
+		socket.checkinConnection(connection);
+		ensure_equals("(3)", socket.totalConnections.load(), 0);
+
+		socket.prewarmConnections(1);
+		connection = socket.checkoutConnection(true);
+		ensure("(4)", connection.blocking);
+		ensure("(5)", !(fcntl(connection.fd, F_GETFL) & O_NONBLOCK));
+		ensure_equals("(6)", socket.totalIdleConnections.load(), 0);
+		ensure_equals("(7)", socket.totalConnections.load(), 1);
+		connection.fail = true;
+		socket.checkinConnection(connection);
+		ensure_equals("(8)", socket.totalConnections.load(), 0);
+	}
+
+	TEST_METHOD(10) {
+		set_test_name("Initiating a blocking session on a pooled non-blocking connection makes it blocking");
+		ProcessPtr process = createProcess();
+		SessionPtr session = process->newSession();
+		Socket *socket = session->getSocket();
+
+		Connection connection = socket->checkoutConnection(false);
+		int fd = connection.fd;
+		connection.fail = false;
+		connection.wantKeepAlive = true;
+		socket->checkinConnection(connection);
+
+		session->initiate(true);
+		ensure_equals("(1)", session->fd(), fd);
+		ensure("(2)", !(fcntl(session->fd(), F_GETFL) & O_NONBLOCK));
+
+		process->sessionClosed(session.get());
+		session.reset();
+		ensure_equals("(3)", socket->totalConnections.load(), 0);
+	}
+
+	static void checkinConnections(Socket *socket, vector<Connection> *connections) {
+		for (unsigned int i = 0; i < connections->size(); i++) {
+			socket->checkinConnection((*connections)[i]);
+		}
+	}
+
+	TEST_METHOD(11) {
+		set_test_name("Concurrent checkins don't push the connection pool past its limit");
+		Socket socket(123, sockets[0].address, "session", "", 3, true);
+		vector< vector<Connection> > connections(4);
+		vector<boost::shared_ptr<oxt::thread> > threads;
+		unsigned int i, j;
+
+		for (i = 0; i < connections.size(); i++) {
+			for (j = 0; j < 8; j++) {
+				Connection connection = socket.checkoutConnection(false);
+				connection.fail = false;
+				connection.wantKeepAlive = true;
+				connections[i].push_back(connection);
+			}
+		}
+		for (i = 0; i < connections.size(); i++) {
+			threads.push_back(boost::make_shared<oxt::thread>(
+				boost::bind(checkinConnections, &socket, &connections[i]),
+				"Checkin " + toString(i), 1024 * 128));
+		}
+		for (i = 0; i < threads.size(); i++) {
+			threads[i]->join();
+		}
+
+		ensure_equals("(1)", socket.totalIdleConnections.load(), 3);
+		ensure_equals("(2)", socket.totalConnections.load(), 3);
+		socket.closeAllConnections();
+	}
+
+	TEST_METHOD(12) {
+		set_test_name("A blocking checkout connects by itself if the app has closed"
+			" the prewarmed connection");
+		Socket socket(123, sockets[0].address, "session", "", 3, true);
+		char buf;
+
+		socket.prewarmConnections(1);
+		FileDescriptor peer(accept(server1, NULL, NULL), __FILE__, __LINE__);
+		peer.close();
+
+		Connection connection = socket.checkoutConnection(true);
+		ensure("(1)", connection.blocking);
+		ensure_equals("(2)", socket.totalConnections.load(), 1);
+		ensure_equals("(3)", socket.totalIdleConnections.load(), 0);
+
+		peer.assign(accept(server1, NULL, NULL), __FILE__, __LINE__);
+		writeExact(connection.fd, "x", 1);
+		ensure_equals("(4)", readExact(peer, &buf, 1), 1u);
+		connection.fail = true;
+		socket.checkinConnection(connection);
+		ensure_equals("(5)", socket.totalConnections.load(), 0);
+	}
 }
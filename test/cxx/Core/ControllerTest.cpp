@@ -6,6 +6,7 @@
 #include <IOTools/MessageIO.h>
 #include <Core/ApplicationPool/TestSession.h>
 #include <Core/Controller.h>
+#include <sys/stat.h>
 
 using namespace std;
 using namespace boost;
@@ -23,9 +24,24 @@ namespace tut {
 				sessionToReturn.reset();
 			}
 
+			#ifdef __linux__
+				virtual ssize_t spliceData(int fdIn, int fdOut, size_t size) {
+					struct stat buf;
+					// Splicing to the pipe works as usual, but splicing from
+					// the pipe to the application fails as if the
+					// application socket doesn't support it.
+					if (failSpliceToApp && fstat(fdOut, &buf) == 0 && !S_ISFIFO(buf.st_mode)) {
+						errno = EINVAL;
+						return -1;
+					}
+					return Core::Controller::spliceData(fdIn, fdOut, size);
+				}
+			#endif
+
 		public:
 			ApplicationPool2::AbstractSessionPtr sessionToReturn;
 			ApplicationPool2::ExceptionPtr exceptionToReturn;
+			bool failSpliceToApp;
 
 			MyController(ServerKit::Context *context,
 				const Core::ControllerSchema &schema,
@@ -33,7 +49,8 @@ namespace tut {
 				const Core::ControllerSingleAppModeSchema &singleAppModeSchema,
 				const Json::Value &singleAppModeConfig)
 				: Core::Controller(context, schema, initialConfig, ConfigKit::DummyTranslator(),
-					&singleAppModeSchema, &singleAppModeConfig, ConfigKit::DummyTranslator())
+					&singleAppModeSchema, &singleAppModeConfig, ConfigKit::DummyTranslator()),
+				  failSpliceToApp(false)
 				{ }
 		};
 
@@ -52,6 +69,9 @@ namespace tut {
 		Json::Value config, singleAppModeConfig;
 		int serverSocket;
 		TestSession testSession;
+		// For tests that need a second session, such as for a
+		// background turbocache refresh.
+		TestSession secondSession;
 		FileDescriptor clientConnection;
 		BufferedIO clientConnectionIO;
 		string peerRequestHeader;
@@ -165,6 +185,22 @@ namespace tut {
 			controller->sessionToReturn.reset(&testSession, false);
 		}
 
+		void useSecondSessionObject() {
+			bg.safe->runSync(boost::bind(&Core_ControllerTest::_setSecondSessionObject, this));
+		}
+
+		void _setSecondSessionObject() {
+			controller->sessionToReturn.reset(&secondSession, false);
+		}
+
+		void setExceptionToReturn(const ApplicationPool2::ExceptionPtr &e) {
+			bg.safe->runSync(boost::bind(&Core_ControllerTest::_setExceptionToReturn, this, e));
+		}
+
+		void _setExceptionToReturn(ApplicationPool2::ExceptionPtr e) {
+			controller->exceptionToReturn = e;
+		}
+
 		MyController::State getServerState() {
 			Controller::State result;
 			bg.safe->runSync(boost::bind(&Core_ControllerTest::_getServerState,
@@ -294,6 +330,41 @@ namespace tut {
 		string readResponseBody() {
 			return clientConnectionIO.readAll();
 		}
+
+		/**
+		 * Sends a request with a body that is large enough to be spliced,
+		 * and checks that the application receives all of it.
+		 */
+		void sendLargeRequestBody() {
+			string body;
+			for (unsigned int i = 0; i < 1024 * 512; i++) {
+				body.append(1, (char) ('a' + i % 26));
+			}
+
+			connectToServer();
+			sendRequest(
+				"POST /hello HTTP/1.1\r\n"
+				"Host: localhost\r\n"
+				"Content-Length: " + toString(body.size()) + "\r\n"
+				"Connection: close\r\n"
+				"\r\n"
+				+ body.substr(0, 100));
+			waitUntilSessionInitiated();
+
+			TempThread thr(boost::bind(&Core_ControllerTest::sendRequest, this,
+				StaticString(body).substr(100)));
+			readPeerRequestHeader();
+			ensure("(1)", readPeerBody() == body);
+			thr.join();
+
+			sendPeerResponse(
+				"HTTP/1.1 200 OK\r\n"
+				"Content-Length: 2\r\n"
+				"\r\n"
+				"ok");
+			ensure("(2)", containsSubstring(readResponseHeader(), "HTTP/1.1 200 OK"));
+			ensure_equals("(3)", readResponseBody(), "ok");
+		}
 	};
 
 	DEFINE_TEST_GROUP_WITH_LIMIT(Core_ControllerTest, 80);
@@ -1118,4 +1189,226 @@ namespace tut {
 		string header = readResponseHeader();
 		ensure(containsSubstring(header, "HTTP/1.1 502"));
 	}
+
+	TEST_METHOD(57) {
+		set_test_name("Session protocol: header names are converted to CGI form,"
+			" and headers with non-alphanumeric names are not forwarded");
+
+		init();
+		useTestSessionObject();
+
+		connectToServer();
+		sendRequest(
+			"GET /hello HTTP/1.1\r\n"
+			"Host: localhost\r\n"
+			"X-Forwarded-For-Some-Long-Proxy: 1.2.3.4\r\n"
+			"X-Forwarded_For: 5.6.7.8\r\n"
+			"Connection: close\r\n"
+			"\r\n");
+		waitUntilSessionInitiated();
+
+		string header = readPeerRequestHeader();
+		ensure(containsSubstring(header,
+			P_STATIC_STRING("HTTP_X_FORWARDED_FOR_SOME_LONG_PROXY\0001.2.3.4\000")));
+		ensure(!containsSubstring(header, P_STATIC_STRING("5.6.7.8")));
+		ensure(containsSubstring(header,
+			P_STATIC_STRING("SERVER_PROTOCOL\000HTTP/1.1\000")));
+		ensure(containsSubstring(header, P_STATIC_STRING("SERVER_SOFTWARE\000")));
+	}
+
+	TEST_METHOD(58) {
+		set_test_name("Large request bodies with a Content-Length are"
+			" forwarded to the application in their entirety");
+
+		config["request_body_splice_threshold"] = 1024;
+		init();
+		useTestSessionObject();
+		sendLargeRequestBody();
+
+		#ifdef __linux__
+			Json::Value doc = inspectStateAsJson();
+			ensure_equals("The body is spliced",
+				doc["spliced_request_bodies"].asUInt(), 1u);
+			ensure_equals(doc["request_body_splice_fallbacks"].asUInt(), 0u);
+		#endif
+	}
+
+	TEST_METHOD(59) {
+		set_test_name("If the application socket does not support splice(),"
+			" then large request bodies are forwarded normally");
+
+		config["request_body_splice_threshold"] = 1024;
+		init();
+		useTestSessionObject();
+		controller->failSpliceToApp = true;
+		sendLargeRequestBody();
+
+		#ifdef __linux__
+			Json::Value doc = inspectStateAsJson();
+			ensure_equals(doc["spliced_request_bodies"].asUInt(), 0u);
+			ensure_equals("Splicing is abandoned",
+				doc["request_body_splice_fallbacks"].asUInt(), 1u);
+		#endif
+	}
+
+
+	/***** Turbocaching *****/
+
+	TEST_METHOD(60) {
+		set_test_name("Concurrent turbocache misses for the same key are"
+			" coalesced into a single application request");
+
+		init();
+		useTestSessionObject();
+
+		connectToServer();
+		sendRequest(
+			"GET /hello HTTP/1.1\r\n"
+			"Host: localhost\r\n"
+			"Connection: close\r\n"
+			"\r\n");
+		waitUntilSessionInitiated();
+
+		// No session is available for the second request, so it must
+		// be served from the response to the first one.
+		FileDescriptor secondConnection(connectToUnixServer("tmp.server",
+			__FILE__, __LINE__), NULL, 0);
+		BufferedIO secondConnectionIO(secondConnection);
+		writeExact(secondConnection,
+			"GET /hello HTTP/1.1\r\n"
+			"Host: localhost\r\n"
+			"Connection: close\r\n"
+			"\r\n");
+		EVENTUALLY(5,
+			result = inspectStateAsJson()["turbocaching"]["coalesced_requests"].asUInt() == 1;
+		);
+
+		readPeerRequestHeader();
+		sendPeerResponse(
+			"HTTP/1.1 200 OK\r\n"
+			"Cache-Control: max-age=60\r\n"
+			"Content-Length: 2\r\n\r\n"
+			"ok");
+
+		string header = readResponseHeader();
+		ensure("(1)", containsSubstring(header, "HTTP/1.1 200"));
+		ensure_equals("(2)", readResponseBody(), "ok");
+
+		header = readHeader(secondConnectionIO);
+		ensure("(3)", containsSubstring(header, "HTTP/1.1 200"));
+		ensure("(4)", containsSubstring(header, "Age: "));
+		ensure_equals("(5)", secondConnectionIO.readAll(), "ok");
+	}
+
+	TEST_METHOD(61) {
+		set_test_name("A stale-while-revalidate refresh is sent to the application"
+			" in the background, and its response is stored in the turbocache");
+
+		init();
+		useTestSessionObject();
+
+		connectToServer();
+		sendRequest(
+			"GET /hello HTTP/1.1\r\n"
+			"Host: localhost\r\n"
+			"Connection: close\r\n"
+			"\r\n");
+		waitUntilSessionInitiated();
+		readPeerRequestHeader();
+		sendPeerResponse(
+			"HTTP/1.1 200 OK\r\n"
+			"Cache-Control: max-age=1, stale-while-revalidate=60\r\n"
+			"Content-Length: 2\r\n\r\n"
+			"ok");
+		ensure("(1)", containsSubstring(readResponseHeader(), "HTTP/1.1 200"));
+		ensure_equals("(2)", readResponseBody(), "ok");
+
+		// Wait until the entry is stale.
+		syscalls::usleep(2100000);
+		useSecondSessionObject();
+
+		connectToServer();
+		sendRequest(
+			"GET /hello HTTP/1.1\r\n"
+			"Host: localhost\r\n"
+			"Connection: close\r\n"
+			"\r\n");
+		ensure("(3)", containsSubstring(readResponseHeader(), "HTTP/1.1 200"));
+		ensure_equals("(4)", readResponseBody(), "ok");
+
+		EVENTUALLY(5,
+			result = secondSession.fd() != -1;
+		);
+		string header = readScalarMessage(secondSession.peerFd());
+		ensure("(5)", containsSubstring(header, P_STATIC_STRING("REQUEST_URI\0/hello\0")));
+		writeExact(secondSession.peerFd(),
+			"HTTP/1.1 200 OK\r\n"
+			"Cache-Control: max-age=60\r\n"
+			"Content-Length: 3\r\n\r\n"
+			"new");
+		secondSession.closePeerFd();
+		EVENTUALLY(5,
+			result = secondSession.isClosed();
+		);
+		ensure("(6)", secondSession.isSuccessful());
+
+		connectToServer();
+		sendRequest(
+			"GET /hello HTTP/1.1\r\n"
+			"Host: localhost\r\n"
+			"Connection: close\r\n"
+			"\r\n");
+		ensure("(7)", containsSubstring(readResponseHeader(), "HTTP/1.1 200"));
+		ensure_equals("(8)", readResponseBody(), "new");
+	}
+
+	TEST_METHOD(62) {
+		set_test_name("When the application responds with a server error, a stale"
+			" turbocache entry within its stale-if-error window is served instead,"
+			" and the session is closed unsuccessfully");
+
+		init();
+		useTestSessionObject();
+
+		connectToServer();
+		sendRequest(
+			"GET /hello HTTP/1.1\r\n"
+			"Host: localhost\r\n"
+			"Connection: close\r\n"
+			"\r\n");
+		waitUntilSessionInitiated();
+		readPeerRequestHeader();
+		sendPeerResponse(
+			"HTTP/1.1 200 OK\r\n"
+			"Cache-Control: max-age=1, stale-if-error=60\r\n"
+			"Content-Length: 2\r\n\r\n"
+			"ok");
+		ensure("(1)", containsSubstring(readResponseHeader(), "HTTP/1.1 200"));
+		ensure_equals("(2)", readResponseBody(), "ok");
+
+		// Wait until the entry is stale.
+		syscalls::usleep(2100000);
+		useSecondSessionObject();
+
+		connectToServer();
+		sendRequest(
+			"GET /hello HTTP/1.1\r\n"
+			"Host: localhost\r\n"
+			"Connection: close\r\n"
+			"\r\n");
+		EVENTUALLY(5,
+			result = secondSession.fd() != -1;
+		);
+		readScalarMessage(secondSession.peerFd());
+		writeExact(secondSession.peerFd(),
+			"HTTP/1.1 503 Service Unavailable\r\n"
+			"Content-Length: 4\r\n\r\n"
+			"oops");
+		secondSession.closePeerFd();
+
+		ensure("(3)", containsSubstring(readResponseHeader(), "HTTP/1.1 200"));
+		ensure_equals("(4)", readResponseBody(), "ok");
+		ensure("(5)", secondSession.isClosed());
+		ensure("(6)", !secondSession.isSuccessful());
+	}
 }
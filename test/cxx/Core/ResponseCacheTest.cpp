@@ -5,6 +5,10 @@
 #include <Core/Controller/Request.h>
 #include <Core/Controller/AppResponse.h>
 #include <Core/ResponseCache.h>
+#include <Core/SharedResponseCache.h>
+#include <SystemTools/SystemTime.h>
+#include <boost/atomic.hpp>
+#include <boost/make_shared.hpp>
 
 using namespace Passenger;
 using namespace Passenger::Core;
@@ -74,6 +78,7 @@ namespace tut {
 			req.cacheKey = HashedStaticString();
 			req.cacheControl = NULL;
 			req.varyCookie = NULL;
+			req.staleCacheEntry = ResponseCacheEntry();
 			req.envvars = NULL;
 
 			req.appResponse.headers.clear();
@@ -152,9 +157,145 @@ namespace tut {
 			req.appResponse.bodyType = AppResponse::RBT_CONTENT_LENGTH;
 			req.appResponse.aux.bodyInfo.contentLength = body.size();
 		}
+
+		void setPath(const StaticString &path) {
+			psg_lstr_init(&req.path);
+			psg_lstr_append(&req.path, req.pool, path.data(), path.size());
+		}
+
+		ResponseCacheType::Entry store(const StaticString &path, unsigned int bodySize = 5) {
+			reset();
+			setPath(path);
+			initCacheableResponse();
+			ensure(responseCache.prepareRequest(this, &req));
+			ensure(responseCache.requestAllowsStoring(&req));
+			ensure(responseCache.prepareRequestForStoring(&req));
+			return responseCache.store(&req, time(NULL), 10, bodySize);
+		}
+
+		ResponseCacheType::Entry fetch(const StaticString &path) {
+			return fetch(responseCache, path);
+		}
+
+		ResponseCacheType::Entry fetch(ResponseCacheType &cache, const StaticString &path) {
+			reset();
+			setPath(path);
+			ensure(cache.prepareRequest(this, &req));
+			ensure(cache.requestAllowsFetching(&req));
+			return cache.fetch(&req, time(NULL));
+		}
+
+		bool storeWithData(ResponseCacheType &cache, const StaticString &path,
+			const StaticString &header, const StaticString &body)
+		{
+			reset();
+			setPath(path);
+			initCacheableResponse();
+			ensure(cache.prepareRequest(this, &req));
+			ensure(cache.requestAllowsStoring(&req));
+			ensure(cache.prepareRequestForStoring(&req));
+
+			struct iovec headerBuffer;
+			headerBuffer.iov_base = (void *) header.data();
+			headerBuffer.iov_len = header.size();
+			LString bodyBuffer;
+			psg_lstr_init(&bodyBuffer);
+			psg_lstr_append(&bodyBuffer, req.pool, body.data(), body.size());
+			return cache.store(&req, time(NULL), &headerBuffer, 1, &bodyBuffer);
+		}
+
+		// Stores a response that is fresh for 60 seconds, unless another
+		// Cache-Control value is given.
+		bool storeWithValidators(ResponseCacheType &cache, const StaticString &path,
+			const StaticString &body, const StaticString &etag,
+			const StaticString &lastModified,
+			const StaticString &cacheControl = "public,max-age=60")
+		{
+			reset();
+			setPath(path);
+			insertAppResponseHeader(createHeader("cache-control", cacheControl),
+				req.pool);
+			if (!etag.empty()) {
+				insertAppResponseHeader(createHeader("etag", etag), req.pool);
+			}
+			if (!lastModified.empty()) {
+				insertAppResponseHeader(createHeader("last-modified", lastModified), req.pool);
+			}
+			ensure(cache.prepareRequest(this, &req));
+			ensure(cache.requestAllowsStoring(&req));
+			ensure(cache.prepareRequestForStoring(&req));
+
+			struct iovec headerBuffer;
+			headerBuffer.iov_base = (void *) "header\r\n";
+			headerBuffer.iov_len = sizeof("header\r\n") - 1;
+			LString bodyBuffer;
+			psg_lstr_init(&bodyBuffer);
+			psg_lstr_append(&bodyBuffer, req.pool, body.data(), body.size());
+			return cache.store(&req, time(NULL), &headerBuffer, 1, &bodyBuffer);
+		}
+
+		ResponseCacheType::Entry fetchAt(ResponseCacheType &cache, const StaticString &path,
+			time_t now)
+		{
+			reset();
+			setPath(path);
+			ensure(cache.prepareRequest(this, &req));
+			ensure(cache.requestAllowsFetching(&req));
+			return cache.fetch(&req, now);
+		}
+
+		// Simulates the app responding with 304 Not Modified without
+		// any freshness information.
+		void respondNotModified() {
+			req.appResponse.statusCode = 304;
+			req.appResponse.headers.clear();
+			req.appResponse.cacheControl = NULL;
+			req.appResponse.expiresHeader = NULL;
+			req.appResponse.lastModifiedHeader = NULL;
+		}
+
+		StaticString lookupReqHeader(const HashedStaticString &name) {
+			const LString *value = req.headers.lookup(name);
+			if (value == NULL) {
+				return StaticString();
+			}
+			value = psg_lstr_make_contiguous(value, req.pool);
+			return StaticString(value->start->data, value->size);
+		}
 	};
 
-	DEFINE_TEST_GROUP_WITH_LIMIT(Core_ResponseCacheTest, 100);
+	static void
+	readSharedCacheConcurrently(SharedResponseCache *cache, boost::atomic<bool> *done,
+		boost::atomic<unsigned int> *corruptions, boost::atomic<unsigned int> *hits)
+	{
+		SharedResponseCache::Reader *reader = cache->registerReader();
+		psg_pool_t *pool = psg_create_pool(PSG_DEFAULT_POOL_SIZE);
+		unsigned int i = 0;
+
+		while (!done->load()) {
+			string key = "key" + toString(i % 8);
+			SharedResponseCache::Snapshot snapshot;
+			if (cache->lookup(reader, key, pool, snapshot)) {
+				hits->fetch_add(1);
+				// All bytes of an entry are written with the same value.
+				for (unsigned int j = 1; j < snapshot.headerSize + snapshot.bodySize; j++) {
+					if (snapshot.data[j] != snapshot.data[0]) {
+						corruptions->fetch_add(1);
+						break;
+					}
+				}
+			}
+			i++;
+			if (i % 64 == 0) {
+				psg_reset_pool(pool, PSG_DEFAULT_POOL_SIZE);
+			}
+		}
+
+		psg_destroy_pool(pool);
+		cache->unregisterReader(reader);
+	}
+
+	DEFINE_TEST_GROUP_WITH_LIMIT(Core_ResponseCacheTest, 110);
 
 
 	/***** Preparation *****/
@@ -226,7 +367,7 @@ namespace tut {
 		ensure("(12)", entry2.valid());
 		ensure_equals("(13)", entry2.index, 0u);
 		ensure_equals<int>("(14)", entry2.body->httpHeaderSize, responseHeadersStr.size());
-		ensure_equals<int>("(15)", entry2.body->httpBodySize, responseBodyStr.size());
+		ensure_equals<unsigned int>("(15)", entry2.body->httpBodySize, responseBodyStr.size());
 	}
 
 	TEST_METHOD(11) {
@@ -571,4 +712,502 @@ namespace tut {
 		ResponseCacheType::Entry entry2(responseCache.fetch(&req, time(NULL)));
 		ensure("(22)", !entry2.valid());
 	}
+
+
+	/***** Capacity and eviction *****/
+
+	TEST_METHOD(70) {
+		set_test_name("It can hold many more entries than before");
+		responseCache.setLimits(1000, 1024 * 1024);
+		for (unsigned int i = 0; i < 1000; i++) {
+			ensure(store("/" + toString(i)).valid());
+		}
+		ensure_equals(responseCache.getCount(), 1000u);
+		ensure_equals(responseCache.getEvictions(), 0u);
+		for (unsigned int i = 0; i < 1000; i++) {
+			ensure("Entry " + toString(i) + " is found", fetch("/" + toString(i)).valid());
+		}
+	}
+
+	TEST_METHOD(71) {
+		set_test_name("When full, it evicts entries that have not been hit recently");
+		responseCache.setLimits(3, 1024 * 1024);
+		ensure(store("/a").valid());
+		ensure(store("/b").valid());
+		ensure(store("/c").valid());
+		ensure(fetch("/a").valid());
+		ensure(fetch("/c").valid());
+
+		ensure(store("/d").valid());
+		ensure_equals(responseCache.getCount(), 3u);
+		ensure_equals(responseCache.getEvictions(), 1u);
+		ensure("(1)", fetch("/a").valid());
+		ensure("(2)", !fetch("/b").valid());
+		ensure("(3)", fetch("/c").valid());
+		ensure("(4)", fetch("/d").valid());
+	}
+
+	TEST_METHOD(72) {
+		set_test_name("It evicts entries to stay within the memory budget");
+		responseCache.setLimits(100, 100);
+		ensure(store("/a", 30).valid());
+		ensure(store("/b", 30).valid());
+		ensure_equals(responseCache.getMemoryUsage(), 80u);
+
+		ensure(store("/c", 30).valid());
+		ensure_equals(responseCache.getCount(), 2u);
+		ensure(responseCache.getMemoryUsage() <= 100u);
+		ensure("(1)", !fetch("/a").valid());
+		ensure("(2)", fetch("/b").valid());
+		ensure("(3)", fetch("/c").valid());
+	}
+
+	TEST_METHOD(73) {
+		set_test_name("It refuses to store responses larger than the memory budget");
+		responseCache.setLimits(100, 100);
+		ensure(store("/a", 10).valid());
+		ensure(!store("/b", 200).valid());
+		ensure(fetch("/a").valid());
+	}
+
+	TEST_METHOD(74) {
+		set_test_name("Storing an existing key replaces the entry");
+		responseCache.setLimits(10, 1024);
+		ensure(store("/a", 10).valid());
+		ResponseCacheType::Entry entry(store("/a", 20));
+		ensure(entry.valid());
+		ensure_equals(responseCache.getCount(), 1u);
+		ensure_equals(responseCache.getMemoryUsage(), 30u);
+		ensure_equals(fetch("/a").body->httpBodySize, 20u);
+	}
+
+	TEST_METHOD(75) {
+		set_test_name("clear() removes all entries");
+		responseCache.setLimits(10, 1024);
+		ensure(store("/a").valid());
+		ensure(store("/b").valid());
+		responseCache.clear();
+		ensure_equals(responseCache.getCount(), 0u);
+		ensure_equals(responseCache.getMemoryUsage(), 0u);
+		ensure(!fetch("/a").valid());
+		ensure(store("/c").valid());
+		ensure(fetch("/c").valid());
+	}
+
+
+	/***** Large bodies *****/
+
+	TEST_METHOD(76) {
+		set_test_name("It caches bodies larger than a single mbuf");
+		string body(1024 * 100, 'x');
+		responseCache.setLimits(10, 1024 * 1024);
+		ensure("(1)", storeWithData(responseCache, "/", "header\r\n", body));
+
+		ResponseCacheType::Entry entry(fetch("/"));
+		ensure("(2)", entry.valid());
+		ensure_equals("(3)", entry.body->httpBodySize, (unsigned int) body.size());
+		ensure("(4)", StaticString(entry.body->httpBodyData, entry.body->httpBodySize) == body);
+		ensure("(5)", entry.body->dataBlock == NULL);
+	}
+
+	TEST_METHOD(77) {
+		set_test_name("It refuses to store bodies larger than the maximum body size");
+		responseCache.setMaxBodySize(1024);
+		ensure("(1)", storeWithData(responseCache, "/a", "header\r\n", string(1024, 'x')));
+		ensure("(2)", !storeWithData(responseCache, "/b", "header\r\n", string(1025, 'x')));
+		ensure("(3)", fetch("/a").valid());
+		ensure("(4)", !fetch("/b").valid());
+	}
+
+	TEST_METHOD(78) {
+		set_test_name("If an mbuf pool is set, large entries are stored in mbuf blocks "
+			"which stay alive while referenced after eviction");
+		struct MemoryKit::mbuf_pool pool;
+		pool.mbuf_block_chunk_size = DEFAULT_MBUF_CHUNK_SIZE;
+		MemoryKit::mbuf_pool_init(&pool);
+		{
+			ResponseCacheType cache(10, 1024 * 1024);
+			cache.setMbufPool(&pool);
+			string body(1024 * 100, 'x');
+			MemoryKit::mbuf buffer;
+
+			ensure("(1)", storeWithData(cache, "/small", "header\r\n", "hello"));
+			ensure("(2)", fetch(cache, "/small").body->dataBlock == NULL);
+
+			ensure("(3)", storeWithData(cache, "/large", "header\r\n", body));
+			ResponseCacheType::Entry entry(fetch(cache, "/large"));
+			ensure("(4)", entry.valid());
+			ensure("(5)", entry.body->dataBlock != NULL);
+			ensure("(6)", StaticString(entry.body->httpBodyData, entry.body->httpBodySize) == body);
+			ensure_equals("(7)", pool.nactive_mbuf_blockq, 1u);
+
+			buffer = MemoryKit::mbuf_block_subset(entry.body->dataBlock,
+				entry.body->httpHeaderSize, entry.body->httpBodySize);
+			cache.clear();
+			ensure_equals("(8)", pool.nactive_mbuf_blockq, 1u);
+			ensure("(9)", StaticString(buffer.start, buffer.size()) == body);
+
+			buffer = MemoryKit::mbuf();
+			ensure_equals("(10)", pool.nactive_mbuf_blockq, 0u);
+		}
+		MemoryKit::mbuf_pool_deinit(&pool);
+	}
+
+
+	/***** Shared cache *****/
+
+	TEST_METHOD(80) {
+		set_test_name("Entries stored through one thread's cache can be fetched through another's");
+		SharedResponseCache shared(16, 1024 * 1024, 1024 * 64);
+		ResponseCacheType cache, other;
+		cache.setShared(&shared);
+		other.setShared(&shared);
+
+		ensure("(1)", storeWithData(cache, "/", "header\r\n", "hello"));
+		ensure_equals("(2)", shared.getCount(), 1u);
+
+		ResponseCacheType::Entry entry(fetch(other, "/"));
+		ensure("(3)", entry.valid());
+		ensure_equals("(4)", StaticString(entry.body->httpHeaderData, entry.body->httpHeaderSize),
+			StaticString("header\r\n"));
+		ensure_equals("(5)", StaticString(entry.body->httpBodyData, entry.body->httpBodySize),
+			StaticString("hello"));
+		ensure_equals("(6)", other.getHits(), 1u);
+		ensure_equals("(7)", cache.getHits(), 0u);
+	}
+
+	TEST_METHOD(81) {
+		set_test_name("Invalidation through one thread's cache is visible to another's");
+		SharedResponseCache shared(16, 1024 * 1024, 1024 * 64);
+		ResponseCacheType cache, other;
+		cache.setShared(&shared);
+		other.setShared(&shared);
+
+		ensure("(1)", storeWithData(cache, "/", "header\r\n", "hello"));
+
+		reset();
+		req.method = HTTP_POST;
+		ensure("(2)", other.prepareRequest(this, &req));
+		ensure("(3)", other.requestAllowsInvalidating(&req));
+		other.invalidate(&req);
+
+		ensure("(4)", !fetch(cache, "/").valid());
+		ensure_equals("(5)", shared.getCount(), 0u);
+	}
+
+	TEST_METHOD(82) {
+		set_test_name("Storing in the shared cache evicts entries to stay within the memory budget");
+		SharedResponseCache shared(16, 20, 1024 * 64);
+		ResponseCacheType cache;
+		cache.setShared(&shared);
+
+		ensure("(1)", storeWithData(cache, "/a", "header\r\n", "hello"));
+		ensure("(2)", storeWithData(cache, "/b", "header\r\n", "hello"));
+		ensure_equals("(3)", shared.getCount(), 1u);
+		ensure("(4)", shared.getMemoryUsage() <= 20u);
+		ensure("(5)", !fetch(cache, "/a").valid());
+		ensure("(6)", fetch(cache, "/b").valid());
+	}
+
+	TEST_METHOD(83) {
+		set_test_name("Concurrent lookups never observe partially written entries");
+		SharedResponseCache shared(8, 1024 * 1024, 1024 * 64);
+		boost::atomic<bool> done(false);
+		boost::atomic<unsigned int> corruptions(0), hits(0);
+		vector< boost::shared_ptr<TempThread> > threads;
+
+		for (unsigned int i = 0; i < 3; i++) {
+			threads.push_back(boost::make_shared<TempThread>(boost::bind(
+				readSharedCacheConcurrently, &shared, &done, &corruptions, &hits)));
+		}
+
+		psg_pool_t *pool = psg_create_pool(PSG_DEFAULT_POOL_SIZE);
+		unsigned long long deadline = SystemTime::getMonotonicUsec() + 300000;
+		unsigned int i = 0;
+		while (SystemTime::getMonotonicUsec() < deadline) {
+			string value(64 + (i % 1024), (char) ('a' + (i % 26)));
+			struct iovec headerBuffer;
+			headerBuffer.iov_base = (void *) value.data();
+			headerBuffer.iov_len = 16;
+			LString body;
+			psg_lstr_init(&body);
+			psg_lstr_append(&body, pool, value.data() + 16, value.size() - 16);
+			shared.store("key" + toString(i % 8), time(NULL), time(NULL) + 60,
+				&headerBuffer, 1, &body);
+			if (i % 5 == 0) {
+				shared.erase("key" + toString((i + 3) % 8));
+			}
+			i++;
+			if (i % 64 == 0) {
+				psg_reset_pool(pool, PSG_DEFAULT_POOL_SIZE);
+			}
+		}
+		psg_destroy_pool(pool);
+
+		done.store(true);
+		for (unsigned int j = 0; j < threads.size(); j++) {
+			threads[j]->join();
+		}
+		ensure_equals("No corruptions", corruptions.load(), 0u);
+		ensure("Some lookups succeeded", hits.load() > 0);
+	}
+
+
+	/***** Revalidation and conditional requests *****/
+
+	TEST_METHOD(90) {
+		set_test_name("A stale entry with validators is kept and the request is made conditional");
+		time_t later = time(NULL) + 120;
+		ensure("(1)", storeWithValidators(responseCache, "/", "hello",
+			"\"v1\"", "Sat, 01 Jan 2000 00:00:00 GMT"));
+
+		ResponseCacheType::Entry entry(fetchAt(responseCache, "/", later));
+		ensure("(2)", !entry.valid());
+		ensure_equals("(3)", entry.cacheMissReason, ResponseCacheType::Entry::NOT_FRESH);
+		ensure("(4)", req.staleCacheEntry.valid());
+		ensure_equals("(5)", StaticString(req.staleCacheEntry.body->httpBodyData,
+			req.staleCacheEntry.body->httpBodySize), StaticString("hello"));
+		ensure_equals("(6)", lookupReqHeader("if-none-match"), StaticString("\"v1\""));
+		ensure_equals("(7)", lookupReqHeader("if-modified-since"),
+			StaticString("Sat, 01 Jan 2000 00:00:00 GMT"));
+		ensure_equals("(8)", responseCache.getCount(), 1u);
+	}
+
+	TEST_METHOD(91) {
+		set_test_name("A stale entry without validators is removed");
+		time_t later = time(NULL) + 120;
+		ensure("(1)", storeWithValidators(responseCache, "/", "hello", "", ""));
+
+		ensure("(2)", !fetchAt(responseCache, "/", later).valid());
+		ensure("(3)", !req.staleCacheEntry.valid());
+		ensure("(4)", req.headers.lookup("if-none-match") == NULL);
+		ensure_equals("(5)", responseCache.getCount(), 0u);
+	}
+
+	TEST_METHOD(92) {
+		set_test_name("A stale entry is not revalidated on behalf of a client's own conditional request");
+		time_t later = time(NULL) + 120;
+		ensure("(1)", storeWithValidators(responseCache, "/", "hello", "\"v1\"", ""));
+
+		reset();
+		insertReqHeader(createHeader("if-none-match", "\"v0\""), req.pool);
+		ensure("(2)", responseCache.prepareRequest(this, &req));
+		ensure("(3)", !responseCache.fetch(&req, later).valid());
+		ensure("(4)", !req.staleCacheEntry.valid());
+		ensure_equals("(5)", lookupReqHeader("if-none-match"), StaticString("\"v0\""));
+	}
+
+	TEST_METHOD(93) {
+		set_test_name("revalidated() makes the entry fresh again, keeping its freshness lifetime");
+		time_t later = time(NULL) + 120;
+		ensure("(1)", storeWithValidators(responseCache, "/", "hello", "\"v1\"", ""));
+		ensure("(2)", !fetchAt(responseCache, "/", later).valid());
+		ensure("(3)", req.staleCacheEntry.valid());
+
+		respondNotModified();
+		responseCache.revalidated(&req, later);
+		ensure_equals("(4)", responseCache.getRevalidations(), 1u);
+		ensure("(5)", req.staleCacheEntry.body->expiryDate > later);
+
+		ResponseCacheType::Entry entry(fetchAt(responseCache, "/", later));
+		ensure("(6)", entry.valid());
+		ensure_equals("(7)", StaticString(entry.body->httpBodyData, entry.body->httpBodySize),
+			StaticString("hello"));
+		ensure("(8)", !fetchAt(responseCache, "/", later + 120).valid());
+	}
+
+	TEST_METHOD(94) {
+		set_test_name("revalidated() restores the entry if it was evicted in the meantime");
+		time_t later = time(NULL) + 120;
+		ensure("(1)", storeWithValidators(responseCache, "/", "hello", "\"v1\"", ""));
+		ensure("(2)", !fetchAt(responseCache, "/", later).valid());
+		responseCache.clear();
+
+		respondNotModified();
+		responseCache.revalidated(&req, later);
+		ResponseCacheType::Entry entry(fetchAt(responseCache, "/", later));
+		ensure("(3)", entry.valid());
+		ensure_equals("(4)", StaticString(entry.body->httpBodyData, entry.body->httpBodySize),
+			StaticString("hello"));
+		ensure_equals("(5)", StaticString(entry.body->etagData, entry.body->etagSize),
+			StaticString("\"v1\""));
+	}
+
+	TEST_METHOD(95) {
+		set_test_name("requestIsNotModified() checks If-None-Match");
+		ensure(storeWithValidators(responseCache, "/", "hello", "W/\"v1\"", ""));
+
+		reset();
+		insertReqHeader(createHeader("if-none-match", "\"v0\", \"v1\""), req.pool);
+		ensure("(1)", responseCache.prepareRequest(this, &req));
+		ResponseCacheType::Entry entry(responseCache.fetch(&req, time(NULL)));
+		ensure("(2)", entry.valid());
+		ensure("(3)", responseCache.requestIsNotModified(&req, entry));
+
+		reset();
+		insertReqHeader(createHeader("if-none-match", "\"v2\""), req.pool);
+		ensure("(4)", responseCache.prepareRequest(this, &req));
+		entry = responseCache.fetch(&req, time(NULL));
+		ensure("(5)", !responseCache.requestIsNotModified(&req, entry));
+
+		reset();
+		insertReqHeader(createHeader("if-none-match", "*"), req.pool);
+		ensure("(6)", responseCache.prepareRequest(this, &req));
+		entry = responseCache.fetch(&req, time(NULL));
+		ensure("(7)", responseCache.requestIsNotModified(&req, entry));
+
+		reset();
+		ensure("(8)", responseCache.prepareRequest(this, &req));
+		entry = responseCache.fetch(&req, time(NULL));
+		ensure("(9)", !responseCache.requestIsNotModified(&req, entry));
+	}
+
+	TEST_METHOD(96) {
+		set_test_name("requestIsNotModified() checks If-Modified-Since");
+		ensure(storeWithValidators(responseCache, "/", "hello", "",
+			"Sat, 01 Jan 2000 00:00:00 GMT"));
+
+		reset();
+		insertReqHeader(createHeader("if-modified-since", "Sat, 01 Jan 2000 00:00:00 GMT"), req.pool);
+		ensure("(1)", responseCache.prepareRequest(this, &req));
+		ResponseCacheType::Entry entry(responseCache.fetch(&req, time(NULL)));
+		ensure("(2)", entry.valid());
+		ensure("(3)", responseCache.requestIsNotModified(&req, entry));
+
+		reset();
+		insertReqHeader(createHeader("if-modified-since", "Fri, 31 Dec 1999 00:00:00 GMT"), req.pool);
+		ensure("(4)", responseCache.prepareRequest(this, &req));
+		entry = responseCache.fetch(&req, time(NULL));
+		ensure("(5)", !responseCache.requestIsNotModified(&req, entry));
+	}
+
+	TEST_METHOD(97) {
+		set_test_name("Revalidation works with a shared cache");
+		SharedResponseCache shared(16, 1024 * 1024, 1024 * 64);
+		ResponseCacheType cache;
+		cache.setShared(&shared);
+		time_t later = time(NULL) + 120;
+
+		ensure("(1)", storeWithValidators(cache, "/", "hello", "\"v1\"", ""));
+		ensure("(2)", !fetchAt(cache, "/", later).valid());
+		ensure("(3)", req.staleCacheEntry.valid());
+		ensure_equals("(4)", lookupReqHeader("if-none-match"), StaticString("\"v1\""));
+
+		respondNotModified();
+		cache.revalidated(&req, later);
+		ResponseCacheType::Entry entry(fetchAt(cache, "/", later));
+		ensure("(5)", entry.valid());
+		ensure_equals("(6)", StaticString(entry.body->httpBodyData, entry.body->httpBodySize),
+			StaticString("hello"));
+		ensure_equals("(7)", StaticString(entry.body->etagData, entry.body->etagSize),
+			StaticString("\"v1\""));
+	}
+
+	TEST_METHOD(98) {
+		set_test_name("A stale entry stored in an mbuf block is revalidated without copying its body");
+		struct MemoryKit::mbuf_pool pool;
+		pool.mbuf_block_chunk_size = DEFAULT_MBUF_CHUNK_SIZE;
+		MemoryKit::mbuf_pool_init(&pool);
+		{
+			ResponseCacheType cache(10, 1024 * 1024);
+			cache.setMbufPool(&pool);
+			string body(1024 * 100, 'x');
+			time_t later = time(NULL) + 120;
+
+			ensure("(1)", storeWithValidators(cache, "/", body, "\"v1\"", ""));
+			MemoryKit::mbuf_block *block = fetch(cache, "/").body->dataBlock;
+			ensure("(2)", block != NULL);
+			ensure("(3)", !fetchAt(cache, "/", later).valid());
+			ensure("(4)", req.staleCacheEntry.valid());
+			ensure("(5)", req.staleCacheEntry.body->dataBlock == block);
+
+			cache.clear();
+			ensure_equals("(6)", pool.nactive_mbuf_blockq, 1u);
+			ensure("(7)", StaticString(req.staleCacheEntry.body->httpBodyData,
+				req.staleCacheEntry.body->httpBodySize) == body);
+
+			cache.releaseStaleEntry(&req);
+			ensure("(8)", !req.staleCacheEntry.valid());
+			ensure_equals("(9)", pool.nactive_mbuf_blockq, 0u);
+		}
+		MemoryKit::mbuf_pool_deinit(&pool);
+	}
+
+
+	/***** Serving stale responses *****/
+
+	TEST_METHOD(100) {
+		set_test_name("A stale entry within its stale-while-revalidate window is served and marked for refreshing");
+		time_t later = time(NULL) + 120;
+		ensure("(1)", storeWithValidators(responseCache, "/", "hello", "", "",
+			"public,max-age=60,stale-while-revalidate=120"));
+
+		ResponseCacheType::Entry entry(fetchAt(responseCache, "/", time(NULL)));
+		ensure("(2)", entry.valid());
+		ensure("(3)", !entry.needsRefresh);
+
+		entry = fetchAt(responseCache, "/", later);
+		ensure("(4)", entry.valid());
+		ensure("(5)", entry.needsRefresh);
+		ensure_equals("(6)", StaticString(entry.body->httpBodyData, entry.body->httpBodySize),
+			StaticString("hello"));
+		ensure_equals("(7)", responseCache.getStaleHits(), 1u);
+
+		ensure("(8)", !fetchAt(responseCache, "/", later + 120).valid());
+		ensure_equals("(9)", responseCache.getCount(), 0u);
+	}
+
+	TEST_METHOD(101) {
+		set_test_name("A stale entry within its stale-if-error window is kept for serving on errors");
+		time_t later = time(NULL) + 120;
+		ensure("(1)", storeWithValidators(responseCache, "/", "hello", "", "",
+			"public,max-age=60,stale-if-error=120"));
+
+		ensure("(2)", !fetchAt(responseCache, "/", later).valid());
+		ensure("(3)", req.staleCacheEntry.valid());
+		ensure("(4)", responseCache.canServeStaleIfError(req.staleCacheEntry, later));
+		ensure("(5)", !responseCache.canServeStaleIfError(req.staleCacheEntry, later + 120));
+		ensure("(6)", req.headers.lookup("if-none-match") == NULL);
+		ensure_equals("(7)", responseCache.getCount(), 1u);
+
+		ensure("(8)", !fetchAt(responseCache, "/", later + 120).valid());
+		ensure("(9)", !req.staleCacheEntry.valid());
+		ensure_equals("(10)", responseCache.getCount(), 0u);
+	}
+
+	TEST_METHOD(102) {
+		set_test_name("purge() removes only entries that may no longer be served stale");
+		time_t later = time(NULL) + 120;
+		ensure("(1)", storeWithValidators(responseCache, "/a", "hello", "", ""));
+		ensure("(2)", storeWithValidators(responseCache, "/b", "hello", "", "",
+			"public,max-age=60,stale-while-revalidate=120"));
+		ensure("(3)", storeWithValidators(responseCache, "/c", "hello", "", "",
+			"public,max-age=60,stale-if-error=120"));
+
+		responseCache.purge(later);
+		ensure_equals("(4)", responseCache.getCount(), 2u);
+		ensure("(5)", fetchAt(responseCache, "/b", later).valid());
+
+		responseCache.purge(later + 120);
+		ensure_equals("(6)", responseCache.getCount(), 0u);
+	}
+
+	TEST_METHOD(103) {
+		set_test_name("A cache that has never stored anything can be used normally");
+		ResponseCacheType cache(16, 1024);
+		ensure("(1)", !fetch(cache, "/a").valid());
+		cache.clear();
+		cache.purge(time(NULL));
+		ensure_equals("(2)", cache.getCount(), 0u);
+		ensure_equals("(3)", cache.getMemoryUsage(), (size_t) 0);
+		ensure("(4)", !cache.inspect().empty());
+
+		ensure("(5)", storeWithValidators(cache, "/a", "hello", "", ""));
+		ensure("(6)", fetch(cache, "/a").valid());
+		ensure_equals("(7)", cache.getCount(), 1u);
+
+		cache.setLimits(8, 1024);
+		ensure_equals("(8)", cache.getCount(), 0u);
+		ensure("(9)", !fetch(cache, "/a").valid());
+	}
 }
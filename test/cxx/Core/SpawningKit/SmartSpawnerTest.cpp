@@ -5,6 +5,10 @@
 #include <LoggingKit/LoggingKit.h>
 #include <LoggingKit/Context.h>
 #include <FileDescriptor.h>
+#include <FileTools/FileManip.h>
+#include <StrIntTools/StrIntUtils.h>
+#include <oxt/thread.hpp>
+#include <boost/bind.hpp>
 #include <IOTools/IOUtils.h>
 #include <unistd.h>
 #include <climits>
@@ -61,15 +65,17 @@ namespace tut {
 			unlink("stub/wsgi/passenger_wsgi.pyc");
 		}
 
-		boost::shared_ptr<SmartSpawner> createSpawner(const SpawningKit::AppPoolOptions &options, bool exitImmediately = false) {
+		boost::shared_ptr<SmartSpawner> createSpawner(const SpawningKit::AppPoolOptions &options,
+			const string &preloaderArg = string())
+		{
 			char buf[PATH_MAX + 1];
 			getcwd(buf, PATH_MAX);
 
 			vector<string> command;
 			command.push_back("ruby");
 			command.push_back(string(buf) + "/support/placebo-preloader.rb");
-			if (exitImmediately) {
-				command.push_back("exit-immediately");
+			if (!preloaderArg.empty()) {
+				command.push_back(preloaderArg);
 			}
 
 			return boost::make_shared<SmartSpawner>(&context, command,
@@ -128,7 +134,7 @@ namespace tut {
 			LoggingKit::setLevel(LoggingKit::CRIT);
 		}
 
-		boost::shared_ptr<SmartSpawner> spawner = createSpawner(options, true);
+		boost::shared_ptr<SmartSpawner> spawner = createSpawner(options, "exit-immediately");
 		try {
 			spawner->spawn(options);
 			fail("SpawnException expected");
@@ -248,4 +254,127 @@ namespace tut {
 			ensure(containsSubstring(e.getSubprocessEnvvars(), "PASSENGER_FOO=foo\n"));
 		}
 	}
+
+	static void spawnAndStorePid(SmartSpawner *spawner,
+		SpawningKit::AppPoolOptions options, pid_t *pid)
+	{
+		try {
+			SpawningKit::Result result = spawner->spawn(options);
+			*pid = result.pid;
+			kill(result.pid, SIGTERM);
+		} catch (const SpawnException &) {
+			*pid = -1;
+		}
+	}
+
+	static vector<pid_t> spawnConcurrentlyAndGetPids(SmartSpawner *spawner,
+		const SpawningKit::AppPoolOptions &options, unsigned int count)
+	{
+		vector<boost::shared_ptr<oxt::thread> > threads;
+		vector<pid_t> pids(count, -1);
+		unsigned int i;
+
+		for (i = 0; i < count; i++) {
+			threads.push_back(boost::make_shared<oxt::thread>(
+				boost::bind(spawnAndStorePid, spawner, options, &pids[i]),
+				"Spawner " + toString(i), 1024 * 512));
+		}
+		for (i = 0; i < count; i++) {
+			threads[i]->join();
+		}
+		return pids;
+	}
+
+	static void spawnConcurrently(SmartSpawner *spawner,
+		const SpawningKit::AppPoolOptions &options, unsigned int count)
+	{
+		vector<pid_t> pids = spawnConcurrentlyAndGetPids(spawner, options, count);
+		unsigned int i;
+
+		for (i = 0; i < count; i++) {
+			ensure("Spawn succeeded", pids[i] > 0);
+			for (unsigned int j = 0; j < i; j++) {
+				ensure("PIDs are unique", pids[i] != pids[j]);
+			}
+		}
+	}
+
+	TEST_METHOD(15) {
+		set_test_name("Concurrent spawns are forked by the preloader in batches");
+		SpawningKit::AppPoolOptions options = createOptions();
+		options.appRoot      = "stub/rack";
+		options.appStartCommand = "ruby start.rb";
+		options.startupFile  = "start.rb";
+		boost::shared_ptr<SmartSpawner> spawner = createSpawner(options,
+			"record-spawn-batch");
+
+		spawnConcurrently(spawner.get(), options, 4);
+
+		// The preloader records the size of every batch it receives.
+		vector<string> sizes;
+		split(unsafeReadFile("/tmp/placebo-preloader.spawn_batch."
+			+ toString(spawner->getPreloaderPid())), '\n', sizes);
+		bool batched = false;
+		for (unsigned int i = 0; i < sizes.size(); i++) {
+			batched = batched || stringToUint(sizes[i]) > 1;
+		}
+		ensure("A spawn_batch command with multiple entries was sent", batched);
+	}
+
+	TEST_METHOD(16) {
+		set_test_name("If the preloader doesn't support batch forking then"
+			" concurrent spawns fall back to forking one by one");
+		SpawningKit::AppPoolOptions options = createOptions();
+		options.appRoot      = "stub/rack";
+		options.appStartCommand = "ruby start.rb";
+		options.startupFile  = "start.rb";
+		boost::shared_ptr<SmartSpawner> spawner = createSpawner(options,
+			"no-spawn-batch");
+
+		if (defaultLogLevel == (LoggingKit::Level) DEFAULT_LOG_LEVEL) {
+			// If the user did not customize the test's log level,
+			// then we'll want to tone down the noise.
+			LoggingKit::setLevel(LoggingKit::CRIT);
+		}
+
+		spawnConcurrently(spawner.get(), options, 4);
+	}
+
+	TEST_METHOD(17) {
+		set_test_name("If a batch fork command fails after it has been sent,"
+			" then the preloader is stopped instead of falling back to"
+			" forking one by one");
+		SpawningKit::AppPoolOptions options = createOptions();
+		options.appRoot      = "stub/rack";
+		options.appStartCommand = "ruby start.rb";
+		options.startupFile  = "start.rb";
+		boost::shared_ptr<SmartSpawner> spawner = createSpawner(options,
+			"broken-spawn-batch");
+
+		if (defaultLogLevel == (LoggingKit::Level) DEFAULT_LOG_LEVEL) {
+			// If the user did not customize the test's log level,
+			// then we'll want to tone down the noise.
+			LoggingKit::setLevel(LoggingKit::CRIT);
+		}
+
+		// A single spawn starts the preloader without batching.
+		SpawningKit::Result result = spawner->spawn(options);
+		kill(result.pid, SIGTERM);
+		pid_t preloaderPid = spawner->getPreloaderPid();
+		ensure(preloaderPid != -1);
+
+		// Whether spawns get batched depends on timing,
+		// so try a few times.
+		bool failed = false;
+		for (unsigned int round = 0; round < 20 && !failed; round++) {
+			vector<pid_t> pids = spawnConcurrentlyAndGetPids(spawner.get(),
+				options, 4);
+			for (unsigned int i = 0; i < pids.size(); i++) {
+				failed = failed || pids[i] == -1;
+			}
+		}
+		ensure("A batch failed", failed);
+		ensure("The preloader was stopped",
+			spawner->getPreloaderPid() != preloaderPid);
+	}
 }
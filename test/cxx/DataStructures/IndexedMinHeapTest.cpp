@@ -0,0 +1,97 @@
+#include <TestSupport.h>
+#include <DataStructures/IndexedMinHeap.h>
+#include <vector>
+#include <cstdlib>
+
+using namespace Passenger;
+using namespace std;
+
+namespace tut {
+	struct DataStructures_IndexedMinHeapTest: public TestBase {
+		IndexedMinHeap heap;
+
+		static unsigned int scanForMinimum(const vector<int> &keys) {
+			unsigned int result = 0;
+			for (unsigned int i = 1; i < keys.size(); i++) {
+				if (keys[i] < keys[result]) {
+					result = i;
+				}
+			}
+			return result;
+		}
+	};
+
+	DEFINE_TEST_GROUP(DataStructures_IndexedMinHeapTest);
+
+	TEST_METHOD(1) {
+		// A new heap is empty.
+		ensure(heap.empty());
+		ensure_equals(heap.size(), 0u);
+	}
+
+	TEST_METHOD(2) {
+		// top() returns the item with the lowest key.
+		heap.push(5);
+		heap.push(3);
+		heap.push(8);
+		ensure_equals(heap.size(), 3u);
+		ensure_equals(heap.top(), 1u);
+		ensure_equals(heap.get(0), 5);
+		ensure_equals(heap.get(1), 3);
+		ensure_equals(heap.get(2), 8);
+	}
+
+	TEST_METHOD(3) {
+		// Ties are broken by the lowest item number.
+		heap.push(2);
+		heap.push(1);
+		heap.push(1);
+		heap.push(1);
+		ensure_equals(heap.top(), 1u);
+		heap.set(1, 2);
+		ensure_equals(heap.top(), 2u);
+		heap.set(0, 1);
+		ensure_equals(heap.top(), 0u);
+	}
+
+	TEST_METHOD(4) {
+		// set() moves items up and down the heap.
+		heap.push(1);
+		heap.push(2);
+		heap.push(3);
+		heap.set(2, 0);
+		ensure_equals(heap.top(), 2u);
+		heap.set(2, 10);
+		ensure_equals(heap.top(), 0u);
+		heap.set(0, 11);
+		ensure_equals(heap.top(), 1u);
+		ensure_equals(heap.get(0), 11);
+		ensure_equals(heap.get(2), 10);
+	}
+
+	TEST_METHOD(5) {
+		// clear() removes all items.
+		heap.push(1);
+		heap.push(2);
+		heap.clear();
+		ensure(heap.empty());
+		heap.push(7);
+		ensure_equals(heap.top(), 0u);
+	}
+
+	TEST_METHOD(6) {
+		// top() always agrees with a linear scan for the first minimum.
+		vector<int> keys;
+		srand(1234);
+		for (unsigned int i = 0; i < 100; i++) {
+			keys.push_back(rand() % 10);
+			heap.push(keys.back());
+		}
+		for (unsigned int i = 0; i < 10000; i++) {
+			unsigned int item = rand() % keys.size();
+			keys[item] = rand() % 10;
+			heap.set(item, keys[item]);
+			ensure_equals(heap.top(), scanForMinimum(keys));
+		}
+	}
+}
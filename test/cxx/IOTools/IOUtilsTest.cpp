@@ -4,6 +4,8 @@
 #include <oxt/system_calls.hpp>
 #include <boost/bind/bind.hpp>
 #include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
 #include <cerrno>
 #include <string>
 #include <algorithm>
@@ -932,4 +934,43 @@ namespace tut {
 		ensure_equals(result.first, "hello");
 		ensure(!result.second);
 	}
+
+
+	/***** Test createTcpServer() *****/
+
+	static unsigned short getLocalPort(int fd) {
+		struct sockaddr_in addr;
+		socklen_t len = sizeof(addr);
+		if (getsockname(fd, (struct sockaddr *) &addr, &len) == -1) {
+			int e = errno;
+			throw SystemException("getsockname() failed", e);
+		}
+		return ntohs(addr.sin_port);
+	}
+
+	TEST_METHOD(90) {
+		set_test_name("createTcpServer() does not allow multiple sockets on the"
+			" same port without reusePort");
+		FileDescriptor fd1(createTcpServer("127.0.0.1", 0, 0, __FILE__, __LINE__),
+			__FILE__, __LINE__);
+		try {
+			FileDescriptor fd2(createTcpServer("127.0.0.1", getLocalPort(fd1), 0,
+				__FILE__, __LINE__), __FILE__, __LINE__);
+			fail("SystemException expected");
+		} catch (const SystemException &e) {
+			ensure_equals(e.code(), EADDRINUSE);
+		}
+	}
+
+	#ifdef SO_REUSEPORT
+		TEST_METHOD(91) {
+			set_test_name("createTcpServer() allows multiple sockets on the same"
+				" port with reusePort");
+			FileDescriptor fd1(createTcpServer("127.0.0.1", 0, 0, __FILE__, __LINE__, true),
+				__FILE__, __LINE__);
+			FileDescriptor fd2(createTcpServer("127.0.0.1", getLocalPort(fd1), 0,
+				__FILE__, __LINE__, true), __FILE__, __LINE__);
+			ensure_equals(getLocalPort(fd2), getLocalPort(fd1));
+		}
+	#endif
 }
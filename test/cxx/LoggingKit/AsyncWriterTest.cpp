@@ -0,0 +1,259 @@
+#include <TestSupport.h>
+#include <LoggingKit/AsyncWriter.h>
+#include <LoggingKit/LoggingKit.h>
+#include <LoggingKit/Context.h>
+#include <FileTools/FileManip.h>
+#include <IOTools/IOUtils.h>
+#include <StrIntTools/StrIntUtils.h>
+#include <boost/bind/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <oxt/thread.hpp>
+#include <string>
+#include <vector>
+#include <poll.h>
+
+using namespace Passenger;
+using namespace Passenger::LoggingKit;
+using namespace std;
+
+namespace tut {
+	struct LoggingKit_AsyncWriterTest: public TestBase {
+		boost::scoped_ptr<AsyncWriter> writer;
+		Pipe p;
+		string output;
+		boost::scoped_ptr<oxt::thread> readerThread;
+		bool loggingKitReconfigured;
+
+		LoggingKit_AsyncWriterTest()
+			: loggingKitReconfigured(false)
+		{
+			p = createPipe(__FILE__, __LINE__);
+		}
+
+		~LoggingKit_AsyncWriterTest() {
+			if (loggingKitReconfigured) {
+				// Let LoggingKit's async writer finish writing to
+				// the pipe before the pipe is closed.
+				if (readerThread == NULL) {
+					startReader();
+				}
+				LoggingKit::context->getConfigRealization()->asyncWriter->flush();
+
+				Json::Value config;
+				config["target"]["stderr"] = true;
+				config["async_logging"] = false;
+				configureLoggingKit(config);
+				unlink("tmp.log");
+			}
+			if (writer != NULL) {
+				if (readerThread == NULL) {
+					startReader();
+				}
+				finish();
+			} else if (readerThread != NULL) {
+				p.second.close();
+				readerThread->join();
+			}
+		}
+
+		void startReader() {
+			readerThread.reset(new oxt::thread(
+				boost::bind(&LoggingKit_AsyncWriterTest::readerMain, this),
+				"Reader", 128 * 1024));
+		}
+
+		void readerMain() {
+			output = readAll(p.first, std::numeric_limits<size_t>::max()).first;
+		}
+
+		// Destroys the writer, which writes out everything that is still
+		// queued, and then collects all output.
+		void finish() {
+			writer.reset();
+			p.second.close();
+			readerThread->join();
+			readerThread.reset();
+		}
+
+		void writeLines(unsigned int count, AsyncOverflowPolicy policy,
+			const string &prefix = "line ", unsigned int padding = 0)
+		{
+			for (unsigned int i = 0; i < count; i++) {
+				string line = prefix + toString(i) + string(padding, 'x') + "\n";
+				writer->write(p.second, line.data(), line.size(), policy);
+			}
+		}
+
+		void configureLoggingKit(const Json::Value &config) {
+			vector<ConfigKit::Error> errors;
+			LoggingKit::ConfigChangeRequest req;
+
+			if (LoggingKit::context->prepareConfigChange(config, errors, req)) {
+				LoggingKit::context->commitConfigChange(req);
+			} else {
+				P_BUG("Error configuring LoggingKit: " << ConfigKit::toString(errors));
+			}
+		}
+
+		void writeToAsyncWriter(AsyncWriter *asyncWriter) {
+			string line(200, 'x');
+			line.append("\n");
+			for (unsigned int i = 0; i < 1000; i++) {
+				asyncWriter->write(p.second, line.data(), line.size(), DROP_ON_OVERFLOW);
+			}
+		}
+
+		static string expectedLines(unsigned int count, const string &prefix = "line ") {
+			string result;
+			for (unsigned int i = 0; i < count; i++) {
+				result.append(prefix + toString(i) + "\n");
+			}
+			return result;
+		}
+	};
+
+	DEFINE_TEST_GROUP(LoggingKit_AsyncWriterTest);
+
+	TEST_METHOD(1) {
+		set_test_name("Entries from a single thread are written in order");
+		writer.reset(new AsyncWriter(4096));
+		startReader();
+		writeLines(10000, BLOCK_ON_OVERFLOW);
+		finish();
+		ensure_equals(output, expectedLines(10000));
+	}
+
+	TEST_METHOD(2) {
+		set_test_name("flush() waits until all queued entries are written");
+		char buf[1024 * 16];
+		writer.reset(new AsyncWriter(4096));
+		writeLines(100, BLOCK_ON_OVERFLOW);
+		writer->flush();
+
+		ssize_t ret = read(p.first, buf, sizeof(buf));
+		ensure(ret > 0);
+		ensure_equals(string(buf, ret), expectedLines(100));
+	}
+
+	TEST_METHOD(3) {
+		set_test_name("Entries that are too large to be queued are written in order");
+		writer.reset(new AsyncWriter(4096));
+		startReader();
+		writeLines(10, BLOCK_ON_OVERFLOW);
+		string big(4096, 'x');
+		big.append("\n");
+		writer->write(p.second, big.data(), big.size(), BLOCK_ON_OVERFLOW);
+		writeLines(10, BLOCK_ON_OVERFLOW);
+		finish();
+		ensure_equals(output, expectedLines(10) + big + expectedLines(10));
+	}
+
+	TEST_METHOD(4) {
+		set_test_name("Entries from multiple threads are all written");
+		vector<oxt::thread *> threads;
+		writer.reset(new AsyncWriter(4096));
+		startReader();
+		for (unsigned int i = 0; i < 4; i++) {
+			threads.push_back(new oxt::thread(
+				boost::bind(&LoggingKit_AsyncWriterTest::writeLines, this,
+					2500, BLOCK_ON_OVERFLOW, "thread " + toString(i) + " line ", 0),
+				"Writer " + toString(i), 128 * 1024));
+		}
+		for (unsigned int i = 0; i < threads.size(); i++) {
+			threads[i]->join();
+			delete threads[i];
+		}
+		finish();
+
+		vector<string> lines;
+		split(output, '\n', lines);
+		ensure_equals(lines.size(), (size_t) 10001);
+		for (unsigned int i = 0; i < 4; i++) {
+			string prefix = "thread " + toString(i) + " line ";
+			unsigned int next = 0;
+			for (unsigned int j = 0; j < lines.size(); j++) {
+				if (startsWith(lines[j], prefix)) {
+					ensure_equals("Lines of a single thread are in order",
+						lines[j], prefix + toString(next));
+					next++;
+				}
+			}
+			ensure_equals(next, 2500u);
+		}
+	}
+
+	TEST_METHOD(5) {
+		set_test_name("The 'drop' overflow policy drops entries when the buffer is full");
+		writer.reset(new AsyncWriter(4096));
+		// Nobody is reading from the pipe yet, so the writer
+		// thread blocks as soon as the pipe buffer is full.
+		writeLines(10000, DROP_ON_OVERFLOW, "line ", 100);
+		unsigned long long dropped = writer->getDroppedEntries();
+		ensure("Some entries were dropped", dropped > 0);
+
+		startReader();
+		finish();
+		vector<string> lines;
+		split(output, '\n', lines);
+		ensure_equals(lines.size() - 1 + dropped, 10000ull);
+		ensure("No drops are reported",
+			output.find("log entries were dropped") == string::npos);
+	}
+
+	TEST_METHOD(6) {
+		set_test_name("The 'count' overflow policy reports the number of dropped entries");
+		writer.reset(new AsyncWriter(4096));
+		writeLines(10000, COUNT_ON_OVERFLOW, "line ", 100);
+		ensure("Some entries were dropped", writer->getDroppedEntries() > 0);
+
+		startReader();
+		finish();
+		ensure(output.find(" log entries were dropped because the"
+			" async logging buffer was full") != string::npos);
+	}
+
+	TEST_METHOD(7) {
+		set_test_name("writeNow() writes the entries that the calling thread"
+			" queued earlier, and then the given data, before it returns");
+		char buf[1024 * 16];
+		string expected = expectedLines(100) + "now\n";
+		string result;
+
+		writer.reset(new AsyncWriter(4096));
+		writeLines(100, BLOCK_ON_OVERFLOW);
+		writer->writeNow(p.second, "now\n", 4);
+
+		while (result.size() < expected.size()) {
+			struct pollfd pfd;
+			pfd.fd = p.first;
+			pfd.events = POLLIN;
+			ensure("All data has been written", poll(&pfd, 1, 0) == 1);
+			ssize_t ret = read(p.first, buf, sizeof(buf));
+			ensure(ret > 0);
+			result.append(buf, ret);
+		}
+		ensure_equals(result, expected);
+	}
+
+	TEST_METHOD(8) {
+		set_test_name("Critical messages are written synchronously"
+			" when async logging is enabled");
+		Json::Value config;
+		config["target"] = "tmp.log";
+		config["async_logging"] = true;
+		configureLoggingKit(config);
+		loggingKitReconfigured = true;
+
+		// Keep the writer thread busy with entries from another thread,
+		// for a pipe that nobody reads from yet.
+		AsyncWriter *asyncWriter = LoggingKit::context->getConfigRealization()->asyncWriter;
+		oxt::thread thr(boost::bind(&LoggingKit_AsyncWriterTest::writeToAsyncWriter,
+			this, asyncWriter), "Writer", 128 * 1024);
+		thr.join();
+		syscalls::usleep(50000);
+
+		P_CRITICAL("Something critical happened");
+		ensure(containsSubstring(unsafeReadFile("tmp.log"),
+			"Something critical happened\n"));
+	}
+}
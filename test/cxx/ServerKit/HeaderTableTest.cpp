@@ -191,4 +191,42 @@ namespace tut {
 
 		ensure_equals<void *>("(3)", table.lookup("Content-Length"), NULL);
 	}
+
+	TEST_METHOD(11) {
+		set_test_name("Well-known headers can be looked up, erased and cleared");
+
+		for (unsigned int i = 0; i < NUM_KNOWN_HEADERS; i++) {
+			ensure_equals(("(1) " + KNOWN_HEADERS[i]).c_str(),
+				lookupKnownHeaderIndex(KNOWN_HEADERS[i].hash()), i);
+			ensure_equals(("(2) " + KNOWN_HEADERS[i]).c_str(),
+				KNOWN_HEADERS[i].hash(), HashedStaticString(KNOWN_HEADERS[i].data(),
+					KNOWN_HEADERS[i].size()).hash());
+		}
+		ensure_equals("(3)", lookupKnownHeaderIndex(HashedStaticString("x-unknown").hash()),
+			(unsigned int) NO_KNOWN_HEADER);
+
+		for (unsigned int i = 0; i < NUM_KNOWN_HEADERS; i++) {
+			insertHeader(createHeader(KNOWN_HEADERS[i], KNOWN_HEADERS[i]), pool);
+		}
+		insertHeader(createHeader("x-unknown", "foo"), pool);
+		ensure_equals("(4)", table.size(), NUM_KNOWN_HEADERS + 1);
+		for (unsigned int i = 0; i < NUM_KNOWN_HEADERS; i++) {
+			ensure(("(5) " + KNOWN_HEADERS[i]).c_str(),
+				psg_lstr_cmp(table.lookup(KNOWN_HEADERS[i]), KNOWN_HEADERS[i]));
+		}
+		ensure("(6)", psg_lstr_cmp(table.lookup("x-unknown"), "foo"));
+
+		table.erase(P_HASHED_STATIC_STRING("host"));
+		ensure_equals<void *>("(7)", table.lookup("host"), NULL);
+		ensure("(8)", psg_lstr_cmp(table.lookup("connection"), "connection"));
+
+		HeaderTable copy(table);
+		ensure("(9)", psg_lstr_cmp(copy.lookup("connection"), "connection"));
+
+		table.clear();
+		for (unsigned int i = 0; i < NUM_KNOWN_HEADERS; i++) {
+			ensure_equals<void *>(("(10) " + KNOWN_HEADERS[i]).c_str(),
+				table.lookup(KNOWN_HEADERS[i]), NULL);
+		}
+	}
 }
@@ -8,6 +8,7 @@
 #include <limits>
 #include <BackgroundEventLoop.h>
 #include <ServerKit/HttpServer.h>
+#include <ServerKit/AcceptLoadBalancer.h>
 #include <LoggingKit/LoggingKit.h>
 #include <FileDescriptor.h>
 #include <Utils.h>
@@ -245,9 +246,14 @@ namespace tut {
 			return enableAutoDechunkBody;
 		}
 
+		virtual MyServer *getClientMigrationTarget(MyClient *client) {
+			return migrationTarget;
+		}
+
 	public:
 		bool allowUpgrades;
 		bool enableAutoDechunkBody;
+		MyServer *migrationTarget;
 
 		vector<MyRequest *> requestsWaitingToStartAcceptingBody;
 		unsigned int bodyBytesRead;
@@ -259,6 +265,7 @@ namespace tut {
 			: ParentClass(context, schema, initialConfig),
 			  allowUpgrades(true),
 			  enableAutoDechunkBody(true),
+			  migrationTarget(NULL),
 			  bodyBytesRead(0),
 			  halfCloseDetected(0),
 			  clientDataErrors(0)
@@ -286,6 +293,7 @@ namespace tut {
 		ServerKit::Context context;
 		ServerKit::HttpServerSchema schema;
 		boost::shared_ptr<MyServer> server;
+		boost::shared_ptr<MyServer> server2;
 		int serverSocket;
 		FileDescriptor fd;
 		BufferedIO io;
@@ -320,6 +328,12 @@ namespace tut {
 			while (getServerState() != MyServer::FINISHED_SHUTDOWN) {
 				syscalls::usleep(10000);
 			}
+			if (server2 != NULL) {
+				bg.safe->runSync(boost::bind(&MyServer::shutdown, server2.get(), true));
+				while (getServerState(server2.get()) != MyServer::FINISHED_SHUTDOWN) {
+					syscalls::usleep(10000);
+				}
+			}
 			bg.safe->runSync(boost::bind(&ServerKit_HttpServerTest::destroyServer,
 				this));
 			safelyClose(serverSocket);
@@ -335,6 +349,7 @@ namespace tut {
 
 		void destroyServer() {
 			server.reset();
+			server2.reset();
 		}
 
 		FileDescriptor &connectToServer() {
@@ -362,14 +377,17 @@ namespace tut {
 			return waitUntilReadable(fd, &timeout);
 		}
 
-		MyServer::State getServerState() {
+		MyServer::State getServerState(MyServer *server = NULL) {
 			MyServer::State result;
+			if (server == NULL) {
+				server = this->server.get();
+			}
 			bg.safe->runSync(boost::bind(&ServerKit_HttpServerTest::_getServerState,
-				this, &result));
+				this, server, &result));
 			return result;
 		}
 
-		void _getServerState(MyServer::State *state) {
+		void _getServerState(MyServer *server, MyServer::State *state) {
 			*state = server->serverState;
 		}
 
@@ -406,14 +424,17 @@ namespace tut {
 			*result = server->bodyBytesRead;
 		}
 
-		unsigned int getActiveClientCount() {
+		unsigned int getActiveClientCount(MyServer *server = NULL) {
 			unsigned int result;
+			if (server == NULL) {
+				server = this->server.get();
+			}
 			bg.safe->runSync(boost::bind(&ServerKit_HttpServerTest::_getActiveClientCount,
-				this, &result));
+				this, server, &result));
 			return result;
 		}
 
-		void _getActiveClientCount(unsigned int *result) {
+		void _getActiveClientCount(MyServer *server, unsigned int *result) {
 			*result = server->activeClientCount;
 		}
 
@@ -2062,4 +2083,151 @@ namespace tut {
 			result = getActiveClientCount() == 0;
 		);
 	}
+
+	TEST_METHOD(108) {
+		set_test_name("getLoad() counts active clients and active requests");
+
+		connectToServer();
+		EVENTUALLY(5,
+			result = server->getLoad() == 1;
+		);
+
+		sendRequestAndWait(
+			"GET /body_test HTTP/1.1\r\n"
+			"Content-Length: 2\r\n\r\n");
+		EVENTUALLY(5,
+			result = server->getLoad() == 2;
+		);
+
+		sendRequest("ab");
+		EVENTUALLY(5,
+			result = server->getLoad() == 1;
+		);
+
+		fd.close();
+		EVENTUALLY(5,
+			result = server->getLoad() == 0;
+		);
+	}
+
+	TEST_METHOD(109) {
+		set_test_name("Idle keep-alive clients can be migrated to another server");
+
+		server2 = boost::make_shared<MyServer>(&context, schema);
+		server2->initialize();
+		server->migrationTarget = server2.get();
+
+		connectToServer();
+		sendRequest(
+			"GET / HTTP/1.1\r\n"
+			"Connection: keep-alive\r\n"
+			"Host: foo\r\n\r\n");
+		string header = readResponseHeader();
+		ensure(containsSubstring(header, "Connection: keep-alive"));
+		char body[7];
+		io.read(body, sizeof(body));
+		ensure_equals(string(body, sizeof(body)), "hello /");
+
+		EVENTUALLY(5,
+			result = getActiveClientCount(server2.get()) == 1;
+		);
+		ensure_equals(getActiveClientCount(), 0u);
+
+		sendRequest(
+			"GET /foo HTTP/1.1\r\n"
+			"Connection: close\r\n"
+			"Host: foo\r\n\r\n");
+		string response = io.readAll();
+		ensure(containsSubstring(response, "hello /foo"));
+		ensure_equals(server->totalRequestsBegun, 1u);
+		ensure_equals(server->totalClientsMigrated, 1u);
+		ensure_equals(server2->totalRequestsBegun, 1u);
+	}
+
+	TEST_METHOD(110) {
+		set_test_name("Keep-alive clients are not migrated while "
+			"a pipelined request is being processed");
+
+		server2 = boost::make_shared<MyServer>(&context, schema);
+		server2->initialize();
+		server->migrationTarget = server2.get();
+
+		connectToServer();
+		sendRequest(
+			"GET / HTTP/1.1\r\n"
+			"Connection: keep-alive\r\n"
+			"Host: foo\r\n\r\n"
+			"GET /foo HTTP/1.1\r\n"
+			"Connection: close\r\n"
+			"Host: foo\r\n\r\n");
+
+		string response = readAll(fd, 1024).first;
+		ensure(containsSubstring(response, "hello /"));
+		ensure(containsSubstring(response, "hello /foo"));
+		ensure_equals(server->totalRequestsBegun, 2u);
+		ensure_equals(server->totalClientsMigrated, 0u);
+		ensure_equals(server2->totalRequestsBegun, 0u);
+	}
+
+	static int createLoadBalancedClient(vector<SocketPair> &clients) {
+		clients.push_back(createUnixSocketPair(__FILE__, __LINE__));
+		setNonBlocking(clients.back().first);
+		return clients.back().first.detach();
+	}
+
+	TEST_METHOD(111) {
+		set_test_name("AcceptLoadBalancer passes new clients to the least loaded server,"
+			" including the clients that it hasn't picked up yet, and breaks ties"
+			" round-robin");
+
+		server2 = boost::make_shared<MyServer>(&context, schema);
+		server2->initialize();
+
+		AcceptLoadBalancer<MyServer> balancer;
+		vector<SocketPair> clients;
+		balancer.servers.push_back(server.get());
+		balancer.servers.push_back(server2.get());
+		balancer.start();
+
+		// The event loop isn't running yet, so the servers don't pick up
+		// any clients and both have a load of 0.
+		for (unsigned int i = 0; i < 3; i++) {
+			balancer.newClients[i] = createLoadBalancedClient(clients);
+		}
+		balancer.newClientCount = 3;
+		balancer.distributeNewClients();
+		ensure_equals("(1)", balancer.inFlightClients[0].load(), 2u);
+		ensure_equals("(2)", balancer.inFlightClients[1].load(), 1u);
+
+		// Round-robin would pick the first server now.
+		balancer.nextServer = 0;
+		balancer.newClients[0] = createLoadBalancedClient(clients);
+		balancer.newClientCount = 1;
+		balancer.distributeNewClients();
+		ensure_equals("(3)", balancer.inFlightClients[0].load(), 2u);
+		ensure_equals("(4)", balancer.inFlightClients[1].load(), 2u);
+
+		startLoop();
+		EVENTUALLY(5,
+			result = balancer.inFlightClients[0].load() == 0
+				&& balancer.inFlightClients[1].load() == 0;
+		);
+		ensure_equals("(5)", server->getLoad(), 2u);
+		ensure_equals("(6)", server2->getLoad(), 2u);
+
+		// Disconnect a client of the second server. Round-robin would
+		// pick the first server again.
+		clients[1].second.close();
+		EVENTUALLY(5,
+			result = server2->getLoad() == 1u;
+		);
+		ensure_equals("(7)", (int) balancer.nextServer, 0);
+		balancer.newClients[0] = createLoadBalancedClient(clients);
+		balancer.newClientCount = 1;
+		balancer.distributeNewClients();
+		EVENTUALLY(5,
+			result = server2->getLoad() == 2u;
+		);
+		ensure_equals("(8)", server->getLoad(), 2u);
+	}
 }
@@ -1,6 +1,7 @@
 #include <TestSupport.h>
 #include <boost/shared_ptr.hpp>
 #include <boost/make_shared.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <boost/thread.hpp>
 #include <oxt/system_calls.hpp>
 #include <vector>
@@ -25,6 +26,7 @@ namespace tut {
 		Json::Value config;
 		ServerKit::Schema skSchema;
 		ServerKit::Context context;
+		boost::scoped_ptr<ServerKit::Context> ioUringContext;
 		ServerKit::BaseServerSchema schema;
 		boost::shared_ptr< Server<Client> > server;
 		int serverSocket1, serverSocket2;
@@ -72,11 +74,38 @@ namespace tut {
 
 		template<typename ServerClass>
 		void initWithServerClass() {
-			server = boost::make_shared<ServerClass>(&context, schema, config);
+			server = boost::make_shared<ServerClass>(getContext(), schema, config);
 			server->initialize();
 			server->listen(serverSocket1);
 		}
 
+		/**
+		 * Makes the server use a Context with io_uring enabled. Returns
+		 * false if the kernel doesn't support it.
+		 */
+		bool useIoUring(unsigned int recvBuffers) {
+			Json::Value contextConfig;
+			contextConfig["io_uring"] = true;
+			contextConfig["io_uring_recv_buffers"] = recvBuffers;
+			ioUringContext.reset(new ServerKit::Context(skSchema, contextConfig));
+			ioUringContext->libev = bg.safe;
+			ioUringContext->libuv = bg.libuv_loop;
+			ioUringContext->initialize();
+			#ifdef PASSENGER_IO_URING_SUPPORTED
+				return ioUringContext->ioUring != NULL;
+			#else
+				return false;
+			#endif
+		}
+
+		ServerKit::Context *getContext() {
+			if (ioUringContext != NULL) {
+				return ioUringContext.get();
+			} else {
+				return &context;
+			}
+		}
+
 		void startServer() {
 			bg.start();
 		}
@@ -453,4 +482,95 @@ namespace tut {
 			result = !clientIsConnected(client.get());
 		);
 	}
+
+
+	/****** io_uring *****/
+
+	class Test30Server: public Server<Client> {
+	protected:
+		virtual Channel::Result onClientDataReceived(Client *client,
+			const MemoryKit::mbuf &buffer, int errcode)
+		{
+			boost::lock_guard<boost::mutex> l(syncher);
+			if (errcode != 0 || buffer.empty()) {
+				eof = true;
+				return Channel::Result(0, true);
+			}
+
+			data.append(buffer.start, buffer.size());
+			if (consumeLater) {
+				// Consume asynchronously, so that the client input
+				// channel doesn't accept input for a while.
+				refClient(client, __FILE__, __LINE__);
+				getContext()->libev->runLater(boost::bind(&Test30Server::consume,
+					this, client, (unsigned int) buffer.size()));
+				return Channel::Result(-1, false);
+			} else {
+				return Channel::Result(buffer.size(), false);
+			}
+		}
+
+		void consume(Client *client, unsigned int size) {
+			if (client->connected()) {
+				client->input.consumed(size, false);
+			}
+			unrefClient(client, __FILE__, __LINE__);
+		}
+
+	public:
+		boost::mutex syncher;
+		string data;
+		bool eof;
+		bool consumeLater;
+
+		Test30Server(Context *ctx, const ServerKit::BaseServerSchema &schema,
+			const Json::Value &initialConfig)
+			: Server<Client>(ctx, schema, initialConfig),
+			  eof(false),
+			  consumeLater(false)
+			{ }
+	};
+
+	static void receiveThroughIoUringServer(ServerKit_ServerTest *test, bool consumeLater) {
+		test->initWithServerClass<Test30Server>();
+		Test30Server *s = (Test30Server *) test->server.get();
+		s->consumeLater = consumeLater;
+		test->startServer();
+
+		string data;
+		for (unsigned int i = 0; i < 1024 * 256; i++) {
+			data.append(1, (char) ('a' + i % 26));
+		}
+
+		FileDescriptor fd(test->connectToServer1());
+		writeExact(fd, data);
+		syscalls::shutdown(fd, SHUT_WR);
+
+		EVENTUALLY(5,
+			boost::lock_guard<boost::mutex> l(s->syncher);
+			result = s->eof;
+		);
+		boost::lock_guard<boost::mutex> l(s->syncher);
+		ensure("(1)", s->data == data);
+	}
+
+	TEST_METHOD(30) {
+		set_test_name("With io_uring, input and EOF are made available through"
+			" client->input, even if the kernel runs out of receive buffers");
+
+		if (!useIoUring(4)) {
+			return;
+		}
+		receiveThroughIoUringServer(this, false);
+	}
+
+	TEST_METHOD(31) {
+		set_test_name("With io_uring, data that is received while client->input"
+			" doesn't accept input is passed on in order once it does");
+
+		if (!useIoUring(256)) {
+			return;
+		}
+		receiveThroughIoUringServer(this, true);
+	}
 }
@@ -1,5 +1,6 @@
 #include <TestSupport.h>
 #include <StrIntTools/StrIntUtils.h>
+#include <SystemTools/SystemTime.h>
 
 using namespace Passenger;
 using namespace std;
@@ -14,6 +15,31 @@ namespace tut {
 		ensure("got [" +  sstream.str() + "], expected [" + expected + "]", sstream.str() == expected);
 	}
 
+	/**
+	 * Reference implementation of convertHttpHeaderNameToScgi(): checks the
+	 * name, copies it and then converts it in place, one byte at a time,
+	 * like the session protocol header construction code used to do.
+	 */
+	static bool convertHttpHeaderNameToScgiSlowly(const char *data, char *output, size_t len) {
+		for (size_t i = 0; i < len; i++) {
+			char ch = data[i];
+			if (ch != '-' && !(ch >= '0' && ch <= '9') && !(ch >= 'a' && ch <= 'z')
+				&& !(ch >= 'A' && ch <= 'Z'))
+			{
+				return false;
+			}
+		}
+		memcpy(output, data, len);
+		for (size_t i = 0; i < len; i++) {
+			if (output[i] == '-') {
+				output[i] = '_';
+			} else {
+				output[i] = toupper(output[i]);
+			}
+		}
+		return true;
+	}
+
 	DEFINE_TEST_GROUP(StrIntTools_StrIntUtilsTest);
 
 	TEST_METHOD(1) {
@@ -57,4 +83,74 @@ namespace tut {
 		ensure(!endsWith(str1, "zzz"));
 		ensure(!endsWith("xyz", "zzz"));
 	}
+
+	TEST_METHOD(6) {
+		set_test_name("convertHttpHeaderNameToScgi() uppercases header names, replaces dashes"
+			" by underscores, and rejects names with other characters");
+		const char pattern[] = "x-Forwarded-For-0123456789-abcdefghijklmnopqrstuvwxyz-ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+		string input(pattern, sizeof(pattern) - 1);
+
+		for (unsigned int len = 0; len <= input.size(); len++) {
+			string expected(len, '\0');
+			string actual(len, '\0');
+			ensure(convertHttpHeaderNameToScgiSlowly(input.data(), &expected[0], len));
+			ensure(convertHttpHeaderNameToScgi(input.data(), &actual[0], len));
+			ensure_equals(("(" + toString(len) + ") Output").c_str(), actual, expected);
+		}
+
+		const char invalidChars[] = "_ .:/@[`{\0\xc3\x80\x7f";
+		for (unsigned int len = 1; len <= input.size(); len++) {
+			for (unsigned int i = 0; i < sizeof(invalidChars) - 1; i++) {
+				string invalid = input.substr(0, len);
+				invalid[len / 2] = invalidChars[i];
+				string output(len, '\0');
+				ensure(("(" + toString(len) + ", " + toString(i) + ") Invalid").c_str(),
+					!convertHttpHeaderNameToScgi(invalid.data(), &output[0], len));
+			}
+		}
+	}
+
+	TEST_METHOD(7) {
+		// Benchmark: converting the header names of a request with 32 headers.
+		ONLY_RUN_AS_BENCHMARK();
+		const char *headerNames[] = {
+			"host", "user-agent", "accept", "accept-language", "accept-encoding",
+			"referer", "cookie", "connection", "upgrade-insecure-requests",
+			"sec-fetch-dest", "sec-fetch-mode", "sec-fetch-site", "sec-fetch-user",
+			"cache-control", "pragma", "dnt", "x-forwarded-for", "x-forwarded-proto",
+			"x-forwarded-host", "x-forwarded-port", "x-real-ip", "x-request-id",
+			"x-request-start", "x-amzn-trace-id", "via", "forwarded", "origin",
+			"if-none-match", "if-modified-since", "authorization",
+			"sec-ch-ua-platform", "sec-ch-ua-mobile"
+		};
+		const unsigned int NHEADERS = sizeof(headerNames) / sizeof(const char *);
+		const unsigned int ITERATIONS = 100000;
+		char output[64];
+		unsigned int valid = 0;
+
+		MonotonicTimeUsec begin = SystemTime::getMonotonicUsec();
+		for (unsigned int i = 0; i < ITERATIONS; i++) {
+			for (unsigned int j = 0; j < NHEADERS; j++) {
+				valid += convertHttpHeaderNameToScgiSlowly(headerNames[j], output,
+					strlen(headerNames[j]));
+			}
+		}
+		MonotonicTimeUsec slowDuration = SystemTime::getMonotonicUsec() - begin;
+
+		begin = SystemTime::getMonotonicUsec();
+		for (unsigned int i = 0; i < ITERATIONS; i++) {
+			for (unsigned int j = 0; j < NHEADERS; j++) {
+				valid += convertHttpHeaderNameToScgi(headerNames[j], output,
+					strlen(headerNames[j]));
+			}
+		}
+		MonotonicTimeUsec fastDuration = SystemTime::getMonotonicUsec() - begin;
+
+		ensure_equals(valid, 2 * ITERATIONS * NHEADERS);
+		fprintf(stderr, "  SCGI header name benchmark (%u headers): %u nsec per request"
+			" byte by byte, %u nsec per request with convertHttpHeaderNameToScgi()\n",
+			NHEADERS,
+			(unsigned int) (slowDuration * 1000 / ITERATIONS),
+			(unsigned int) (fastDuration * 1000 / ITERATIONS));
+	}
 }
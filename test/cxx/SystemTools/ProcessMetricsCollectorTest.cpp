@@ -5,6 +5,7 @@
 #include <cerrno>
 #include <ProcessManagement/Spawn.h>
 #include <SystemTools/ProcessMetricsCollector.h>
+#include <SystemTools/SystemTime.h>
 #include <StrIntTools/StrIntUtils.h>
 
 using namespace Passenger;
@@ -113,4 +114,108 @@ namespace tut {
 			ensure("Swap is correct", (swap < 10000 || swap == -1));
 		#endif
 	}
+
+	TEST_METHOD(4) {
+		// Measuring the unique set size works.
+		ssize_t pss, privateDirty, uss, swap;
+		child = spawnChild(50);
+		usleep(500000);
+		collector.measureRealMemory(child, pss, privateDirty, uss, swap);
+		#if defined(__APPLE__)
+			if (geteuid() == 0) {
+				ensure("USS is correct", uss > 50000 && uss < 100000);
+			} else {
+				ensure_equals("USS is correct", uss, (ssize_t) -1);
+			}
+		#elif defined(__linux__)
+			ensure("USS is correct", uss > 50000 && uss < 60000);
+			ensure("USS includes the private dirty RSS", uss >= privateDirty);
+		#else
+			ensure("USS is correct", (uss > 50000 && uss < 60000) || uss == -1);
+		#endif
+	}
+
+	#ifdef __linux__
+		TEST_METHOD(5) {
+			// smaps_rollup, if available, gives the same results as summing up smaps.
+			ssize_t pss, privateDirty, uss, swap;
+			ssize_t rollupPss, rollupPrivateDirty, rollupUss, rollupSwap;
+			child = spawnChild(50);
+			usleep(500000);
+
+			string prefix = "/proc/" + toString(child);
+			if (!collector.measureRealMemoryFromSmaps(prefix + "/smaps_rollup",
+				rollupPss, rollupPrivateDirty, rollupUss, rollupSwap))
+			{
+				return;
+			}
+			ensure(collector.measureRealMemoryFromSmaps(prefix + "/smaps",
+				pss, privateDirty, uss, swap));
+			ensure("PSS is correct", rollupPss >= pss * 0.95 && rollupPss <= pss * 1.05);
+			ensure("Private dirty is correct", rollupPrivateDirty >= privateDirty * 0.95
+				&& rollupPrivateDirty <= privateDirty * 1.05);
+			ensure("USS is correct", rollupUss >= uss * 0.95 && rollupUss <= uss * 1.05);
+			ensure("Swap is correct", rollupSwap >= swap * 0.95 && rollupSwap <= swap * 1.05);
+		}
+	#endif
+
+	#ifdef __linux__
+		TEST_METHOD(6) {
+			// Reading /proc gives the same results as 'ps'.
+			child = spawnChild(50);
+			usleep(500000);
+			vector<pid_t> pids;
+			pids.push_back(getpid());
+			pids.push_back(child);
+
+			ProcessMetricMap fromProc = collector.collect(pids);
+			ProcessMetricMap fromPs = collector.collectFromPs<vector<pid_t>,
+				vector<pid_t>::const_iterator>(pids);
+			ensure_equals(fromProc.size(), 2u);
+			ensure_equals(fromPs.size(), 2u);
+
+			for (unsigned int i = 0; i < pids.size(); i++) {
+				const ProcessMetrics &a = fromProc[pids[i]];
+				const ProcessMetrics &b = fromPs[pids[i]];
+				ensure_equals("PID is correct", a.pid, b.pid);
+				ensure_equals("PPID is correct", a.ppid, b.ppid);
+				ensure_equals("PGID is correct", a.processGroupId, b.processGroupId);
+				ensure_equals("UID is correct", a.uid, b.uid);
+				ensure_equals("Command is correct", a.command, b.command);
+				ensure("RSS is correct", a.rss >= b.rss * 0.9 && a.rss <= b.rss * 1.1);
+				ensure("VM size is correct", a.vmsize >= b.vmsize * 0.9
+					&& a.vmsize <= b.vmsize * 1.1);
+			}
+			ensure("Real memory is measured", fromProc[child].realMemory() > 50000);
+		}
+
+		TEST_METHOD(7) {
+			// Benchmark: reading /proc versus forking 'ps'.
+			ONLY_RUN_AS_BENCHMARK();
+			const unsigned int ITERATIONS = 50;
+			child = spawnChild(1);
+			vector<pid_t> pids;
+			pids.push_back(getpid());
+			pids.push_back(child);
+
+			MonotonicTimeUsec begin = SystemTime::getMonotonicUsec();
+			for (unsigned int i = 0; i < ITERATIONS; i++) {
+				ensure_equals(collector.collectFromPs<vector<pid_t>,
+					vector<pid_t>::const_iterator>(pids).size(), 2u);
+			}
+			MonotonicTimeUsec psDuration = SystemTime::getMonotonicUsec() - begin;
+
+			begin = SystemTime::getMonotonicUsec();
+			for (unsigned int i = 0; i < ITERATIONS; i++) {
+				ensure_equals(collector.collectFromProcFilesystem<vector<pid_t>,
+					vector<pid_t>::const_iterator>(pids).size(), 2u);
+			}
+			MonotonicTimeUsec procDuration = SystemTime::getMonotonicUsec() - begin;
+
+			fprintf(stderr, "  Process metrics benchmark: %u usec per collection with ps, "
+				"%u usec per collection with /proc\n",
+				(unsigned int) (psDuration / ITERATIONS),
+				(unsigned int) (procDuration / ITERATIONS));
+		}
+	#endif
 }
@@ -95,6 +95,15 @@ using namespace oxt;
 		} \
 	} while (false)
 
+// Benchmarks take a while and only print their results, so they are
+// skipped unless PASSENGER_RUN_BENCHMARKS is set.
+#define ONLY_RUN_AS_BENCHMARK() \
+	do { \
+		if (getenv("PASSENGER_RUN_BENCHMARKS") == NULL) { \
+			return; \
+		} \
+	} while (false)
+
 
 extern LoggingKit::Level defaultLogLevel;
 extern ResourceLocator *resourceLocator;
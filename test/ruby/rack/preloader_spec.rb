@@ -43,6 +43,30 @@ def start(options = {})
       "end of startup file\n" \
       "worker_process_started: forked=true\n")
   end
+
+  it "calls the prepare_for_fork event when asked to prepare for forking" do
+    File.prepend(@stub.startup_file, %q{
+      history_file = "history.txt"
+      PhusionPassenger.on_event(:prepare_for_fork) do
+        ::File.open(history_file, 'a') do |f|
+          f.puts "prepare_for_fork\n"
+        end
+      end
+      PhusionPassenger.on_event(:starting_worker_process) do |forked|
+        ::File.open(history_file, 'a') do |f|
+          f.puts "worker_process_started: forked=#{forked}\n"
+        end
+      end
+    })
+    @preloader = Preloader.new(["ruby", "#{PhusionPassenger.helper_scripts_dir}/rack-preloader.rb"], @stub.app_root)
+    @preloader.start
+    expect(@preloader.prepare_for_fork).to eq("result" => "ok")
+    @process = @preloader.spawn
+    expect(@process).to be_an_instance_of(AppProcess)
+    expect(File.read("#{@stub.app_root}/history.txt")).to eq(
+      "prepare_for_fork\n" \
+      "worker_process_started: forked=true\n")
+  end
 end
 
 end # module PhusionPassenger
@@ -327,6 +327,19 @@ def spawn(options = {})
     end
   end
 
+  def prepare_for_fork
+    socket = Utils.connect_to_server(
+      @preloader_process.find_socket_with_protocol('preloader')['address'])
+    begin
+      socket.puts(PhusionPassenger::Utils::JSON.generate(
+        :command => 'prepare_for_fork'
+      ))
+      PhusionPassenger::Utils::JSON.parse(socket.readline)
+    ensure
+      socket.close
+    end
+  end
+
 private
   def write_spawn_request(socket, work_dir)
     socket.puts(PhusionPassenger::Utils::JSON.generate(
@@ -15,6 +15,9 @@
 work_dir = ENV['PASSENGER_SPAWN_WORK_DIR']
 
 socket_filename = "/tmp/placebo-preloader.sock.#{Process.pid}"
+# In "record-spawn-batch" mode, the number of work dirs in every
+# spawn_batch command is appended to this file.
+spawn_batch_record_filename = "/tmp/placebo-preloader.spawn_batch.#{Process.pid}"
 server = UNIXServer.new(socket_filename)
 File.open("#{work_dir}/response/properties.json", 'w') do |f|
   f.write(PhusionPassenger::Utils::JSON.generate(
@@ -31,34 +34,58 @@
   f.write('1')
 end
 
-def process_client_command(server, client, data)
-  doc = PhusionPassenger::Utils::JSON.parse(data)
-  if doc['command'] == 'spawn'
-    work_dir = doc['work_dir']
-    options = PhusionPassenger::Utils::JSON.parse(File.read("#{work_dir}/args.json"))
+def fork_child(server, client, work_dir)
+  options = PhusionPassenger::Utils::JSON.parse(File.read("#{work_dir}/args.json"))
 
-    pid = fork
-    if pid.nil?
-      STDIN.reopen("#{work_dir}/stdin", 'r')
-      STDOUT.reopen("#{work_dir}/stdout_and_err", 'w')
-      STDERR.reopen(STDERR)
-      STDOUT.sync = STDERR.sync = true
-      server.close
-      client.close
+  pid = fork
+  if pid.nil?
+    STDIN.reopen("#{work_dir}/stdin", 'r')
+    STDOUT.reopen("#{work_dir}/stdout_and_err", 'w')
+    STDERR.reopen(STDERR)
+    STDOUT.sync = STDERR.sync = true
+    server.close
+    client.close
 
-      ENV['PASSENGER_SPAWN_WORK_DIR'] = work_dir
-      exec(options['start_command'])
+    ENV['PASSENGER_SPAWN_WORK_DIR'] = work_dir
+    exec(options['start_command'])
+  else
+    if defined?(NativeSupport)
+      NativeSupport.detach_process(pid)
     else
-      client.write(PhusionPassenger::Utils::JSON.generate(
-        :result => 'ok',
-        :pid => pid
-      ))
-      if defined?(NativeSupport)
-        NativeSupport.detach_process(pid)
-      else
-        Process.detach(pid)
+      Process.detach(pid)
+    end
+    pid
+  end
+end
+
+def process_client_command(server, client, data, spawn_batch_record_filename)
+  doc = PhusionPassenger::Utils::JSON.parse(data)
+  if doc['command'] == 'spawn'
+    if ARGV[0] == "record-spawn-batch"
+      # Give concurrent spawns time to queue up behind this one,
+      # so that they are sent as a batch.
+      sleep 0.5
+    end
+    pid = fork_child(server, client, doc['work_dir'])
+    client.write(PhusionPassenger::Utils::JSON.generate(
+      :result => 'ok',
+      :pid => pid
+    ))
+  elsif doc['command'] == 'spawn_batch' && ARGV[0] == "broken-spawn-batch"
+    # Hang up without answering, as if we crashed while forking.
+  elsif doc['command'] == 'spawn_batch' && ARGV[0] != "no-spawn-batch"
+    if ARGV[0] == "record-spawn-batch"
+      File.open(spawn_batch_record_filename, 'a') do |f|
+        f.puts(doc['work_dirs'].size)
       end
     end
+    pids = doc['work_dirs'].map do |work_dir|
+      fork_child(server, client, work_dir)
+    end
+    client.write(PhusionPassenger::Utils::JSON.generate(
+      :result => 'ok',
+      :pids => pids
+    ) + "\n")
   elsif doc['command'] == 'pid'
     client.write(PhusionPassenger::Utils::JSON.generate(
       :result => 'ok',
@@ -79,7 +106,8 @@ def process_client_command(server, client, data)
     if ios.include?(server)
       client = server.accept
       begin
-        process_client_command(server, client, client.readline)
+        process_client_command(server, client, client.readline,
+          spawn_batch_record_filename)
       ensure
         client.close
       end
@@ -94,4 +122,5 @@ def process_client_command(server, client, data)
   end
 ensure
   File.unlink(socket_filename) rescue nil
+  File.unlink(spawn_batch_record_filename) rescue nil
 end